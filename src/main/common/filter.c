@@ -27,7 +27,6 @@
 #include "drivers/gyro_sync.h"
 
 #define BIQUAD_Q    (1.0f / 1.41421356f)     /* quality factor - butterworth (1 / sqrt(2)) */
-#define M_PI_FLOAT  3.14159265358979323846f
 
 /* sets up a biquad Filter */
 void biquadFilterInit(biquadFilter_t *newState, uint8_t filterCutFreq, int16_t samplingRate)
@@ -76,26 +75,134 @@ float biquadFilterApply(biquadFilter_t *state, float sample)
     return result;
 }
 
+// Filter bank
+
+void filterBankInit(filterBank_t *bank)
+{
+    bank->stageCount = 0;
+}
+
+static biquadFilter_t *filterBankNewStage(filterBank_t *bank, float f_cut, float dT)
+{
+    // Stages at or above Nyquist would not filter anything and may be unstable
+    if (bank->stageCount >= FILTER_BANK_MAX_STAGES || f_cut <= 0 || dT <= 0 || f_cut * dT >= 0.5f) {
+        return NULL;
+    }
+
+    biquadFilter_t *stage = &bank->stage[bank->stageCount++];
+    stage->d1 = stage->d2 = 0;
+    return stage;
+}
+
+bool filterBankAddPT1(filterBank_t *bank, float f_cut, float dT)
+{
+    biquadFilter_t *stage = filterBankNewStage(bank, f_cut, dT);
+    if (!stage) {
+        return false;
+    }
+
+    const float RC = 1.0f / (2.0f * M_PIf * f_cut);
+    const float k = dT / (RC + dT);
+
+    // state += k * (input - state)
+    stage->b0 = k;
+    stage->b1 = stage->b2 = 0;
+    stage->a1 = k - 1.0f;
+    stage->a2 = 0;
+    return true;
+}
+
+bool filterBankAddLowpass(filterBank_t *bank, float f_cut, float dT)
+{
+    biquadFilter_t *stage = filterBankNewStage(bank, f_cut, dT);
+    if (!stage) {
+        return false;
+    }
+
+    const float omega = 2 * M_PIf * f_cut * dT;
+    const float cs = cos_approx(omega);
+    const float alpha = sin_approx(omega) / (2 * BIQUAD_Q);
+    const float a0 = 1 + alpha;
+
+    stage->b0 = (1 - cs) / 2 / a0;
+    stage->b1 = (1 - cs) / a0;
+    stage->b2 = stage->b0;
+    stage->a1 = -2 * cs / a0;
+    stage->a2 = (1 - alpha) / a0;
+    return true;
+}
+
+// f_cutoff is the lower edge of the notch, where the attenuation is 3dB
+bool filterBankAddNotch(filterBank_t *bank, float f_center, float f_cutoff, float dT)
+{
+    if (f_cutoff <= 0 || f_cutoff >= f_center) {
+        return false;
+    }
+
+    biquadFilter_t *stage = filterBankNewStage(bank, f_center, dT);
+    if (!stage) {
+        return false;
+    }
+
+    const float Q = f_center * f_cutoff / (f_center * f_center - f_cutoff * f_cutoff);
+    const float omega = 2 * M_PIf * f_center * dT;
+    const float cs = cos_approx(omega);
+    const float alpha = sin_approx(omega) / (2 * Q);
+    const float a0 = 1 + alpha;
+
+    stage->b0 = 1 / a0;
+    stage->b1 = -2 * cs / a0;
+    stage->b2 = stage->b0;
+    stage->a1 = stage->b1;
+    stage->a2 = (1 - alpha) / a0;
+    return true;
+}
+
+float filterBankApply(filterBank_t *bank, float input)
+{
+    for (int i = 0; i < bank->stageCount; i++) {
+        input = biquadFilterApply(&bank->stage[i], input);
+    }
+    return input;
+}
+
 // PT1 Low Pass filter
 
 // f_cut = cutoff frequency
-void pt1FilterInit(pt1Filter_t *filter, uint8_t f_cut, float dT)
+void pt1FilterInit(pt1Filter_t *filter, float f_cut, float dT)
 {
-    filter->RC = 1.0f / ( 2.0f * M_PI_FLOAT * f_cut );
+    filter->RC = 1.0f / ( 2.0f * M_PIf * f_cut );
     filter->dT = dT;
+    filter->f_cut = f_cut;
+    filter->k = dT / (filter->RC + dT);
 }
 
+static void pt1FilterUpdateCoefficient(pt1Filter_t *filter, float f_cut, float dT)
+{
+    if (f_cut != filter->f_cut || fabsf(dT - filter->dT) > filter->dT * PT1_DT_TOLERANCE) {
+        pt1FilterInit(filter, f_cut, dT);
+    }
+}
+
+// Uses the coefficient set by pt1FilterInit()
 float pt1FilterApply(pt1Filter_t *filter, float input)
 {
-    filter->state = filter->state + filter->dT / (filter->RC + filter->dT) * (input - filter->state);
+    filter->state = filter->state + filter->k * (input - filter->state);
     return filter->state;
 }
 
+// Same as pt1FilterApply4(), but the coefficient is only recalculated when f_cut changes or dT moves out of PT1_DT_TOLERANCE
+float pt1FilterApplyCached(pt1Filter_t *filter, float input, float f_cut, float dT)
+{
+    pt1FilterUpdateCoefficient(filter, f_cut, dT);
+    return pt1FilterApply(filter, input);
+}
+
 float pt1FilterApply4(pt1Filter_t *filter, float input, float f_cut, float dT)
 {
     // Pre calculate and store RC
     if (!filter->RC) {
-        filter->RC = 1.0f / ( 2.0f * (float)M_PI * f_cut );
+        filter->RC = 1.0f / ( 2.0f * M_PIf * f_cut );
     }
 
     filter->state = filter->state + dT / (filter->RC + dT) * (input - filter->state);
@@ -106,12 +213,9 @@ float pt1FilterApply4(pt1Filter_t *filter, float input, float f_cut, float dT)
 // rate_limit = maximum rate of change of the output value in units per second
 float pt1FilterApplyWithRateLimit(pt1Filter_t *filter, float input, float f_cut, float rate_limit, float dT)
 {
-    // Pre calculate and store RC
-    if (!filter->RC) {
-        filter->RC = 1.0f / ( 2.0f * (float)M_PI * f_cut );
-    }
+    pt1FilterUpdateCoefficient(filter, f_cut, dT);
 
-    const float newState = filter->state + dT / (filter->RC + dT) * (input - filter->state);
+    const float newState = filter->state + filter->k * (input - filter->state);
     const float rateLimitPerSample = rate_limit * dT;
     filter->state = constrainf(newState, filter->state - rateLimitPerSample, filter->state + rateLimitPerSample);
 
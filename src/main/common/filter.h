@@ -21,14 +21,27 @@ typedef struct pt1Filter_s {
     float state;
     float RC;
     float dT;
+    float f_cut;
+    float k;                                // dT / (RC + dT) for the f_cut and dT above
 } pt1Filter_t;
 
+// pt1FilterApplyCached() keeps the coefficient while dT stays within this fraction of the dT it was calculated for
+#define PT1_DT_TOLERANCE 0.05f
+
 /* this holds the data required to update samples thru a filter */
 typedef struct biquadFilter_s {
     float b0, b1, b2, a1, a2;
     float d1, d2;
 } biquadFilter_t;
 
+// Chain of filter stages sharing the biquad form, a PT1 stage is a first order section
+#define FILTER_BANK_MAX_STAGES 3
+
+typedef struct filterBank_s {
+    biquadFilter_t stage[FILTER_BANK_MAX_STAGES];
+    uint8_t stageCount;
+} filterBank_t;
+
 typedef struct firFilter_s {
     float *buf;
     const float *coeffs;
@@ -36,7 +49,9 @@ typedef struct firFilter_s {
     uint8_t coeffsLength;
 } firFilter_t;
 
+void pt1FilterInit(pt1Filter_t *filter, float f_cut, float dT);
 float pt1FilterApply(pt1Filter_t *filter, float input);
+float pt1FilterApplyCached(pt1Filter_t *filter, float input, float f_cut, float dT);
 float pt1FilterApply4(pt1Filter_t *filter, float input, float f_cut, float dt);
 float pt1FilterApplyWithRateLimit(pt1Filter_t *filter, float input, float f_cut, float rate_limit, float dT);
 void pt1FilterReset(pt1Filter_t *filter, float input);
@@ -44,6 +59,12 @@ void pt1FilterReset(pt1Filter_t *filter, float input);
 void biquadFilterInit(biquadFilter_t *filter, uint8_t filterCutFreq, int16_t samplingRate);
 float biquadFilterApply(biquadFilter_t *filter, float sample);
 
+void filterBankInit(filterBank_t *bank);
+bool filterBankAddPT1(filterBank_t *bank, float f_cut, float dT);
+bool filterBankAddLowpass(filterBank_t *bank, float f_cut, float dT);
+bool filterBankAddNotch(filterBank_t *bank, float f_center, float f_cutoff, float dT);
+float filterBankApply(filterBank_t *bank, float input);
+
 void firFilterInit(firFilter_t *filter, float *buf, uint8_t bufLength, const float *coeffs);
 void firFilterInit2(firFilter_t *filter, float *buf, uint8_t bufLength, const float *coeffs, uint8_t coeffsLength);
 void firFilterUpdate(firFilter_t *filter, float input);
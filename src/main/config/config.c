@@ -30,11 +30,13 @@
 
 #include "drivers/sensor.h"
 #include "drivers/accgyro.h"
+#include "drivers/accgyro_mpu_fifo.h"
 #include "drivers/compass.h"
 #include "drivers/system.h"
 #include "drivers/gpio.h"
 #include "drivers/timer.h"
 #include "drivers/pwm_rx.h"
+#include "drivers/pwm_mapping.h"
 #include "drivers/rx_nrf24l01.h"
 #include "drivers/serial.h"
 
@@ -52,6 +54,7 @@
 #include "io/escservo.h"
 #include "io/rc_controls.h"
 #include "io/rc_curves.h"
+#include "io/rc_smoothing.h"
 #include "io/ledstrip.h"
 #include "io/gps.h"
 
@@ -73,6 +76,7 @@
 
 #include "config/config_profile.h"
 #include "config/config_master.h"
+#include "config/config_store.h"
 
 #ifndef DEFAULT_RX_FEATURE
 #define DEFAULT_RX_FEATURE FEATURE_RX_PARALLEL_PWM
@@ -118,49 +122,31 @@ void useRcControlsConfig(modeActivationCondition_t *modeActivationConditions, es
 
 #endif
 
-#if !defined(FLASH_SIZE) && !defined(FLASH_PAGE_COUNT)
-    #ifdef STM32F10X_MD
-        #define FLASH_PAGE_COUNT 128
-    #endif
-
-    #ifdef STM32F10X_HD
-        #define FLASH_PAGE_COUNT 128
-    #endif
-#endif
-
-#if defined(FLASH_SIZE)
-#if defined(STM32F40_41xxx)
-#define FLASH_PAGE_COUNT 4 // just to make calculations work
-#elif defined (STM32F411xE)
-#define FLASH_PAGE_COUNT 4 // just to make calculations work
-#else
-#define FLASH_PAGE_COUNT ((FLASH_SIZE * 0x400) / FLASH_PAGE_SIZE)
-#endif
-#endif
-
 #if !defined(FLASH_PAGE_SIZE)
 #error "Flash page size not defined for target."
 #endif
 
-#if !defined(FLASH_PAGE_COUNT)
-#error "Flash page count not defined for target."
-#endif
-
+// the config store alternates between two areas, see config_store.h
 #if FLASH_SIZE <= 128
-#define FLASH_TO_RESERVE_FOR_CONFIG 0x800
+#define CONFIG_AREA_SIZE 0x800
 #else
-#define FLASH_TO_RESERVE_FOR_CONFIG 0x1000
+#define CONFIG_AREA_SIZE 0x1000
 #endif
 
-// use the last flash pages for storage
 #ifdef CUSTOM_FLASH_MEMORY_ADDRESS
 size_t custom_flash_memory_address = 0;
 #define CONFIG_START_FLASH_ADDRESS (custom_flash_memory_address)
 #else
-// use the last flash pages for storage
-#ifndef CONFIG_START_FLASH_ADDRESS 
-#define CONFIG_START_FLASH_ADDRESS (0x08000000 + (uint32_t)((FLASH_PAGE_SIZE * FLASH_PAGE_COUNT) - FLASH_TO_RESERVE_FOR_CONFIG))
+// both areas are reserved after the firmware by the FLASH_CONFIG region of the linker script
+extern void *__config_start;
+#define CONFIG_START_FLASH_ADDRESS ((uintptr_t)&__config_start)
 #endif
+
+// the areas have to be erased separately, on the F4 the second one is in the next sector
+#if defined(STM32F40_41xxx) || defined (STM32F411xE)
+#define CONFIG_ALT_START_FLASH_ADDRESS (CONFIG_START_FLASH_ADDRESS + FLASH_PAGE_SIZE)
+#else
+#define CONFIG_ALT_START_FLASH_ADDRESS (CONFIG_START_FLASH_ADDRESS + CONFIG_AREA_SIZE)
 #endif
 
 master_t masterConfig;                 // master config struct with data independent from profiles
@@ -170,7 +156,7 @@ static uint32_t activeFeaturesLatch = 0;
 static uint8_t currentControlRateProfileIndex = 0;
 controlRateConfig_t *currentControlRateProfile;
 
-static const uint8_t EEPROM_CONF_VERSION = 120;
+static const uint8_t EEPROM_CONF_VERSION = 122;
 
 static void resetAccelerometerTrims(flightDynamicsTrims_t * accZero, flightDynamicsTrims_t * accGain)
 {
@@ -225,6 +211,9 @@ void resetPidProfile(pidProfile_t *pidProfile)
     pidProfile->yaw_p_limit = YAW_P_LIMIT_DEFAULT;
     pidProfile->mag_hold_rate_limit = MAG_HOLD_RATE_LIMIT_DEFAULT;
 
+    pidProfile->anti_gravity_gain = ANTI_GRAVITY_GAIN_OFF;
+    pidProfile->anti_gravity_threshold = 35;
+
     pidProfile->max_angle_inclination[FD_ROLL] = 300;    // 30 degrees
     pidProfile->max_angle_inclination[FD_PITCH] = 300;    // 30 degrees
 }
@@ -342,6 +331,12 @@ void resetTelemetryConfig(telemetryConfig_t *telemetryConfig)
     telemetryConfig->frsky_unit = FRSKY_UNIT_METRICS;
     telemetryConfig->frsky_vfas_precision = 0;
     telemetryConfig->hottAlarmSoundInterval = 5;
+    telemetryConfig->mavlink_ext_status_rate = 2;
+    telemetryConfig->mavlink_rc_chan_rate = 5;
+    telemetryConfig->mavlink_pos_rate = 2;
+    telemetryConfig->mavlink_extra1_rate = 10;
+    telemetryConfig->mavlink_extra2_rate = 10;
+    telemetryConfig->ltmUpdateRate = LTM_RATE_AUTO;
 }
 #endif
 
@@ -498,6 +493,11 @@ static void resetConf(void)
     masterConfig.acc_hardware = ACC_DEFAULT;     // default/autodetect
     masterConfig.gyroConfig.gyroMovementCalibrationThreshold = 32;
 
+    masterConfig.dtermConfig.dterm_notch_hz = 0;
+    masterConfig.dtermConfig.dterm_notch_cutoff = 150;
+    masterConfig.dtermConfig.dterm_lpf2_hz = 0;
+    masterConfig.dtermConfig.dterm_setpoint_weight = 0;
+
     masterConfig.mag_hardware = MAG_DEFAULT;     // default/autodetect
     masterConfig.baro_hardware = BARO_DEFAULT;   // default/autodetect
 
@@ -525,7 +525,7 @@ static void resetConf(void)
     masterConfig.rxConfig.rssi_channel = 0;
     masterConfig.rxConfig.rssi_scale = RSSI_SCALE_DEFAULT;
     masterConfig.rxConfig.rssi_ppm_invert = 0;
-    masterConfig.rxConfig.rcSmoothing = 1;
+    masterConfig.rxConfig.rcSmoothing = RC_SMOOTHING_FILTER;
 
     resetAllRxChannelRangeConfigurations(masterConfig.rxConfig.channelRanges);
 
@@ -547,6 +547,7 @@ static void resetConf(void)
     masterConfig.motor_pwm_rate = BRUSHLESS_MOTORS_PWM_RATE;
 #endif
     masterConfig.servo_pwm_rate = 50;
+    masterConfig.motor_pwm_protocol = MOTOR_PWM_PROTOCOL_STANDARD;
 
 #ifdef GPS
     // gps/nav stuff
@@ -567,6 +568,7 @@ static void resetConf(void)
     masterConfig.i2c_overclock = 0;
     masterConfig.gyroSync = 0;
     masterConfig.gyroSyncDenominator = 2;
+    masterConfig.gyroFifo = 0;
 
     resetPidProfile(&currentProfile->pidProfile);
 
@@ -745,41 +747,62 @@ static void resetConf(void)
     }
 }
 
-static uint8_t calculateChecksum(const uint8_t *data, uint32_t length)
+static void clearFlashErrorFlags(void)
 {
-    uint8_t checksum = 0;
-    const uint8_t *byteOffset;
+#ifdef STM32F40_41xxx
+    FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR | FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR);
+#endif
+#ifdef STM32F303
+    FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPERR);
+#endif
+#ifdef STM32F10X
+    FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR);
+#endif
+}
 
-    for (byteOffset = data; byteOffset < (data + length); byteOffset++)
-        checksum ^= *byteOffset;
-    return checksum;
+static bool configFlashErase(uintptr_t address)
+{
+#if defined(STM32F40_41xxx) || defined (STM32F411xE)
+    // sectors 5 and up are 128KB, starting at 0x08020000
+    const uint16_t sector = FLASH_Sector_5 + ((address - 0x08020000) / FLASH_PAGE_SIZE) * (FLASH_Sector_6 - FLASH_Sector_5);
+    return FLASH_EraseSector(sector, VoltageRange_3) == FLASH_COMPLETE;
+#else
+    return FLASH_ErasePage(address) == FLASH_COMPLETE;
+#endif
 }
 
-static bool isEEPROMContentValid(void)
+static bool configFlashProgram(uintptr_t address, uint32_t value)
 {
-    const master_t *temp = (const master_t *) CONFIG_START_FLASH_ADDRESS;
-    uint8_t checksum = 0;
+    return FLASH_ProgramWord(address, value) == FLASH_COMPLETE;
+}
 
-    // check version number
-    if (EEPROM_CONF_VERSION != temp->version)
-        return false;
+static const configStoreFlash_t configFlash = {
+    .erase = configFlashErase,
+    .program = configFlashProgram
+};
 
-    // check size and magic numbers
-    if (temp->size != sizeof(master_t) || temp->magic_be != 0xBE || temp->magic_ef != 0xEF)
-        return false;
+// start is set by initEEPROM(), CONFIG_START_FLASH_ADDRESS is not a constant on every target
+static configStore_t configStore = {
+    .size = CONFIG_AREA_SIZE,
+    .pageSize = FLASH_PAGE_SIZE,
+    .version = EEPROM_CONF_VERSION,
+    .flash = &configFlash
+};
 
-    // verify integrity of temporary copy
-    checksum = calculateChecksum((const uint8_t *) temp, sizeof(master_t));
-    if (checksum != 0)
-        return false;
+// a restored config is staged straight into the inactive area of the store
+static configStoreStage_t configRestoreStage;
+static bool configRestoreInProgress = false;
 
-    // looks good, let's roll!
-    return true;
+static bool isEEPROMContentValid(void)
+{
+    return configStoreIsValid(&configStore, sizeof(master_t));
 }
 
 void activateControlRateConfig(void)
 {
+    generatePitchRollYawCurves(currentControlRateProfile);
     generateThrottleCurve(currentControlRateProfile, &masterConfig.escAndServoConfig);
+    generateThrottlePIDGains(currentControlRateProfile, &masterConfig.rxConfig);
 }
 
 void activateConfig(void)
@@ -827,6 +850,7 @@ void activateConfig(void)
 
     imuConfigure(&imuRuntimeConfig, &currentProfile->pidProfile);
 
+    pidUseDtermConfig(&masterConfig.dtermConfig);
     pidInit();
 
 #ifdef NAV
@@ -843,7 +867,7 @@ void activateConfig(void)
 #endif
 }
 
-static void validateAndFixConfig(void)
+void validateAndFixConfig(void)
 {
     if (!(featureConfigured(FEATURE_RX_PARALLEL_PWM) || featureConfigured(FEATURE_RX_PPM) || featureConfigured(FEATURE_RX_SERIAL) || featureConfigured(FEATURE_RX_MSP) || featureConfigured(FEATURE_RX_NRF24))) {
          featureSet(DEFAULT_RX_FEATURE);
@@ -853,6 +877,24 @@ static void validateAndFixConfig(void)
          featureClear(FEATURE_RX_SERIAL | FEATURE_RX_PARALLEL_PWM | FEATURE_RX_MSP | FEATURE_RX_NRF24);
      }
 
+#ifdef USE_DSHOT
+    // DShot runs the motor timers itself, OneShot125 would force their overflow.
+    // 3D needs reversible ESCs driven around neutral3d, DShot throttle values are one directional.
+    if (masterConfig.motor_pwm_protocol != MOTOR_PWM_PROTOCOL_STANDARD) {
+        featureClear(FEATURE_ONESHOT125 | FEATURE_3D);
+    }
+#else
+    masterConfig.motor_pwm_protocol = MOTOR_PWM_PROTOCOL_STANDARD;
+#endif
+
+#ifdef USE_MPU_FIFO
+    // at 8kHz a longer loop overflows the FIFO every cycle, it would be reset and the registers read instead
+    const uint32_t fifoLooptime = masterConfig.gyroSync ? masterConfig.gyroSyncDenominator * 125 : masterConfig.looptime;
+    if (masterConfig.gyro_lpf == 0 && fifoLooptime > MPU_FIFO_MAX_LOOPTIME_8KHZ) {
+        masterConfig.gyroFifo = 0;
+    }
+#endif
+
      if (featureConfigured(FEATURE_RX_MSP)) {
          featureClear(FEATURE_RX_SERIAL | FEATURE_RX_PARALLEL_PWM | FEATURE_RX_PPM | FEATURE_RX_NRF24);
      }
@@ -994,6 +1036,18 @@ static void validateAndFixConfig(void)
     }
 #endif
 
+    // the notch is skipped when its lower edge is not below the center
+    if (masterConfig.dtermConfig.dterm_notch_hz && masterConfig.dtermConfig.dterm_notch_cutoff >= masterConfig.dtermConfig.dterm_notch_hz) {
+        masterConfig.dtermConfig.dterm_notch_cutoff = masterConfig.dtermConfig.dterm_notch_hz / 2;
+    }
+
+    for (int i = 0; i < MAX_PROFILE_COUNT; i++) {
+        pidProfile_t *pidProfile = &masterConfig.profile[i].pidProfile;
+
+        pidProfile->anti_gravity_gain = constrain(pidProfile->anti_gravity_gain, ANTI_GRAVITY_GAIN_OFF, ANTI_GRAVITY_GAIN_MAX);
+        pidProfile->anti_gravity_threshold = constrain(pidProfile->anti_gravity_threshold, ANTI_GRAVITY_THRESHOLD_MIN, ANTI_GRAVITY_THRESHOLD_MAX);
+    }
+
     useRxConfig(&masterConfig.rxConfig);
 
     serialConfig_t *serialConfig = &masterConfig.serialConfig;
@@ -1019,18 +1073,18 @@ void applyAndSaveBoardAlignmentDelta(int16_t roll, int16_t pitch)
 
 void initEEPROM(void)
 {
+    configStore.start = CONFIG_START_FLASH_ADDRESS;
+    configStore.altStart = CONFIG_ALT_START_FLASH_ADDRESS;
 }
 
 void readEEPROM(void)
 {
-    // Sanity check
-    if (!isEEPROMContentValid())
-        failureMode(FAILURE_INVALID_EEPROM_CONTENTS);
-
     suspendRxSignal();
 
-    // Read flash
-    memcpy(&masterConfig, (char *) CONFIG_START_FLASH_ADDRESS, sizeof(master_t));
+    // Read flash, replaying every change saved since the store was last compacted.
+    // The store is validated while it is loaded, there is no separate check first.
+    if (!configStoreLoad(&configStore, &masterConfig, sizeof(master_t)))
+        failureMode(FAILURE_INVALID_EEPROM_CONTENTS);
 
     if (masterConfig.current_profile_index > MAX_PROFILE_COUNT - 1) // sanity check
         masterConfig.current_profile_index = 0;
@@ -1057,69 +1111,94 @@ void readEEPROMAndNotify(void)
 
 void writeEEPROM(void)
 {
-    // Generate compile time error if the config does not fit in the reserved area of flash.
-    BUILD_BUG_ON(sizeof(master_t) > FLASH_TO_RESERVE_FOR_CONFIG);
+    // Generate compile time error if the config does not fit in an area of the config store.
+    BUILD_BUG_ON(CONFIG_STORE_MIN_SIZE(sizeof(master_t)) > CONFIG_AREA_SIZE);
+    // or is too big for delta saves, every save would compact
+    BUILD_BUG_ON(sizeof(master_t) > CONFIG_STORE_MAX_CONFIG_SIZE);
 
-    FLASH_Status status = 0;
-    uint32_t wordOffset;
+    bool success;
     int8_t attemptsRemaining = 3;
 
     suspendRxSignal();
 
-    // prepare checksum/version constants
+    // prepare version constants, integrity is covered by the CRC of each record in the config store
     masterConfig.version = EEPROM_CONF_VERSION;
     masterConfig.size = sizeof(master_t);
     masterConfig.magic_be = 0xBE;
     masterConfig.magic_ef = 0xEF;
-    masterConfig.chk = 0; // erase checksum before recalculating
-    masterConfig.chk = calculateChecksum((const uint8_t *) &masterConfig, sizeof(master_t));
+    masterConfig.chk = 0;
+
+    // compaction reuses the area a restore is staged in
+    configRestoreInProgress = false;
 
-    // write it
+    // write it, only the changed bytes are appended unless the store has to be compacted
     FLASH_Unlock();
-    while (attemptsRemaining--) {
-#ifdef STM32F40_41xxx
-        FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR | FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR);
-#endif
-#ifdef STM32F303
-        FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPERR);
-#endif
-#ifdef STM32F10X
-        FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR);
-#endif
-        for (wordOffset = 0; wordOffset < sizeof(master_t); wordOffset += 4) {
-            if (wordOffset % FLASH_PAGE_SIZE == 0) {
-#if defined(STM32F40_41xxx)
-                status = FLASH_EraseSector(FLASH_Sector_8, VoltageRange_3); //0x08080000 to 0x080A0000
-#elif defined (STM32F411xE)
-                status = FLASH_EraseSector(FLASH_Sector_7, VoltageRange_3); //0x08060000 to 0x08080000
-#else
-                status = FLASH_ErasePage(CONFIG_START_FLASH_ADDRESS + wordOffset);
-#endif
-                if (status != FLASH_COMPLETE) {
-                    break;
-                }
-            }
-
-            status = FLASH_ProgramWord(CONFIG_START_FLASH_ADDRESS + wordOffset,
-                    *(uint32_t *) ((char *) &masterConfig + wordOffset));
-            if (status != FLASH_COMPLETE) {
-                break;
-            }
-        }
-        if (status == FLASH_COMPLETE) {
-            break;
-        }
+    clearFlashErrorFlags();
+    success = configStoreSave(&configStore, &masterConfig, sizeof(master_t));
+    while (!success && attemptsRemaining--) {
+        clearFlashErrorFlags();
+        success = configStoreCompact(&configStore, &masterConfig, sizeof(master_t));
     }
     FLASH_Lock();
 
     // Flash write failed - just die now
-    if (status != FLASH_COMPLETE || !isEEPROMContentValid()) {
+    if (!success || !isEEPROMContentValid()) {
         failureMode(FAILURE_FLASH_WRITE_FAILED);
     }
 
     resumeRxSignal();
 }
 
+bool beginConfigRestore(void)
+{
+    suspendRxSignal();
+
+    FLASH_Unlock();
+    clearFlashErrorFlags();
+    configRestoreInProgress = configStoreStageBegin(&configStore, &configRestoreStage, sizeof(master_t));
+    FLASH_Lock();
+
+    resumeRxSignal();
+
+    return configRestoreInProgress;
+}
+
+bool writeConfigRestore(const uint8_t *data, uint16_t length)
+{
+    if (!configRestoreInProgress) {
+        return false;
+    }
+
+    FLASH_Unlock();
+    configRestoreInProgress = configStoreStageWrite(&configStore, &configRestoreStage, data, length);
+    FLASH_Lock();
+
+    return configRestoreInProgress;
+}
+
+bool commitConfigRestore(void)
+{
+    if (!configRestoreInProgress) {
+        return false;
+    }
+
+    configRestoreInProgress = false;
+
+    FLASH_Unlock();
+    const bool success = configStoreStageCommit(&configStore, &configRestoreStage);
+    FLASH_Lock();
+
+    if (!success) {
+        return false;
+    }
+
+    // the restored config is now the stored one, save whatever validation had to fix
+    readEEPROM();
+    writeEEPROM();
+
+    return true;
+}
+
 void ensureEEPROMContainsValidData(void)
 {
     if (isEEPROMContentValid()) {
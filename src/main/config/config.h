@@ -84,9 +84,14 @@ void copyCurrentProfileToProfileSlot(uint8_t profileSlotIndex);
 void initEEPROM(void);
 void resetEEPROM(void);
 void readEEPROM(void);
+void validateAndFixConfig(void);
+void activateConfig(void);
 void readEEPROMAndNotify(void);
 void writeEEPROM();
 void ensureEEPROMContainsValidData(void);
+bool beginConfigRestore(void);
+bool writeConfigRestore(const uint8_t *data, uint16_t length);
+bool commitConfigRestore(void);
 void saveConfigAndNotify(void);
 
 uint8_t getCurrentProfile(void);
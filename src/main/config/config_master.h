@@ -30,6 +30,7 @@ typedef struct master_t {
     uint8_t i2c_overclock;                  // Overclock i2c Bus for faster IMU readings
     uint8_t gyroSync;                       // Enable interrupt based loop
     uint8_t gyroSyncDenominator;            // Gyro sync Denominator
+    uint8_t gyroFifo;                       // Average all gyro and acc samples through the sensor FIFO
 
     motorMixer_t customMotorMixer[MAX_SUPPORTED_MOTORS];
 #ifdef USE_SERVOS
@@ -41,6 +42,7 @@ typedef struct master_t {
 
     uint16_t motor_pwm_rate;                // The update rate of motor outputs (50-498Hz)
     uint16_t servo_pwm_rate;                // The update rate of servo outputs (50-498Hz)
+    uint8_t motor_pwm_protocol;             // STANDARD or one of the DShot rates, see motorPwmProtocol_e
 
     // global sensor-related stuff
 
@@ -57,6 +59,7 @@ typedef struct master_t {
     uint8_t gyro_lpf;                       // gyro LPF setting - values are driver specific, in case of invalid number, a reasonable default ~30-40HZ is chosen.
 
     gyroConfig_t gyroConfig;
+    dtermConfig_t dtermConfig;
 
     barometerConfig_t barometerConfig;
 
@@ -0,0 +1,426 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common/maths.h"
+
+#include "config/config_store.h"
+
+/*
+ * Store layout, all fields little endian words:
+ *
+ *   header:  magic, configSize | version << 16, sequence
+ *   record:  offset | (length | commit flag) << 16, crc16, data padded to a word boundary
+ *
+ * A save appends a batch of records and only the last one carries the commit flag. The first word of a
+ * record is programmed last and the commit record is the last record written, so a save interrupted by a
+ * power loss leaves an uncommitted tail that is ignored when loading and compacted away by the next save.
+ *
+ * When both areas are valid the one with the higher sequence number is loaded. Compaction always writes
+ * the area that is not loaded, the loaded one is only erased by the compaction after that.
+ */
+
+#define CONFIG_STORE_MAGIC 0x53474643 // "CFGS"
+#define CONFIG_STORE_ERASED_WORD 0xFFFFFFFF
+
+#define CONFIG_STORE_RECORD_COMMIT 0x8000
+
+#define CONFIG_STORE_RECORD_SIZE(length) (CONFIG_STORE_RECORD_HEADER_SIZE + (((length) + 3) & ~3))
+
+// Most saves change a handful of settings, more runs than this are cheaper to store as a new base record
+#define CONFIG_STORE_MAX_DELTA_RECORDS 8
+
+// one bit per config word, set when the stored word differs from the one being saved
+#define CONFIG_STORE_CHANGED_MAP_SIZE ((CONFIG_STORE_MAX_CONFIG_SIZE / 4 + 31) / 32)
+
+typedef enum {
+    CONFIG_RECORD_VALID,
+    CONFIG_RECORD_BAD_CRC,
+    CONFIG_RECORD_END,
+    CONFIG_RECORD_DAMAGED
+} configRecordState_e;
+
+typedef struct configRecord_s {
+    uint16_t offset;
+    uint16_t length;
+    bool commit;
+    const uint8_t *data;
+} configRecord_t;
+
+typedef struct configRun_s {
+    uint16_t offset;
+    uint16_t length;
+} configRun_t;
+
+typedef struct configLog_s {
+    uintptr_t start;                        // area the config is loaded from
+    uint32_t sequence;
+    uintptr_t commitEnd;                    // end of the last committed batch of records
+    uintptr_t logEnd;                       // where the next record goes, 0 when the area has to be compacted
+} configLog_t;
+
+static uint32_t readWord(uintptr_t address)
+{
+    return *(const uint32_t *)address;
+}
+
+static uint16_t recordCrc(uint32_t firstWord, const uint8_t *data, uint16_t length)
+{
+    uint16_t crc = 0;
+
+    for (int i = 0; i < 4; i++) {
+        crc = crc16_ccitt(crc, (firstWord >> (i * 8)) & 0xFF);
+    }
+    while (length--) {
+        crc = crc16_ccitt(crc, *data++);
+    }
+    return crc;
+}
+
+// a committed record at offset 0 covering the whole config
+static uint32_t baseRecordFirstWord(uint16_t configSize)
+{
+    return (uint32_t)(configSize | CONFIG_STORE_RECORD_COMMIT) << 16;
+}
+
+static bool isHeaderValid(const configStore_t *store, uintptr_t area, uint16_t configSize)
+{
+    return readWord(area) == CONFIG_STORE_MAGIC
+        && readWord(area + 4) == (configSize | ((uint32_t)store->version << 16));
+}
+
+static configRecordState_e readRecord(const configStore_t *store, uintptr_t area, uint16_t configSize, uintptr_t address, configRecord_t *record, bool checkCrc)
+{
+    const uintptr_t end = area + store->size;
+
+    if (address + CONFIG_STORE_RECORD_HEADER_SIZE > end) {
+        return CONFIG_RECORD_END;
+    }
+
+    const uint32_t firstWord = readWord(address);
+    if (firstWord == CONFIG_STORE_ERASED_WORD) {
+        return CONFIG_RECORD_END;
+    }
+
+    record->offset = firstWord & 0xFFFF;
+    record->length = (firstWord >> 16) & ~CONFIG_STORE_RECORD_COMMIT;
+    record->commit = (firstWord >> 16) & CONFIG_STORE_RECORD_COMMIT;
+    record->data = (const uint8_t *)(address + CONFIG_STORE_RECORD_HEADER_SIZE);
+
+    if (record->length == 0 || record->offset + record->length > configSize || address + CONFIG_STORE_RECORD_SIZE(record->length) > end) {
+        return CONFIG_RECORD_DAMAGED;
+    }
+
+    if (checkCrc && (readWord(address + 4) & 0xFFFF) != recordCrc(firstWord, record->data, record->length)) {
+        return CONFIG_RECORD_BAD_CRC;
+    }
+
+    return CONFIG_RECORD_VALID;
+}
+
+static bool isErased(const configStore_t *store, uintptr_t area, uintptr_t address)
+{
+    for (; address < area + store->size; address += 4) {
+        if (readWord(address) != CONFIG_STORE_ERASED_WORD) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Checks one area and finds the end of the last committed batch of records. The scan stops at the first
+ * damaged or corrupted record, nothing after it is trusted.
+ */
+static bool scanArea(const configStore_t *store, uintptr_t area, uint16_t configSize, configLog_t *log)
+{
+    configRecord_t record;
+    uintptr_t address = area + CONFIG_STORE_HEADER_SIZE;
+
+    if (!isHeaderValid(store, area, configSize)) {
+        return false;
+    }
+
+    // the first record must be a committed base record covering the whole config
+    if (readRecord(store, area, configSize, address, &record, true) != CONFIG_RECORD_VALID || record.offset != 0 || record.length != configSize || !record.commit) {
+        return false;
+    }
+
+    configRecordState_e state;
+
+    do {
+        address += CONFIG_STORE_RECORD_SIZE(record.length);
+        if (record.commit) {
+            log->commitEnd = address;
+        }
+        state = readRecord(store, area, configSize, address, &record, true);
+    } while (state == CONFIG_RECORD_VALID);
+
+    log->start = area;
+    log->sequence = readWord(area + 8);
+    log->logEnd = (state == CONFIG_RECORD_END && isErased(store, area, log->commitEnd)) ? log->commitEnd : 0;
+    return true;
+}
+
+// Finds the area to load, the newer one when both are valid
+static bool scan(const configStore_t *store, uint16_t configSize, configLog_t *log)
+{
+    configLog_t altLog;
+
+    const bool valid = scanArea(store, store->start, configSize, log);
+    const bool altValid = scanArea(store, store->altStart, configSize, &altLog);
+
+    if (altValid && (!valid || (int32_t)(altLog.sequence - log->sequence) > 0)) {
+        *log = altLog;
+    }
+    return valid || altValid;
+}
+
+// Replays every committed record. The CRCs were checked by scan(), they are not checked again.
+static void readStoredImage(const configStore_t *store, const configLog_t *log, uint8_t *config, uint16_t configSize)
+{
+    configRecord_t record;
+
+    for (uintptr_t address = log->start + CONFIG_STORE_HEADER_SIZE;
+            address < log->commitEnd && readRecord(store, log->start, configSize, address, &record, false) == CONFIG_RECORD_VALID;
+            address += CONFIG_STORE_RECORD_SIZE(record.length)) {
+        memcpy(config + record.offset, record.data, record.length);
+    }
+}
+
+/*
+ * Marks the words of the stored config that differ from config, replaying the log once. A record that only
+ * covers part of a word can set its bit but not clear it, so a word may be rewritten without having changed.
+ */
+static void findChangedWords(const configStore_t *store, const configLog_t *log, const uint8_t *config, uint16_t configSize, uint32_t *changed)
+{
+    configRecord_t record;
+
+    memset(changed, 0, CONFIG_STORE_CHANGED_MAP_SIZE * sizeof(uint32_t));
+
+    for (uintptr_t address = log->start + CONFIG_STORE_HEADER_SIZE;
+            address < log->commitEnd && readRecord(store, log->start, configSize, address, &record, false) == CONFIG_RECORD_VALID;
+            address += CONFIG_STORE_RECORD_SIZE(record.length)) {
+
+        const uint16_t recordEnd = record.offset + record.length;
+
+        for (uint16_t word = record.offset / 4; word * 4 < recordEnd; word++) {
+            const uint16_t wordStart = word * 4;
+            const uint16_t wordEnd = MIN(wordStart + 4, configSize);
+            const uint16_t overlapStart = MAX(wordStart, record.offset);
+            const uint16_t overlapEnd = MIN(wordEnd, recordEnd);
+            const uint32_t bit = 1U << (word % 32);
+
+            if (memcmp(record.data + overlapStart - record.offset, config + overlapStart, overlapEnd - overlapStart) != 0) {
+                changed[word / 32] |= bit;
+            } else if (overlapStart == wordStart && overlapEnd == wordEnd) {
+                changed[word / 32] &= ~bit;
+            }
+        }
+    }
+}
+
+static bool writeRecord(const configStore_t *store, uintptr_t address, const uint8_t *config, uint16_t offset, uint16_t length, bool commit)
+{
+    const uint32_t firstWord = offset | ((uint32_t)(length | (commit ? CONFIG_STORE_RECORD_COMMIT : 0)) << 16);
+    const uint8_t *data = config + offset;
+
+    if (!store->flash->program(address + 4, 0xFFFF0000 | recordCrc(firstWord, data, length))) {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < length; i += 4) {
+        uint32_t word = CONFIG_STORE_ERASED_WORD;
+        memcpy(&word, data + i, MIN(length - i, 4));
+        if (!store->flash->program(address + CONFIG_STORE_RECORD_HEADER_SIZE + i, word)) {
+            return false;
+        }
+    }
+
+    return store->flash->program(address, firstWord);
+}
+
+bool configStoreIsValid(const configStore_t *store, uint16_t configSize)
+{
+    configLog_t log;
+
+    return scan(store, configSize, &log);
+}
+
+bool configStoreLoad(const configStore_t *store, void *config, uint16_t configSize)
+{
+    configLog_t log;
+
+    if (!scan(store, configSize, &log)) {
+        return false;
+    }
+
+    readStoredImage(store, &log, config, configSize);
+    return true;
+}
+
+/*
+ * Compaction writes a new base record to the area that is not loaded. The loaded area is left alone, a
+ * compaction that does not complete leaves it as the one that is loaded. The record can be written in
+ * pieces as the config arrives, it only becomes the loaded config once configStoreStageCommit() is done.
+ */
+bool configStoreStageBegin(const configStore_t *store, configStoreStage_t *stage, uint16_t configSize)
+{
+    configLog_t log;
+
+    if ((uint32_t)CONFIG_STORE_MIN_SIZE(configSize) > store->size) {
+        return false;
+    }
+
+    stage->area = store->start;
+    stage->sequence = 0;
+    if (scan(store, configSize, &log)) {
+        stage->area = (log.start == store->start) ? store->altStart : store->start;
+        stage->sequence = log.sequence + 1;
+    }
+
+    for (uintptr_t address = stage->area; address < stage->area + store->size; address += store->pageSize) {
+        if (!store->flash->erase(address)) {
+            return false;
+        }
+    }
+
+    stage->configSize = configSize;
+    stage->length = 0;
+    stage->crc = recordCrc(baseRecordFirstWord(configSize), NULL, 0);
+    stage->partialWord = CONFIG_STORE_ERASED_WORD;
+    return true;
+}
+
+bool configStoreStageWrite(const configStore_t *store, configStoreStage_t *stage, const uint8_t *data, uint16_t length)
+{
+    if (length > stage->configSize - stage->length) {
+        return false;
+    }
+
+    const uintptr_t recordData = stage->area + CONFIG_STORE_HEADER_SIZE + CONFIG_STORE_RECORD_HEADER_SIZE;
+
+    while (length--) {
+        const uint8_t byteInWord = stage->length % 4;
+
+        stage->crc = crc16_ccitt(stage->crc, *data);
+        stage->partialWord &= ~(0xFFU << (byteInWord * 8));
+        stage->partialWord |= (uint32_t)*data++ << (byteInWord * 8);
+        stage->length++;
+
+        if (byteInWord == 3) {
+            if (!store->flash->program(recordData + stage->length - 4, stage->partialWord)) {
+                return false;
+            }
+            stage->partialWord = CONFIG_STORE_ERASED_WORD;
+        }
+    }
+    return true;
+}
+
+bool configStoreStageCommit(const configStore_t *store, configStoreStage_t *stage)
+{
+    const uintptr_t record = stage->area + CONFIG_STORE_HEADER_SIZE;
+    if (stage->length != stage->configSize) {
+        return false;
+    }
+
+    // the last word is padded with erased bytes
+    if (stage->length % 4 && !store->flash->program(record + CONFIG_STORE_RECORD_HEADER_SIZE + (stage->length & ~3), stage->partialWord)) {
+        return false;
+    }
+
+    // the first word of the record and then the magic go in last, an area that was not completely written is never valid
+    return store->flash->program(record + 4, 0xFFFF0000 | stage->crc)
+        && store->flash->program(record, baseRecordFirstWord(stage->configSize))
+        && store->flash->program(stage->area + 8, stage->sequence)
+        && store->flash->program(stage->area + 4, stage->configSize | ((uint32_t)store->version << 16))
+        && store->flash->program(stage->area, CONFIG_STORE_MAGIC);
+}
+
+bool configStoreCompact(const configStore_t *store, const void *config, uint16_t configSize)
+{
+    configStoreStage_t stage;
+
+    return configStoreStageBegin(store, &stage, configSize)
+        && configStoreStageWrite(store, &stage, config, configSize)
+        && configStoreStageCommit(store, &stage);
+}
+
+/*
+ * Appends records for the words that differ from what is stored. Falls back to compaction when the store
+ * is invalid, full or the change is too scattered to be worth logging.
+ */
+bool configStoreSave(const configStore_t *store, const void *config, uint16_t configSize)
+{
+    const uint8_t *newConfig = config;
+    uint32_t changed[CONFIG_STORE_CHANGED_MAP_SIZE];
+    configRun_t runs[CONFIG_STORE_MAX_DELTA_RECORDS];
+    uint8_t runCount = 0;
+    configLog_t log;
+
+    if (configSize > CONFIG_STORE_MAX_CONFIG_SIZE || !scan(store, configSize, &log) || !log.logEnd) {
+        return configStoreCompact(store, config, configSize);
+    }
+
+    findChangedWords(store, &log, newConfig, configSize, changed);
+
+    for (uint16_t offset = 0; offset < configSize; offset += 4) {
+        const uint16_t word = offset / 4;
+        if (!(changed[word / 32] & (1U << (word % 32)))) {
+            continue;
+        }
+
+        const uint16_t end = MIN(offset + 4, configSize);
+
+        // join runs separated by less than a record header, a single record is smaller
+        if (runCount > 0 && offset - (runs[runCount - 1].offset + runs[runCount - 1].length) < CONFIG_STORE_RECORD_HEADER_SIZE) {
+            runs[runCount - 1].length = end - runs[runCount - 1].offset;
+            continue;
+        }
+
+        if (runCount == CONFIG_STORE_MAX_DELTA_RECORDS) {
+            return configStoreCompact(store, config, configSize);
+        }
+        runs[runCount].offset = offset;
+        runs[runCount].length = end - offset;
+        runCount++;
+    }
+
+    uint32_t requiredSize = 0;
+    for (int i = 0; i < runCount; i++) {
+        requiredSize += CONFIG_STORE_RECORD_SIZE(runs[i].length);
+    }
+
+    uintptr_t logEnd = log.logEnd;
+    if (logEnd + requiredSize > log.start + store->size) {
+        return configStoreCompact(store, config, configSize);
+    }
+
+    // the last record commits the batch, a save that does not get that far is not loaded
+    for (int i = 0; i < runCount; i++) {
+        if (!writeRecord(store, logEnd, newConfig, runs[i].offset, runs[i].length, i == runCount - 1)) {
+            return false;
+        }
+        logEnd += CONFIG_STORE_RECORD_SIZE(runs[i].length);
+    }
+
+    return true;
+}
@@ -0,0 +1,75 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Log structured config storage in internal flash.
+ *
+ * The store has two areas. The active area starts with a header, followed by a base record holding the
+ * whole config and then delta records holding only the bytes changed by later saves. Loading replays the
+ * records in order. When a save does not fit in the remaining space the other area is erased and written
+ * with a single base record (compaction). Its header carries a higher sequence number and goes in last,
+ * so the previous area stays valid until the new one is complete.
+ *
+ * Loading stops at the first damaged record and ignores records of a save that was not committed.
+ */
+
+#define CONFIG_STORE_HEADER_SIZE 12
+#define CONFIG_STORE_RECORD_HEADER_SIZE 8
+
+// Largest config a delta save is computed for, bigger configs are always compacted
+#define CONFIG_STORE_MAX_CONFIG_SIZE 4096
+
+// Space needed in each area for an empty store holding a config of the given size
+#define CONFIG_STORE_MIN_SIZE(configSize) (CONFIG_STORE_HEADER_SIZE + CONFIG_STORE_RECORD_HEADER_SIZE + (((configSize) + 3) & ~3))
+
+typedef struct configStoreFlash_s {
+    bool (*erase)(uintptr_t address);               // erase the page starting at address
+    bool (*program)(uintptr_t address, uint32_t value); // program one erased, word aligned word
+} configStoreFlash_t;
+
+// A config written to the area that is not loaded as it arrives, see configStoreStageBegin()
+typedef struct configStoreStage_s {
+    uintptr_t area;
+    uint32_t sequence;
+    uint16_t configSize;
+    uint16_t length;                        // bytes written so far
+    uint16_t crc;                           // of the base record so far
+    uint32_t partialWord;                   // bytes waiting for the rest of their word
+} configStoreStage_t;
+
+typedef struct configStore_s {
+    uintptr_t start;                        // first area, word aligned, memory mapped
+    uintptr_t altStart;                     // second area, must not share an erase page with the first
+    uint32_t size;                          // of each area
+    uint32_t pageSize;                      // erase granularity, may be larger than size
+    uint8_t version;                        // stores written with another version are invalid
+    const configStoreFlash_t *flash;
+} configStore_t;
+
+bool configStoreIsValid(const configStore_t *store, uint16_t configSize);
+bool configStoreLoad(const configStore_t *store, void *config, uint16_t configSize);
+bool configStoreSave(const configStore_t *store, const void *config, uint16_t configSize);
+bool configStoreCompact(const configStore_t *store, const void *config, uint16_t configSize);
+
+bool configStoreStageBegin(const configStore_t *store, configStoreStage_t *stage, uint16_t configSize);
+bool configStoreStageWrite(const configStore_t *store, configStoreStage_t *stage, const uint8_t *data, uint16_t length);
+bool configStoreStageCommit(const configStore_t *store, configStoreStage_t *stage);
@@ -26,6 +26,7 @@ typedef struct gyro_s {
     sensorReadFuncPtr read;                                 // read 3 axis data function
     sensorReadFuncPtr temperature;                          // read temperature if available
     sensorInterruptFuncPtr intStatus;
+    sensorInterruptFuncPtr intConfigured;                   // true when intStatus follows the data ready interrupt
     float scale;                                            // scalefactor
 } gyro_t;
 
@@ -24,6 +24,7 @@
 #include "build_config.h"
 #include "debug.h"
 
+#include "common/axis.h"
 #include "common/maths.h"
 
 #include "nvic.h"
@@ -41,6 +42,8 @@
 #include "accgyro_spi_mpu6000.h"
 #include "accgyro_spi_mpu6500.h"
 #include "accgyro_mpu.h"
+#include "accgyro_mpu_fifo.h"
+#include "gyro_sync.h"
 
 //#define DEBUG_MPU_DATA_READY_INTERRUPT
 
@@ -49,7 +52,8 @@ static bool mpuWriteRegisterI2C(uint8_t reg, uint8_t data);
 
 static void mpu6050FindRevision(void);
 
-static volatile bool mpuDataReady;
+static volatile uint8_t mpuDataReadyCount;
+static uint8_t mpuDataReadyRequired = 1;   // data ready interrupts per gyro sync, the FIFO keeps the samples in between
 
 #ifdef USE_SPI
 static bool detectSPISensorsAndUpdateDetectionResult(void);
@@ -196,11 +200,14 @@ static void mpu6050FindRevision(void)
 }
 
 extiCallbackRec_t mpuIntCallbackRec;
+static bool mpuIntExtiConfigured = false;
 
 void mpuIntExtiHandler(extiCallbackRec_t *cb)
 {
     UNUSED(cb);
-    mpuDataReady = true;
+    if (mpuDataReadyCount < UINT8_MAX) {
+        mpuDataReadyCount++;
+    }
 
 #ifdef DEBUG_MPU_DATA_READY_INTERRUPT
     static uint32_t lastCalledAt = 0;
@@ -236,11 +243,18 @@ void mpuIntExtiInit(void)
     EXTIHandlerInit(&mpuIntCallbackRec, mpuIntExtiHandler);
     EXTIConfig(mpuIntIO, &mpuIntCallbackRec, NVIC_PRIO_MPU_INT_EXTI, EXTI_Trigger_Rising);
     EXTIEnable(mpuIntIO, true);
+
+    mpuIntExtiConfigured = true;
 #endif
 
     mpuExtiInitDone = true;
 }
 
+bool mpuIsDataReadyInterruptConfigured(void)
+{
+    return mpuIntExtiConfigured;
+}
+
 static bool mpuReadRegisterI2C(uint8_t reg, uint8_t length, uint8_t* data)
 {
     bool ack = i2cRead(MPU_I2C_INSTANCE, MPU_ADDRESS, reg, length, data);
@@ -288,11 +302,115 @@ bool mpuGyroRead(int16_t *gyroADC)
 bool checkMPUDataReady(void)
 {
     bool ret;
-    if (mpuDataReady) {
+    if (mpuDataReadyCount >= mpuDataReadyRequired) {
         ret = true;
-        mpuDataReady= false;
+        mpuDataReadyCount = 0;
     } else {
         ret = false;
     }
     return ret;
 }
+
+#ifdef USE_MPU_FIFO
+static int16_t mpuFifoAcc[XYZ_AXIS_COUNT];
+static int16_t mpuFifoGyro[XYZ_AXIS_COUNT];
+static bool mpuFifoAccReady;
+static bool mpuFifoGyroReady;
+
+// Reading the FIFO over I2C takes longer than the loop, only SPI sensors use it
+bool mpuFifoAvailable(void)
+{
+    return gyroMPU6xxxUseFifo() && mpuDetectionResult.sensor == MPU_65xx_SPI;
+}
+
+// USER_CTRL also holds the I2C master bits the AK8963 driver sets on MPU9250 boards
+static void mpuFifoReset(void)
+{
+    uint8_t userCtrl;
+
+    if (mpuConfiguration.read(MPU_RA_USER_CTRL, 1, &userCtrl)) {
+        mpuConfiguration.write(MPU_RA_USER_CTRL, userCtrl | MPU_RF_USER_FIFO_EN | MPU_RF_USER_FIFO_RST);
+    }
+}
+
+void mpuFifoInit(uint8_t samplesPerDataReady)
+{
+    mpuConfiguration.write(MPU_RA_FIFO_EN, MPU_RF_FIFO_EN_ACCEL | MPU_RF_FIFO_EN_GYRO);
+    mpuFifoReset();
+
+    mpuDataReadyRequired = samplesPerDataReady;
+}
+
+/*
+ * Reads every sample collected since the last burst and averages them for both acc and gyro,
+ * so the bus is used once per loop whichever of them is read first.
+ */
+static bool mpuFifoBurstRead(void)
+{
+    static uint8_t fifoData[MPU_FIFO_BURST_SAMPLES * MPU_FIFO_SAMPLE_SIZE];
+    uint8_t countData[2];
+
+    if (!mpuConfiguration.read(MPU_RA_FIFO_COUNTH, 2, countData)) {
+        return false;
+    }
+
+    const uint16_t fifoCount = ((countData[0] & 0x1F) << 8) | countData[1];
+
+    // a full FIFO has overwritten samples and may no longer be aligned to the sample frames
+    if (fifoCount > MPU_FIFO_SIZE - MPU_FIFO_SAMPLE_SIZE) {
+        mpuFifoReset();
+        return false;
+    }
+
+    mpuFifoSum_t sum;
+    mpuFifoSumReset(&sum);
+
+    uint16_t samplesLeft = fifoCount / MPU_FIFO_SAMPLE_SIZE;
+    while (samplesLeft) {
+        const uint8_t burstSamples = MIN(samplesLeft, MPU_FIFO_BURST_SAMPLES);
+
+        if (!mpuConfiguration.read(MPU_RA_FIFO_R_W, burstSamples * MPU_FIFO_SAMPLE_SIZE, fifoData)) {
+            // part of the FIFO may have been consumed, the next read would start inside a sample frame
+            mpuFifoReset();
+            return false;
+        }
+
+        mpuFifoSumSamples(&sum, fifoData, burstSamples);
+        samplesLeft -= burstSamples;
+    }
+
+    if (!mpuFifoSumAverage(&sum, mpuFifoAcc, mpuFifoGyro)) {
+        return false;
+    }
+
+    mpuFifoAccReady = true;
+    mpuFifoGyroReady = true;
+
+    return true;
+}
+
+// Falls back to the data registers when the FIFO was empty or had overflowed
+bool mpuAccReadFifo(int16_t *accData)
+{
+    if (!mpuFifoAccReady && !mpuFifoBurstRead()) {
+        return mpuAccRead(accData);
+    }
+
+    memcpy(accData, mpuFifoAcc, sizeof(mpuFifoAcc));
+    mpuFifoAccReady = false;
+
+    return true;
+}
+
+bool mpuGyroReadFifo(int16_t *gyroADC)
+{
+    if (!mpuFifoGyroReady && !mpuFifoBurstRead()) {
+        return mpuGyroRead(gyroADC);
+    }
+
+    memcpy(gyroADC, mpuFifoGyro, sizeof(mpuFifoGyro));
+    mpuFifoGyroReady = false;
+
+    return true;
+}
+#endif
@@ -116,6 +116,10 @@
 
 // RF = Register Flag
 #define MPU_RF_DATA_RDY_EN (1 << 0)
+#define MPU_RF_FIFO_EN_GYRO     0x70    // FIFO_EN: XG, YG and ZG
+#define MPU_RF_FIFO_EN_ACCEL    0x08    // FIFO_EN: ACCEL
+#define MPU_RF_USER_FIFO_EN     0x40    // USER_CTRL
+#define MPU_RF_USER_FIFO_RST    0x04    // USER_CTRL
 
 typedef bool (*mpuReadRegisterFunc)(uint8_t reg, uint8_t length, uint8_t* data);
 typedef bool (*mpuWriteRegisterFunc)(uint8_t reg, uint8_t data);
@@ -184,7 +188,14 @@ extern mpuDetectionResult_t mpuDetectionResult;
 
 void configureMPUDataReadyInterruptHandling(void);
 void mpuIntExtiInit(void);
+bool mpuIsDataReadyInterruptConfigured(void);
 bool mpuAccRead(int16_t *accData);
 bool mpuGyroRead(int16_t *gyroADC);
+#ifdef USE_MPU_FIFO
+bool mpuFifoAvailable(void);
+void mpuFifoInit(uint8_t samplesPerDataReady);
+bool mpuAccReadFifo(int16_t *accData);
+bool mpuGyroReadFifo(int16_t *gyroADC);
+#endif
 mpuDetectionResult_t *detectMpu(const extiConfig_t *configToUse);
 bool checkMPUDataReady(void);
@@ -58,6 +58,7 @@ bool mpu3050Detect(gyro_t *gyro)
     gyro->read = mpuGyroRead;
     gyro->temperature = mpu3050ReadTemp;
     gyro->intStatus = checkMPUDataReady;
+    gyro->intConfigured = mpuIsDataReadyInterruptConfigured;
 
     // 16.4 dps/lsb scalefactor
     gyro->scale = 1.0f / 16.4f;
@@ -73,6 +73,7 @@ bool mpu6050GyroDetect(gyro_t *gyro)
     gyro->init = mpu6050GyroInit;
     gyro->read = mpuGyroRead;
     gyro->intStatus = checkMPUDataReady;
+    gyro->intConfigured = mpuIsDataReadyInterruptConfigured;
 
     // 16.4 dps/lsb scalefactor
     gyro->scale = 1.0f / 16.4f;
@@ -55,6 +55,7 @@ bool mpu6500GyroDetect(gyro_t *gyro)
     gyro->init = mpu6500GyroInit;
     gyro->read = mpuGyroRead;
     gyro->intStatus = checkMPUDataReady;
+    gyro->intConfigured = mpuIsDataReadyInterruptConfigured;
 
     // 16.4 dps/lsb scalefactor
     gyro->scale = 1.0f / 16.4f;
@@ -96,7 +97,14 @@ void mpu6500GyroInit(uint8_t lpf)
     mpuConfiguration.write(MPU_RA_GYRO_CONFIG, INV_FSR_2000DPS << 3);
     mpuConfiguration.write(MPU_RA_ACCEL_CONFIG, INV_FSR_8G << 3);
     mpuConfiguration.write(MPU_RA_CONFIG, lpf);
-    mpuConfiguration.write(MPU_RA_SMPLRT_DIV, gyroMPU6xxxCalculateDivider()); // Get Divider
+
+    uint8_t sampleRateDivider = gyroMPU6xxxCalculateDivider();
+#ifdef USE_MPU_FIFO
+    if (mpuFifoAvailable()) {
+        sampleRateDivider = 0;  // sample at the full rate, the FIFO keeps the samples the divider would drop
+    }
+#endif
+    mpuConfiguration.write(MPU_RA_SMPLRT_DIV, sampleRateDivider); // Get Divider
 
     // Data ready interrupt configuration
 #ifdef USE_MPU9250_MAG
@@ -109,4 +117,9 @@ void mpu6500GyroInit(uint8_t lpf)
     mpuConfiguration.write(MPU_RA_INT_ENABLE, 0x01); // RAW_RDY_EN interrupt enable
 #endif
 
+#ifdef USE_MPU_FIFO
+    if (mpuFifoAvailable()) {
+        mpuFifoInit(gyroMPU6xxxCalculateDivider() + 1);
+    }
+#endif
 }
@@ -0,0 +1,70 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common/axis.h"
+
+#include "drivers/accgyro_mpu_fifo.h"
+
+void mpuFifoSumReset(mpuFifoSum_t *sum)
+{
+    memset(sum, 0, sizeof(*sum));
+}
+
+static int16_t mpuFifoWord(const uint8_t *data)
+{
+    return (int16_t)((data[0] << 8) | data[1]);
+}
+
+void mpuFifoSumSamples(mpuFifoSum_t *sum, const uint8_t *data, uint8_t sampleCount)
+{
+    for (int sample = 0; sample < sampleCount; sample++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            sum->acc[axis] += mpuFifoWord(&data[axis * 2]);
+            sum->gyro[axis] += mpuFifoWord(&data[6 + axis * 2]);
+        }
+        data += MPU_FIFO_SAMPLE_SIZE;
+    }
+
+    sum->sampleCount += sampleCount;
+}
+
+static int16_t mpuFifoRoundedAverage(int32_t sum, int32_t count)
+{
+    return (sum >= 0) ? (sum + count / 2) / count : (sum - count / 2) / count;
+}
+
+/*
+ * Averaging N samples decimates the sensor rate to the loop rate. The boxcar's nulls sit on
+ * multiples of the loop rate, the frequencies that would otherwise alias down to DC.
+ */
+bool mpuFifoSumAverage(const mpuFifoSum_t *sum, int16_t *accData, int16_t *gyroData)
+{
+    if (!sum->sampleCount) {
+        return false;
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        accData[axis] = mpuFifoRoundedAverage(sum->acc[axis], sum->sampleCount);
+        gyroData[axis] = mpuFifoRoundedAverage(sum->gyro[axis], sum->sampleCount);
+    }
+
+    return true;
+}
@@ -0,0 +1,39 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+ * FIFO frames hold the enabled sensor registers in register order,
+ * with accel and gyro enabled that is accel X/Y/Z then gyro X/Y/Z as big endian words.
+ */
+#define MPU_FIFO_SIZE               512
+#define MPU_FIFO_SAMPLE_SIZE        12
+#define MPU_FIFO_BURST_SAMPLES      16      // largest read in one bus transaction, 8kHz sampling with a 2ms loop
+
+// Longest loop the FIFO holds every sample of at the 8kHz rate of gyro_lpf = 256HZ, with room for loop jitter
+#define MPU_FIFO_MAX_LOOPTIME_8KHZ  ((MPU_FIFO_SIZE / MPU_FIFO_SAMPLE_SIZE - 2) * 125)
+
+typedef struct mpuFifoSum_s {
+    int32_t acc[XYZ_AXIS_COUNT];
+    int32_t gyro[XYZ_AXIS_COUNT];
+    uint16_t sampleCount;
+} mpuFifoSum_t;
+
+void mpuFifoSumReset(mpuFifoSum_t *sum);
+void mpuFifoSumSamples(mpuFifoSum_t *sum, const uint8_t *data, uint8_t sampleCount);
+bool mpuFifoSumAverage(const mpuFifoSum_t *sum, int16_t *accData, int16_t *gyroData);
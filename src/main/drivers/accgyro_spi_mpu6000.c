@@ -269,6 +269,7 @@ bool mpu6000SpiGyroDetect(gyro_t *gyro)
     gyro->init = mpu6000SpiGyroInit;
     gyro->read = mpuGyroRead;
     gyro->intStatus = checkMPUDataReady;
+    gyro->intConfigured = mpuIsDataReadyInterruptConfigured;
 
     // 16.4 dps/lsb scalefactor
     gyro->scale = 1.0f / 16.4f;
@@ -119,7 +119,11 @@ bool mpu6500SpiAccDetect(acc_t *acc)
     }
 
     acc->init = mpu6500AccInit;
+#ifdef USE_MPU_FIFO
+    acc->read = mpuFifoAvailable() ? mpuAccReadFifo : mpuAccRead;
+#else
     acc->read = mpuAccRead;
+#endif
 
     return true;
 }
@@ -131,8 +135,13 @@ bool mpu6500SpiGyroDetect(gyro_t *gyro)
     }
 
     gyro->init = mpu6500GyroInit;
+#ifdef USE_MPU_FIFO
+    gyro->read = mpuFifoAvailable() ? mpuGyroReadFifo : mpuGyroRead;
+#else
     gyro->read = mpuGyroRead;
+#endif
     gyro->intStatus = checkMPUDataReady;
+    gyro->intConfigured = mpuIsDataReadyInterruptConfigured;
 
     // 16.4 dps/lsb scalefactor
     gyro->scale = 1.0f / 16.4f;
@@ -45,4 +45,7 @@ typedef struct drv_adc_config_s {
 } drv_adc_config_t;
 
 void adcInit(drv_adc_config_t *init);
+#ifdef USE_DSHOT
+DMA_Channel_TypeDef *adcGetDmaChannel(void);
+#endif
 uint16_t adcGetChannel(uint8_t channel);
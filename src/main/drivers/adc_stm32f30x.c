@@ -95,6 +95,15 @@ ADCDevice adcDeviceByInstance(ADC_TypeDef *instance)
     return ADCINVALID;
 }
 
+DMA_Channel_TypeDef *adcGetDmaChannel(void)
+{
+    ADCDevice device = adcDeviceByInstance(ADC_INSTANCE);
+    if (device == ADCINVALID)
+        return NULL;
+
+    return adcHardware[device].DMAy_Channelx;
+}
+
 void adcInit(drv_adc_config_t *init)
 {
     UNUSED(init);
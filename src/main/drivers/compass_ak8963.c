@@ -210,7 +210,9 @@ bool ak8963Detect(mag_t *mag)
     ack = verifympu9250WriteRegister(MPU_RA_I2C_MST_CTRL, 0x0D);              // I2C multi-master / 400kHz
     delay(10);
 
-    ack = verifympu9250WriteRegister(MPU_RA_USER_CTRL, 0x30);                 // I2C master mode, SPI mode only
+    uint8_t userCtrl = 0;
+    mpu9250ReadRegister(MPU_RA_USER_CTRL, 1, &userCtrl);                      // keep FIFO_EN if the gyro reads its FIFO
+    ack = verifympu9250WriteRegister(MPU_RA_USER_CTRL, userCtrl | 0x30);      // I2C master mode, SPI mode only
     delay(10);
 #endif
 
@@ -0,0 +1,71 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "drivers/dshot.h"
+
+#define DSHOT_PULSE_MIN     1000
+#define DSHOT_PULSE_MAX     2000
+
+void dshotTimingInit(dshotTiming_t *timing, uint16_t kbitRate, uint8_t timerMhz)
+{
+    timing->bitPeriod = (uint32_t)timerMhz * 1000 / kbitRate;
+    timing->bit1 = timing->bitPeriod * 3 / 4;
+    timing->bit0 = timing->bitPeriod * 3 / 8;
+}
+
+/*
+ * Motor values are pulse widths in the 1000-2000us range, anything at or below 1000 stops the motor.
+ * There is no calibration: the range maps linearly onto the whole DShot throttle range.
+ */
+uint16_t dshotThrottleFromPulse(uint16_t pulse)
+{
+    if (pulse <= DSHOT_PULSE_MIN) {
+        return DSHOT_DISARM_COMMAND;
+    }
+    if (pulse >= DSHOT_PULSE_MAX) {
+        return DSHOT_MAX_THROTTLE;
+    }
+
+    return DSHOT_MIN_THROTTLE + (uint32_t)(pulse - DSHOT_PULSE_MIN) * (DSHOT_MAX_THROTTLE - DSHOT_MIN_THROTTLE) / (DSHOT_PULSE_MAX - DSHOT_PULSE_MIN);
+}
+
+uint16_t dshotPrepareFrame(uint16_t value, bool requestTelemetry)
+{
+    uint16_t packet = (value << 1) | (requestTelemetry ? 1 : 0);
+
+    // checksum is the xor of the three nibbles of the packet
+    uint16_t csum = packet ^ (packet >> 4) ^ (packet >> 8);
+
+    return (packet << 4) | (csum & 0x0f);
+}
+
+/*
+ * Writes the compare values for one frame into every stride-th slot of buffer.
+ * Burst DMA interleaves the channels of a timer, so stride is the number of channels in the burst.
+ */
+void dshotEncodeFrame(uint32_t *buffer, uint8_t stride, uint16_t frame, const dshotTiming_t *timing)
+{
+    for (int i = 0; i < DSHOT_FRAME_BITS; i++) {
+        buffer[i * stride] = (frame & 0x8000) ? timing->bit1 : timing->bit0;
+        frame <<= 1;
+    }
+    buffer[DSHOT_FRAME_BITS * stride] = 0;
+    buffer[(DSHOT_FRAME_BITS + 1) * stride] = 0;
+}
@@ -0,0 +1,43 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/*
+ * DShot frame: 11 bit throttle, 1 telemetry request bit and a 4 bit checksum, sent MSB first.
+ * Every bit takes the same time, a 1 is high for 3/4 of the bit and a 0 for 3/8 of it.
+ */
+#define DSHOT_FRAME_BITS            16
+#define DSHOT_DMA_BUFFER_SIZE       (DSHOT_FRAME_BITS + 2)  // two trailing zero slots hold the line low after the frame
+
+#define DSHOT_TIMER_MHZ             24
+
+#define DSHOT_DISARM_COMMAND        0
+#define DSHOT_MIN_THROTTLE          48      // 1..47 are reserved for ESC commands
+#define DSHOT_MAX_THROTTLE          2047
+
+typedef struct dshotTiming_s {
+    uint16_t bitPeriod;             // timer ticks per bit
+    uint16_t bit1;                  // high time of a 1
+    uint16_t bit0;                  // high time of a 0
+} dshotTiming_t;
+
+void dshotTimingInit(dshotTiming_t *timing, uint16_t kbitRate, uint8_t timerMhz);
+
+uint16_t dshotThrottleFromPulse(uint16_t pulse);
+uint16_t dshotPrepareFrame(uint16_t value, bool requestTelemetry);
+void dshotEncodeFrame(uint32_t *buffer, uint8_t stride, uint16_t frame, const dshotTiming_t *timing);
@@ -35,6 +35,7 @@ extern gyro_t gyro;
 
 uint32_t targetLooptime;
 static uint8_t mpuDividerDrops;
+static bool mpuUseFifo;
 
 bool getMpuDataStatus(gyro_t *gyro)
 {
@@ -46,8 +47,16 @@ bool gyroSyncCheckUpdate(void)
     return getMpuDataStatus(&gyro);
 }
 
-void gyroSetSampleRate(uint32_t looptime, uint8_t lpf, uint8_t gyroSync, uint8_t gyroSyncDenominator)
+// Without the data ready interrupt gyroSyncCheckUpdate() never fires and the loop runs off the watchdog
+bool gyroSyncIsInterruptDriven(void)
 {
+    return gyro.intConfigured && gyro.intConfigured();
+}
+
+void gyroSetSampleRate(uint32_t looptime, uint8_t lpf, uint8_t gyroSync, uint8_t gyroSyncDenominator, uint8_t gyroFifo)
+{
+    mpuUseFifo = gyroFifo;
+
     if (gyroSync) {
         int gyroSamplePeriod;
         if (lpf == 0) {
@@ -69,3 +78,9 @@ uint8_t gyroMPU6xxxCalculateDivider(void)
 {
     return mpuDividerDrops;
 }
+
+// Drivers with a FIFO sample at the full rate instead and average the samples the divider would drop
+bool gyroMPU6xxxUseFifo(void)
+{
+    return mpuUseFifo;
+}
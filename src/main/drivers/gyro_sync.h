@@ -20,5 +20,7 @@
 extern uint32_t targetLooptime;
 
 bool gyroSyncCheckUpdate(void);
+bool gyroSyncIsInterruptDriven(void);
 uint8_t gyroMPU6xxxCalculateDivider(void);
-void gyroSetSampleRate(uint32_t looptime, uint8_t lpf, uint8_t gyroSync, uint8_t gyroSyncDenominator);
+bool gyroMPU6xxxUseFifo(void);
+void gyroSetSampleRate(uint32_t looptime, uint8_t lpf, uint8_t gyroSync, uint8_t gyroSyncDenominator, uint8_t gyroFifo);
@@ -32,6 +32,9 @@ void ws2811LedStripInit(void);
 
 void ws2811LedStripHardwareInit(void);
 void ws2811LedStripDMAEnable(void);
+#ifdef USE_DSHOT
+DMA_Channel_TypeDef *ws2811LedStripDmaChannel(void);
+#endif
 
 void ws2811UpdateStrip(void);
 
@@ -159,6 +159,11 @@ void DMA1_Channel7_IRQHandler(void)
 }
 #endif
 
+DMA_Channel_TypeDef *ws2811LedStripDmaChannel(void)
+{
+    return WS2811_DMA_CHANNEL;
+}
+
 void ws2811LedStripDMAEnable(void)
 {
     DMA_SetCurrDataCounter(WS2811_DMA_CHANNEL, WS2811_DMA_BUFFER_SIZE);  // load number of bytes to be transferred
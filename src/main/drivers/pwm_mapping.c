@@ -22,6 +22,8 @@
 
 #include "platform.h"
 
+#include "common/color.h"
+
 #include "gpio.h"
 #include "io.h"
 #include "io_impl.h"
@@ -30,10 +32,15 @@
 #include "pwm_output.h"
 #include "pwm_rx.h"
 #include "pwm_mapping.h"
+#include "adc.h"
+#include "light_ws2811strip.h"
 
 void pwmBrushedMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex, uint16_t motorPwmRate, uint16_t idlePulse);
 void pwmBrushlessMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex, uint16_t motorPwmRate, uint16_t idlePulse);
 void pwmOneshotMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex);
+void pwmDshotMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex, motorPwmProtocol_e protocol);
+bool pwmDshotMotorsAvailable(const timerHardware_t * const motorHardware[], uint8_t motorCount);
+void pwmDshotReserveDmaChannel(DMA_Channel_TypeDef *dmaChannel);
 void pwmServoConfig(const timerHardware_t *timerHardware, uint8_t servoIndex, uint16_t servoPwmRate, uint16_t servoCenterPulse);
 
 /*
@@ -93,6 +100,39 @@ bool CheckGPIOPinSource(ioTag_t tag, GPIO_TypeDef *gpio, uint16_t pin)
     return IO_GPIOBYTAG(tag) == gpio && IO_GPIO_PinSource(IOGetByTag(tag)) == pin;
 }
 
+#ifdef USE_DSHOT
+// All motors get DShot, or all of them fall back to standard PWM if any of them can't use it
+static void pwmDshotMotorsInit(drv_pwm_config_t *init)
+{
+    const timerHardware_t *motorHardware[MAX_PWM_MOTORS];
+    uint8_t motorCount = 0;
+
+    for (int i = 0; i < pwmIOConfiguration.ioCount; i++) {
+        if ((pwmIOConfiguration.ioConfigurations[i].flags & PWM_PF_MOTOR) && motorCount < MAX_PWM_MOTORS) {
+            motorHardware[motorCount++] = pwmIOConfiguration.ioConfigurations[i].timerHardware;
+        }
+    }
+
+    const bool useDshot = motorCount == pwmIOConfiguration.motorCount && pwmDshotMotorsAvailable(motorHardware, motorCount);
+    pwmIOConfiguration.dshotUnavailable = !useDshot;
+
+    for (int i = 0; i < pwmIOConfiguration.ioCount; i++) {
+        pwmPortConfiguration_t *port = &pwmIOConfiguration.ioConfigurations[i];
+
+        if (!(port->flags & PWM_PF_MOTOR)) {
+            continue;
+        }
+
+        if (useDshot) {
+            pwmDshotMotorConfig(port->timerHardware, port->index, init->motorPwmProtocol);
+        } else {
+            pwmBrushlessMotorConfig(port->timerHardware, port->index, init->motorPwmRate, init->idlePulse);
+            port->flags = PWM_PF_MOTOR | PWM_PF_OUTPUT_PROTOCOL_PWM;
+        }
+    }
+}
+#endif
+
 pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
 {
 #ifndef SKIP_RX_PWM_PPM
@@ -110,6 +150,23 @@ pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
 
     const uint16_t *setup = hardwareMaps[i];
 
+#ifdef USE_DSHOT
+    if (init->motorPwmProtocol != MOTOR_PWM_PROTOCOL_STANDARD) {
+        // devices set up after pwmInit() whose DMA channel a motor timer could otherwise take over
+#ifdef USE_ADC
+        pwmDshotReserveDmaChannel(adcGetDmaChannel());
+#endif
+#ifdef LED_STRIP
+        if (init->useLEDStrip) {
+            pwmDshotReserveDmaChannel(ws2811LedStripDmaChannel());
+        }
+#endif
+#if defined(USE_SDCARD) && defined(SDCARD_DMA_CHANNEL_TX)
+        pwmDshotReserveDmaChannel(SDCARD_DMA_CHANNEL_TX);
+#endif
+    }
+#endif
+
     for (i = 0; i < USABLE_TIMER_CHANNEL_COUNT && setup[i] != 0xFFFF; i++) {
         uint8_t timerIndex = setup[i] & 0x00FF;
         uint8_t type = (setup[i] & 0xFF00) >> 8;
@@ -276,12 +333,12 @@ pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
         if (type == MAP_TO_PPM_INPUT) {
 #ifndef SKIP_RX_PWM_PPM
 #ifdef CC3D_PPM1
-            if (init->useOneshot || isMotorBrushed(init->motorPwmRate)) {
+            if (init->useOneshot || init->motorPwmProtocol != MOTOR_PWM_PROTOCOL_STANDARD || isMotorBrushed(init->motorPwmRate)) {
                 ppmAvoidPWMTimerClash(timerHardwarePtr, TIM4);
             }
 #endif
 #ifdef SPARKY
-            if (init->useOneshot || isMotorBrushed(init->motorPwmRate)) {
+            if (init->useOneshot || init->motorPwmProtocol != MOTOR_PWM_PROTOCOL_STANDARD || isMotorBrushed(init->motorPwmRate)) {
                 ppmAvoidPWMTimerClash(timerHardwarePtr, TIM2);
             }
 #endif
@@ -299,11 +356,19 @@ pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
         } else if (type == MAP_TO_MOTOR_OUTPUT) {
 
 #if defined(CC3D) && !defined(CC3D_PPM1)
-            if (init->useOneshot || isMotorBrushed(init->motorPwmRate)) {
+            if (init->useOneshot || init->motorPwmProtocol != MOTOR_PWM_PROTOCOL_STANDARD || isMotorBrushed(init->motorPwmRate)) {
                 // Skip it if it would cause PPM capture timer to be reconfigured or manually overflowed
                 if (timerHardwarePtr->tim == TIM2)
                     continue;
             }
+#endif
+#ifdef USE_DSHOT
+            if (init->motorPwmProtocol != MOTOR_PWM_PROTOCOL_STANDARD) {
+
+                // set up by pwmDshotMotorsInit() once all motors are known
+                pwmIOConfiguration.ioConfigurations[pwmIOConfiguration.ioCount].flags = PWM_PF_MOTOR | PWM_PF_OUTPUT_PROTOCOL_DSHOT;
+
+            } else
 #endif
             if (init->useOneshot) {
 
@@ -343,5 +408,11 @@ pwmIOConfiguration_t *pwmInit(drv_pwm_config_t *init)
         pwmIOConfiguration.ioCount++;
     }
 
+#ifdef USE_DSHOT
+    if (init->motorPwmProtocol != MOTOR_PWM_PROTOCOL_STANDARD) {
+        pwmDshotMotorsInit(init);
+    }
+#endif
+
     return &pwmIOConfiguration;
 }
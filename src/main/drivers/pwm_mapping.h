@@ -47,6 +47,12 @@
 #define ONESHOT125_TIMER_MHZ 8
 #define PWM_BRUSHED_TIMER_MHZ 8
 
+typedef enum {
+    MOTOR_PWM_PROTOCOL_STANDARD = 0,    // PWM, OneShot125 or brushed, see motor_pwm_rate and FEATURE_ONESHOT125
+    MOTOR_PWM_PROTOCOL_DSHOT150,
+    MOTOR_PWM_PROTOCOL_DSHOT300,
+    MOTOR_PWM_PROTOCOL_DSHOT600,
+} motorPwmProtocol_e;
 
 typedef struct sonarIOConfig_s {
     ioTag_t triggerTag;
@@ -80,6 +86,7 @@ typedef struct drv_pwm_config_s {
 #endif
     bool airplane;       // fixed wing hardware config, lots of servos etc
     uint16_t motorPwmRate;
+    uint8_t motorPwmProtocol;
     uint16_t idlePulse;  // PWM value to use when initializing the driver. set this to either PULSE_1MS (regular pwm),
                          // some higher value (used by 3d mode), or 0, for brushed pwm drivers.
     sonarIOConfig_t sonarIOConfig;
@@ -101,7 +108,8 @@ typedef enum {
     PWM_PF_OUTPUT_PROTOCOL_PWM = (1 << 3),
     PWM_PF_OUTPUT_PROTOCOL_ONESHOT = (1 << 4),
     PWM_PF_PPM = (1 << 5),
-    PWM_PF_PWM = (1 << 6)
+    PWM_PF_PWM = (1 << 6),
+    PWM_PF_OUTPUT_PROTOCOL_DSHOT = (1 << 7)
 } pwmPortFlags_e;
 
 
@@ -117,6 +125,7 @@ typedef struct pwmIOConfiguration_s {
     uint8_t ioCount;
     uint8_t pwmInputCount;
     uint8_t ppmInputCount;
+    bool dshotUnavailable;      // DShot was requested but can't drive every motor, they all use standard PWM
     pwmPortConfiguration_t ioConfigurations[USABLE_TIMER_CHANNEL_COUNT];
 } pwmIOConfiguration_t;
 
@@ -26,6 +26,7 @@
 #include "io.h"
 #include "io_impl.h"
 #include "timer.h"
+#include "dshot.h"
 
 #include "flight/failsafe.h" // FIXME dependency into the main code from a driver
 
@@ -46,6 +47,12 @@ typedef struct {
     TIM_TypeDef *tim;
     uint16_t period;
     pwmWriteFuncPtr pwmWritePtr;
+#ifdef USE_DSHOT
+    uint32_t *dmaBuffer;        // first slot of this channel in the timer's DMA buffer
+    uint8_t dmaStride;
+    uint8_t dmaSlot;            // CCR of this channel, counted from CCR1
+    uint8_t dshotTimerIndex;
+#endif
 } pwmOutputPort_t;
 
 static pwmOutputPort_t pwmOutputPorts[MAX_PWM_OUTPUT_PORTS];
@@ -59,6 +66,57 @@ static pwmOutputPort_t *servos[MAX_PWM_SERVOS];
 static uint8_t allocatedOutputPortCount = 0;
 
 static bool pwmMotorsEnabled = true;
+
+#ifdef USE_DSHOT
+#define DSHOT_MAX_TIMER_CHANNELS 4
+#define DSHOT_MAX_RESERVED_DMA_CHANNELS 4
+
+// Timers which can drive DShot: a burst on the update event writes the motor CCRs through DMAR
+typedef struct {
+    TIM_TypeDef *tim;
+    DMA_Channel_TypeDef *dmaChannel;
+    uint32_t dmaRcc;
+    uint8_t channelCount;
+} dshotTimerDef_t;
+
+static const dshotTimerDef_t dshotTimerDefs[] = {
+    { TIM1,  DMA1_Channel5, RCC_AHBPeriph_DMA1, 4 },
+    { TIM2,  DMA1_Channel2, RCC_AHBPeriph_DMA1, 4 },
+    { TIM3,  DMA1_Channel3, RCC_AHBPeriph_DMA1, 4 },
+    { TIM4,  DMA1_Channel7, RCC_AHBPeriph_DMA1, 4 },
+#if defined(STM32F3)
+    { TIM8,  DMA2_Channel1, RCC_AHBPeriph_DMA2, 4 },
+    { TIM15, DMA1_Channel5, RCC_AHBPeriph_DMA1, 2 },
+    { TIM16, DMA1_Channel3, RCC_AHBPeriph_DMA1, 1 },
+    { TIM17, DMA1_Channel1, RCC_AHBPeriph_DMA1, 1 },
+#endif
+};
+
+// The burst writes CCR1 up to the highest motor channel, so the motors can use any channels in any order.
+// A channel without a motor gets 0 and stays low.
+typedef struct {
+    const dshotTimerDef_t *def;
+    uint8_t slotCount;
+    uint32_t dmaBuffer[DSHOT_DMA_BUFFER_SIZE * DSHOT_MAX_TIMER_CHANNELS];
+} dshotTimer_t;
+
+static dshotTimer_t dshotTimers[MAX_MOTORS];
+static uint8_t dshotTimerCount = 0;
+static dshotTiming_t dshotTiming;
+static bool dshotArmed = false;
+static uint16_t dshotDisarmedStopPulse = 0;
+
+#if defined(STM32F3)
+#define DSHOT_DMA_CCR_EN DMA_CCR_EN
+#else
+#define DSHOT_DMA_CCR_EN DMA_CCR1_EN
+#endif
+
+// DMA channels of devices set up after pwmInit(), which DShot must leave alone
+static DMA_Channel_TypeDef *dshotReservedDmaChannels[DSHOT_MAX_RESERVED_DMA_CHANNELS];
+static uint8_t dshotReservedDmaChannelCount = 0;
+#endif
+
 static void pwmOCConfig(TIM_TypeDef *tim, uint8_t channel, uint16_t value, uint8_t outputPolarity)
 {
     TIM_OCInitTypeDef  TIM_OCInitStructure;
@@ -160,6 +218,30 @@ void pwmShutdownPulsesForAllMotors(uint8_t motorCount)
     }
 }
 
+#ifdef USE_DSHOT
+// In normal mode the channel stays enabled after the burst, the counter reaching 0 marks it as done
+static bool dshotTimerIsBusy(const dshotTimer_t *dshotTimer)
+{
+    DMA_Channel_TypeDef *dmaChannel = dshotTimer->def->dmaChannel;
+
+    return (dmaChannel->CCR & DSHOT_DMA_CCR_EN) && DMA_GetCurrDataCounter(dmaChannel) != 0;
+}
+
+static void pwmWriteDshot(uint8_t index, uint16_t value)
+{
+    // a frame still being sent keeps its buffer, the motor gets this value on the next update
+    if (dshotTimerIsBusy(&dshotTimers[motors[index]->dshotTimerIndex])) {
+        return;
+    }
+
+    // disarmed motors output min_command or neutral3d, which would be a throttle value for DShot.
+    // Higher values come from the motor test and spin the motor.
+    const uint16_t command = (dshotArmed || value > dshotDisarmedStopPulse) ? dshotThrottleFromPulse(value) : DSHOT_DISARM_COMMAND;
+    uint16_t frame = dshotPrepareFrame(command, false);
+    dshotEncodeFrame(motors[index]->dmaBuffer, motors[index]->dmaStride, frame, &dshotTiming);
+}
+#endif
+
 void pwmDisableMotors(void)
 {
     pwmMotorsEnabled = false;
@@ -189,6 +271,32 @@ void pwmCompleteOneshotMotorUpdate(uint8_t motorCount)
     }
 }
 
+#ifdef USE_DSHOT
+/*
+ * Frames are encoded by pwmWriteMotor(), this restarts the burst DMA of every DShot timer
+ * so the next update events clock the new frames out on all channels of the timer at once.
+ * A timer still sending the previous frames, when the loop is faster than the frame, is skipped.
+ */
+void pwmCompleteDshotMotorUpdate(void)
+{
+    if (!pwmMotorsEnabled) {
+        return;
+    }
+
+    for (int i = 0; i < dshotTimerCount; i++) {
+        const dshotTimerDef_t *def = dshotTimers[i].def;
+
+        if (dshotTimerIsBusy(&dshotTimers[i])) {
+            continue;
+        }
+
+        DMA_Cmd(def->dmaChannel, DISABLE);
+        DMA_SetCurrDataCounter(def->dmaChannel, DSHOT_DMA_BUFFER_SIZE * dshotTimers[i].slotCount);
+        DMA_Cmd(def->dmaChannel, ENABLE);
+    }
+}
+#endif
+
 bool isMotorBrushed(uint16_t motorPwmRate)
 {
     return (motorPwmRate > 500);
@@ -214,6 +322,178 @@ void pwmOneshotMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIn
     motors[motorIndex]->pwmWritePtr = pwmWriteStandard;
 }
 
+#ifdef USE_DSHOT
+static uint16_t dshotKbitRate(motorPwmProtocol_e protocol)
+{
+    switch (protocol) {
+        case MOTOR_PWM_PROTOCOL_DSHOT150:
+            return 150;
+        case MOTOR_PWM_PROTOCOL_DSHOT300:
+            return 300;
+        default:
+            return 600;
+    }
+}
+
+void pwmDshotSetArmed(bool armed, uint16_t disarmedStopPulse)
+{
+    dshotArmed = armed;
+    dshotDisarmedStopPulse = disarmedStopPulse;
+}
+
+void pwmDshotReserveDmaChannel(DMA_Channel_TypeDef *dmaChannel)
+{
+    if (dshotReservedDmaChannelCount < DSHOT_MAX_RESERVED_DMA_CHANNELS) {
+        dshotReservedDmaChannels[dshotReservedDmaChannelCount++] = dmaChannel;
+    }
+}
+
+static bool isDshotDmaChannelFree(DMA_Channel_TypeDef *dmaChannel)
+{
+    for (int i = 0; i < dshotReservedDmaChannelCount; i++) {
+        if (dshotReservedDmaChannels[i] == dmaChannel) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static dshotTimer_t *dshotTimerFind(TIM_TypeDef *tim)
+{
+    for (int i = 0; i < dshotTimerCount; i++) {
+        if (dshotTimers[i].def->tim == tim) {
+            return &dshotTimers[i];
+        }
+    }
+    return NULL;
+}
+
+static const dshotTimerDef_t *dshotTimerDefFind(TIM_TypeDef *tim)
+{
+    for (unsigned i = 0; i < sizeof(dshotTimerDefs) / sizeof(dshotTimerDefs[0]); i++) {
+        if (dshotTimerDefs[i].tim == tim) {
+            return &dshotTimerDefs[i];
+        }
+    }
+    return NULL;
+}
+
+static dshotTimer_t *dshotTimerConfig(const dshotTimerDef_t *def)
+{
+    TIM_TypeDef *tim = def->tim;
+
+    dshotTimer_t *dshotTimer = &dshotTimers[dshotTimerCount++];
+    dshotTimer->def = def;
+    dshotTimer->slotCount = 0;
+
+    DMA_InitTypeDef DMA_InitStructure;
+
+    RCC_AHBPeriphClockCmd(def->dmaRcc, ENABLE);
+    DMA_DeInit(def->dmaChannel);
+
+    DMA_StructInit(&DMA_InitStructure);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&tim->DMAR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)dshotTimer->dmaBuffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+    DMA_InitStructure.DMA_BufferSize = DSHOT_DMA_BUFFER_SIZE;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    // 32 bit timers on the F3 need word writes, the F1 timer registers are 16 bit
+#if defined(STM32F3)
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+#else
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+#endif
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(def->dmaChannel, &DMA_InitStructure);
+
+    TIM_DMACmd(tim, TIM_DMA_Update, ENABLE);
+
+    return dshotTimer;
+}
+
+// The burst stride changes with every motor added to the timer, so the motors' buffer slots move too
+static void dshotTimerUpdateBurst(dshotTimer_t *dshotTimer)
+{
+    TIM_TypeDef *tim = dshotTimer->def->tim;
+
+    TIM_DMAConfig(tim, TIM_DMABase_CCR1, (dshotTimer->slotCount - 1) << 8);
+
+    for (int i = 0; i < MAX_PWM_MOTORS; i++) {
+        if (motors[i] && motors[i]->tim == tim && motors[i]->pwmWritePtr == pwmWriteDshot) {
+            motors[i]->dmaBuffer = &dshotTimer->dmaBuffer[motors[i]->dmaSlot];
+            motors[i]->dmaStride = dshotTimer->slotCount;
+        }
+    }
+}
+
+/*
+ * DShot drives all motors or none of them, the ESCs of one craft must not get different protocols.
+ * Every motor timer needs an update DMA channel that no other timer or device uses.
+ */
+bool pwmDshotMotorsAvailable(const timerHardware_t * const motorHardware[], uint8_t motorCount)
+{
+    const dshotTimerDef_t *defs[MAX_MOTORS];
+    uint8_t defCount = 0;
+
+    if (motorCount > MAX_MOTORS) {
+        return false;
+    }
+
+    for (int i = 0; i < motorCount; i++) {
+        const dshotTimerDef_t *def = dshotTimerDefFind(motorHardware[i]->tim);
+        if (!def || (motorHardware[i]->channel >> 2) >= def->channelCount) {
+            return false;
+        }
+
+        bool known = false;
+        for (int j = 0; j < defCount; j++) {
+            if (defs[j] == def) {
+                known = true;
+            } else if (defs[j]->dmaChannel == def->dmaChannel) {
+                return false;
+            }
+        }
+        if (!known) {
+            if (!isDshotDmaChannelFree(def->dmaChannel)) {
+                return false;
+            }
+            defs[defCount++] = def;
+        }
+    }
+
+    return true;
+}
+
+// pwmDshotMotorsAvailable() must have accepted the whole motor set
+void pwmDshotMotorConfig(const timerHardware_t *timerHardware, uint8_t motorIndex, motorPwmProtocol_e protocol)
+{
+    dshotTimingInit(&dshotTiming, dshotKbitRate(protocol), DSHOT_TIMER_MHZ);
+
+    // TIM_Channel_x is the register offset from CCR1
+    const uint8_t channelSlot = timerHardware->channel >> 2;
+
+    dshotTimer_t *dshotTimer = dshotTimerFind(timerHardware->tim);
+    if (!dshotTimer) {
+        dshotTimer = dshotTimerConfig(dshotTimerDefFind(timerHardware->tim));
+    }
+
+    if (channelSlot >= dshotTimer->slotCount) {
+        dshotTimer->slotCount = channelSlot + 1;
+    }
+
+    motors[motorIndex] = pwmOutConfig(timerHardware, DSHOT_TIMER_MHZ, dshotTiming.bitPeriod, 0);
+    motors[motorIndex]->pwmWritePtr = pwmWriteDshot;
+    motors[motorIndex]->dmaSlot = channelSlot;
+    motors[motorIndex]->dshotTimerIndex = dshotTimer - dshotTimers;
+
+    dshotTimerUpdateBurst(dshotTimer);
+}
+#endif
+
 #ifdef USE_SERVOS
 void pwmServoConfig(const timerHardware_t *timerHardware, uint8_t servoIndex, uint16_t servoPwmRate, uint16_t servoCenterPulse)
 {
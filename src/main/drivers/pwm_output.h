@@ -20,6 +20,8 @@
 void pwmWriteMotor(uint8_t index, uint16_t value);
 void pwmShutdownPulsesForAllMotors(uint8_t motorCount);
 void pwmCompleteOneshotMotorUpdate(uint8_t motorCount);
+void pwmCompleteDshotMotorUpdate(void);
+void pwmDshotSetArmed(bool armed, uint16_t disarmedStopPulse);
 
 void pwmWriteServo(uint8_t index, uint16_t value);
 
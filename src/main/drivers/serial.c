@@ -17,6 +17,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
@@ -58,12 +59,28 @@ void serialWriteBuf(serialPort_t *instance, uint8_t *data, int count)
 
 uint32_t serialRxBytesWaiting(serialPort_t *instance)
 {
-    return instance->vTable->serialTotalRxWaiting(instance);
+    const uint32_t bytesWaiting = instance->vTable->serialTotalRxWaiting(instance);
+
+    if (bytesWaiting > instance->rxBufferHighWater) {
+        instance->rxBufferHighWater = bytesWaiting;
+    }
+
+    return bytesWaiting;
 }
 
-uint8_t serialTxBytesFree(serialPort_t *instance)
+uint32_t serialTxBytesFree(serialPort_t *instance)
 {
-    return instance->vTable->serialTotalTxFree(instance);
+    const uint32_t bytesFree = instance->vTable->serialTotalTxFree(instance);
+
+    // Ports without a TX ring buffer (USB VCP) report a nominal free count, RX only ports have nothing to track
+    if ((instance->mode & MODE_TX) && instance->txBufferSize > bytesFree) {
+        const uint32_t bytesUsed = instance->txBufferSize - 1 - bytesFree;
+        if (bytesUsed > instance->txBufferHighWater) {
+            instance->txBufferHighWater = bytesUsed;
+        }
+    }
+
+    return bytesFree;
 }
 
 uint8_t serialRead(serialPort_t *instance)
@@ -71,6 +88,41 @@ uint8_t serialRead(serialPort_t *instance)
     return instance->vTable->serialRead(instance);
 }
 
+uint32_t serialPeekRx(serialPort_t *instance, const uint8_t **data)
+{
+    const uint32_t count = instance->vTable->peekRx(instance, data);
+
+    if (count) {
+        // the run may stop at the end of the ring buffer, sample the whole occupancy
+        serialRxBytesWaiting(instance);
+    }
+
+    return count;
+}
+
+void serialSkipRx(serialPort_t *instance, uint32_t count)
+{
+    instance->vTable->skipRx(instance, count);
+}
+
+uint32_t serialReadBuf(serialPort_t *instance, uint8_t *data, uint32_t maxCount)
+{
+    uint32_t total = 0;
+    const uint8_t *rxData;
+    uint32_t rxCount;
+
+    while (total < maxCount && (rxCount = serialPeekRx(instance, &rxData)) > 0) {
+        if (rxCount > maxCount - total) {
+            rxCount = maxCount - total;
+        }
+        memcpy(data + total, rxData, rxCount);
+        serialSkipRx(instance, rxCount);
+        total += rxCount;
+    }
+
+    return total;
+}
+
 void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate)
 {
     instance->vTable->serialSetBaudRate(instance, baudRate);
@@ -36,6 +36,14 @@ typedef enum portOptions_t {
 
 typedef void (*serialReceiveCallbackPtr)(uint16_t data);   // used by serial drivers to return frames to app
 
+// RX and TX ring buffers handed to a driver when a port is opened
+typedef struct serialPortBuffers_s {
+    volatile uint8_t *rxBuffer;
+    volatile uint8_t *txBuffer;
+    uint32_t rxBufferSize;
+    uint32_t txBufferSize;
+} serialPortBuffers_t;
+
 typedef struct serialPort_s {
 
     const struct serialPortVTable *vTable;
@@ -55,6 +63,10 @@ typedef struct serialPort_s {
     uint32_t txBufferHead;
     uint32_t txBufferTail;
 
+    // Peak buffer occupancy observed through the serial API
+    uint32_t rxBufferHighWater;
+    uint32_t txBufferHighWater;
+
     // FIXME rename member to rxCallback
     serialReceiveCallbackPtr callback;
 } serialPort_t;
@@ -63,7 +75,7 @@ struct serialPortVTable {
     void (*serialWrite)(serialPort_t *instance, uint8_t ch);
 
     uint32_t (*serialTotalRxWaiting)(serialPort_t *instance);
-    uint8_t (*serialTotalTxFree)(serialPort_t *instance);
+    uint32_t (*serialTotalTxFree)(serialPort_t *instance);
 
     uint8_t (*serialRead)(serialPort_t *instance);
 
@@ -78,13 +90,21 @@ struct serialPortVTable {
     // Optional functions used to buffer large writes.
     void (*beginWrite)(serialPort_t *instance);
     void (*endWrite)(serialPort_t *instance);
+
+    // Bulk read access. peekRx returns the number of received bytes available in one contiguous run starting at *data,
+    // without consuming them. skipRx consumes count bytes previously returned by peekRx.
+    uint32_t (*peekRx)(serialPort_t *instance, const uint8_t **data);
+    void (*skipRx)(serialPort_t *instance, uint32_t count);
 };
 
 void serialWrite(serialPort_t *instance, uint8_t ch);
 uint32_t serialRxBytesWaiting(serialPort_t *instance);
-uint8_t serialTxBytesFree(serialPort_t *instance);
+uint32_t serialTxBytesFree(serialPort_t *instance);
 void serialWriteBuf(serialPort_t *instance, uint8_t *data, int count);
 uint8_t serialRead(serialPort_t *instance);
+uint32_t serialReadBuf(serialPort_t *instance, uint8_t *data, uint32_t maxCount);
+uint32_t serialPeekRx(serialPort_t *instance, const uint8_t **data);
+void serialSkipRx(serialPort_t *instance, uint32_t count);
 void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate);
 void serialSetMode(serialPort_t *instance, portMode_t mode);
 bool isSerialTransmitBufferEmpty(serialPort_t *instance);
@@ -50,10 +50,7 @@ typedef struct softSerial_s {
     IO_t rxIO;
     IO_t txIO;
     const timerHardware_t *rxTimerHardware;
-    volatile uint8_t rxBuffer[SOFTSERIAL_BUFFER_SIZE];
-
     const timerHardware_t *txTimerHardware;
-    volatile uint8_t txBuffer[SOFTSERIAL_BUFFER_SIZE];
 
     uint8_t          isSearchingForStartBit;
     uint8_t          rxBitIndex;
@@ -164,20 +161,23 @@ static void serialTimerRxConfig(const timerHardware_t *timerHardwarePtr, uint8_t
     timerChConfigCallbacks(timerHardwarePtr, &softSerialPorts[reference].edgeCb, NULL);
 }
 
-static void resetBuffers(softSerial_t *softSerial)
+static void resetBuffers(softSerial_t *softSerial, const serialPortBuffers_t *buffers)
 {
-    softSerial->port.rxBufferSize = SOFTSERIAL_BUFFER_SIZE;
-    softSerial->port.rxBuffer = softSerial->rxBuffer;
+    softSerial->port.rxBufferSize = buffers->rxBufferSize;
+    softSerial->port.rxBuffer = buffers->rxBuffer;
     softSerial->port.rxBufferTail = 0;
     softSerial->port.rxBufferHead = 0;
 
-    softSerial->port.txBuffer = softSerial->txBuffer;
-    softSerial->port.txBufferSize = SOFTSERIAL_BUFFER_SIZE;
+    softSerial->port.txBuffer = buffers->txBuffer;
+    softSerial->port.txBufferSize = buffers->txBufferSize;
     softSerial->port.txBufferTail = 0;
     softSerial->port.txBufferHead = 0;
+
+    softSerial->port.rxBufferHighWater = 0;
+    softSerial->port.txBufferHighWater = 0;
 }
 
-serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallbackPtr callback, uint32_t baud, portOptions_t options)
+serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallbackPtr callback, uint32_t baud, portOptions_t options, const serialPortBuffers_t *buffers)
 {
     softSerial_t *softSerial = &(softSerialPorts[portIndex]);
 
@@ -201,7 +201,7 @@ serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallb
     softSerial->port.options = options;
     softSerial->port.callback = callback;
 
-    resetBuffers(softSerial);
+    resetBuffers(softSerial, buffers);
 
     softSerial->isTransmittingData = false;
 
@@ -412,7 +412,7 @@ uint32_t softSerialRxBytesWaiting(serialPort_t *instance)
     return (s->port.rxBufferHead - s->port.rxBufferTail) & (s->port.rxBufferSize - 1);
 }
 
-uint8_t softSerialTxBytesFree(serialPort_t *instance)
+uint32_t softSerialTxBytesFree(serialPort_t *instance)
 {
     if ((instance->mode & MODE_TX) == 0) {
         return 0;
@@ -420,7 +420,7 @@ uint8_t softSerialTxBytesFree(serialPort_t *instance)
 
     softSerial_t *s = (softSerial_t *)instance;
 
-    uint8_t bytesUsed = (s->port.txBufferHead - s->port.txBufferTail) & (s->port.txBufferSize - 1);
+    uint32_t bytesUsed = (s->port.txBufferHead - s->port.txBufferTail) & (s->port.txBufferSize - 1);
 
     return (s->port.txBufferSize - 1) - bytesUsed;
 }
@@ -442,6 +442,23 @@ uint8_t softSerialReadByte(serialPort_t *instance)
     return ch;
 }
 
+uint32_t softSerialPeekRx(serialPort_t *instance, const uint8_t **data)
+{
+    uint32_t count = softSerialRxBytesWaiting(instance);
+
+    if (count > instance->rxBufferSize - instance->rxBufferTail) {
+        count = instance->rxBufferSize - instance->rxBufferTail;
+    }
+
+    *data = (const uint8_t *)&instance->rxBuffer[instance->rxBufferTail];
+    return count;
+}
+
+void softSerialSkipRx(serialPort_t *instance, uint32_t count)
+{
+    instance->rxBufferTail = (instance->rxBufferTail + count) % instance->rxBufferSize;
+}
+
 void softSerialWriteByte(serialPort_t *s, uint8_t ch)
 {
     if ((s->mode & MODE_TX) == 0) {
@@ -455,7 +472,13 @@ void softSerialWriteByte(serialPort_t *s, uint8_t ch)
 void softSerialSetBaudRate(serialPort_t *s, uint32_t baudRate)
 {
     softSerial_t *softSerial = (softSerial_t *)s;
-    openSoftSerial(softSerial->softSerialPortIndex, s->callback, baudRate, softSerial->port.options);
+    const serialPortBuffers_t buffers = {
+        .rxBuffer = s->rxBuffer,
+        .txBuffer = s->txBuffer,
+        .rxBufferSize = s->rxBufferSize,
+        .txBufferSize = s->txBufferSize
+    };
+    openSoftSerial(softSerial->softSerialPortIndex, s->callback, baudRate, softSerial->port.options, &buffers);
 }
 
 void softSerialSetMode(serialPort_t *instance, portMode_t mode)
@@ -480,6 +503,8 @@ const struct serialPortVTable softSerialVTable[] = {
         .writeBuf = NULL,
         .beginWrite = NULL,
         .endWrite = NULL,
+        .peekRx = softSerialPeekRx,
+        .skipRx = softSerialSkipRx,
     }
 };
 
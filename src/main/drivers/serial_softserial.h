@@ -17,20 +17,21 @@
 
 #pragma once
 
-#define SOFTSERIAL_BUFFER_SIZE 256
-
 typedef enum {
     SOFTSERIAL1 = 0,
     SOFTSERIAL2
 } softSerialPortIndex_e;
 
-serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallbackPtr callback, uint32_t baud, portOptions_t options);
+// Buffer sizes must be a power of two
+serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallbackPtr callback, uint32_t baud, portOptions_t options, const serialPortBuffers_t *buffers);
 
 // serialPort API
 void softSerialWriteByte(serialPort_t *instance, uint8_t ch);
 uint32_t softSerialRxBytesWaiting(serialPort_t *instance);
-uint8_t softSerialTxBytesFree(serialPort_t *instance);
+uint32_t softSerialTxBytesFree(serialPort_t *instance);
 uint8_t softSerialReadByte(serialPort_t *instance);
+uint32_t softSerialPeekRx(serialPort_t *instance, const uint8_t **data);
+void softSerialSkipRx(serialPort_t *instance, uint32_t count);
 void softSerialSetBaudRate(serialPort_t *s, uint32_t baudRate);
 bool isSoftSerialTransmitBufferEmpty(serialPort_t *s);
 
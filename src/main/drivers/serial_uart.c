@@ -94,7 +94,7 @@ static void uartReconfigure(uartPort_t *uartPort)
     USART_Cmd(uartPort->USARTx, ENABLE);
 }
 
-serialPort_t *uartOpen(USART_TypeDef *USARTx, serialReceiveCallbackPtr callback, uint32_t baudRate, portMode_t mode, portOptions_t options)
+serialPort_t *uartOpen(USART_TypeDef *USARTx, serialReceiveCallbackPtr callback, uint32_t baudRate, portMode_t mode, portOptions_t options, const serialPortBuffers_t *buffers)
 {
     uartPort_t *s = NULL;
 
@@ -127,8 +127,13 @@ serialPort_t *uartOpen(USART_TypeDef *USARTx, serialReceiveCallbackPtr callback,
     s->txDMAEmpty = true;
 
     // common serial initialisation code should move to serialPort::init()
+    s->port.rxBuffer = buffers->rxBuffer;
+    s->port.txBuffer = buffers->txBuffer;
+    s->port.rxBufferSize = buffers->rxBufferSize;
+    s->port.txBufferSize = buffers->txBufferSize;
     s->port.rxBufferHead = s->port.rxBufferTail = 0;
     s->port.txBufferHead = s->port.txBufferTail = 0;
+    s->port.rxBufferHighWater = s->port.txBufferHighWater = 0;
     // callback works for IRQ-based RX ONLY
     s->port.callback = callback;
     s->port.mode = mode;
@@ -316,7 +321,7 @@ uint32_t uartTotalRxBytesWaiting(serialPort_t *instance)
     }
 }
 
-uint8_t uartTotalTxBytesFree(serialPort_t *instance)
+uint32_t uartTotalTxBytesFree(serialPort_t *instance)
 {
     uartPort_t *s = (uartPort_t*)instance;
 
@@ -397,6 +402,51 @@ uint8_t uartRead(serialPort_t *instance)
     return ch;
 }
 
+uint32_t uartPeekRx(serialPort_t *instance, const uint8_t **data)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    uint32_t readPos;
+
+#ifdef STM32F4
+    if (s->rxDMAStream) {
+#else
+    if (s->rxDMAChannel) {
+#endif
+        readPos = s->port.rxBufferSize - s->rxDMAPos;
+    } else {
+        readPos = s->port.rxBufferTail;
+    }
+
+    // Bytes past the end of the buffer wrap to its start and are returned by the next peek
+    uint32_t count = uartTotalRxBytesWaiting(instance);
+    if (count > s->port.rxBufferSize - readPos) {
+        count = s->port.rxBufferSize - readPos;
+    }
+
+    *data = (const uint8_t *)&s->port.rxBuffer[readPos];
+    return count;
+}
+
+void uartSkipRx(serialPort_t *instance, uint32_t count)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+
+#ifdef STM32F4
+    if (s->rxDMAStream) {
+#else
+    if (s->rxDMAChannel) {
+#endif
+        s->rxDMAPos -= count;
+        if (s->rxDMAPos == 0)
+            s->rxDMAPos = s->port.rxBufferSize;
+    } else {
+        s->port.rxBufferTail += count;
+        if (s->port.rxBufferTail >= s->port.rxBufferSize) {
+            s->port.rxBufferTail = 0;
+        }
+    }
+}
+
 void uartWrite(serialPort_t *instance, uint8_t ch)
 {
     uartPort_t *s = (uartPort_t *)instance;
@@ -432,6 +482,8 @@ const struct serialPortVTable uartVTable[] = {
         .writeBuf = NULL,
         .beginWrite = NULL,
         .endWrite = NULL,
+        .peekRx = uartPeekRx,
+        .skipRx = uartSkipRx,
     }
 };
 
@@ -63,14 +63,18 @@ static bool isUsbVcpTransmitBufferEmpty(serialPort_t *instance)
 
 static uint32_t usbVcpAvailable(serialPort_t *instance)
 {
-    UNUSED(instance);
+    vcpPort_t *port = container_of(instance, vcpPort_t, port);
 
-    return receiveLength;
+    return (port->rxLength - port->rxAt) + receiveLength;
 }
 
 static uint8_t usbVcpRead(serialPort_t *instance)
 {
-    UNUSED(instance);
+    vcpPort_t *port = container_of(instance, vcpPort_t, port);
+
+    if (port->rxAt < port->rxLength) {
+        return port->rxBuf[port->rxAt++];
+    }
 
     uint8_t buf[1];
 
@@ -83,6 +87,25 @@ static uint8_t usbVcpRead(serialPort_t *instance)
     return buf[0];
 }
 
+static uint32_t usbVcpPeekRx(serialPort_t *instance, const uint8_t **data)
+{
+    vcpPort_t *port = container_of(instance, vcpPort_t, port);
+
+    if (port->rxAt >= port->rxLength) {
+        port->rxLength = CDC_Receive_DATA(port->rxBuf, sizeof(port->rxBuf));
+        port->rxAt = 0;
+    }
+
+    *data = &port->rxBuf[port->rxAt];
+    return port->rxLength - port->rxAt;
+}
+
+static void usbVcpSkipRx(serialPort_t *instance, uint32_t count)
+{
+    vcpPort_t *port = container_of(instance, vcpPort_t, port);
+    port->rxAt += count;
+}
+
 static void usbVcpWriteBuf(serialPort_t *instance, void *data, int count)
 {
     UNUSED(instance);
@@ -143,7 +166,7 @@ static void usbVcpBeginWrite(serialPort_t *instance)
     port->buffering = true;
 }
 
-uint8_t usbTxBytesFree()
+uint32_t usbTxBytesFree()
 {
     // Because we block upon transmit and don't buffer bytes, our "buffer" capacity is effectively unlimited.
     return 255;
@@ -167,7 +190,9 @@ static const struct serialPortVTable usbVTable[] = {
         .setMode = usbVcpSetMode,
         .writeBuf = usbVcpWriteBuf,
         .beginWrite = usbVcpBeginWrite,
-        .endWrite = usbVcpEndWrite
+        .endWrite = usbVcpEndWrite,
+        .peekRx = usbVcpPeekRx,
+        .skipRx = usbVcpSkipRx
     }
 };
 
@@ -27,6 +27,11 @@ typedef struct {
     uint8_t txAt;
     // Set if the port is in bulk write mode and can buffer.
     bool buffering;
+
+    // Received bytes staged for bulk reads, one USB packet at a time.
+    uint8_t rxBuf[64];
+    uint8_t rxAt;
+    uint8_t rxLength;
 } vcpPort_t;
 
 serialPort_t *usbVcpOpen(void);
@@ -0,0 +1,83 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common/maths.h"
+
+#include "flight/loop_timing.h"
+
+static uint32_t nominalLooptime;
+static float nominalDt;
+static bool fixedRate;
+static loopTimingStats_t loopTimingStats;
+
+/*
+ * With gyro sync the control loop runs once per gyro sample (or every gyro_sync_denom samples), so the time
+ * between two runs is the gyro sample period however late the scheduler got to the loop.
+ * The control loop then uses the nominal period as its dT and the scheduler jitter is only kept as a statistic.
+ * isFixedRate must only be set when the loop is really triggered by the gyro data ready interrupt.
+ */
+void loopTimingInit(uint32_t looptime, bool isFixedRate)
+{
+    nominalLooptime = looptime;
+    nominalDt = looptime * 1e-6f;
+    fixedRate = isFixedRate;
+
+    loopTimingResetStats();
+}
+
+/*
+ * Returns the dT in seconds for the control loop cycle that took cycleTime us since the last one.
+ * gyroTriggered is false when the cycle was started by the watchdog instead of a gyro sample.
+ */
+float loopTimingUpdate(uint32_t cycleTime, bool gyroTriggered)
+{
+    const int32_t jitter = (int32_t)cycleTime - (int32_t)nominalLooptime;
+
+    loopTimingStats.cycleCount++;
+    loopTimingStats.jitterMinUs = MIN(loopTimingStats.jitterMinUs, jitter);
+    loopTimingStats.jitterMaxUs = MAX(loopTimingStats.jitterMaxUs, jitter);
+
+    // More than half a period late, at least one gyro sample was missed
+    if (jitter > (int32_t)nominalLooptime / 2) {
+        loopTimingStats.overrunCount++;
+    } else if (fixedRate && gyroTriggered) {
+        return nominalDt;
+    }
+
+    return cycleTime * 1e-6f;
+}
+
+bool loopTimingIsFixedRate(void)
+{
+    return fixedRate;
+}
+
+const loopTimingStats_t *loopTimingGetStats(void)
+{
+    return &loopTimingStats;
+}
+
+void loopTimingResetStats(void)
+{
+    memset(&loopTimingStats, 0, sizeof(loopTimingStats));
+    loopTimingStats.jitterMinUs = INT32_MAX;
+    loopTimingStats.jitterMaxUs = INT32_MIN;
+}
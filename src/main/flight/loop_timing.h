@@ -0,0 +1,32 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+typedef struct loopTimingStats_s {
+    uint32_t cycleCount;
+    uint32_t overrunCount;                  // cycles that missed a gyro sample, these run on the measured cycle time
+    int32_t jitterMinUs;                    // cycle time less the nominal period
+    int32_t jitterMaxUs;
+} loopTimingStats_t;
+
+void loopTimingInit(uint32_t looptime, bool isFixedRate);
+float loopTimingUpdate(uint32_t cycleTime, bool gyroTriggered);
+bool loopTimingIsFixedRate(void);
+
+const loopTimingStats_t *loopTimingGetStats(void);
+void loopTimingResetStats(void);
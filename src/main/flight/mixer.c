@@ -46,6 +46,7 @@
 #include "sensors/acceleration.h"
 
 #include "flight/mixer.h"
+#include "flight/motor_latency.h"
 #include "flight/failsafe.h"
 #include "flight/pid.h"
 #include "flight/imu.h"
@@ -63,6 +64,7 @@ int16_t motor[MAX_SUPPORTED_MOTORS];
 int16_t motor_disarmed[MAX_SUPPORTED_MOTORS];
 
 bool motorLimitReached = false;
+uint8_t motorLimitReachedAxes = 0;
 
 static mixerConfig_t *mixerConfig;
 static flight3DConfig_t *flight3DConfig;
@@ -72,6 +74,10 @@ static rxConfig_t *rxConfig;
 static mixerMode_e currentMixerMode;
 static motorMixer_t currentMixer[MAX_SUPPORTED_MOTORS];
 
+// currentMixer with the yaw motor direction folded in, rebuilt when either changes
+static motorMixer_t mixMatrix[MAX_SUPPORTED_MOTORS];
+static int8_t mixMatrixYawDirection;
+
 
 #ifdef USE_SERVOS
 static uint8_t servoRuleCount = 0;
@@ -87,6 +93,29 @@ static uint8_t maxServoIndex;
 static servoParam_t *servoConf;
 static biquadFilter_t servoFitlerState[MAX_SUPPORTED_SERVOS];
 static bool servoFilterIsSet;
+
+/*
+ * A servo rule with everything that only depends on the configuration worked out in advance.
+ * The servo direction is folded into rate and limits, the limits are in output units.
+ */
+typedef struct servoMixerOp_s {
+    uint8_t inputSource;
+    uint8_t target;
+    int8_t rate;
+    uint8_t speed;
+    int16_t min;
+    int16_t max;
+    uint8_t box;
+    int8_t flaperonDirection;               // 0 when the target is not a flaperon
+} servoMixerOp_t;
+
+// currentServoMixer compiled by servoMixerCompileRules(), sorted by input source
+static servoMixerOp_t servoMixerOps[MAX_SERVO_RULES];
+static uint8_t servoMixerOpCount;
+static uint8_t servoMixerInputs[INPUT_SOURCE_COUNT];    // input sources referenced by the ops
+static uint8_t servoMixerInputCount;
+static uint16_t servoFilterMask;                        // servos that are written out
+static int16_t servoMixerOutput[MAX_SERVO_RULES];       // speed limited output per op
 #endif
 
 static const motorMixer_t mixerQuadX[] = {
@@ -353,6 +382,11 @@ void mixerUseConfigs(
     escAndServoConfig = escAndServoConfigToUse;
     mixerConfig = mixerConfigToUse;
     rxConfig = rxConfigToUse;
+
+#ifdef USE_SERVOS
+    // servo limits and directions come from the profile
+    servoMixerCompileRules();
+#endif
 }
 
 #ifdef USE_SERVOS
@@ -465,6 +499,8 @@ void mixerInit(mixerMode_e mixerMode, motorMixer_t *initialCustomMotorMixers, se
         }
 
     }
+
+    servoMixerCompileRules();
 }
 #else
 void mixerInit(mixerMode_e mixerMode, motorMixer_t *initialCustomMixers)
@@ -474,6 +510,27 @@ void mixerInit(mixerMode_e mixerMode, motorMixer_t *initialCustomMixers)
 }
 #endif
 
+static void mixerBuildMatrix(void)
+{
+    for (int i = 0; i < motorCount; i++) {
+        mixMatrix[i] = currentMixer[i];
+        mixMatrix[i].yaw = -mixerConfig->yaw_motor_direction * currentMixer[i].yaw;
+    }
+    mixMatrixYawDirection = mixerConfig->yaw_motor_direction;
+}
+
+static float mixerMatrixAxis(const motorMixer_t *row, int axis)
+{
+    switch (axis) {
+        case ROLL:
+            return row->roll;
+        case PITCH:
+            return row->pitch;
+        default:
+            return row->yaw;
+    }
+}
+
 #ifdef USE_SERVOS
 void mixerUsePWMIOConfiguration(void)
 {
@@ -510,6 +567,7 @@ void mixerUsePWMIOConfiguration(void)
         }
     }
 
+    mixerBuildMatrix();
     mixerResetDisarmedMotors();
 }
 #else
@@ -520,6 +578,7 @@ void mixerUsePWMIOConfiguration(void)
     for (i = 0; i < motorCount; i++) {
         currentMixer[i] = mixerQuadX[i];
     }
+    mixerBuildMatrix();
     mixerResetDisarmedMotors();
 }
 #endif
@@ -554,6 +613,8 @@ void loadCustomServoMixer(void)
         currentServoMixer[i] = customServoMixers[i];
         servoRuleCount++;
     }
+
+    servoMixerCompileRules();
 }
 
 void servoMixerLoadMix(int index, servoMixer_t *customServoMixers)
@@ -653,13 +714,25 @@ void writeMotors(void)
 {
     int i;
 
+#ifdef USE_DSHOT
+    // DShot has a stop command, disarmed motors at their idle value get it, motor test values pass through
+    pwmDshotSetArmed(ARMING_FLAG(ARMED), feature(FEATURE_3D) ? flight3DConfig->neutral3d : escAndServoConfig->mincommand);
+#endif
+
     for (i = 0; i < motorCount; i++)
         pwmWriteMotor(i, motor[i]);
 
+    motorLatencyRecord(MOTOR_LATENCY_MOTOR_WRITE, micros());
 
     if (feature(FEATURE_ONESHOT125)) {
         pwmCompleteOneshotMotorUpdate(motorCount);
     }
+
+#ifdef USE_DSHOT
+    pwmCompleteDshotMotorUpdate();
+#endif
+
+    motorLatencyRecord(MOTOR_LATENCY_MOTOR_UPDATE, micros());
 }
 
 void writeAllMotors(int16_t mc)
@@ -693,25 +766,37 @@ void mixTable(void)
         axisPID[YAW] = constrain(axisPID[YAW], -mixerConfig->yaw_jump_prevention_limit - ABS(rcCommand[YAW]), mixerConfig->yaw_jump_prevention_limit + ABS(rcCommand[YAW]));
     }
 
+    if (mixMatrixYawDirection != mixerConfig->yaw_motor_direction) {
+        mixerBuildMatrix();
+    }
+
     // Initial mixer concept by bdoiron74 reused and optimized for Air Mode
-    int16_t rpyMix[MAX_SUPPORTED_MOTORS];
-    int16_t rpyMixMax = 0; // assumption: symetrical about zero.
-    int16_t rpyMixMin = 0;
+    const float rollPID = axisPID[ROLL];
+    const float pitchPID = axisPID[PITCH];
+    const float yawPID = axisPID[YAW];
+    float rpyMix[MAX_SUPPORTED_MOTORS];
+    float rpyMixMax = 0.0f; // assumption: symetrical about zero.
+    float rpyMixMin = 0.0f;
+    int rpyMixMaxIndex = 0;
+    int rpyMixMinIndex = 0;
 
     // motors for non-servo mixes
     for (i = 0; i < motorCount; i++) {
-        rpyMix[i] =
-            axisPID[PITCH] * currentMixer[i].pitch +
-            axisPID[ROLL] * currentMixer[i].roll +
-            -mixerConfig->yaw_motor_direction * axisPID[YAW] * currentMixer[i].yaw;
+        rpyMix[i] = rollPID * mixMatrix[i].roll + pitchPID * mixMatrix[i].pitch + yawPID * mixMatrix[i].yaw;
 
-        if (rpyMix[i] > rpyMixMax) rpyMixMax = rpyMix[i];
-        if (rpyMix[i] < rpyMixMin) rpyMixMin = rpyMix[i];
+        if (rpyMix[i] > rpyMixMax) {
+            rpyMixMax = rpyMix[i];
+            rpyMixMaxIndex = i;
+        }
+        if (rpyMix[i] < rpyMixMin) {
+            rpyMixMin = rpyMix[i];
+            rpyMixMinIndex = i;
+        }
     }
 
-    int16_t rpyMixRange = rpyMixMax - rpyMixMin;
-    int16_t throttleRange, throttleCommand;
+    int16_t throttleCommand;
     int16_t throttleMin, throttleMax;
+    int16_t motorMin, motorMax;
     static int16_t throttlePrevious = 0;   // Store the last throttle direction for deadband transitions
 
     // Find min and max throttle based on condition.
@@ -733,58 +818,68 @@ void mixTable(void)
             throttleMax = escAndServoConfig->maxthrottle;
             throttleCommand = throttleMin = flight3DConfig->deadband3d_high;
         }
+
+        if (throttlePrevious <= (rxConfig->midrc - flight3DConfig->deadband3d_throttle)) {
+            motorMin = escAndServoConfig->minthrottle;
+            motorMax = flight3DConfig->deadband3d_low;
+        } else {
+            motorMin = flight3DConfig->deadband3d_high;
+            motorMax = escAndServoConfig->maxthrottle;
+        }
     } else {
         throttleCommand = rcCommand[THROTTLE];
         throttleMin = escAndServoConfig->minthrottle;
         throttleMax = escAndServoConfig->maxthrottle;
+        motorMin = escAndServoConfig->minthrottle;
+        motorMax = escAndServoConfig->maxthrottle;
     }
 
-    throttleRange = throttleMax - throttleMin;
+    // Desaturate in units of the available throttle range: 0 is throttleMin, 1 is throttleMax
+    const float throttleRange = MAX(throttleMax - throttleMin, 1);
+    const float rpyMixRange = (rpyMixMax - rpyMixMin) / throttleRange;
+    float rpyScale = 1.0f / throttleRange;
+    float throttleLow, throttleHigh;
 
     #define THROTTLE_CLIPPING_FACTOR    0.33f
-    if (rpyMixRange > throttleRange) {
+    if (rpyMixRange > 1.0f) {
         motorLimitReached = true;
-        float mixReduction = (float)throttleRange / rpyMixRange;
-
-        for (i = 0; i < motorCount; i++) {
-            rpyMix[i] =  mixReduction  * rpyMix[i];
+        rpyScale /= rpyMixRange;
+
+        // An axis is saturated when pushing it further would widen the spread between the highest and lowest motor
+        motorLimitReachedAxes = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            const float spread = mixerMatrixAxis(&mixMatrix[rpyMixMaxIndex], axis) - mixerMatrixAxis(&mixMatrix[rpyMixMinIndex], axis);
+            if (spread * axisPID[axis] > 0.0f) {
+                motorLimitReachedAxes |= (1 << axis);
+            }
         }
 
         // Allow some clipping on edges to soften correction response
-        throttleMin = throttleMin + (throttleRange / 2) - (throttleRange * THROTTLE_CLIPPING_FACTOR / 2);
-        throttleMax = throttleMin + (throttleRange / 2) + (throttleRange * THROTTLE_CLIPPING_FACTOR / 2);
+        throttleLow = 0.5f - THROTTLE_CLIPPING_FACTOR / 2;
+        throttleHigh = throttleLow + 0.5f + THROTTLE_CLIPPING_FACTOR / 2;
     } else {
         motorLimitReached = false;
-        throttleMin = MIN(throttleMin + (rpyMixRange / 2), throttleMin + (throttleRange / 2) - (throttleRange * THROTTLE_CLIPPING_FACTOR / 2));
-        throttleMax = MAX(throttleMax - (rpyMixRange / 2), throttleMin + (throttleRange / 2) + (throttleRange * THROTTLE_CLIPPING_FACTOR / 2));
+        motorLimitReachedAxes = 0;
+        throttleLow = MIN(rpyMixRange / 2, 0.5f - THROTTLE_CLIPPING_FACTOR / 2);
+        throttleHigh = MAX(1.0f - rpyMixRange / 2, throttleLow + 0.5f + THROTTLE_CLIPPING_FACTOR / 2);
     }
 
     // Now add in the desired throttle, but keep in a range that doesn't clip adjusted
     // roll/pitch/yaw. This could move throttle down, but also up for those low throttle flips.
     if (ARMING_FLAG(ARMED)) {
-        bool isFailsafeActive = failsafeIsActive();
+        if (failsafeIsActive()) {
+            motorMin = escAndServoConfig->mincommand;
+            motorMax = escAndServoConfig->maxthrottle;
+        }
+
+        // Motor stop handling
+        const bool motorsStopped = feature(FEATURE_MOTOR_STOP) && !feature(FEATURE_3D) && (rcData[THROTTLE] < rxConfig->mincheck);
 
         for (i = 0; i < motorCount; i++) {
-            motor[i] = rpyMix[i] + constrain(throttleCommand * currentMixer[i].throttle, throttleMin, throttleMax);
-
-            if (isFailsafeActive) {
-                motor[i] = constrain(motor[i], escAndServoConfig->mincommand, escAndServoConfig->maxthrottle);
-            } else if (feature(FEATURE_3D)) {
-                if (throttlePrevious <= (rxConfig->midrc - flight3DConfig->deadband3d_throttle)) {
-                    motor[i] = constrain(motor[i], escAndServoConfig->minthrottle, flight3DConfig->deadband3d_low);
-                } else {
-                    motor[i] = constrain(motor[i], flight3DConfig->deadband3d_high, escAndServoConfig->maxthrottle);
-                }
-            } else {
-                motor[i] = constrain(motor[i], escAndServoConfig->minthrottle, escAndServoConfig->maxthrottle);
-            }
+            const float throttle = constrainf((throttleCommand * mixMatrix[i].throttle - throttleMin) / throttleRange, throttleLow, throttleHigh);
+            const int16_t motorValue = throttleMin + (rpyMix[i] * rpyScale + throttle) * throttleRange;
 
-            // Motor stop handling
-            if (feature(FEATURE_MOTOR_STOP) && ARMING_FLAG(ARMED) && !feature(FEATURE_3D)) {
-                if (((rcData[THROTTLE]) < rxConfig->mincheck)) {
-                    motor[i] = escAndServoConfig->mincommand;
-                }
-            }
+            motor[i] = motorsStopped ? escAndServoConfig->mincommand : constrain(motorValue, motorMin, motorMax);
         }
     } else {
         for (i = 0; i < motorCount; i++) {
@@ -795,88 +890,162 @@ void mixTable(void)
 
 #ifdef USE_SERVOS
 
-void servoMixer(uint16_t flaperon_throw_offset, uint8_t flaperon_throw_inverted)
+/*
+ * Compiles currentServoMixer against the servo configuration, call whenever either changes.
+ */
+void servoMixerCompileRules(void)
 {
-    int16_t input[INPUT_SOURCE_COUNT]; // Range [-500:+500]
-    static int16_t currentOutput[MAX_SERVO_RULES];
-    int i;
+    int i, j;
+    uint16_t inputMask = 0;
 
-    if (FLIGHT_MODE(PASSTHRU_MODE)) {
-        // Direct passthru from RX
-        input[INPUT_STABILIZED_ROLL] = rcCommand[ROLL];
-        input[INPUT_STABILIZED_PITCH] = rcCommand[PITCH];
-        input[INPUT_STABILIZED_YAW] = rcCommand[YAW];
-    } else {
-        // Assisted modes (gyro only or gyro+acc according to AUX configuration in Gui
-        input[INPUT_STABILIZED_ROLL] = axisPID[ROLL];
-        input[INPUT_STABILIZED_PITCH] = axisPID[PITCH];
-        input[INPUT_STABILIZED_YAW] = axisPID[YAW];
+    servoMixerOpCount = 0;
+    servoMixerInputCount = 0;
+    servoFilterMask = 0;
+
+    if (!servoConf) {
+        return;
+    }
+
+    for (i = 0; i < servoRuleCount; i++) {
+        const servoMixer_t *rule = &currentServoMixer[i];
+        servoMixerOp_t op;
 
+        if (rule->targetChannel >= MAX_SUPPORTED_SERVOS || rule->inputSource >= INPUT_SOURCE_COUNT) {
+            continue;
+        }
+
+        uint16_t servo_width = servoConf[rule->targetChannel].max - servoConf[rule->targetChannel].min;
+        int16_t min = rule->min * servo_width / 100 - servo_width / 2;
+        int16_t max = rule->max * servo_width / 100 - servo_width / 2;
+
+        op.inputSource = rule->inputSource;
+        op.target = rule->targetChannel;
+        op.speed = rule->speed;
+        op.box = rule->box;
+        op.flaperonDirection = (op.target == SERVO_FLAPPERON_1 || op.target == SERVO_FLAPPERON_2) ? getFlaperonDirection(op.target) : 0;
+
+        // -constrain(x, min, max) == constrain(-x, -max, -min)
+        if (servoDirection(op.target, op.inputSource) < 0) {
+            op.rate = -rule->rate;
+            op.min = -max;
+            op.max = -min;
+        } else {
+            op.rate = rule->rate;
+            op.min = min;
+            op.max = max;
+        }
+
+        // insertion sort by input source, rules of the same source keep their order
+        for (j = servoMixerOpCount; j > 0 && servoMixerOps[j - 1].inputSource > op.inputSource; j--) {
+            servoMixerOps[j] = servoMixerOps[j - 1];
+        }
+        servoMixerOps[j] = op;
+        servoMixerOpCount++;
+
+        inputMask |= 1 << op.inputSource;
+    }
+
+    for (i = 0; i < INPUT_SOURCE_COUNT; i++) {
+        if (inputMask & (1 << i)) {
+            servoMixerInputs[servoMixerInputCount++] = i;
+        }
+    }
+
+    if (mixerUsesServos) {
+        for (i = minServoIndex; i <= maxServoIndex && i < MAX_SUPPORTED_SERVOS; i++) {
+            servoFilterMask |= 1 << i;
+        }
+    }
+    if (feature(FEATURE_SERVO_TILT)) {
+        servoFilterMask |= (1 << SERVO_GIMBAL_PITCH) | (1 << SERVO_GIMBAL_ROLL);
+    }
+
+    // speed limited outputs start over from the new rules
+    memset(servoMixerOutput, 0, sizeof(servoMixerOutput));
+}
+
+static int16_t servoMixerInput(uint8_t inputSource)
+{
+    switch (inputSource) {
+    case INPUT_STABILIZED_ROLL:
+    case INPUT_STABILIZED_PITCH:
+        // Direct passthru from RX or assisted modes (gyro only or gyro+acc according to AUX configuration in Gui)
+        return FLIGHT_MODE(PASSTHRU_MODE) ? rcCommand[inputSource - INPUT_STABILIZED_ROLL + ROLL] : axisPID[inputSource - INPUT_STABILIZED_ROLL + ROLL];
+
+    case INPUT_STABILIZED_YAW:
+        if (FLIGHT_MODE(PASSTHRU_MODE)) {
+            return rcCommand[YAW];
+        }
         // Reverse yaw servo when inverted in 3D mode
         if (feature(FEATURE_3D) && (rcData[THROTTLE] < rxConfig->midrc)) {
-            input[INPUT_STABILIZED_YAW] *= -1;
+            return -axisPID[YAW];
         }
-    }
+        return axisPID[YAW];
 
-    input[INPUT_GIMBAL_PITCH] = scaleRange(attitude.values.pitch, -1800, 1800, -500, +500);
-    input[INPUT_GIMBAL_ROLL] = scaleRange(attitude.values.roll, -1800, 1800, -500, +500);
+    case INPUT_STABILIZED_THROTTLE:
+        return motor[0] - 1000 - 500;  // Since it derives from rcCommand or mincommand and must be [-500:+500]
 
-    input[INPUT_STABILIZED_THROTTLE] = motor[0] - 1000 - 500;  // Since it derives from rcCommand or mincommand and must be [-500:+500]
+    case INPUT_GIMBAL_PITCH:
+        return scaleRange(attitude.values.pitch, -1800, 1800, -500, +500);
 
-    // center the RC input value around the RC middle value
-    // by subtracting the RC middle value from the RC input value, we get:
-    // data - middle = input
-    // 2000 - 1500 = +500
-    // 1500 - 1500 = 0
-    // 1000 - 1500 = -500
-    input[INPUT_RC_ROLL]     = rcData[ROLL]     - rxConfig->midrc;
-    input[INPUT_RC_PITCH]    = rcData[PITCH]    - rxConfig->midrc;
-    input[INPUT_RC_YAW]      = rcData[YAW]      - rxConfig->midrc;
-    input[INPUT_RC_THROTTLE] = rcData[THROTTLE] - rxConfig->midrc;
-    input[INPUT_RC_AUX1]     = rcData[AUX1]     - rxConfig->midrc;
-    input[INPUT_RC_AUX2]     = rcData[AUX2]     - rxConfig->midrc;
-    input[INPUT_RC_AUX3]     = rcData[AUX3]     - rxConfig->midrc;
-    input[INPUT_RC_AUX4]     = rcData[AUX4]     - rxConfig->midrc;
+    case INPUT_GIMBAL_ROLL:
+        return scaleRange(attitude.values.roll, -1800, 1800, -500, +500);
+
+    default:
+        // center the RC input value around the RC middle value
+        // by subtracting the RC middle value from the RC input value, we get:
+        // data - middle = input
+        // 2000 - 1500 = +500
+        // 1500 - 1500 = 0
+        // 1000 - 1500 = -500
+        return rcData[inputSource - INPUT_RC_ROLL + ROLL] - rxConfig->midrc;
+    }
+}
+
+void servoMixer(uint16_t flaperon_throw_offset, uint8_t flaperon_throw_inverted)
+{
+    int16_t input[INPUT_SOURCE_COUNT]; // Range [-500:+500]
+    int i;
+
+    for (i = 0; i < servoMixerInputCount; i++) {
+        input[servoMixerInputs[i]] = servoMixerInput(servoMixerInputs[i]);
+    }
 
     for (i = 0; i < MAX_SUPPORTED_SERVOS; i++)
         servo[i] = 0;
 
+    /*
+    Flaperon fligh mode
+    */
+    int16_t flaperonOffset = 0;
+    if (FLIGHT_MODE(FLAPERON)) {
+        flaperonOffset = flaperon_throw_inverted == 1 ? -flaperon_throw_offset : flaperon_throw_offset;
+    }
+
     // mix servos according to rules
-    for (i = 0; i < servoRuleCount; i++) {
+    for (i = 0; i < servoMixerOpCount; i++) {
+        const servoMixerOp_t *op = &servoMixerOps[i];
+        int16_t *output = &servoMixerOutput[i];
+
         // consider rule if no box assigned or box is active
-        if (currentServoMixer[i].box == 0 || IS_RC_MODE_ACTIVE(BOXSERVO1 + currentServoMixer[i].box - 1)) {
-            uint8_t target = currentServoMixer[i].targetChannel;
-            uint8_t from = currentServoMixer[i].inputSource;
-            uint16_t servo_width = servoConf[target].max - servoConf[target].min;
-            int16_t min = currentServoMixer[i].min * servo_width / 100 - servo_width / 2;
-            int16_t max = currentServoMixer[i].max * servo_width / 100 - servo_width / 2;
-
-            if (currentServoMixer[i].speed == 0) {
-                currentOutput[i] = input[from];
-            } else {
-                if (currentOutput[i] < input[from]) {
-                    currentOutput[i] = constrain(currentOutput[i] + currentServoMixer[i].speed, currentOutput[i], input[from]);
-                } else if (currentOutput[i] > input[from]) {
-                    currentOutput[i] = constrain(currentOutput[i] - currentServoMixer[i].speed, input[from], currentOutput[i]);
-                }
-            }
+        if (op->box != 0 && !IS_RC_MODE_ACTIVE(BOXSERVO1 + op->box - 1)) {
+            *output = 0;
+            continue;
+        }
 
-            /*
-            Flaperon fligh mode
-            */
-            if (FLIGHT_MODE(FLAPERON) && (target == SERVO_FLAPPERON_1 || target == SERVO_FLAPPERON_2)) {
-                int8_t multiplier = 1;
+        const int16_t in = input[op->inputSource];
 
-                if (flaperon_throw_inverted == 1) {
-                    multiplier = -1;
-                }
-                currentOutput[i] += flaperon_throw_offset * getFlaperonDirection(target) * multiplier;
-            }
-
-            servo[target] += servoDirection(target, from) * constrain(((int32_t)currentOutput[i] * currentServoMixer[i].rate) / 100, min, max);
-        } else {
-            currentOutput[i] = 0;
+        if (op->speed == 0) {
+            *output = in;
+        } else if (*output < in) {
+            *output = constrain(*output + op->speed, *output, in);
+        } else if (*output > in) {
+            *output = constrain(*output - op->speed, in, *output);
         }
+
+        *output += flaperonOffset * op->flaperonDirection;
+
+        servo[op->target] += constrain(((int32_t)*output * op->rate) / 100, op->min, op->max);
     }
 
     for (i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
@@ -925,8 +1094,10 @@ void filterServos(void)
         }
 
         for (servoIdx = 0; servoIdx < MAX_SUPPORTED_SERVOS; servoIdx++) {
-            // Apply servo lowpass filter and do sanity cheching
-            servo[servoIdx] = (int16_t) biquadFilterApply(&servoFitlerState[servoIdx], (float)servo[servoIdx]);
+            // Apply servo lowpass filter to the servos that are written out
+            if (servoFilterMask & (1 << servoIdx)) {
+                servo[servoIdx] = (int16_t) biquadFilterApply(&servoFitlerState[servoIdx], (float)servo[servoIdx]);
+            }
         }
     }
 
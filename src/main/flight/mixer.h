@@ -215,6 +215,7 @@ void filterServos(void);
 extern int16_t motor[MAX_SUPPORTED_MOTORS];
 extern int16_t motor_disarmed[MAX_SUPPORTED_MOTORS];
 extern bool motorLimitReached;
+extern uint8_t motorLimitReachedAxes;      // bit per axis, set when the mixer had to scale down roll, pitch or yaw
 
 struct escAndServoConfig_s;
 struct rxConfig_s;
@@ -234,6 +235,7 @@ void mixerLoadMix(int index, motorMixer_t *customMixers);
 #ifdef USE_SERVOS
 void servoMixerLoadMix(int index, servoMixer_t *customServoMixers);
 void loadCustomServoMixer(void);
+void servoMixerCompileRules(void);
 int servoDirection(int servoIndex, int fromChannel);
 #endif
 void mixerResetDisarmedMotors(void);
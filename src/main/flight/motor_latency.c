@@ -0,0 +1,72 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common/maths.h"
+
+#include "flight/motor_latency.h"
+
+static uint32_t gyroSampleAt;
+static uint8_t motorLatencyNextStage = MOTOR_LATENCY_STAGE_COUNT;
+static uint32_t motorLatency[MOTOR_LATENCY_STAGE_COUNT];
+static motorLatencyStats_t motorLatencyStats;
+
+/*
+ * Starts timing the gyro sample the control loop is about to work on.
+ * With gyro sync this is when data ready was seen, otherwise it is the start of the loop.
+ */
+void motorLatencyGyroSample(uint32_t sampleAt)
+{
+    gyroSampleAt = sampleAt;
+    motorLatencyNextStage = MOTOR_LATENCY_PID;
+}
+
+// Each stage is timed once per gyro sample, in order, the first time it is reached after the sample
+void motorLatencyRecord(motorLatencyStage_e stage, uint32_t currentTime)
+{
+    if (stage != motorLatencyNextStage) {
+        return;
+    }
+
+    const uint32_t latency = currentTime - gyroSampleAt;
+
+    motorLatency[stage] = latency;
+    motorLatencyStats.latencyMaxUs[stage] = MAX(motorLatencyStats.latencyMaxUs[stage], latency);
+    motorLatencyNextStage++;
+
+    if (stage == MOTOR_LATENCY_MOTOR_UPDATE) {
+        motorLatencyStats.cycleCount++;
+    }
+}
+
+uint32_t motorLatencyGet(motorLatencyStage_e stage)
+{
+    return motorLatency[stage];
+}
+
+const motorLatencyStats_t *motorLatencyGetStats(void)
+{
+    return &motorLatencyStats;
+}
+
+void motorLatencyResetStats(void)
+{
+    memset(&motorLatencyStats, 0, sizeof(motorLatencyStats));
+}
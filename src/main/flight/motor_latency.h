@@ -0,0 +1,37 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+typedef enum {
+    MOTOR_LATENCY_PID = 0,                  // gyro sample to the PID controller having run
+    MOTOR_LATENCY_MOTOR_WRITE,              // gyro sample to the last pwmWriteMotor() call
+    MOTOR_LATENCY_MOTOR_UPDATE,             // gyro sample to the oneshot/DShot update being triggered, standard PWM waits for the timer
+    MOTOR_LATENCY_STAGE_COUNT
+} motorLatencyStage_e;
+
+typedef struct motorLatencyStats_s {
+    uint32_t cycleCount;                    // gyro samples that made it to the motor update
+    uint32_t latencyMaxUs[MOTOR_LATENCY_STAGE_COUNT];
+} motorLatencyStats_t;
+
+void motorLatencyGyroSample(uint32_t sampleAt);
+void motorLatencyRecord(motorLatencyStage_e stage, uint32_t currentTime);
+uint32_t motorLatencyGet(motorLatencyStage_e stage);
+
+const motorLatencyStats_t *motorLatencyGetStats(void);
+void motorLatencyResetStats(void);
@@ -1309,7 +1309,7 @@ float navPidApply2(float setpoint, float measurement, float dt, pidController_t
         pid->last_input = measurement;
     }
 
-    newDerivative = pid->param.kD * pt1FilterApply4(&pid->dterm_filter_state, newDerivative, NAV_DTERM_CUT_HZ, dt);
+    newDerivative = pid->param.kD * pt1FilterApplyCached(&pid->dterm_filter_state, newDerivative, NAV_DTERM_CUT_HZ, dt);
 
     /* Pre-calculate output and limit it if actuator is saturating */
     float outVal = newProportional + pid->integrator + newDerivative;
@@ -1325,8 +1325,7 @@ void navPidReset(pidController_t *pid)
 {
     pid->integrator = 0.0f;
     pid->last_input = 0.0f;
-    pid->dterm_filter_state.state = 0.0f;
-    pid->dterm_filter_state.RC = 0.0f;
+    pt1FilterReset(&pid->dterm_filter_state, 0.0f);
 }
 
 void navPidInit(pidController_t *pid, float _kP, float _kI, float _kD)
@@ -1945,6 +1944,12 @@ void resetWaypointList(void)
     }
 }
 
+/* Number of waypoints in a complete mission, 0 while a mission is missing or being uploaded */
+int getWaypointCount(void)
+{
+    return posControl.waypointListValid ? posControl.waypointCount : 0;
+}
+
 static void calcualteAndSetActiveWaypointToLocalPosition(t_fp_vector * pos)
 {
     posControl.activeWaypoint.pos = *pos;
@@ -251,6 +251,7 @@ float getEstimatedActualPosition(int axis);
 void getWaypoint(uint8_t wpNumber, navWaypoint_t * wpData);
 void setWaypoint(uint8_t wpNumber, navWaypoint_t * wpData);
 void resetWaypointList(void);
+int getWaypointCount(void);
 
 /* Geodetic functions */
 typedef enum {
@@ -29,6 +29,7 @@
 #include "common/axis.h"
 #include "common/maths.h"
 #include "common/filter.h"
+#include "common/utils.h"
 
 #include "drivers/sensor.h"
 #include "drivers/accgyro.h"
@@ -58,7 +59,7 @@ typedef struct {
     float gyroRate;
     float rateTarget;
 
-    // Buffer for derivative calculation
+    // Buffer for derivative calculation, holds the gyro rate less the weighted setpoint
 #define PID_GYRO_RATE_BUF_LENGTH 5
     float gyroRateBuf[PID_GYRO_RATE_BUF_LENGTH];
     firFilter_t gyroRateFilter;
@@ -75,17 +76,15 @@ typedef struct {
 
     // Rate filtering
     pt1Filter_t ptermLpfState;
-    pt1Filter_t deltaLpfState;
+    filterBank_t dtermFilter;
 } pidState_t;
 
 extern uint8_t motorCount;
-extern bool motorLimitReached;
+extern uint8_t motorLimitReachedAxes;
 extern float dT;
 
 int16_t magHoldTargetHeading;
 
-// Thrust PID Attenuation factor. 0.0f means fully attenuated, 1.0f no attenuation is applied
-static float tpaFactor;
 int16_t axisPID[FLIGHT_DYNAMICS_INDEX_COUNT];
 
 #ifdef BLACKBOX
@@ -94,6 +93,13 @@ int32_t axisPID_P[FLIGHT_DYNAMICS_INDEX_COUNT], axisPID_I[FLIGHT_DYNAMICS_INDEX_
 
 static pidState_t pidState[FLIGHT_DYNAMICS_INDEX_COUNT];
 
+static const dtermConfig_t *dtermConfig;
+static float dtermSetpointWeight;
+
+// What the D-term filters were generated for
+static uint32_t dtermFilterLooptime;
+static uint8_t dtermFilterLpfHz;
+
 void pidInit(void)
 {
     // Calculate derivative using 5-point noise-robust differentiators without time delay (one-sided or forward filters)
@@ -105,6 +111,14 @@ void pidInit(void)
     }
 }
 
+void pidUseDtermConfig(const dtermConfig_t *dtermConfigToUse)
+{
+    dtermConfig = dtermConfigToUse;
+
+    // Have the next coefficient update regenerate the filters
+    dtermFilterLooptime = 0;
+}
+
 void pidResetErrorAccumulators(void)
 {
     // Reset R/P/Y integrator
@@ -142,7 +156,8 @@ float pidRateToRcCommand(float rateDPS, uint8_t rate)
 
 float pidRcCommandToRate(int16_t stick, uint8_t rate)
 {
-    return scaleRangef((float) stick, (float) -500, (float) 500, (float) -rate, (float) rate) * 10;
+    // [-500;500] to [-rate;rate] in 10dps units
+    return stick * rate * (10.0f / 500.0f);
 }
 
 /*
@@ -156,38 +171,149 @@ FP-PID has been rescaled to match LuxFloat (and MWRewrite) from Cleanflight 1.13
 
 #define KD_ATTENUATION_BREAK        0.25f
 
-void updatePIDCoefficients(const pidProfile_t *pidProfile, const controlRateConfig_t *controlRateConfig, const rxConfig_t *rxConfig)
+// Throttle [1000;2000] in steps of 50, the last point is past the end of the range so it can be interpolated to
+#define THROTTLE_GAIN_LOOKUP_STEP   50
+#define THROTTLE_GAIN_LOOKUP_LENGTH ((PWM_RANGE_MAX - PWM_RANGE_MIN) / THROTTLE_GAIN_LOOKUP_STEP + 2)
+
+// ROLL and PITCH gain multipliers by throttle: TPA on P and D, KD attenuation on D
+static float lookupThrottlePGain[THROTTLE_GAIN_LOOKUP_LENGTH];
+static float lookupThrottleDGain[THROTTLE_GAIN_LOOKUP_LENGTH];
+
+static int16_t antiGravityLastThrottle;
+static uint32_t antiGravityLastUpdateAt;
+static uint32_t antiGravityBoostUntil;
+
+static float tpaFactorAt(const controlRateConfig_t *controlRateConfig, int16_t throttle)
 {
     // TPA should be updated only when TPA is actually set
-    if (controlRateConfig->dynThrPID == 0 || rcData[THROTTLE] < controlRateConfig->tpa_breakpoint) {
-        tpaFactor = 1.0f;
-    } else if (rcData[THROTTLE] < 2000) {
-        tpaFactor = (100 - (uint16_t)controlRateConfig->dynThrPID * (rcData[THROTTLE] - controlRateConfig->tpa_breakpoint) / (2000 - controlRateConfig->tpa_breakpoint)) / 100.0f;
+    if (controlRateConfig->dynThrPID == 0 || throttle < controlRateConfig->tpa_breakpoint) {
+        return 1.0f;
+    } else if (throttle < 2000) {
+        return (100 - (uint16_t)controlRateConfig->dynThrPID * (throttle - controlRateConfig->tpa_breakpoint) / (2000 - controlRateConfig->tpa_breakpoint)) / 100.0f;
     } else {
-        tpaFactor = (100 - controlRateConfig->dynThrPID) / 100.0f;
+        return (100 - controlRateConfig->dynThrPID) / 100.0f;
     }
+}
 
+static float kdAttenuationFactorAt(const rxConfig_t *rxConfig, int16_t throttle)
+{
     // Additional throttle-based KD attenuation (kudos to RS2K & Raceflight)
-    float relThrottle = constrainf( ((float)rcData[THROTTLE] - (float)rxConfig->mincheck) / ((float)rxConfig->maxcheck - (float)rxConfig->mincheck), 0.0f, 1.0f);
-    float kdAttenuationFactor;
+    const float relThrottle = constrainf( ((float)throttle - (float)rxConfig->mincheck) / ((float)rxConfig->maxcheck - (float)rxConfig->mincheck), 0.0f, 1.0f);
 
     if (relThrottle < KD_ATTENUATION_BREAK) {
-        kdAttenuationFactor = constrainf((relThrottle / KD_ATTENUATION_BREAK) + 0.50f, 0.0f, 1.0f);
+        return constrainf((relThrottle / KD_ATTENUATION_BREAK) + 0.50f, 0.0f, 1.0f);
     } else {
-        kdAttenuationFactor = 1.0f;
+        return 1.0f;
+    }
+}
+
+/*
+ * Call whenever TPA or the RX check points change, the gains then only need a table lookup on each RX update.
+ */
+void generateThrottlePIDGains(const controlRateConfig_t *controlRateConfig, const rxConfig_t *rxConfig)
+{
+    for (int i = 0; i < THROTTLE_GAIN_LOOKUP_LENGTH; i++) {
+        const int16_t throttle = PWM_RANGE_MIN + i * THROTTLE_GAIN_LOOKUP_STEP;
+        const float tpaFactor = tpaFactorAt(controlRateConfig, throttle);
+
+        lookupThrottlePGain[i] = tpaFactor;
+        lookupThrottleDGain[i] = tpaFactor * kdAttenuationFactorAt(rxConfig, throttle);
+    }
+}
+
+static float throttleGainLookup(const float *lookup, int16_t throttle)
+{
+    const int32_t offset = constrain(throttle, PWM_RANGE_MIN, PWM_RANGE_MAX) - PWM_RANGE_MIN;
+    const int32_t lookupStep = offset / THROTTLE_GAIN_LOOKUP_STEP;
+
+    return lookup[lookupStep] + (offset - lookupStep * THROTTLE_GAIN_LOOKUP_STEP) * (lookup[lookupStep + 1] - lookup[lookupStep]) / THROTTLE_GAIN_LOOKUP_STEP;
+}
+
+STATIC_UNIT_TESTED float throttlePGain(int16_t throttle)
+{
+    return throttleGainLookup(lookupThrottlePGain, throttle);
+}
+
+STATIC_UNIT_TESTED float throttleDGain(int16_t throttle)
+{
+    return throttleGainLookup(lookupThrottleDGain, throttle);
+}
+
+/*
+ * Anti-gravity: fast throttle moves upset the attitude and the I-term takes long to catch up,
+ * so the I gain is boosted while the throttle moves faster than the threshold and for a while after.
+ */
+STATIC_UNIT_TESTED float antiGravityIGain(const pidProfile_t *pidProfile, int16_t throttle, uint32_t currentTime)
+{
+    const uint32_t throttleDelta = ABS(throttle - antiGravityLastThrottle);
+    const uint32_t timeDelta = currentTime - antiGravityLastUpdateAt;
+
+    antiGravityLastThrottle = throttle;
+    antiGravityLastUpdateAt = currentTime;
+
+    if (pidProfile->anti_gravity_gain <= ANTI_GRAVITY_GAIN_OFF) {
+        return 1.0f;
+    }
+
+    // throttleDelta / timeDelta > threshold / 10ms, in float as the product overflows after a long RX stall
+    if (throttleDelta * 10000.0f > pidProfile->anti_gravity_threshold * (float)timeDelta) {
+        antiGravityBoostUntil = currentTime + ANTI_GRAVITY_HOLD_US;
+    }
+
+    if (cmp32(antiGravityBoostUntil, currentTime) > 0) {
+        return pidProfile->anti_gravity_gain / 10.0f;
+    }
+
+    return 1.0f;
+}
+
+/*
+ * D-term chain: dterm_lpf_hz PT1, dterm_lpf2_hz biquad lowpass and the notch, each stage only when enabled.
+ * The filters run at the nominal loop rate so their coefficients only depend on the settings and the looptime.
+ */
+static void generateDtermFilters(const pidProfile_t *pidProfile)
+{
+    const float refreshDt = targetLooptime * 1e-6f;
+
+    for (int axis = 0; axis < 3; axis++) {
+        filterBank_t *dtermFilter = &pidState[axis].dtermFilter;
+
+        filterBankInit(dtermFilter);
+        filterBankAddPT1(dtermFilter, pidProfile->dterm_lpf_hz, refreshDt);
+
+        if (dtermConfig) {
+            filterBankAddLowpass(dtermFilter, dtermConfig->dterm_lpf2_hz, refreshDt);
+            filterBankAddNotch(dtermFilter, dtermConfig->dterm_notch_hz, dtermConfig->dterm_notch_cutoff, refreshDt);
+        }
     }
 
+    dtermSetpointWeight = dtermConfig ? dtermConfig->dterm_setpoint_weight / 100.0f : 0.0f;
+
+    dtermFilterLooptime = targetLooptime;
+    dtermFilterLpfHz = pidProfile->dterm_lpf_hz;
+}
+
+void updatePIDCoefficients(const pidProfile_t *pidProfile, uint32_t currentTime)
+{
+    if (dtermFilterLooptime != targetLooptime || dtermFilterLpfHz != pidProfile->dterm_lpf_hz) {
+        generateDtermFilters(pidProfile);
+    }
+
+    const float pGain = throttlePGain(rcData[THROTTLE]);
+    const float dGain = throttleDGain(rcData[THROTTLE]);
+    const float iGain = antiGravityIGain(pidProfile, rcData[THROTTLE], currentTime);
+
     // PID coefficients can be update only with THROTTLE and TPA or inflight PID adjustments
-    //TODO: Next step would be to update those only at THROTTLE or inflight adjustments change
     for (int axis = 0; axis < 3; axis++) {
         pidState[axis].kP = pidProfile->P8[axis] / FP_PID_RATE_P_MULTIPLIER;
         pidState[axis].kI = pidProfile->I8[axis] / FP_PID_RATE_I_MULTIPLIER;
         pidState[axis].kD = pidProfile->D8[axis] / FP_PID_RATE_D_MULTIPLIER;
 
-        // Apply TPA to ROLL and PITCH axes
+        // Apply TPA and anti-gravity to ROLL and PITCH axes
         if (axis != FD_YAW) {
-            pidState[axis].kP *= tpaFactor;
-            pidState[axis].kD *= tpaFactor * kdAttenuationFactor;
+            pidState[axis].kP *= pGain;
+            pidState[axis].kI *= iGain;
+            pidState[axis].kD *= dGain;
         }
 
         if ((pidProfile->P8[axis] != 0) && (pidProfile->I8[axis] != 0)) {
@@ -267,7 +393,7 @@ static void pidLevel(const pidProfile_t *pidProfile, const controlRateConfig_t *
     //     response to rapid attitude changes and smoothing out self-leveling reaction
     if (pidProfile->I8[PIDLEVEL]) {
         // I8[PIDLEVEL] is filter cutoff frequency (Hz). Practical values of filtering frequency is 5-10 Hz
-        angleRateTarget = pt1FilterApply4(&pidState->angleFilterState, angleRateTarget, pidProfile->I8[PIDLEVEL], dT);
+        angleRateTarget = pt1FilterApplyCached(&pidState->angleFilterState, angleRateTarget, pidProfile->I8[PIDLEVEL], dT);
     }
 
     // P[LEVEL] defines self-leveling strength (both for ANGLE and HORIZON modes)
@@ -291,7 +417,7 @@ static void pidApplyRateController(const pidProfile_t *pidProfile, pidState_t *p
 
     // Additional P-term LPF on YAW axis
     if (axis == FD_YAW && pidProfile->yaw_lpf_hz) {
-        newPTerm = pt1FilterApply4(&pidState->ptermLpfState, newPTerm, pidProfile->yaw_lpf_hz, dT);
+        newPTerm = pt1FilterApplyCached(&pidState->ptermLpfState, newPTerm, pidProfile->yaw_lpf_hz, dT);
     }
 
     // Calculate new D-term
@@ -300,19 +426,17 @@ static void pidApplyRateController(const pidProfile_t *pidProfile, pidState_t *p
         // optimisation for when D8 is zero, often used by YAW axis
         newDTerm = 0;
     } else {
-        firFilterUpdate(&pidState->gyroRateFilter, pidState->gyroRate);
+        // Setpoint weighting: D acts on the weighted setpoint less the gyro rate, adding some setpoint feed-forward
+        firFilterUpdate(&pidState->gyroRateFilter, pidState->gyroRate - dtermSetpointWeight * pidState->rateTarget);
         newDTerm = firFilterApply(&pidState->gyroRateFilter) * (-pidState->kD / dT);
 
-        // Apply additional lowpass
-        if (pidProfile->dterm_lpf_hz) {
-            newDTerm = pt1FilterApply4(&pidState->deltaLpfState, newDTerm, pidProfile->dterm_lpf_hz, dT);
-        }
+        // Apply the D-term filter chain
+        newDTerm = filterBankApply(&pidState->dtermFilter, newDTerm);
 
         // Additionally constrain D
         newDTerm = constrainf(newDTerm, -300.0f, 300.0f);
     }
 
-    // TODO: Get feedback from mixer on available correction range for each axis
     const float newOutput = newPTerm + newDTerm + pidState->errorGyroIf;
     const float newOutputLimited = constrainf(newOutput, -PID_MAX_OUTPUT, +PID_MAX_OUTPUT);
 
@@ -322,8 +446,8 @@ static void pidApplyRateController(const pidProfile_t *pidProfile, pidState_t *p
 
     pidState->errorGyroIf += (rateError * pidState->kI * antiWindupScaler * dT) + ((newOutputLimited - newOutput) * pidState->kT * dT);
 
-    // Don't grow I-term if motors are at their limit
-    if (STATE(ANTI_WINDUP) || motorLimitReached) {
+    // Don't grow I-term if motors are at their limit on this axis
+    if (STATE(ANTI_WINDUP) || (motorLimitReachedAxes & (1 << axis))) {
         pidState->errorGyroIf = constrainf(pidState->errorGyroIf, -pidState->errorGyroIfLimit, pidState->errorGyroIfLimit);
     } else {
         pidState->errorGyroIfLimit = ABS(pidState->errorGyroIf);
@@ -433,7 +557,7 @@ float pidMagHold(const pidProfile_t *pidProfile)
 
     magHoldRate = error * pidProfile->P8[PIDMAG] / 30;
     magHoldRate = constrainf(magHoldRate, -pidProfile->mag_hold_rate_limit, pidProfile->mag_hold_rate_limit);
-    magHoldRate = pt1FilterApply4(&magHoldRateFilter, magHoldRate, MAG_HOLD_ERROR_LPF_FREQ, dT);
+    magHoldRate = pt1FilterApplyCached(&magHoldRateFilter, magHoldRate, MAG_HOLD_ERROR_LPF_FREQ, dT);
 
     return magHoldRate;
 }
@@ -33,6 +33,12 @@
 #define MAG_HOLD_RATE_LIMIT_MAX 250
 #define MAG_HOLD_RATE_LIMIT_DEFAULT 90
 
+#define ANTI_GRAVITY_GAIN_OFF 10            // I gain multiplier in 1/10
+#define ANTI_GRAVITY_GAIN_MAX 50
+#define ANTI_GRAVITY_THRESHOLD_MIN 2
+#define ANTI_GRAVITY_THRESHOLD_MAX 100
+#define ANTI_GRAVITY_HOLD_US 250000         // I gain stays boosted this long after the last fast throttle move
+
 typedef enum {
     PIDROLL,
     PIDPITCH,
@@ -66,14 +72,26 @@ typedef struct pidProfile_s {
     int16_t max_angle_inclination[ANGLE_INDEX_COUNT];       // Max possible inclination (roll and pitch axis separately
 
     uint8_t mag_hold_rate_limit;            //Maximum rotation rate MAG_HOLD mode can feed to yaw rate PID controller
+    uint8_t anti_gravity_gain;              // ROLL and PITCH I gain multiplier after fast throttle moves, 10 = off
+    uint8_t anti_gravity_threshold;         // throttle change in us per 10ms that boosts the I gain
 } pidProfile_t;
 
+// D-term filtering after the dterm_lpf_hz PT1, and the setpoint weight, shared by all profiles
+typedef struct dtermConfig_s {
+    uint16_t dterm_notch_hz;                // center of the D-term notch filter, 0 = off
+    uint16_t dterm_notch_cutoff;            // lower edge of the D-term notch
+    uint8_t dterm_lpf2_hz;                  // second order D-term lowpass, 0 = off
+    uint8_t dterm_setpoint_weight;          // percent of the rate setpoint the D-term acts on, 0 = D on gyro only
+} dtermConfig_t;
+
 extern int16_t axisPID[];
 extern int32_t axisPID_P[], axisPID_I[], axisPID_D[], axisPID_Setpoint[];
 
 void pidInit(void);
+void pidUseDtermConfig(const dtermConfig_t *dtermConfigToUse);
 void pidResetErrorAccumulators(void);
-void updatePIDCoefficients(const pidProfile_t *pidProfile, const controlRateConfig_t *controlRateConfig, const rxConfig_t *rxConfig);
+void generateThrottlePIDGains(const controlRateConfig_t *controlRateConfig, const rxConfig_t *rxConfig);
+void updatePIDCoefficients(const pidProfile_t *pidProfile, uint32_t currentTime);
 void pidController(const pidProfile_t *pidProfile, const controlRateConfig_t *controlRateConfig, const rxConfig_t *rxConfig);
 
 float pidRateToRcCommand(float rateDPS, uint8_t rate);
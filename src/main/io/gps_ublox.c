@@ -650,11 +650,17 @@ static bool gpsReceiveData(void)
     bool hasNewData = false;
 
     if (gpsState.gpsPort) {
-        while (serialRxBytesWaiting(gpsState.gpsPort) && !hasNewData) {
-            uint8_t newChar = serialRead(gpsState.gpsPort);
-            if (gpsNewFrameUBLOX(newChar)) {
-                hasNewData = true;
+        const uint8_t *rxData;
+        uint32_t rxCount;
+
+        while (!hasNewData && (rxCount = serialPeekRx(gpsState.gpsPort, &rxData)) > 0) {
+            uint32_t i = 0;
+            while (i < rxCount && !hasNewData) {
+                if (gpsNewFrameUBLOX(rxData[i++])) {
+                    hasNewData = true;
+                }
             }
+            serialSkipRx(gpsState.gpsPort, i);
         }
     }
 
@@ -60,7 +60,7 @@
 #define MSP_PROTOCOL_VERSION                0
 
 #define API_VERSION_MAJOR                   1 // increment when major changes are made
-#define API_VERSION_MINOR                   21 // increment when any change is made, reset to zero when major changes are released after changing API_VERSION_MAJOR
+#define API_VERSION_MINOR                   25 // increment when any change is made, reset to zero when major changes are released after changing API_VERSION_MAJOR
 
 #define API_VERSION_LENGTH                  2
 
@@ -102,6 +102,15 @@
 #define MSP_NAME                        10   //out message          Returns user set board name - betaflight
 #define MSP_SET_NAME                    11   //in message           Sets board name - betaflight
 
+// Binary config backup/restore, the blob is the raw master_t so it is only portable between identical firmware builds
+#define MSP_CONFIG_SNAPSHOT             20   //out message          Returns a chunk of the config blob, request: offset
+#define MSP_SET_CONFIG_SNAPSHOT         21   //in message           Writes a chunk of the config blob, in order starting at offset 0
+#define MSP_CONFIG_SNAPSHOT_COMMIT      22   //in message           Checks the CRC of the restored blob, validates and saves it
+
+#define MSP_RX_LATENCY                  23   //out message          Time in us from the end of the last RC frame to the RX task, rcCommand, mixer and motor output, in that order
+#define MSP_RX_STATS                    24   //out message          RC link frame, error and drop counts, frame interval histogram and frame to mixer delay
+#define MSP_MOTOR_LATENCY               25   //out message          Time in us from the gyro sample to the PID controller, motor write and motor update, last and max
+
 
 //
 // MSP commands for Cleanflight original features
@@ -293,63 +293,154 @@ bool isModeActivationConditionPresent(modeActivationCondition_t *modeActivationC
     return false;
 }
 
-bool isRangeActive(uint8_t auxChannelIndex, channelRange_t *range) {
-    if (!IS_RANGE_USABLE(range)) {
-        return false;
+/*
+ * Mode activation conditions and adjustment ranges are indexed by the aux channel they watch, so each RX update only
+ * re-evaluates the ranges on channels that moved to another step. A range covers whole steps, a channel that stays
+ * within its step cannot change the result.
+ */
+typedef struct auxChannelIndex_s {
+    const void *ranges;                                 // config the index was built from
+    uint32_t rangeMaskByChannel[MAX_AUX_CHANNEL_COUNT]; // usable ranges watching each aux channel
+    uint8_t channelStep[MAX_AUX_CHANNEL_COUNT];         // step each channel was last evaluated at
+    uint32_t usedChannelMask;
+    uint32_t activeRangeMask;
+    bool valid;
+} auxChannelIndex_t;
+
+static auxChannelIndex_t modeActivationIndex;
+static auxChannelIndex_t adjustmentRangeIndex;
+
+static uint8_t specifiedConditionCountPerMode[CHECKBOX_ITEM_COUNT];
+static uint8_t validConditionCountPerMode[CHECKBOX_ITEM_COUNT];
+static modeActivationOperator_e indexedModeActivationOperator;
+
+static uint8_t getAuxChannelStep(uint8_t auxChannelIndex)
+{
+    return CHANNEL_VALUE_TO_STEP(constrain(rcData[auxChannelIndex + NON_AUX_CHANNEL_COUNT], CHANNEL_RANGE_MIN, CHANNEL_RANGE_MAX - 1));
+}
+
+static void auxChannelIndexAddRange(auxChannelIndex_t *index, uint8_t rangeIndex, uint8_t auxChannelIndex, const channelRange_t *range)
+{
+    if (!IS_RANGE_USABLE(range) || auxChannelIndex >= MAX_AUX_CHANNEL_COUNT) {
+        return;
     }
+    index->rangeMaskByChannel[auxChannelIndex] |= (1 << rangeIndex);
+    index->usedChannelMask |= (1 << auxChannelIndex);
+}
 
-    uint16_t channelValue = constrain(rcData[auxChannelIndex + NON_AUX_CHANNEL_COUNT], CHANNEL_RANGE_MIN, CHANNEL_RANGE_MAX - 1);
-    return (channelValue >= 900 + (range->startStep * 25) &&
-            channelValue < 900 + (range->endStep * 25));
+// returns the ranges to re-evaluate, all of them straight after the index is (re)built
+static uint32_t auxChannelIndexUpdate(auxChannelIndex_t *index)
+{
+    uint32_t changedRangeMask = 0;
+
+    for (uint8_t auxChannelIndex = 0; auxChannelIndex < MAX_AUX_CHANNEL_COUNT; auxChannelIndex++) {
+        if (!(index->usedChannelMask & (1 << auxChannelIndex))) {
+            continue;
+        }
+
+        const uint8_t step = getAuxChannelStep(auxChannelIndex);
+        if (step != index->channelStep[auxChannelIndex] || !index->valid) {
+            index->channelStep[auxChannelIndex] = step;
+            changedRangeMask |= index->rangeMaskByChannel[auxChannelIndex];
+        }
+    }
+
+    index->valid = true;
+    return changedRangeMask;
 }
 
-void updateActivatedModes(modeActivationCondition_t *modeActivationConditions, modeActivationOperator_e modeActivationOperator)
+static bool isRangeActiveAtStep(const channelRange_t *range, uint8_t step)
 {
-    uint8_t modeIndex;
+    return step >= range->startStep && step < range->endStep;
+}
 
-    // Unfortunately for AND logic it's not enough to simply check if any of the specified channel range conditions are valid for a mode.
-    // We need to count the total number of conditions specified for each mode, and check that all those conditions are currently valid.
+void resetAuxChannelIndexes(void)
+{
+    modeActivationIndex.valid = false;
+    adjustmentRangeIndex.valid = false;
+}
 
-    uint8_t specifiedConditionCountPerMode[CHECKBOX_ITEM_COUNT];
-    uint8_t validConditionCountPerMode[CHECKBOX_ITEM_COUNT];
+static void buildModeActivationIndex(modeActivationCondition_t *modeActivationConditions, modeActivationOperator_e modeActivationOperator)
+{
+    memset(&modeActivationIndex, 0, sizeof(modeActivationIndex));
+    modeActivationIndex.ranges = modeActivationConditions;
+    indexedModeActivationOperator = modeActivationOperator;
 
+    // For AND logic it's not enough to simply check if any of the specified channel range conditions are valid for a mode.
+    // We need to count the total number of conditions specified for each mode, and check that all those conditions are currently valid.
     memset(specifiedConditionCountPerMode, 0, CHECKBOX_ITEM_COUNT);
     memset(validConditionCountPerMode, 0, CHECKBOX_ITEM_COUNT);
 
-    for (modeIndex = 0; modeIndex < MAX_MODE_ACTIVATION_CONDITION_COUNT; modeIndex++) {
-        modeActivationCondition_t *modeActivationCondition = &modeActivationConditions[modeIndex];
+    for (uint8_t conditionIndex = 0; conditionIndex < MAX_MODE_ACTIVATION_CONDITION_COUNT; conditionIndex++) {
+        modeActivationCondition_t *modeActivationCondition = &modeActivationConditions[conditionIndex];
+
+        if (IS_RANGE_USABLE(&modeActivationCondition->range) && modeActivationCondition->auxChannelIndex < MAX_AUX_CHANNEL_COUNT) {
+            specifiedConditionCountPerMode[modeActivationCondition->modeId]++;
+            auxChannelIndexAddRange(&modeActivationIndex, conditionIndex, modeActivationCondition->auxChannelIndex, &modeActivationCondition->range);
+        }
+    }
+
+    // Modes without conditions are never activated
+    rcModeActivationMask = 0;
+}
+
+void updateActivatedModes(modeActivationCondition_t *modeActivationConditions, modeActivationOperator_e modeActivationOperator)
+{
+    if (!modeActivationIndex.valid || modeActivationIndex.ranges != modeActivationConditions || indexedModeActivationOperator != modeActivationOperator) {
+        buildModeActivationIndex(modeActivationConditions, modeActivationOperator);
+    }
+
+    const uint32_t changedConditionMask = auxChannelIndexUpdate(&modeActivationIndex);
+    if (!changedConditionMask) {
+        return;
+    }
+
+    uint32_t changedModeMask = 0;
 
-        // Increment the number of specified conditions for this mode
-        specifiedConditionCountPerMode[modeActivationCondition->modeId]++;
+    for (uint8_t conditionIndex = 0; conditionIndex < MAX_MODE_ACTIVATION_CONDITION_COUNT; conditionIndex++) {
+        if (!(changedConditionMask & (1 << conditionIndex))) {
+            continue;
+        }
+
+        modeActivationCondition_t *modeActivationCondition = &modeActivationConditions[conditionIndex];
+        const uint8_t step = modeActivationIndex.channelStep[modeActivationCondition->auxChannelIndex];
+        const bool isActive = isRangeActiveAtStep(&modeActivationCondition->range, step);
+        const bool wasActive = modeActivationIndex.activeRangeMask & (1 << conditionIndex);
+
+        if (isActive == wasActive) {
+            continue;
+        }
 
-        if (isRangeActive(modeActivationCondition->auxChannelIndex, &modeActivationCondition->range)) {
-            // Increment the number of valid conditions for this mode
+        // Keep the number of valid conditions for this mode up to date
+        if (isActive) {
+            modeActivationIndex.activeRangeMask |= (1 << conditionIndex);
             validConditionCountPerMode[modeActivationCondition->modeId]++;
+        } else {
+            modeActivationIndex.activeRangeMask &= ~(1 << conditionIndex);
+            validConditionCountPerMode[modeActivationCondition->modeId]--;
         }
+        changedModeMask |= (1 << modeActivationCondition->modeId);
     }
 
-    // Disable all modes to begin with
-    rcModeActivationMask = 0;
+    // Now see which of the affected modes should be enabled
+    for (uint8_t modeIndex = 0; modeIndex < CHECKBOX_ITEM_COUNT; modeIndex++) {
+        if (!(changedModeMask & (1 << modeIndex))) {
+            continue;
+        }
 
-    // Now see which modes should be enabled
-    for (modeIndex = 0; modeIndex < CHECKBOX_ITEM_COUNT; modeIndex++) {
-        // only modes with conditions specified are considered
-        if (specifiedConditionCountPerMode[modeIndex] > 0) {
-            // For AND logic, the specified condition count and valid condition count must be the same.
-            // For OR logic, the valid condition count must be greater than zero.
-
-            if (modeActivationOperator == MODE_OPERATOR_AND) {
-                // AND the conditions
-                if (validConditionCountPerMode[modeIndex] == specifiedConditionCountPerMode[modeIndex]) {
-                    ACTIVATE_RC_MODE(modeIndex);
-                }
-            }
-            else {
-                // OR the conditions
-                if (validConditionCountPerMode[modeIndex] > 0) {
-                    ACTIVATE_RC_MODE(modeIndex);
-                }
-            }
+        bool isModeActive;
+        if (modeActivationOperator == MODE_OPERATOR_AND) {
+            // AND the conditions, the specified condition count and valid condition count must be the same
+            isModeActive = validConditionCountPerMode[modeIndex] == specifiedConditionCountPerMode[modeIndex];
+        } else {
+            // OR the conditions, the valid condition count must be greater than zero
+            isModeActive = validConditionCountPerMode[modeIndex] > 0;
+        }
+
+        if (isModeActive) {
+            ACTIVATE_RC_MODE(modeIndex);
+        } else {
+            DEACTIVATE_RC_MODE(modeIndex);
         }
     }
 }
@@ -495,6 +586,7 @@ void applyStepAdjustment(controlRateConfig_t *controlRateConfig, uint8_t adjustm
         case ADJUSTMENT_RC_EXPO:
             newValue = constrain((int)controlRateConfig->rcExpo8 + delta, 0, 100); // FIXME magic numbers repeated in serial_cli.c
             controlRateConfig->rcExpo8 = newValue;
+            generatePitchRollYawCurves(controlRateConfig);
             blackboxLogInflightAdjustmentEvent(ADJUSTMENT_RC_EXPO, newValue);
         break;
         case ADJUSTMENT_THROTTLE_EXPO:
@@ -667,15 +759,35 @@ void processRcAdjustments(controlRateConfig_t *controlRateConfig, rxConfig_t *rx
     }
 }
 
+static void buildAdjustmentRangeIndex(adjustmentRange_t *adjustmentRanges)
+{
+    memset(&adjustmentRangeIndex, 0, sizeof(adjustmentRangeIndex));
+    adjustmentRangeIndex.ranges = adjustmentRanges;
+
+    for (uint8_t rangeIndex = 0; rangeIndex < MAX_ADJUSTMENT_RANGE_COUNT; rangeIndex++) {
+        adjustmentRange_t *adjustmentRange = &adjustmentRanges[rangeIndex];
+        auxChannelIndexAddRange(&adjustmentRangeIndex, rangeIndex, adjustmentRange->auxChannelIndex, &adjustmentRange->range);
+    }
+}
+
+// A range configures its adjustment slot when its channel moves into it, configureAdjustment() keeps the slot as it is after that
 void updateAdjustmentStates(adjustmentRange_t *adjustmentRanges)
 {
-    uint8_t index;
+    if (!adjustmentRangeIndex.valid || adjustmentRangeIndex.ranges != adjustmentRanges) {
+        buildAdjustmentRangeIndex(adjustmentRanges);
+    }
+
+    const uint32_t changedRangeMask = auxChannelIndexUpdate(&adjustmentRangeIndex);
 
-    for (index = 0; index < MAX_ADJUSTMENT_RANGE_COUNT; index++) {
-        adjustmentRange_t *adjustmentRange = &adjustmentRanges[index];
+    for (uint8_t rangeIndex = 0; rangeIndex < MAX_ADJUSTMENT_RANGE_COUNT; rangeIndex++) {
+        if (!(changedRangeMask & (1 << rangeIndex))) {
+            continue;
+        }
 
-        if (isRangeActive(adjustmentRange->auxChannelIndex, &adjustmentRange->range)) {
+        adjustmentRange_t *adjustmentRange = &adjustmentRanges[rangeIndex];
+        const uint8_t step = adjustmentRangeIndex.channelStep[adjustmentRange->auxChannelIndex];
 
+        if (isRangeActiveAtStep(&adjustmentRange->range, step)) {
             const adjustmentConfig_t *adjustmentConfig = &defaultAdjustmentConfigs[adjustmentRange->adjustmentFunction - ADJUSTMENT_FUNCTION_CONFIG_INDEX_OFFSET];
 
             configureAdjustment(adjustmentRange->adjustmentIndex, adjustmentRange->auxSwitchChannelIndex, adjustmentConfig);
@@ -692,6 +804,8 @@ void useRcControlsConfig(modeActivationCondition_t *modeActivationConditions, es
     escAndServoConfig = escAndServoConfigToUse;
     pidProfile = pidProfileToUse;
 
+    resetAuxChannelIndexes();
+
     isUsingSticksToArm = !isModeActivationConditionPresent(modeActivationConditions, BOXARM);
 
 #ifdef NAV
@@ -704,4 +818,7 @@ void useRcControlsConfig(modeActivationCondition_t *modeActivationConditions, es
 void resetAdjustmentStates(void)
 {
     memset(adjustmentStates, 0, sizeof(adjustmentStates));
+
+    // active ranges have to configure their slots again
+    adjustmentRangeIndex.valid = false;
 }
@@ -60,6 +60,7 @@ extern uint32_t rcModeActivationMask;
 
 #define IS_RC_MODE_ACTIVE(modeId) ((1 << (modeId)) & rcModeActivationMask)
 #define ACTIVATE_RC_MODE(modeId) (rcModeActivationMask |= (1 << modeId))
+#define DEACTIVATE_RC_MODE(modeId) (rcModeActivationMask &= ~(1 << modeId))
 
 typedef enum rc_alias {
     ROLL = 0,
@@ -177,6 +178,7 @@ rollPitchStatus_e calculateRollPitchCenterStatus(rxConfig_t *rxConfig);
 void processRcStickPositions(rxConfig_t *rxConfig, throttleStatus_e throttleStatus, bool disarm_kill_switch);
 
 void updateActivatedModes(modeActivationCondition_t *modeActivationConditions, modeActivationOperator_e modeActivationOperator);
+void resetAuxChannelIndexes(void);
 
 
 typedef enum {
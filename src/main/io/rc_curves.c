@@ -17,6 +17,9 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <math.h>
+
+#include "common/maths.h"
 
 #include "rx/rx.h"
 #include "io/rc_controls.h"
@@ -24,10 +27,12 @@
 
 #include "io/rc_curves.h"
 
-#define PITCH_LOOKUP_LENGTH 7
-#define YAW_LOOKUP_LENGTH 7
+// Stick deflection [0;500] in steps of 8, the last point is past the end of the range so it can be interpolated to
+#define RC_LOOKUP_STEP 8
+#define RC_LOOKUP_LENGTH (500 / RC_LOOKUP_STEP + 2)
 #define THROTTLE_LOOKUP_LENGTH 12
 
+static int16_t lookupPitchRollYawRC[3][RC_LOOKUP_LENGTH];   // lookup tables for expo ROLL, PITCH and YAW, positive half
 static int16_t lookupThrottleRC[THROTTLE_LOOKUP_LENGTH];    // lookup table for expo & mid THROTTLE
 int16_t lookupThrottleRCMid;                         // THROTTLE curve mid point
 
@@ -47,10 +52,32 @@ void generateThrottleCurve(controlRateConfig_t *controlRateConfig, escAndServoCo
     }
 }
 
-int16_t rcLookup(int32_t stickDeflection, uint8_t expo)
+static float rcCurve(int32_t stickDeflection, uint8_t expo)
 {
     float tmpf = stickDeflection / 100.0f;
-    return (int16_t)((2500.0f + (float)expo * (tmpf * tmpf - 25.0f)) * tmpf / 25.0f);
+    return (2500.0f + (float)expo * (tmpf * tmpf - 25.0f)) * tmpf / 25.0f;
+}
+
+void generatePitchRollYawCurves(controlRateConfig_t *controlRateConfig)
+{
+    const uint8_t expo[3] = { controlRateConfig->rcExpo8, controlRateConfig->rcExpo8, controlRateConfig->rcYawExpo8 };
+
+    for (int axis = ROLL; axis <= YAW; axis++) {
+        for (int i = 0; i < RC_LOOKUP_LENGTH; i++) {
+            lookupPitchRollYawRC[axis][i] = lrintf(rcCurve(i * RC_LOOKUP_STEP, expo[axis]));
+        }
+    }
+}
+
+// The curves are odd, the tables hold the positive half
+int16_t rcLookup(uint8_t axis, int32_t stickDeflection)
+{
+    const int16_t *lookup = lookupPitchRollYawRC[axis];
+    const int32_t absoluteDeflection = ABS(stickDeflection);
+    const int32_t lookupStep = absoluteDeflection / RC_LOOKUP_STEP;
+    const int16_t value = lookup[lookupStep] + (absoluteDeflection - lookupStep * RC_LOOKUP_STEP) * (lookup[lookupStep + 1] - lookup[lookupStep]) / RC_LOOKUP_STEP;
+
+    return stickDeflection < 0 ? -value : value;
 }
 
 int16_t rcLookupThrottle(int32_t absoluteDeflection)
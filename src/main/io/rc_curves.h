@@ -17,8 +17,9 @@
 
 #pragma once
 
+void generatePitchRollYawCurves(controlRateConfig_t *controlRateConfig);
 void generateThrottleCurve(controlRateConfig_t *controlRateConfig, escAndServoConfig_t *escAndServoConfig);
 
-int16_t rcLookup(int32_t stickDeflection, uint8_t expo);
+int16_t rcLookup(uint8_t axis, int32_t stickDeflection);
 int16_t rcLookupThrottle(int32_t tmp);
 int16_t rcLookupThrottleMid(void);
@@ -0,0 +1,180 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "common/filter.h"
+#include "common/maths.h"
+
+#include "io/rc_smoothing.h"
+
+// roll, pitch, yaw and throttle
+#define RC_SMOOTHING_CHANNEL_COUNT 4
+
+#define RC_SMOOTHING_INTERVAL_MIN_US 1000
+#define RC_SMOOTHING_INTERVAL_MAX_US 100000     // longer gaps are signal loss, not the frame rate
+#define RC_SMOOTHING_INTERVAL_DEFAULT_US 20000
+#define RC_SMOOTHING_INTERVAL_AVERAGE_WEIGHT 0.125f
+
+// Intervals this much longer than the estimate are lost frames, unless enough of them in a row show the link slowed down
+#define RC_SMOOTHING_LONG_INTERVAL_RATIO 1.5f
+#define RC_SMOOTHING_LONG_INTERVALS_TO_RESET 4
+
+// The cutoff is a third of the frame rate, low enough to hide the steps and high enough not to add noticeable delay
+#define RC_SMOOTHING_CUTOFF_FRAME_RATE_RATIO 3.0f
+#define RC_SMOOTHING_CUTOFF_MIN_HZ 5.0f
+#define RC_SMOOTHING_CUTOFF_MAX_HZ 100.0f
+#define RC_SMOOTHING_CUTOFF_CHANGE_HZ 1.0f
+
+// Two PT1 stages in series at the same cutoff are 3dB down at 0.644 of it, so each stage is set higher
+#define RC_SMOOTHING_PT2_STAGE_SCALE 1.553f
+
+static uint32_t lastFrameAt;
+static float frameIntervalUs = RC_SMOOTHING_INTERVAL_DEFAULT_US;
+static uint8_t longIntervalCount;
+static float cutoffHz;
+
+static pt1Filter_t filterStage[RC_SMOOTHING_CHANNEL_COUNT][2];
+static bool filterInitialised;
+
+static float interpolationStart[RC_SMOOTHING_CHANNEL_COUNT];
+static float interpolationOutput[RC_SMOOTHING_CHANNEL_COUNT];
+
+static void updateCutoff(void)
+{
+    const float newCutoffHz = constrainf(1000000.0f / (RC_SMOOTHING_CUTOFF_FRAME_RATE_RATIO * frameIntervalUs), RC_SMOOTHING_CUTOFF_MIN_HZ, RC_SMOOTHING_CUTOFF_MAX_HZ);
+
+    // don't retune for every bit of jitter in the frame timing
+    if (ABS(newCutoffHz - cutoffHz) < RC_SMOOTHING_CUTOFF_CHANGE_HZ) {
+        return;
+    }
+
+    // the filter stages pick up the new cutoff and keep their state
+    cutoffHz = newCutoffHz;
+}
+
+void rcSmoothingInit(uint32_t nominalFrameIntervalUs)
+{
+    frameIntervalUs = nominalFrameIntervalUs ? nominalFrameIntervalUs : RC_SMOOTHING_INTERVAL_DEFAULT_US;
+    longIntervalCount = 0;
+    cutoffHz = 0;
+    filterInitialised = false;
+    updateCutoff();
+}
+
+static void updateFrameInterval(uint32_t frameAt)
+{
+    const uint32_t interval = frameAt - lastFrameAt;
+    lastFrameAt = frameAt;
+
+    if (interval < RC_SMOOTHING_INTERVAL_MIN_US || interval > RC_SMOOTHING_INTERVAL_MAX_US) {
+        return;
+    }
+
+    if (interval > frameIntervalUs * RC_SMOOTHING_LONG_INTERVAL_RATIO) {
+        if (++longIntervalCount < RC_SMOOTHING_LONG_INTERVALS_TO_RESET) {
+            return;
+        }
+        frameIntervalUs = interval;
+    } else {
+        frameIntervalUs += (interval - frameIntervalUs) * RC_SMOOTHING_INTERVAL_AVERAGE_WEIGHT;
+    }
+    longIntervalCount = 0;
+
+    updateCutoff();
+}
+
+static void applyFilter(int16_t *command, float dT)
+{
+    if (!filterInitialised) {
+        for (int channel = 0; channel < RC_SMOOTHING_CHANNEL_COUNT; channel++) {
+            pt1FilterReset(&filterStage[channel][0], command[channel]);
+            pt1FilterReset(&filterStage[channel][1], command[channel]);
+        }
+        filterInitialised = true;
+    }
+
+    const float stageCutoffHz = cutoffHz * RC_SMOOTHING_PT2_STAGE_SCALE;
+
+    for (int channel = 0; channel < RC_SMOOTHING_CHANNEL_COUNT; channel++) {
+        float value = pt1FilterApplyCached(&filterStage[channel][0], command[channel], stageCutoffHz, dT);
+        value = pt1FilterApplyCached(&filterStage[channel][1], value, stageCutoffHz, dT);
+        command[channel] = lrintf(value);
+    }
+}
+
+static void applyInterpolation(int16_t *command, bool isRXDataNew, uint32_t currentTime, float dT)
+{
+    // ramp from where the output is to the new frame, arriving on the last loop before the next frame is expected
+    if (isRXDataNew) {
+        for (int channel = 0; channel < RC_SMOOTHING_CHANNEL_COUNT; channel++) {
+            interpolationStart[channel] = interpolationOutput[channel];
+        }
+    }
+
+    const float progress = constrainf((currentTime - lastFrameAt + dT * 1000000.0f) / frameIntervalUs, 0.0f, 1.0f);
+
+    for (int channel = 0; channel < RC_SMOOTHING_CHANNEL_COUNT; channel++) {
+        interpolationOutput[channel] = interpolationStart[channel] + (command[channel] - interpolationStart[channel]) * progress;
+        command[channel] = lrintf(interpolationOutput[channel]);
+    }
+}
+
+/*
+ * Smooths rcCommand between RX frames. Called every PID loop after rcCommand is calculated, isRXDataNew is set
+ * on the first call after a new frame was processed and frameAt is when that frame ended, so the interval is
+ * measured without the RX task and PID loop scheduling jitter.
+ */
+void rcSmoothingApply(rcSmoothingType_e type, int16_t *command, bool isRXDataNew, uint32_t frameAt, uint32_t currentTime, float dT)
+{
+    if (isRXDataNew) {
+        updateFrameInterval(frameAt);
+    }
+
+    switch (type) {
+    case RC_SMOOTHING_INTERPOLATE:
+        applyInterpolation(command, isRXDataNew, currentTime, dT);
+        filterInitialised = false;
+        break;
+
+    case RC_SMOOTHING_FILTER:
+        applyFilter(command, dT);
+        break;
+
+    default:
+        filterInitialised = false;
+        break;
+    }
+
+    if (type != RC_SMOOTHING_INTERPOLATE) {
+        for (int channel = 0; channel < RC_SMOOTHING_CHANNEL_COUNT; channel++) {
+            interpolationOutput[channel] = command[channel];
+        }
+    }
+}
+
+uint32_t rcSmoothingGetFrameInterval(void)
+{
+    return lrintf(frameIntervalUs);
+}
+
+uint8_t rcSmoothingGetCutoffHz(void)
+{
+    return lrintf(cutoffHz);
+}
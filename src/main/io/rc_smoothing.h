@@ -0,0 +1,30 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+typedef enum {
+    RC_SMOOTHING_OFF = 0,
+    RC_SMOOTHING_INTERPOLATE,               // linear ramp to each new frame over the measured frame interval
+    RC_SMOOTHING_FILTER                     // 2nd order low pass tuned to the measured frame interval
+} rcSmoothingType_e;
+
+void rcSmoothingInit(uint32_t nominalFrameIntervalUs);
+void rcSmoothingApply(rcSmoothingType_e type, int16_t *command, bool isRXDataNew, uint32_t frameAt, uint32_t currentTime, float dT);
+
+uint32_t rcSmoothingGetFrameInterval(void);
+uint8_t rcSmoothingGetCutoffHz(void);
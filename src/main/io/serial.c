@@ -24,6 +24,7 @@
 
 #include "build_config.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "drivers/system.h"
@@ -53,6 +54,41 @@
 static serialConfig_t *serialConfig;
 static serialPortUsage_t serialPortUsageList[SERIAL_PORT_COUNT];
 
+// The RX and TX buffers of all UART and softserial ports are carved from this pool by serialInit()
+#ifndef SERIAL_BUFFER_POOL_SIZE
+#ifdef USE_VCP
+#define SERIAL_BUFFER_POOL_SIZE ((SERIAL_PORT_COUNT - 1) * 512)
+#else
+#define SERIAL_BUFFER_POOL_SIZE (SERIAL_PORT_COUNT * 512)
+#endif
+#endif
+
+#define SERIAL_BUFFER_SIZE_MIN      32
+#define SERIAL_BUFFER_SIZE_MAX      1024
+#define SERIAL_BUFFER_SIZE_DEFAULT  64      // ports without a known function, e.g. serial passthrough
+
+static volatile uint8_t serialBufferPool[SERIAL_BUFFER_POOL_SIZE];
+
+typedef struct serialBufferProfile_s {
+    uint16_t function;
+    uint16_t rxBurstSize;       // largest message received in one go
+    uint16_t txBurstSize;       // largest message queued for transmission in one go
+    uint8_t rxIntervalMs;       // longest time received bytes wait for the task servicing the port, 0 if not streamed
+    uint8_t txIntervalMs;       // same for bytes waiting to be transmitted
+} serialBufferProfile_t;
+
+static const serialBufferProfile_t serialBufferProfiles[] = {
+    { FUNCTION_MSP,                 256, 256, 10, 10 },     // the CLI runs on MSP ports and takes whole lines
+    { FUNCTION_GPS,                 128, 128, 40,  0 },
+    { FUNCTION_TELEMETRY_FRSKY,      32,  64,  0,  4 },
+    { FUNCTION_TELEMETRY_HOTT,       32,  64,  4,  4 },
+    { FUNCTION_TELEMETRY_LTM,        32,  64,  0,  4 },
+    { FUNCTION_TELEMETRY_SMARTPORT,  32,  32,  4,  4 },
+    { FUNCTION_RX_SERIAL,            32,  32,  0,  0 },     // received bytes are handed to a callback
+    { FUNCTION_BLACKBOX,             32, 512,  0, 40 },
+    { FUNCTION_TELEMETRY_MAVLINK,    64, 128,  4,  4 },     // GCS requests, a MISSION_ITEM is 45 bytes
+};
+
 const serialPortIdentifier_e serialPortIdentifiers[SERIAL_PORT_COUNT] = {
 #ifdef USE_VCP
     SERIAL_PORT_USB_VCP,
@@ -101,7 +137,7 @@ baudRate_e lookupBaudRateIndex(uint32_t baudRate)
     return BAUD_AUTO;
 }
 
-static serialPortUsage_t *findSerialPortUsageByIdentifier(serialPortIdentifier_e identifier)
+serialPortUsage_t *findSerialPortUsageByIdentifier(serialPortIdentifier_e identifier)
 {
     uint8_t index;
     for (index = 0; index < SERIAL_PORT_COUNT; index++) {
@@ -255,6 +291,130 @@ bool doesConfigurationUsePort(serialPortIdentifier_e identifier)
     return candidate != NULL && candidate->functionMask;
 }
 
+static uint32_t serialBufferSizeRoundUp(uint32_t size)
+{
+    uint32_t bufferSize = SERIAL_BUFFER_SIZE_MIN;
+
+    while (bufferSize < size && bufferSize < SERIAL_BUFFER_SIZE_MAX) {
+        bufferSize <<= 1;
+    }
+
+    return bufferSize;
+}
+
+static uint32_t serialFunctionBaudRate(const serialPortConfig_t *portConfig, serialPortFunction_e function)
+{
+    uint8_t baudRateIndex;
+
+    switch (function) {
+    case FUNCTION_MSP:
+        baudRateIndex = portConfig->msp_baudrateIndex;
+        break;
+    case FUNCTION_GPS:
+        baudRateIndex = portConfig->gps_baudrateIndex;
+        break;
+    case FUNCTION_BLACKBOX:
+        baudRateIndex = portConfig->blackbox_baudrateIndex;
+        break;
+    case FUNCTION_RX_SERIAL:
+        baudRateIndex = BAUD_AUTO;
+        break;
+    default:
+        baudRateIndex = portConfig->telemetry_baudrateIndex;
+        break;
+    }
+
+    // Protocols that pick their own baud rate run at 115200 or less
+    return baudRateIndex == BAUD_AUTO ? 115200 : baudRates[baudRateIndex];
+}
+
+/*
+ * Each buffer must hold the largest burst the function produces or consumes, and everything the
+ * line can carry between two runs of the task servicing the port, whichever is larger.
+ */
+STATIC_UNIT_TESTED void serialCalculateBufferSizes(const serialPortConfig_t *portConfig, serialPortBuffers_t *buffers)
+{
+    buffers->rxBufferSize = 0;
+    buffers->txBufferSize = 0;
+
+    for (uint8_t i = 0; portConfig && i < ARRAYLEN(serialBufferProfiles); i++) {
+        const serialBufferProfile_t *profile = &serialBufferProfiles[i];
+        if (!(portConfig->functionMask & profile->function)) {
+            continue;
+        }
+
+        const uint32_t bytesPerSecond = serialFunctionBaudRate(portConfig, profile->function) / 10;
+        const uint32_t rxBufferSize = serialBufferSizeRoundUp(MAX(profile->rxBurstSize, bytesPerSecond * profile->rxIntervalMs / 1000));
+        const uint32_t txBufferSize = serialBufferSizeRoundUp(MAX(profile->txBurstSize, bytesPerSecond * profile->txIntervalMs / 1000));
+
+        // Shared ports need to satisfy every function on them
+        buffers->rxBufferSize = MAX(buffers->rxBufferSize, rxBufferSize);
+        buffers->txBufferSize = MAX(buffers->txBufferSize, txBufferSize);
+    }
+
+    if (!buffers->rxBufferSize) {
+        buffers->rxBufferSize = SERIAL_BUFFER_SIZE_DEFAULT;
+        buffers->txBufferSize = SERIAL_BUFFER_SIZE_DEFAULT;
+    }
+}
+
+static bool serialPortNeedsBuffers(serialPortIdentifier_e identifier)
+{
+    return identifier != SERIAL_PORT_NONE && identifier != SERIAL_PORT_USB_VCP;
+}
+
+static void serialAllocateBuffers(void)
+{
+    uint32_t totalSize = 0;
+
+    for (uint8_t index = 0; index < SERIAL_PORT_COUNT; index++) {
+        serialPortUsage_t *usage = &serialPortUsageList[index];
+        if (serialPortNeedsBuffers(usage->identifier)) {
+            serialCalculateBufferSizes(serialFindPortConfiguration(usage->identifier), &usage->buffers);
+            totalSize += usage->buffers.rxBufferSize + usage->buffers.txBufferSize;
+        }
+    }
+
+    // Over budget, halve the largest buffers until everything fits
+    while (totalSize > SERIAL_BUFFER_POOL_SIZE) {
+        uint32_t *largest = NULL;
+        for (uint8_t index = 0; index < SERIAL_PORT_COUNT; index++) {
+            serialPortUsage_t *usage = &serialPortUsageList[index];
+            if (!serialPortNeedsBuffers(usage->identifier)) {
+                continue;
+            }
+            if (!largest || usage->buffers.rxBufferSize > *largest) {
+                largest = &usage->buffers.rxBufferSize;
+            }
+            if (usage->buffers.txBufferSize > *largest) {
+                largest = &usage->buffers.txBufferSize;
+            }
+        }
+        if (!largest || *largest <= SERIAL_BUFFER_SIZE_MIN) {
+            break;
+        }
+        *largest /= 2;
+        totalSize -= *largest;
+    }
+
+    // Still over budget with every buffer at the minimum, ports that do not fit are left without buffers and cannot be opened
+    uint32_t poolOffset = 0;
+    for (uint8_t index = 0; index < SERIAL_PORT_COUNT; index++) {
+        serialPortUsage_t *usage = &serialPortUsageList[index];
+        if (!serialPortNeedsBuffers(usage->identifier)) {
+            continue;
+        }
+        if (poolOffset + usage->buffers.rxBufferSize + usage->buffers.txBufferSize > SERIAL_BUFFER_POOL_SIZE) {
+            memset(&usage->buffers, 0, sizeof(usage->buffers));
+            continue;
+        }
+        usage->buffers.rxBuffer = &serialBufferPool[poolOffset];
+        poolOffset += usage->buffers.rxBufferSize;
+        usage->buffers.txBuffer = &serialBufferPool[poolOffset];
+        poolOffset += usage->buffers.txBufferSize;
+    }
+}
+
 serialPort_t *openSerialPort(
     serialPortIdentifier_e identifier,
     serialPortFunction_e function,
@@ -276,6 +436,11 @@ serialPort_t *openSerialPort(
         return NULL;
     }
 
+    if (serialPortNeedsBuffers(identifier) && !serialPortUsage->buffers.rxBuffer) {
+        // no room left in the buffer pool
+        return NULL;
+    }
+
     serialPort_t *serialPort = NULL;
 
     switch(identifier) {
@@ -286,43 +451,43 @@ serialPort_t *openSerialPort(
 #endif
 #ifdef USE_USART1
     case SERIAL_PORT_USART1:
-        serialPort = uartOpen(USART1, callback, baudRate, mode, options);
+        serialPort = uartOpen(USART1, callback, baudRate, mode, options, &serialPortUsage->buffers);
         break;
 #endif
 #ifdef USE_USART2
     case SERIAL_PORT_USART2:
-        serialPort = uartOpen(USART2, callback, baudRate, mode, options);
+        serialPort = uartOpen(USART2, callback, baudRate, mode, options, &serialPortUsage->buffers);
         break;
 #endif
 #ifdef USE_USART3
     case SERIAL_PORT_USART3:
-        serialPort = uartOpen(USART3, callback, baudRate, mode, options);
+        serialPort = uartOpen(USART3, callback, baudRate, mode, options, &serialPortUsage->buffers);
         break;
 #endif
 #ifdef USE_USART4
     case SERIAL_PORT_USART4:
-        serialPort = uartOpen(USART4, callback, baudRate, mode, options);
+        serialPort = uartOpen(USART4, callback, baudRate, mode, options, &serialPortUsage->buffers);
         break;
 #endif
 #ifdef USE_USART5
     case SERIAL_PORT_USART5:
-        serialPort = uartOpen(USART5, callback, baudRate, mode, options);
+        serialPort = uartOpen(USART5, callback, baudRate, mode, options, &serialPortUsage->buffers);
         break;
 #endif
 #ifdef USE_USART6
     case SERIAL_PORT_USART6:
-        serialPort = uartOpen(USART6, callback, baudRate, mode, options);
+        serialPort = uartOpen(USART6, callback, baudRate, mode, options, &serialPortUsage->buffers);
         break;
 #endif
 #ifdef USE_SOFTSERIAL1
     case SERIAL_PORT_SOFTSERIAL1:
-        serialPort = openSoftSerial(SOFTSERIAL1, callback, baudRate, options);
+        serialPort = openSoftSerial(SOFTSERIAL1, callback, baudRate, options, &serialPortUsage->buffers);
         serialSetMode(serialPort, mode);
         break;
 #endif
 #ifdef USE_SOFTSERIAL2
     case SERIAL_PORT_SOFTSERIAL2:
-        serialPort = openSoftSerial(SOFTSERIAL2, callback, baudRate, options);
+        serialPort = openSoftSerial(SOFTSERIAL2, callback, baudRate, options, &serialPortUsage->buffers);
         serialSetMode(serialPort, mode);
         break;
 #endif
@@ -383,6 +548,8 @@ void serialInit(serialConfig_t *initialSerialConfig, bool softserialEnabled)
             }
         }
     }
+
+    serialAllocateBuffers();
 }
 
 void serialRemovePort(serialPortIdentifier_e identifier)
@@ -44,8 +44,10 @@
 #include "drivers/serial.h"
 #include "drivers/bus_i2c.h"
 #include "drivers/gpio.h"
+#include "drivers/gyro_sync.h"
 #include "drivers/timer.h"
 #include "drivers/pwm_rx.h"
+#include "drivers/pwm_mapping.h"
 #include "drivers/sdcard.h"
 
 #include "drivers/buf_writer.h"
@@ -54,6 +56,7 @@
 #include "io/gps.h"
 #include "io/gimbal.h"
 #include "io/rc_controls.h"
+#include "io/rc_smoothing.h"
 #include "io/serial.h"
 #include "io/ledstrip.h"
 #include "io/flashfs.h"
@@ -76,9 +79,11 @@
 #include "flight/mixer.h"
 #include "flight/navigation_rewrite.h"
 #include "flight/failsafe.h"
+#include "flight/loop_timing.h"
 
 #include "telemetry/telemetry.h"
 #include "telemetry/frsky.h"
+#include "telemetry/mavlink.h"
 
 #include "config/runtime_config.h"
 #include "config/config.h"
@@ -102,9 +107,18 @@ void gpsEnablePassthrough(serialPort_t *gpsPassthroughPort);
 
 static serialPort_t *cliPort;
 static bufWriter_t *cliWriter;
-static uint8_t cliWriteBuffer[sizeof(*cliWriter) + 16];
+// 64 bytes matches the USB full speed packet size, so VCP output goes out in whole packets
+static uint8_t cliWriteBuffer[sizeof(*cliWriter) + 64];
+
+// batch mode, used when pasting a dump back in: no echo or prompt, errors are counted and config is validated at the end
+static bool cliBatchMode = false;
+static bool cliOutputSuppressed = false;
+static uint16_t cliBatchLine;
+static uint16_t cliBatchErrorCount;
+static uint16_t cliBatchFirstErrorLine;
 
 static void cliAux(char *cmdline);
+static void cliBatch(char *cmdline);
 static void cliRxFail(char *cmdline);
 static void cliAdjustmentRange(char *cmdline);
 static void cliMotorMix(char *cmdline);
@@ -133,6 +147,7 @@ static void cliTasks(char *cmdline);
 #endif
 static void cliVersion(char *cmdline);
 static void cliRxRange(char *cmdline);
+static void cliRxStats(char *cmdline);
 static void cliPFlags(char *cmdline);
 
 #ifdef GPS
@@ -254,6 +269,9 @@ typedef struct {
 const clicmd_t cmdTable[] = {
     CLI_COMMAND_DEF("adjrange", "configure adjustment ranges", NULL, cliAdjustmentRange),
     CLI_COMMAND_DEF("aux", "configure modes", NULL, cliAux),
+    CLI_COMMAND_DEF("batch", "start or end a batch of commands",
+        "start\r\n"
+        "\tend", cliBatch),
 #ifdef LED_STRIP
     CLI_COMMAND_DEF("color", "configure colors", NULL, cliColor),
     CLI_COMMAND_DEF("mode_color", "configure mode and special colors", NULL, cliModeColor),
@@ -298,6 +316,7 @@ const clicmd_t cmdTable[] = {
     CLI_COMMAND_DEF("rateprofile", "change rate profile", "[<index>]", cliRateProfile),
     CLI_COMMAND_DEF("rxrange", "configure rx channel ranges", NULL, cliRxRange),
     CLI_COMMAND_DEF("rxfail", "show/set rx failsafe settings", NULL, cliRxFail),
+    CLI_COMMAND_DEF("rxstats", "show/reset rc link statistics", "[reset]", cliRxStats),
     CLI_COMMAND_DEF("save", "save and reboot", NULL, cliSave),
     CLI_COMMAND_DEF("serial", "configure serial ports", NULL, cliSerial),
 #ifdef USE_SERVOS
@@ -432,6 +451,22 @@ static const char * const lookupTableNavRthAltMode[] = {
 };
 #endif
 
+static const char * const lookupTableRcSmoothing[] = {
+    "OFF", "INTERPOLATE", "FILTER"
+};
+
+#ifdef TELEMETRY
+static const char * const lookupTableLtmRates[] = {
+    "AUTO", "FAST", "NORMAL", "MEDIUM", "SLOW"
+};
+#endif
+
+#ifdef USE_DSHOT
+static const char * const lookupTableMotorPwmProtocol[] = {
+    "STANDARD", "DSHOT150", "DSHOT300", "DSHOT600"
+};
+#endif
+
 static const char * const lookupTableAuxOperator[] = {
     "OR", "AND"
 };
@@ -471,6 +506,13 @@ typedef enum {
     TABLE_NAV_RTH_ALT_MODE,
 #endif
     TABLE_AUX_OPERATOR,
+    TABLE_RC_SMOOTHING,
+#ifdef TELEMETRY
+    TABLE_LTM_RATES,
+#endif
+#ifdef USE_DSHOT
+    TABLE_MOTOR_PWM_PROTOCOL,
+#endif
 } lookupTableIndex_e;
 
 static const lookupTableEntry_t lookupTables[] = {
@@ -503,6 +545,13 @@ static const lookupTableEntry_t lookupTables[] = {
     { lookupTableNavRthAltMode, sizeof(lookupTableNavRthAltMode) / sizeof(char *) },
 #endif
     { lookupTableAuxOperator, sizeof(lookupTableAuxOperator) / sizeof(char *) },
+    { lookupTableRcSmoothing, sizeof(lookupTableRcSmoothing) / sizeof(char *) },
+#ifdef TELEMETRY
+    { lookupTableLtmRates, sizeof(lookupTableLtmRates) / sizeof(char *) },
+#endif
+#ifdef USE_DSHOT
+    { lookupTableMotorPwmProtocol, sizeof(lookupTableMotorPwmProtocol) / sizeof(char *) },
+#endif
 };
 
 #define VALUE_TYPE_OFFSET 0
@@ -559,6 +608,9 @@ const clivalue_t valueTable[] = {
     { "i2c_overclock",              VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &masterConfig.i2c_overclock, .config.lookup = { TABLE_OFF_ON }, 0 },
     { "gyro_sync",                  VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &masterConfig.gyroSync, .config.lookup = { TABLE_OFF_ON } },
     { "gyro_sync_denom",            VAR_UINT8  | MASTER_VALUE,  &masterConfig.gyroSyncDenominator, .config.minmax = { 1,  32 } },
+#ifdef USE_MPU_FIFO
+    { "gyro_fifo",                  VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &masterConfig.gyroFifo, .config.lookup = { TABLE_OFF_ON } },
+#endif
 
     { "mid_rc",                     VAR_UINT16 | MASTER_VALUE,  &masterConfig.rxConfig.midrc, .config.minmax = { 1200,  1700 }, 0 },
     { "min_check",                  VAR_UINT16 | MASTER_VALUE,  &masterConfig.rxConfig.mincheck, .config.minmax = { PWM_RANGE_ZERO,  PWM_RANGE_MAX }, 0 },
@@ -566,7 +618,7 @@ const clivalue_t valueTable[] = {
     { "rssi_channel",               VAR_INT8   | MASTER_VALUE,  &masterConfig.rxConfig.rssi_channel, .config.minmax = { 0,  MAX_SUPPORTED_RC_CHANNEL_COUNT }, 0 },
     { "rssi_scale",                 VAR_UINT8  | MASTER_VALUE,  &masterConfig.rxConfig.rssi_scale, .config.minmax = { RSSI_SCALE_MIN,  RSSI_SCALE_MAX }, 0 },
     { "rssi_ppm_invert",            VAR_INT8   | MASTER_VALUE | MODE_LOOKUP,  &masterConfig.rxConfig.rssi_ppm_invert, .config.lookup = { TABLE_OFF_ON }, 0 },
-    { "rc_smoothing",               VAR_INT8   | MASTER_VALUE | MODE_LOOKUP,  &masterConfig.rxConfig.rcSmoothing, .config.lookup = { TABLE_OFF_ON }, 0 },
+    { "rc_smoothing",               VAR_INT8   | MASTER_VALUE | MODE_LOOKUP,  &masterConfig.rxConfig.rcSmoothing, .config.lookup = { TABLE_RC_SMOOTHING }, 0 },
     { "input_filtering_mode",       VAR_INT8   | MASTER_VALUE | MODE_LOOKUP,  &masterConfig.inputFilteringMode, .config.lookup = { TABLE_OFF_ON }, 0 },
 
     { "min_throttle",               VAR_UINT16 | MASTER_VALUE,  &masterConfig.escAndServoConfig.minthrottle, .config.minmax = { PWM_RANGE_ZERO,  PWM_RANGE_MAX }, 0 },
@@ -582,6 +634,9 @@ const clivalue_t valueTable[] = {
     { "3d_deadband_throttle",       VAR_UINT16 | MASTER_VALUE,  &masterConfig.flight3DConfig.deadband3d_throttle, .config.minmax = { PWM_RANGE_ZERO,  PWM_RANGE_MAX }, 0 },
 
     { "motor_pwm_rate",             VAR_UINT16 | MASTER_VALUE,  &masterConfig.motor_pwm_rate, .config.minmax = { 50,  32000 }, 0 },
+#ifdef USE_DSHOT
+    { "motor_pwm_protocol",         VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &masterConfig.motor_pwm_protocol, .config.lookup = { TABLE_MOTOR_PWM_PROTOCOL }, 0 },
+#endif
 #ifdef USE_SERVOS
     { "servo_pwm_rate",             VAR_UINT16 | MASTER_VALUE,  &masterConfig.servo_pwm_rate, .config.minmax = { 50,  498 }, 0 },
 #endif
@@ -693,6 +748,12 @@ const clivalue_t valueTable[] = {
     { "frsky_unit",                 VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &masterConfig.telemetryConfig.frsky_unit, .config.lookup = { TABLE_UNIT }, 0 },
     { "frsky_vfas_precision",       VAR_UINT8  | MASTER_VALUE,  &masterConfig.telemetryConfig.frsky_vfas_precision, .config.minmax = { FRSKY_VFAS_PRECISION_LOW,  FRSKY_VFAS_PRECISION_HIGH }, 0 },
     { "hott_alarm_sound_interval",  VAR_UINT8  | MASTER_VALUE,  &masterConfig.telemetryConfig.hottAlarmSoundInterval, .config.minmax = { 0,  120 }, 0 },
+    { "mavlink_ext_status_rate",    VAR_UINT8  | MASTER_VALUE,  &masterConfig.telemetryConfig.mavlink_ext_status_rate, .config.minmax = { 0,  TELEMETRY_MAVLINK_MAXRATE }, 0 },
+    { "mavlink_rc_chan_rate",       VAR_UINT8  | MASTER_VALUE,  &masterConfig.telemetryConfig.mavlink_rc_chan_rate, .config.minmax = { 0,  TELEMETRY_MAVLINK_MAXRATE }, 0 },
+    { "mavlink_pos_rate",           VAR_UINT8  | MASTER_VALUE,  &masterConfig.telemetryConfig.mavlink_pos_rate, .config.minmax = { 0,  TELEMETRY_MAVLINK_MAXRATE }, 0 },
+    { "mavlink_extra1_rate",        VAR_UINT8  | MASTER_VALUE,  &masterConfig.telemetryConfig.mavlink_extra1_rate, .config.minmax = { 0,  TELEMETRY_MAVLINK_MAXRATE }, 0 },
+    { "mavlink_extra2_rate",        VAR_UINT8  | MASTER_VALUE,  &masterConfig.telemetryConfig.mavlink_extra2_rate, .config.minmax = { 0,  TELEMETRY_MAVLINK_MAXRATE }, 0 },
+    { "ltm_update_rate",            VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &masterConfig.telemetryConfig.ltmUpdateRate, .config.lookup = { TABLE_LTM_RATES }, 0 },
 #endif
 
     { "battery_capacity",           VAR_UINT16 | MASTER_VALUE,  &masterConfig.batteryConfig.batteryCapacity, .config.minmax = { 0,  20000 }, 0 },
@@ -806,11 +867,19 @@ const clivalue_t valueTable[] = {
     { "dterm_lpf_hz",               VAR_UINT8  | PROFILE_VALUE, &masterConfig.profile[0].pidProfile.dterm_lpf_hz, .config.minmax = {0, 200 } },
     { "yaw_lpf_hz",                 VAR_UINT8  | PROFILE_VALUE, &masterConfig.profile[0].pidProfile.yaw_lpf_hz, .config.minmax = {0, 200 } },
 
+    { "dterm_lpf2_hz",              VAR_UINT8  | MASTER_VALUE,  &masterConfig.dtermConfig.dterm_lpf2_hz, .config.minmax = { 0,  200 }, 0 },
+    { "dterm_notch_hz",             VAR_UINT16 | MASTER_VALUE,  &masterConfig.dtermConfig.dterm_notch_hz, .config.minmax = { 0,  500 }, 0 },
+    { "dterm_notch_cutoff",         VAR_UINT16 | MASTER_VALUE,  &masterConfig.dtermConfig.dterm_notch_cutoff, .config.minmax = { 1,  500 }, 0 },
+    { "dterm_setpoint_weight",      VAR_UINT8  | MASTER_VALUE,  &masterConfig.dtermConfig.dterm_setpoint_weight, .config.minmax = { 0,  200 }, 0 },
+
     { "yaw_p_limit",                VAR_UINT16 | PROFILE_VALUE, &masterConfig.profile[0].pidProfile.yaw_p_limit, .config.minmax = { YAW_P_LIMIT_MIN,  YAW_P_LIMIT_MAX }, 0 },
 
     { "iterm_ignore_threshold",     VAR_UINT16 | PROFILE_VALUE, &masterConfig.profile[0].pidProfile.rollPitchItermIgnoreRate, .config.minmax = {15, 1000 } },
     { "yaw_iterm_ignore_threshold", VAR_UINT16 | PROFILE_VALUE, &masterConfig.profile[0].pidProfile.yawItermIgnoreRate, .config.minmax = {15, 1000 } },
 
+    { "anti_gravity_gain",          VAR_UINT8  | PROFILE_VALUE, &masterConfig.profile[0].pidProfile.anti_gravity_gain, .config.minmax = { ANTI_GRAVITY_GAIN_OFF,  ANTI_GRAVITY_GAIN_MAX }, 0 },
+    { "anti_gravity_threshold",     VAR_UINT8  | PROFILE_VALUE, &masterConfig.profile[0].pidProfile.anti_gravity_threshold, .config.minmax = { ANTI_GRAVITY_THRESHOLD_MIN,  ANTI_GRAVITY_THRESHOLD_MAX }, 0 },
+
 #ifdef BLACKBOX
     { "blackbox_rate_num",          VAR_UINT8  | MASTER_VALUE,  &masterConfig.blackbox_rate_num, .config.minmax = { 1,  32 }, 0 },
     { "blackbox_rate_denom",        VAR_UINT8  | MASTER_VALUE,  &masterConfig.blackbox_rate_denom, .config.minmax = { 1,  32 }, 0 },
@@ -837,6 +906,10 @@ const clivalue_t valueTable[] = {
 
 #define VALUE_COUNT (sizeof(valueTable) / sizeof(clivalue_t))
 
+// valueTable indexes sorted by name, built on first entry to the CLI so 'set' can use a binary search
+static uint16_t valueTableSortedIndex[VALUE_COUNT];
+static bool valueTableSorted = false;
+
 
 typedef union {
     int32_t int_value;
@@ -849,21 +922,64 @@ static void cliPrintVarRange(const clivalue_t *var);
 static void cliPrint(const char *str);
 static void cliPrintf(const char *fmt, ...);
 static void cliWrite(uint8_t ch);
+static void cliPutp(void *p, char ch);
+static void cliSortValueTable(void);
 
 static void cliPrompt(void)
 {
+    if (cliBatchMode) {
+        return;
+    }
+
     cliPrint("\r\n# ");
     bufWriterFlush(cliWriter);
 }
 
+/*
+ * Errors are printed between cliStartError() and cliEndError(). In batch mode normal output is suppressed,
+ * so errors are still shown, prefixed with the line number within the batch.
+ */
+static void cliStartError(void)
+{
+    if (!cliBatchMode) {
+        return;
+    }
+
+    if (cliBatchErrorCount == 0) {
+        cliBatchFirstErrorLine = cliBatchLine;
+    }
+    cliBatchErrorCount++;
+
+    cliOutputSuppressed = false;
+    cliPrintf("line %d: ", cliBatchLine);
+}
+
+static void cliEndError(void)
+{
+    cliOutputSuppressed = cliBatchMode;
+}
+
+static void cliPrintErrorf(const char *fmt, ...)
+{
+    va_list va;
+
+    cliStartError();
+
+    va_start(va, fmt);
+    tfp_format(cliWriter, cliPutp, fmt, va);
+    va_end(va);
+
+    cliEndError();
+}
+
 static void cliShowParseError(void)
 {
-    cliPrint("Parse error\r\n");
+    cliPrintErrorf("Parse error\r\n");
 }
 
 static void cliShowArgumentRangeError(char *name, int min, int max)
 {
-    cliPrintf("%s must be between %d and %d\r\n", name, min, max);
+    cliPrintErrorf("%s must be between %d and %d\r\n", name, min, max);
 }
 
 static char *processChannelRangeArgs(char *ptr, channelRange_t *range, uint8_t *validArgumentCount)
@@ -942,7 +1058,7 @@ static void cliRxFail(char *cmdline)
                     value = atoi(++ptr);
                     value = CHANNEL_VALUE_TO_RXFAIL_STEP(value);
                     if (value > MAX_RXFAIL_RANGE_STEP) {
-                        cliPrint("Value out of range\r\n");
+                        cliPrintErrorf("Value out of range\r\n");
                         return;
                     }
 
@@ -1024,6 +1140,7 @@ static void cliAux(char *cmdline)
             if (validArgumentCount != 4) {
                 memset(mac, 0, sizeof(modeActivationCondition_t));
             }
+            resetAuxChannelIndexes();
         } else {
             cliShowArgumentRangeError("index", 0, MAX_MODE_ACTIVATION_CONDITION_COUNT - 1);
         }
@@ -1193,6 +1310,7 @@ static void cliAdjustmentRange(char *cmdline)
                 memset(ar, 0, sizeof(adjustmentRange_t));
                 cliShowParseError();
             }
+            resetAuxChannelIndexes();
         } else {
             cliShowArgumentRangeError("index", 0, MAX_ADJUSTMENT_RANGE_COUNT - 1);
         }
@@ -1233,7 +1351,7 @@ static void cliMotorMix(char *cmdline)
             len = strlen(++ptr);
             for (i = 0; ; i++) {
                 if (mixerNames[i] == NULL) {
-                    cliPrint("Invalid name\r\n");
+                    cliPrintErrorf("Invalid name\r\n");
                     break;
                 }
                 if (strncasecmp(ptr, mixerNames[i], len) == 0) {
@@ -1325,6 +1443,31 @@ static void cliRxRange(char *cmdline)
     }
 }
 
+static void cliRxStats(char *cmdline)
+{
+    if (strcasecmp(cmdline, "reset") == 0) {
+        rxResetStats();
+        return;
+    }
+
+#ifdef SERIAL_RX
+    if (feature(FEATURE_RX_SERIAL) && masterConfig.rxConfig.serialrx_provider < ARRAYLEN(lookupTableSerialRX)) {
+        cliPrintf("Provider: %s\r\n", lookupTableSerialRX[masterConfig.rxConfig.serialrx_provider]);
+    }
+#endif
+
+    const rxStats_t *rxStats = rxGetStats();
+    cliPrintf("Frames: %d, errors: %d, dropped: %d\r\n", rxStats->frameCount, rxStats->errorCount, rxStats->droppedCount);
+    cliPrintf("Frame to mixer: %dus, max %dus\r\n", rxStats->frameToMixerUs, rxStats->frameToMixerMaxUs);
+    cliPrintf("Measured frame interval: %dus, RC smoothing cutoff: %dHz\r\n", rcSmoothingGetFrameInterval(), rcSmoothingGetCutoffHz());
+
+    cliPrint("Frame interval:");
+    for (int i = 0; i < RX_INTERVAL_HISTOGRAM_BUCKET_COUNT - 1; i++) {
+        cliPrintf(" <%dms %d", rxIntervalHistogramLimitsMs[i], rxStats->intervalHistogram[i]);
+    }
+    cliPrintf(" >=%dms %d\r\n", rxIntervalHistogramLimitsMs[RX_INTERVAL_HISTOGRAM_BUCKET_COUNT - 2], rxStats->intervalHistogram[RX_INTERVAL_HISTOGRAM_BUCKET_COUNT - 1]);
+}
+
 #ifdef LED_STRIP
 static void cliLed(char *cmdline)
 {
@@ -1509,6 +1652,7 @@ static void cliServo(char *cmdline)
         servo->angleAtMax = arguments[5];
         servo->rate = arguments[6];
         servo->forwardFromChannel = arguments[7];
+        servoMixerCompileRules();
     }
 }
 #endif
@@ -1549,13 +1693,14 @@ static void cliServoMix(char *cmdline)
         for (i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
             currentProfile->servoConf[i].reversedSources = 0;
         }
+        servoMixerCompileRules();
     } else if (strncasecmp(cmdline, "load", 4) == 0) {
         ptr = strchr(cmdline, ' ');
         if (ptr) {
             len = strlen(++ptr);
             for (i = 0; ; i++) {
                 if (mixerNames[i] == NULL) {
-                    cliPrintf("Invalid name\r\n");
+                    cliPrintErrorf("Invalid name\r\n");
                     break;
                 }
                 if (strncasecmp(ptr, mixerNames[i], len) == 0) {
@@ -1605,6 +1750,7 @@ static void cliServoMix(char *cmdline)
                 currentProfile->servoConf[args[SERVO]].reversedSources |= 1 << args[INPUT];
             else
                 currentProfile->servoConf[args[SERVO]].reversedSources &= ~(1 << args[INPUT]);
+            servoMixerCompileRules();
         } else
             cliShowParseError();
 
@@ -2030,6 +2176,7 @@ void cliEnter(serialPort_t *serialPort)
     setPrintfSerialPort(cliPort);
     cliWriter = bufWriterInit(cliWriteBuffer, sizeof(cliWriteBuffer),
                               (bufWrite_t)serialWriteBufShim, serialPort);
+    cliSortValueTable();
 
     cliPrint("\r\nEntering CLI Mode, type 'exit' to return, or 'help'\r\n");
     cliPrompt();
@@ -2040,6 +2187,9 @@ static void cliExit(char *cmdline)
 {
     UNUSED(cmdline);
 
+    cliBatchMode = false;
+    cliOutputSuppressed = false;
+
     cliPrint("\r\nLeaving CLI mode, unsaved changes lost.\r\n");
     bufWriterFlush(cliWriter);
 
@@ -2091,7 +2241,7 @@ static void cliFeature(char *cmdline)
 
         for (i = 0; ; i++) {
             if (featureNames[i] == NULL) {
-                cliPrint("Invalid name\r\n");
+                cliPrintErrorf("Invalid name\r\n");
                 break;
             }
 
@@ -2160,7 +2310,7 @@ static void cliBeeper(char *cmdline)
 
         for (i = 0; ; i++) {
             if (i == beeperCount) {
-                cliPrint("Invalid name\r\n");
+                cliPrintErrorf("Invalid name\r\n");
                 break;
             }
             if (strncasecmp(cmdline, beeperNameForTableIndex(i), len) == 0) {
@@ -2277,7 +2427,7 @@ static void cliMixer(char *cmdline)
 
     for (i = 0; ; i++) {
         if (mixerNames[i] == NULL) {
-            cliPrint("Invalid name\r\n");
+            cliPrintErrorf("Invalid name\r\n");
             return;
         }
         if (strncasecmp(cmdline, mixerNames[i], len) == 0) {
@@ -2352,7 +2502,7 @@ static void cliPlaySound(char *cmdline)
                 if ((name=beeperNameForTableIndex(i)) != NULL)
                     break;   //if name OK then play sound below
                 if (i == lastSoundIdx + 1) {     //prevent infinite loop
-                    cliPrintf("Error playing sound\r\n");
+                    cliPrintErrorf("Error playing sound\r\n");
                     return;
                 }
             }
@@ -2414,10 +2564,63 @@ static void cliReboot(void) {
     systemReset();
 }
 
+static void cliBatchStart(void)
+{
+    cliPrint("Batch started, output suppressed until 'batch end'\r\n");
+    bufWriterFlush(cliWriter);
+
+    cliBatchMode = true;
+    cliOutputSuppressed = true;
+    cliBatchLine = 0;
+    cliBatchErrorCount = 0;
+    cliBatchFirstErrorLine = 0;
+}
+
+// Returns true if the batch completed without errors
+static bool cliBatchEnd(void)
+{
+    cliBatchMode = false;
+    cliOutputSuppressed = false;
+
+    // settings were applied one at a time without cross checks, fix up any conflicts now the whole batch is in
+    validateAndFixConfig();
+
+    if (cliBatchErrorCount) {
+        cliPrintf("Batch ended, %d lines, %d errors, first error at line %d\r\n", cliBatchLine, cliBatchErrorCount, cliBatchFirstErrorLine);
+    } else {
+        cliPrintf("Batch ended, %d lines, no errors\r\n", cliBatchLine);
+    }
+
+    return cliBatchErrorCount == 0;
+}
+
+static void cliBatch(char *cmdline)
+{
+    if (strncasecmp(cmdline, "start", 5) == 0) {
+        if (!cliBatchMode) {
+            cliBatchStart();
+        }
+    } else if (strncasecmp(cmdline, "end", 3) == 0) {
+        if (cliBatchMode) {
+            cliBatchEnd();
+        } else {
+            cliPrint("No batch in progress\r\n");
+        }
+    } else {
+        cliShowParseError();
+    }
+}
+
 static void cliSave(char *cmdline)
 {
     UNUSED(cmdline);
 
+    // a dump restore ends with 'save', refuse to store a config that only partially applied
+    if (cliBatchMode && !cliBatchEnd()) {
+        cliPrint("Not saving, fix the errors and try again\r\n");
+        return;
+    }
+
     cliPrint("Saving");
     //copyCurrentProfileToProfileSlot(masterConfig.current_profile_index);
     writeEEPROM();
@@ -2436,12 +2639,13 @@ static void cliDefaults(char *cmdline)
 static void cliPrint(const char *str)
 {
     while (*str)
-        bufWriterAppend(cliWriter, *str++);
+        cliWrite(*str++);
 }
 
 static void cliPutp(void *p, char ch)
 {
-    bufWriterAppend(p, ch);
+    UNUSED(p);
+    cliWrite(ch);
 }
 
 static void cliPrintf(const char *fmt, ...)
@@ -2454,21 +2658,30 @@ static void cliPrintf(const char *fmt, ...)
 
 static void cliWrite(uint8_t ch)
 {
-    bufWriterAppend(cliWriter, ch);
+    if (!cliOutputSuppressed) {
+        bufWriterAppend(cliWriter, ch);
+    }
 }
 
-static void cliPrintVar(const clivalue_t *var, uint32_t full)
+// Profile and rate profile settings point into the first profile, offset them to the current one
+static void *cliGetValuePointer(const clivalue_t *var)
 {
-    int32_t value = 0;
-    char ftoaBuffer[FTOA_BUFFER_SIZE];
-
-    void *ptr = var->ptr;
+    uint8_t *ptr = var->ptr;
     if ((var->type & VALUE_SECTION_MASK) == PROFILE_VALUE) {
-        ptr = ((uint8_t *)ptr) + (sizeof(profile_t) * masterConfig.current_profile_index);
+        ptr += sizeof(profile_t) * masterConfig.current_profile_index;
     }
     if ((var->type & VALUE_SECTION_MASK) == CONTROL_RATE_VALUE) {
-        ptr = ((uint8_t *)ptr) + (sizeof(controlRateConfig_t) * getCurrentControlRateProfile());
+        ptr += sizeof(controlRateConfig_t) * getCurrentControlRateProfile();
     }
+    return ptr;
+}
+
+static void cliPrintVar(const clivalue_t *var, uint32_t full)
+{
+    int32_t value = 0;
+    char ftoaBuffer[FTOA_BUFFER_SIZE];
+
+    void *ptr = cliGetValuePointer(var);
 
     switch (var->type & VALUE_TYPE_MASK) {
         case VAR_UINT8:
@@ -2545,13 +2758,7 @@ static void cliPrintVarRange(const clivalue_t *var)
 
 static void cliSetVar(const clivalue_t *var, const int_float_value_t value)
 {
-    void *ptr = var->ptr;
-    if ((var->type & VALUE_SECTION_MASK) == PROFILE_VALUE) {
-        ptr = ((uint8_t *)ptr) + (sizeof(profile_t) * masterConfig.current_profile_index);
-    }
-    if ((var->type & VALUE_SECTION_MASK) == CONTROL_RATE_VALUE) {
-        ptr = ((uint8_t *)ptr) + (sizeof(controlRateConfig_t) * getCurrentControlRateProfile());
-    }
+    void *ptr = cliGetValuePointer(var);
 
     switch (var->type & VALUE_TYPE_MASK) {
         case VAR_UINT8:
@@ -2578,6 +2785,123 @@ static void cliSetVar(const clivalue_t *var, const int_float_value_t value)
     }
 }
 
+/*
+ * Settings access for other protocols, settings are numbered in valueTable order and passed as float.
+ * Writes follow the same ranges as 'set' and change the running config only, saving is up to the caller.
+ */
+uint16_t cliGetSettingCount(void)
+{
+    return VALUE_COUNT;
+}
+
+const char *cliGetSettingName(uint16_t index)
+{
+    return index < VALUE_COUNT ? valueTable[index].name : NULL;
+}
+
+float cliGetSettingValue(uint16_t index)
+{
+    const clivalue_t *var = &valueTable[index];
+    const void *ptr = cliGetValuePointer(var);
+
+    switch (var->type & VALUE_TYPE_MASK) {
+        case VAR_UINT8:
+            return *(uint8_t *)ptr;
+        case VAR_INT8:
+            return *(int8_t *)ptr;
+        case VAR_UINT16:
+            return *(uint16_t *)ptr;
+        case VAR_INT16:
+            return *(int16_t *)ptr;
+        case VAR_UINT32:
+            return *(uint32_t *)ptr;
+        case VAR_FLOAT:
+        default:
+            return *(float *)ptr;
+    }
+}
+
+bool cliSetSettingValue(uint16_t index, float value)
+{
+    if (index >= VALUE_COUNT) {
+        return false;
+    }
+
+    const clivalue_t *var = &valueTable[index];
+    float min;
+    float max;
+
+    if ((var->type & VALUE_MODE_MASK) == MODE_LOOKUP) {
+        min = 0;
+        max = lookupTables[var->config.lookup.tableIndex].valueCount - 1;
+    } else {
+        min = var->config.minmax.min;
+        max = var->config.minmax.max;
+    }
+
+    if (!(value >= min && value <= max)) {
+        return false;
+    }
+
+    int_float_value_t newValue;
+    if ((var->type & VALUE_TYPE_MASK) == VAR_FLOAT) {
+        newValue.float_value = value;
+    } else {
+        newValue.int_value = (int32_t)(value < 0 ? value - 0.5f : value + 0.5f);
+    }
+
+    cliSetVar(var, newValue);
+    return true;
+}
+
+static void cliSortValueTable(void)
+{
+    BUILD_BUG_ON(VALUE_COUNT > UINT16_MAX);
+
+    if (valueTableSorted) {
+        return;
+    }
+
+    // insertion sort, only done once and the table is small
+    for (uint32_t i = 0; i < VALUE_COUNT; i++) {
+        uint32_t j = i;
+        while (j > 0 && strcasecmp(valueTable[valueTableSortedIndex[j - 1]].name, valueTable[i].name) > 0) {
+            valueTableSortedIndex[j] = valueTableSortedIndex[j - 1];
+            j--;
+        }
+        valueTableSortedIndex[j] = i;
+    }
+
+    valueTableSorted = true;
+}
+
+// Finds the setting whose name exactly matches the first nameLength characters of name, ignoring case
+static const clivalue_t *cliFindValue(const char *name, uint32_t nameLength)
+{
+    int32_t low = 0;
+    int32_t high = VALUE_COUNT - 1;
+
+    while (low <= high) {
+        const int32_t mid = (low + high) / 2;
+        const clivalue_t *val = &valueTable[valueTableSortedIndex[mid]];
+
+        int result = strncasecmp(name, val->name, nameLength);
+        if (result == 0 && val->name[nameLength] != '\0') {
+            result = -1; // name is a prefix of a longer setting name
+        }
+
+        if (result == 0) {
+            return val;
+        } else if (result < 0) {
+            high = mid - 1;
+        } else {
+            low = mid + 1;
+        }
+    }
+
+    return NULL;
+}
+
 static void cliSet(char *cmdline)
 {
     uint32_t i;
@@ -2610,65 +2934,63 @@ static void cliSet(char *cmdline)
             eqptr++;
         }
 
-        for (i = 0; i < VALUE_COUNT; i++) {
-            val = &valueTable[i];
-            // ensure exact match when setting to prevent setting variables with shorter names
-            if (strncasecmp(cmdline, valueTable[i].name, strlen(valueTable[i].name)) == 0 && variableNameLength == strlen(valueTable[i].name)) {
-
-                bool changeValue = false;
-                int_float_value_t tmp = {0};
-                switch (valueTable[i].type & VALUE_MODE_MASK) {
-                    case MODE_DIRECT: {
-                            if(*eqptr != 0 && strspn(eqptr, "0123456789.+-") == strlen(eqptr)) {
-                                int32_t value = 0;
-                                float valuef = 0;
-
-                                value = atoi(eqptr);
-                                valuef = fastA2F(eqptr);
-
-                                if ((valuef >= valueTable[i].config.minmax.min && valuef <= valueTable[i].config.minmax.max) // note: compare float value
-                                        || (valueTable[i].config.minmax.min == 0 && valueTable[i].config.minmax.max == 0)) {  // setting both min and max to zero allows full range
-
-                                    if ((valueTable[i].type & VALUE_TYPE_MASK) == VAR_FLOAT)
-                                        tmp.float_value = valuef;
-                                    else
-                                        tmp.int_value = value;
-
-                                    changeValue = true;
-                                }
+        val = cliFindValue(cmdline, variableNameLength);
+        if (val) {
+            bool changeValue = false;
+            int_float_value_t tmp = {0};
+            switch (val->type & VALUE_MODE_MASK) {
+                case MODE_DIRECT: {
+                        if(*eqptr != 0 && strspn(eqptr, "0123456789.+-") == strlen(eqptr)) {
+                            int32_t value = 0;
+                            float valuef = 0;
+
+                            value = atoi(eqptr);
+                            valuef = fastA2F(eqptr);
+
+                            if ((valuef >= val->config.minmax.min && valuef <= val->config.minmax.max) // note: compare float value
+                                    || (val->config.minmax.min == 0 && val->config.minmax.max == 0)) {  // setting both min and max to zero allows full range
+
+                                if ((val->type & VALUE_TYPE_MASK) == VAR_FLOAT)
+                                    tmp.float_value = valuef;
+                                else
+                                    tmp.int_value = value;
+
+                                changeValue = true;
                             }
                         }
-                        break;
-                    case MODE_LOOKUP: {
-                            const lookupTableEntry_t *tableEntry = &lookupTables[valueTable[i].config.lookup.tableIndex];
-                            bool matched = false;
-                            for (uint8_t tableValueIndex = 0; tableValueIndex < tableEntry->valueCount && !matched; tableValueIndex++) {
-                                matched = strcasecmp(tableEntry->values[tableValueIndex], eqptr) == 0;
-
-                                if (matched) {
-                                    tmp.int_value = tableValueIndex;
-                                    changeValue = true;
-                                }
+                    }
+                    break;
+                case MODE_LOOKUP: {
+                        const lookupTableEntry_t *tableEntry = &lookupTables[val->config.lookup.tableIndex];
+                        bool matched = false;
+                        for (uint8_t tableValueIndex = 0; tableValueIndex < tableEntry->valueCount && !matched; tableValueIndex++) {
+                            matched = strcasecmp(tableEntry->values[tableValueIndex], eqptr) == 0;
+
+                            if (matched) {
+                                tmp.int_value = tableValueIndex;
+                                changeValue = true;
                             }
                         }
-                        break;
-                }
-
-                if (changeValue) {
-                    cliSetVar(val, tmp);
+                    }
+                    break;
+            }
 
-                    cliPrintf("%s set to ", valueTable[i].name);
-                    cliPrintVar(val, 0);
-                } else {
-                    cliPrint("Invalid value.");
-                    cliPrintVarRange(val);
-                    cliPrint("\r\n");
-                }
+            if (changeValue) {
+                cliSetVar(val, tmp);
 
-                return;
+                cliPrintf("%s set to ", val->name);
+                cliPrintVar(val, 0);
+            } else {
+                cliStartError();
+                cliPrint("Invalid value.");
+                cliPrintVarRange(val);
+                cliPrint("\r\n");
+                cliEndError();
             }
+
+            return;
         }
-        cliPrint("Invalid name\r\n");
+        cliPrintErrorf("Invalid name\r\n");
     } else {
         // no equals, check for matching variables.
         cliGet(cmdline);
@@ -2699,7 +3021,7 @@ static void cliGet(char *cmdline)
         return;
     }
 
-    cliPrint("Invalid name\r\n");
+    cliPrintErrorf("Invalid name\r\n");
 }
 
 static void cliStatus(char *cmdline)
@@ -2738,6 +3060,28 @@ static void cliStatus(char *cmdline)
 #endif
 
     cliPrintf("Cycle Time: %d, I2C Errors: %d, config size: %d\r\n", cycleTime, i2cErrorCounter, sizeof(master_t));
+
+    const loopTimingStats_t *loopTimingStats = loopTimingGetStats();
+    if (loopTimingStats->cycleCount) {
+        cliPrintf("Loop timing: %s %dus, jitter %d to %dus, %d overruns in %d cycles\r\n",
+            loopTimingIsFixedRate() ? "fixed" : "measured", targetLooptime,
+            loopTimingStats->jitterMinUs, loopTimingStats->jitterMaxUs, loopTimingStats->overrunCount, loopTimingStats->cycleCount);
+    }
+
+#ifdef USE_DSHOT
+    if (pwmGetOutputConfiguration()->dshotUnavailable) {
+        cliPrint("Motor protocol: DShot can't drive all motor outputs, using standard PWM\r\n");
+    }
+#endif
+
+    for (int i = 0; i < SERIAL_PORT_COUNT; i++) {
+        const serialPortUsage_t *usage = findSerialPortUsageByIdentifier(serialPortIdentifiers[i]);
+        if (usage && usage->serialPort && usage->buffers.rxBufferSize) {
+            cliPrintf("Serial port %d: RX buffer %d/%d, TX buffer %d/%d\r\n", usage->identifier,
+                usage->serialPort->rxBufferHighWater, usage->buffers.rxBufferSize,
+                usage->serialPort->txBufferHighWater, usage->buffers.txBufferSize);
+        }
+    }
 }
 
 #ifndef SKIP_TASK_STATISTICS
@@ -2789,111 +3133,152 @@ static void cliPFlags(char *cmdline)
     cliPrintf("# Persistent config flags: 0x%08x", masterConfig.persistentFlags );
 }
 
-void cliProcess(void)
+static void cliExecuteLine(void)
 {
-    if (!cliWriter) {
-        return;
+    cliPrint("\r\n");
+
+    if (cliBatchMode) {
+        cliBatchLine++;
     }
 
-    // Be a little bit tricky.  Flush the last inputs buffer, if any.
-    bufWriterFlush(cliWriter);
+    // Strip comment starting with # from line
+    char *p = cliBuffer;
+    p = strchr(p, '#');
+    if (NULL != p) {
+        bufferIndex = (uint32_t)(p - cliBuffer);
+    }
 
-    while (serialRxBytesWaiting(cliPort)) {
-        uint8_t c = serialRead(cliPort);
-        if (c == '\t' || c == '?') {
-            // do tab completion
-            const clicmd_t *cmd, *pstart = NULL, *pend = NULL;
-            uint32_t i = bufferIndex;
-            for (cmd = cmdTable; cmd < cmdTable + CMD_COUNT; cmd++) {
-                if (bufferIndex && (strncasecmp(cliBuffer, cmd->name, bufferIndex) != 0))
-                    continue;
-                if (!pstart)
-                    pstart = cmd;
-                pend = cmd;
+    // Strip trailing whitespace
+    while (bufferIndex > 0 && cliBuffer[bufferIndex - 1] == ' ') {
+        bufferIndex--;
+    }
+
+    // Process non-empty lines
+    if (bufferIndex > 0) {
+        cliBuffer[bufferIndex] = 0; // null terminate
+
+        const clicmd_t *cmd;
+        for (cmd = cmdTable; cmd < cmdTable + CMD_COUNT; cmd++) {
+            if(!strncasecmp(cliBuffer, cmd->name, strlen(cmd->name))   // command names match
+               && !isalnum((unsigned)cliBuffer[strlen(cmd->name)]))    // next characted in bufffer is not alphanumeric (command is correctly terminated)
+                break;
+        }
+        if(cmd < cmdTable + CMD_COUNT)
+            cmd->func(cliBuffer + strlen(cmd->name) + 1);
+        else {
+            cliStartError();
+            cliPrint("Unknown command, try 'help'");
+            if (cliBatchMode) {
+                // no prompt follows to end the line
+                cliPrint("\r\n");
             }
-            if (pstart) {    /* Buffer matches one or more commands */
-                for (; ; bufferIndex++) {
-                    if (pstart->name[bufferIndex] != pend->name[bufferIndex])
-                        break;
-                    if (!pstart->name[bufferIndex] && bufferIndex < sizeof(cliBuffer) - 2) {
-                        /* Unambiguous -- append a space */
-                        cliBuffer[bufferIndex++] = ' ';
-                        cliBuffer[bufferIndex] = '\0';
-                        break;
-                    }
-                    cliBuffer[bufferIndex] = pstart->name[bufferIndex];
+            cliEndError();
+        }
+        bufferIndex = 0;
+    }
+
+    memset(cliBuffer, 0, sizeof(cliBuffer));
+}
+
+// Returns true when enter was pressed and cliBuffer holds a line ready for cliExecuteLine()
+static bool cliProcessChar(uint8_t c)
+{
+    if (c == '\t' || c == '?') {
+        // do tab completion
+        const clicmd_t *cmd, *pstart = NULL, *pend = NULL;
+        uint32_t i = bufferIndex;
+        for (cmd = cmdTable; cmd < cmdTable + CMD_COUNT; cmd++) {
+            if (bufferIndex && (strncasecmp(cliBuffer, cmd->name, bufferIndex) != 0))
+                continue;
+            if (!pstart)
+                pstart = cmd;
+            pend = cmd;
+        }
+        if (pstart) {    /* Buffer matches one or more commands */
+            for (; ; bufferIndex++) {
+                if (pstart->name[bufferIndex] != pend->name[bufferIndex])
+                    break;
+                if (!pstart->name[bufferIndex] && bufferIndex < sizeof(cliBuffer) - 2) {
+                    /* Unambiguous -- append a space */
+                    cliBuffer[bufferIndex++] = ' ';
+                    cliBuffer[bufferIndex] = '\0';
+                    break;
                 }
+                cliBuffer[bufferIndex] = pstart->name[bufferIndex];
             }
-            if (!bufferIndex || pstart != pend) {
-                /* Print list of ambiguous matches */
-                cliPrint("\r\033[K");
-                for (cmd = pstart; cmd <= pend; cmd++) {
-                    cliPrint(cmd->name);
-                    cliWrite('\t');
-                }
-                cliPrompt();
-                i = 0;    /* Redraw prompt */
+        }
+        if (!bufferIndex || pstart != pend) {
+            /* Print list of ambiguous matches */
+            cliPrint("\r\033[K");
+            for (cmd = pstart; cmd <= pend; cmd++) {
+                cliPrint(cmd->name);
+                cliWrite('\t');
             }
-            for (; i < bufferIndex; i++)
-                cliWrite(cliBuffer[i]);
-        } else if (!bufferIndex && c == 4) {   // CTRL-D
-            cliExit(cliBuffer);
-            return;
-        } else if (c == 12) {                  // NewPage / CTRL-L
-            // clear screen
-            cliPrint("\033[2J\033[1;1H");
             cliPrompt();
-        } else if (bufferIndex && (c == '\n' || c == '\r')) {
-            // enter pressed
-            cliPrint("\r\n");
+            i = 0;    /* Redraw prompt */
+        }
+        for (; i < bufferIndex; i++)
+            cliWrite(cliBuffer[i]);
+    } else if (c == 12) {                  // NewPage / CTRL-L
+        // clear screen
+        cliPrint("\033[2J\033[1;1H");
+        cliPrompt();
+    } else if (bufferIndex && (c == '\n' || c == '\r')) {
+        // enter pressed
+        return true;
+    } else if (c == 127) {
+        // backspace
+        if (bufferIndex) {
+            cliBuffer[--bufferIndex] = 0;
+            cliPrint("\010 \010");
+        }
+    } else if (bufferIndex < sizeof(cliBuffer) && c >= 32 && c <= 126) {
+        if (!bufferIndex && c == ' ')
+            return false; // Ignore leading spaces
+        cliBuffer[bufferIndex++] = c;
+        cliWrite(c);
+    }
 
-            // Strip comment starting with # from line
-            char *p = cliBuffer;
-            p = strchr(p, '#');
-            if (NULL != p) {
-                bufferIndex = (uint32_t)(p - cliBuffer);
-            }
+    return false;
+}
 
-            // Strip trailing whitespace
-            while (bufferIndex > 0 && cliBuffer[bufferIndex - 1] == ' ') {
-                bufferIndex--;
-            }
+void cliProcess(void)
+{
+    if (!cliWriter) {
+        return;
+    }
+
+    // Be a little bit tricky.  Flush the last inputs buffer, if any.
+    bufWriterFlush(cliWriter);
 
-            // Process non-empty lines
-            if (bufferIndex > 0) {
-                cliBuffer[bufferIndex] = 0; // null terminate
+    const uint8_t *rxData;
+    uint32_t rxCount;
 
-                const clicmd_t *cmd;
-                for (cmd = cmdTable; cmd < cmdTable + CMD_COUNT; cmd++) {
-                    if(!strncasecmp(cliBuffer, cmd->name, strlen(cmd->name))   // command names match
-                       && !isalnum((unsigned)cliBuffer[strlen(cmd->name)]))    // next characted in bufffer is not alphanumeric (command is correctly terminated)
-                        break;
-                }
-                if(cmd < cmdTable + CMD_COUNT)
-                    cmd->func(cliBuffer + strlen(cmd->name) + 1);
-                else
-                    cliPrint("Unknown command, try 'help'");
-                bufferIndex = 0;
+    while ((rxCount = serialPeekRx(cliPort, &rxData)) > 0) {
+        uint32_t i = 0;
+        bool lineComplete = false;
+
+        while (i < rxCount && !lineComplete) {
+            const uint8_t c = rxData[i++];
+            if (!bufferIndex && c == 4) {   // CTRL-D
+                serialSkipRx(cliPort, i);
+                cliExit(cliBuffer);
+                return;
             }
+            lineComplete = cliProcessChar(c);
+        }
+
+        // Release the bytes before running a command, it may take over the port (e.g. serialpassthrough)
+        serialSkipRx(cliPort, i);
 
-            memset(cliBuffer, 0, sizeof(cliBuffer));
+        if (lineComplete) {
+            cliExecuteLine();
 
             // 'exit' will reset this flag, so we don't need to print prompt again
             if (!cliMode)
                 return;
 
             cliPrompt();
-        } else if (c == 127) {
-            // backspace
-            if (bufferIndex) {
-                cliBuffer[--bufferIndex] = 0;
-                cliPrint("\010 \010");
-            }
-        } else if (bufferIndex < sizeof(cliBuffer) && c >= 32 && c <= 126) {
-            if (!bufferIndex && c == ' ')
-                continue; // Ignore leading spaces
-            cliBuffer[bufferIndex++] = c;
-            cliWrite(c);
         }
     }
 }
@@ -23,4 +23,9 @@ extern uint8_t cliMode;
 void cliProcess(void);
 bool cliIsActiveOnPort(serialPort_t *serialPort);
 
+uint16_t cliGetSettingCount(void);
+const char *cliGetSettingName(uint16_t index);
+float cliGetSettingValue(uint16_t index);
+bool cliSetSettingValue(uint16_t index, float value);
+
 #endif /* CLI_H_ */
@@ -30,6 +30,7 @@
 #include "common/axis.h"
 #include "common/color.h"
 #include "common/maths.h"
+#include "common/utils.h"
 
 #include "drivers/system.h"
 
@@ -53,6 +54,7 @@
 
 #include "io/escservo.h"
 #include "io/rc_controls.h"
+#include "io/rc_curves.h"
 #include "io/gps.h"
 #include "io/gimbal.h"
 #include "io/serial.h"
@@ -73,6 +75,7 @@
 #include "sensors/gyro.h"
 
 #include "flight/mixer.h"
+#include "flight/motor_latency.h"
 #include "flight/pid.h"
 #include "flight/imu.h"
 #include "flight/hil.h"
@@ -425,6 +428,152 @@ static void serializeDataflashReadReply(uint32_t address, uint8_t size)
 }
 #endif
 
+/*
+ * Config snapshot chunks carry: config version (1), blob size (2), chunk offset (2), CRC16 of chunk data (2), chunk data.
+ * Restored chunks are written straight into the spare area of the config store, the running config only changes
+ * when the commit passes its checks. A restore is only allowed while disarmed.
+ */
+#define CONFIG_SNAPSHOT_HEADER_SIZE 7
+#define CONFIG_SNAPSHOT_READ_CHUNK_SIZE 128
+
+static bool configSnapshotRestoreInProgress = false;
+static uint16_t configSnapshotRestoreOffset;
+static uint8_t configSnapshotRestoreVersion;
+static uint16_t configSnapshotRestoreCrc;
+
+static uint16_t configSnapshotCrc(uint16_t crc, const uint8_t *data, uint32_t length)
+{
+    while (length--) {
+        crc = crc16_ccitt(crc, *data++);
+    }
+    return crc;
+}
+
+static void serializeConfigSnapshotReply(uint16_t offset)
+{
+    const uint8_t *blob = (const uint8_t *)&masterConfig;
+    uint16_t size = 0;
+
+    if (offset < sizeof(master_t)) {
+        const uint16_t remaining = sizeof(master_t) - offset;
+        size = MIN(remaining, CONFIG_SNAPSHOT_READ_CHUNK_SIZE);
+    }
+
+    headSerialReply(CONFIG_SNAPSHOT_HEADER_SIZE + size);
+
+    serialize8(masterConfig.version);
+    serialize16(sizeof(master_t));
+    serialize16(offset);
+    serialize16(configSnapshotCrc(0, blob + offset, size));
+
+    for (int i = 0; i < size; i++) {
+        serialize8(blob[offset + i]);
+    }
+}
+
+static void abortConfigSnapshotRestore(void)
+{
+    configSnapshotRestoreInProgress = false;
+}
+
+// the version, size and magic bytes are checked as they stream past, the blob is never held in RAM
+static bool configSnapshotChunkHasValidMarkers(uint16_t offset, const uint8_t *chunk, uint8_t chunkSize)
+{
+    const struct {
+        uint16_t offset;
+        uint8_t value;
+    } markers[] = {
+        { offsetof(master_t, version), configSnapshotRestoreVersion },
+        { offsetof(master_t, size), sizeof(master_t) & 0xFF },
+        { offsetof(master_t, size) + 1, sizeof(master_t) >> 8 },
+        { offsetof(master_t, magic_be), 0xBE },
+        { offsetof(master_t, magic_ef), 0xEF },
+    };
+
+    for (unsigned i = 0; i < ARRAYLEN(markers); i++) {
+        if (markers[i].offset >= offset && markers[i].offset < offset + chunkSize
+                && chunk[markers[i].offset - offset] != markers[i].value) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool processConfigSnapshotChunk(void)
+{
+    if (ARMING_FLAG(ARMED) || currentPort->dataSize < CONFIG_SNAPSHOT_HEADER_SIZE) {
+        return false;
+    }
+
+    const uint8_t version = read8();
+    const uint16_t blobSize = read16();
+    const uint16_t offset = read16();
+    const uint16_t crc = read16();
+    const uint8_t chunkSize = currentPort->dataSize - CONFIG_SNAPSHOT_HEADER_SIZE;
+    const uint8_t *chunk = &currentPort->inBuf[currentPort->indRX];
+
+    if (offset == 0) {
+        configSnapshotRestoreVersion = masterConfig.version;
+    }
+
+    if (version != configSnapshotRestoreVersion || blobSize != sizeof(master_t) || offset + chunkSize > sizeof(master_t)) {
+        abortConfigSnapshotRestore();
+        return false;
+    }
+
+    // a corrupted chunk is dropped before it touches the flash, the tool can simply resend it
+    if (configSnapshotCrc(0, chunk, chunkSize) != crc) {
+        return false;
+    }
+
+    if (offset != 0 && (!configSnapshotRestoreInProgress || offset != configSnapshotRestoreOffset)) {
+        abortConfigSnapshotRestore();
+        return false;
+    }
+
+    if (!configSnapshotChunkHasValidMarkers(offset, chunk, chunkSize)) {
+        abortConfigSnapshotRestore();
+        return false;
+    }
+
+    // the first chunk (re)starts the restore in a freshly erased area
+    if (offset == 0) {
+        configSnapshotRestoreCrc = 0;
+        configSnapshotRestoreInProgress = beginConfigRestore();
+    }
+
+    if (!configSnapshotRestoreInProgress || !writeConfigRestore(chunk, chunkSize)) {
+        abortConfigSnapshotRestore();
+        return false;
+    }
+
+    configSnapshotRestoreCrc = configSnapshotCrc(configSnapshotRestoreCrc, chunk, chunkSize);
+    configSnapshotRestoreOffset = offset + chunkSize;
+
+    return true;
+}
+
+static bool commitConfigSnapshot(void)
+{
+    if (ARMING_FLAG(ARMED) || currentPort->dataSize < 2) {
+        return false;
+    }
+
+    const uint16_t crc = read16();
+
+    if (!configSnapshotRestoreInProgress
+            || configSnapshotRestoreOffset != sizeof(master_t)
+            || configSnapshotRestoreCrc != crc) {
+        abortConfigSnapshotRestore();
+        return false;
+    }
+
+    configSnapshotRestoreInProgress = false;
+
+    return commitConfigRestore();
+}
+
 static void resetMspPort(mspPort_t *mspPortToReset, serialPort_t *serialPort)
 {
     memset(mspPortToReset, 0, sizeof(mspPort_t));
@@ -661,6 +810,45 @@ static bool processOutCommand(uint8_t cmdMSP)
 #endif
         break;
 
+    case MSP_RX_LATENCY:
+        // in rxLatencyStage_e order, see docs/API/MSP_extensions.md
+        headSerialReply(4 * RX_LATENCY_STAGE_COUNT);
+        for (i = 0; i < RX_LATENCY_STAGE_COUNT; i++) {
+            serialize32(rxGetLatency(i));
+        }
+        break;
+
+    case MSP_RX_STATS:
+        {
+            const rxStats_t *rxStats = rxGetStats();
+            headSerialReply(4 * 5 + 4 * RX_INTERVAL_HISTOGRAM_BUCKET_COUNT);
+            serialize32(rxStats->frameCount);
+            serialize32(rxStats->errorCount);
+            serialize32(rxStats->droppedCount);
+            serialize32(rxStats->frameToMixerUs);
+            serialize32(rxStats->frameToMixerMaxUs);
+            for (i = 0; i < RX_INTERVAL_HISTOGRAM_BUCKET_COUNT; i++) {
+                serialize32(rxStats->intervalHistogram[i]);
+            }
+        }
+        break;
+
+    case MSP_MOTOR_LATENCY:
+        {
+            const motorLatencyStats_t *motorLatencyStats = motorLatencyGetStats();
+            headSerialReply(4 + 8 * MOTOR_LATENCY_STAGE_COUNT);
+            serialize32(motorLatencyStats->cycleCount);
+            for (i = 0; i < MOTOR_LATENCY_STAGE_COUNT; i++) {
+                serialize32(motorLatencyGet(i));
+                serialize32(motorLatencyStats->latencyMaxUs[i]);
+            }
+        }
+        break;
+
+    case MSP_CONFIG_SNAPSHOT:
+        serializeConfigSnapshotReply(currentPort->dataSize >= 2 ? read16() : 0);
+        break;
+
     case MSP_BUILD_INFO:
         headSerialReply(
                 BUILD_DATE_LENGTH +
@@ -1331,6 +1519,8 @@ static bool processInCommand(void)
                 adjRange->range.endStep = read8();
                 adjRange->adjustmentFunction = read8();
                 adjRange->auxSwitchChannelIndex = read8();
+
+                resetAuxChannelIndexes();
             } else {
                 headSerialError(0);
             }
@@ -1360,6 +1550,8 @@ static bool processInCommand(void)
             if (currentPort->dataSize >= 11) {
                 currentControlRateProfile->rcYawExpo8 = read8();
             }
+            generatePitchRollYawCurves(currentControlRateProfile);
+            generateThrottlePIDGains(currentControlRateProfile, &masterConfig.rxConfig);
         } else {
             headSerialError(0);
         }
@@ -1421,6 +1613,7 @@ static bool processInCommand(void)
             currentProfile->servoConf[i].angleAtMax = read8();
             currentProfile->servoConf[i].forwardFromChannel = read8();
             currentProfile->servoConf[i].reversedSources = read32();
+            servoMixerCompileRules();
         }
 #endif
         break;
@@ -1480,6 +1673,18 @@ static bool processInCommand(void)
         if (!ARMING_FLAG(ARMED))
             ENABLE_STATE(CALIBRATE_MAG);
         break;
+    case MSP_SET_CONFIG_SNAPSHOT:
+        if (!processConfigSnapshotChunk()) {
+            return false;
+        }
+        break;
+
+    case MSP_CONFIG_SNAPSHOT_COMMIT:
+        if (!commitConfigSnapshot()) {
+            return false;
+        }
+        break;
+
     case MSP_EEPROM_WRITE:
         if (ARMING_FLAG(ARMED)) {
             headSerialError(0);
@@ -1592,6 +1797,8 @@ static bool processInCommand(void)
         if (currentPort->dataSize > 13) {
             masterConfig.rxConfig.nrf24rx_id = read32();
         }
+        // the D gain attenuation is tabulated between mincheck and maxcheck
+        generateThrottlePIDGains(currentControlRateProfile, &masterConfig.rxConfig);
         break;
 
     case MSP_SET_FAILSAFE_CONFIG:
@@ -1814,19 +2021,30 @@ void mspProcess(void)
         writer = bufWriterInit(buf, sizeof(buf),
                                (bufWrite_t)serialWriteBufShim, currentPort->port);
 
-        while (serialRxBytesWaiting(mspSerialPort)) {
+        const uint8_t *rxData;
+        uint32_t rxCount;
+        bool commandReceived = false;
 
-            uint8_t c = serialRead(mspSerialPort);
-            bool consumed = mspProcessReceivedData(c);
+        while (!commandReceived && (rxCount = serialPeekRx(mspSerialPort, &rxData)) > 0) {
+            uint32_t i = 0;
 
-            if (!consumed && !ARMING_FLAG(ARMED)) {
-                evaluateOtherData(mspSerialPort, c);
-            }
+            while (i < rxCount && !commandReceived) {
+                const uint8_t c = rxData[i++];
+                bool consumed = mspProcessReceivedData(c);
+
+                if (!consumed && !ARMING_FLAG(ARMED)) {
+                    evaluateOtherData(mspSerialPort, c);
+                }
 
-            if (currentPort->c_state == COMMAND_RECEIVED) {
-                mspProcessReceivedCommand();
-                break; // process one command at a time so as not to block.
+                commandReceived = (currentPort->c_state == COMMAND_RECEIVED);
             }
+
+            // Bytes after the command stay in the port buffer for the next call
+            serialSkipRx(mspSerialPort, i);
+        }
+
+        if (commandReceived) {
+            mspProcessReceivedCommand(); // process one command at a time so as not to block.
         }
 
         bufWriterFlush(writer);
@@ -58,6 +58,7 @@
 #include "io/gps.h"
 #include "io/escservo.h"
 #include "io/rc_controls.h"
+#include "io/rc_smoothing.h"
 #include "io/gimbal.h"
 #include "io/ledstrip.h"
 #include "io/display.h"
@@ -78,6 +79,7 @@
 #include "blackbox/blackbox.h"
 
 #include "flight/pid.h"
+#include "flight/loop_timing.h"
 #include "flight/imu.h"
 #include "flight/mixer.h"
 #include "flight/failsafe.h"
@@ -261,6 +263,7 @@ void init(void)
 
     pwm_params.useOneshot = feature(FEATURE_ONESHOT125);
     pwm_params.motorPwmRate = masterConfig.motor_pwm_rate;
+    pwm_params.motorPwmProtocol = masterConfig.motor_pwm_protocol;
     pwm_params.idlePulse = masterConfig.escAndServoConfig.mincommand;
     if (feature(FEATURE_3D))
         pwm_params.idlePulse = masterConfig.flight3DConfig.neutral3d;
@@ -388,7 +391,7 @@ void init(void)
 #endif
 
     // Set gyro sampling rate divider before initialization
-    gyroSetSampleRate(masterConfig.looptime, masterConfig.gyro_lpf, masterConfig.gyroSync, masterConfig.gyroSyncDenominator);
+    gyroSetSampleRate(masterConfig.looptime, masterConfig.gyro_lpf, masterConfig.gyroSync, masterConfig.gyroSyncDenominator, masterConfig.gyroFifo);
 
     if (!sensorsAutodetect(&masterConfig.sensorAlignmentConfig,
             masterConfig.gyro_lpf,
@@ -401,6 +404,9 @@ void init(void)
         failureMode(FAILURE_MISSING_ACC);
     }
 
+    // the gyro driver has set up its data ready interrupt by now
+    loopTimingInit(targetLooptime, masterConfig.gyroSync && gyroSyncIsInterruptDriven());
+
     systemState |= SYSTEM_STATE_SENSORS_READY;
 
     LED1_ON;
@@ -433,6 +439,11 @@ void init(void)
 
     rxInit(&masterConfig.rxConfig, currentProfile->modeActivationConditions);
 
+    // the nominal frame interval of the receiver is only the starting point, the actual one is measured
+    uint16_t rxRefreshRate;
+    initRxRefreshRate(&rxRefreshRate);
+    rcSmoothingInit(rxRefreshRate);
+
 #ifdef GPS
     if (feature(FEATURE_GPS)) {
         gpsInit(
@@ -30,7 +30,6 @@
 #include "common/axis.h"
 #include "common/color.h"
 #include "common/utils.h"
-#include "common/filter.h"
 
 #include "drivers/sensor.h"
 #include "drivers/accgyro.h"
@@ -58,6 +57,7 @@
 #include "io/escservo.h"
 #include "io/rc_controls.h"
 #include "io/rc_curves.h"
+#include "io/rc_smoothing.h"
 #include "io/gimbal.h"
 #include "io/gps.h"
 #include "io/ledstrip.h"
@@ -74,6 +74,8 @@
 #include "blackbox/blackbox.h"
 
 #include "flight/mixer.h"
+#include "flight/loop_timing.h"
+#include "flight/motor_latency.h"
 #include "flight/pid.h"
 #include "flight/imu.h"
 #include "flight/hil.h"
@@ -127,14 +129,14 @@ bool isCalibrating(void)
     return (!isAccelerationCalibrationComplete() && sensors(SENSOR_ACC)) || (!isGyroCalibrationComplete());
 }
 
-int16_t getAxisRcCommand(int16_t rawData, int16_t rate, int16_t deadband)
+int16_t getAxisRcCommand(uint8_t axis, int16_t rawData, int16_t deadband)
 {
     int16_t stickDeflection;
 
     stickDeflection = constrain(rawData - masterConfig.rxConfig.midrc, -500, 500);
     stickDeflection = applyDeadband(stickDeflection, deadband);
 
-    return rcLookup(stickDeflection, rate);
+    return rcLookup(axis, stickDeflection);
 }
 
 void annexCode(void)
@@ -143,9 +145,9 @@ void annexCode(void)
     int32_t throttleValue;
 
     // Compute ROLL PITCH and YAW command
-    rcCommand[ROLL] = getAxisRcCommand(rcData[ROLL], currentControlRateProfile->rcExpo8, currentProfile->rcControlsConfig.deadband);
-    rcCommand[PITCH] = getAxisRcCommand(rcData[PITCH], currentControlRateProfile->rcExpo8, currentProfile->rcControlsConfig.deadband);
-    rcCommand[YAW] = -getAxisRcCommand(rcData[YAW], currentControlRateProfile->rcYawExpo8, currentProfile->rcControlsConfig.yaw_deadband);
+    rcCommand[ROLL] = getAxisRcCommand(ROLL, rcData[ROLL], currentProfile->rcControlsConfig.deadband);
+    rcCommand[PITCH] = getAxisRcCommand(PITCH, rcData[PITCH], currentProfile->rcControlsConfig.deadband);
+    rcCommand[YAW] = -getAxisRcCommand(YAW, rcData[YAW], currentProfile->rcControlsConfig.yaw_deadband);
 
     //Compute THROTTLE command
     throttleValue = constrain(rcData[THROTTLE], masterConfig.rxConfig.mincheck, PWM_RANGE_MAX);
@@ -481,63 +483,20 @@ void processRx(void)
 
 }
 
-void filterRc(bool isRXDataNew)
-{
-    static int16_t lastCommand[4] = { 0, 0, 0, 0 };
-    static int16_t deltaRC[4] = { 0, 0, 0, 0 };
-    static int16_t factor, rcInterpolationFactor;
-    static biquadFilter_t filteredCycleTimeState;
-    static bool filterInitialised;
-    uint16_t filteredCycleTime;
-    uint16_t rxRefreshRate;
-
-    // Set RC refresh rate for sampling and channels to filter
-    initRxRefreshRate(&rxRefreshRate);
-
-    // Calculate average cycle time (1Hz LPF on cycle time)
-    if (!filterInitialised) {
-        biquadFilterInit(&filteredCycleTimeState, 1, 0);
-        filterInitialised = true;
-    }
-
-    filteredCycleTime = biquadFilterApply(&filteredCycleTimeState, (float) cycleTime);
-
-    rcInterpolationFactor = rxRefreshRate / filteredCycleTime + 1;
-
-    if (isRXDataNew) {
-        for (int channel=0; channel < 4; channel++) {
-            deltaRC[channel] = rcCommand[channel] -  (lastCommand[channel] - deltaRC[channel] * factor / rcInterpolationFactor);
-            lastCommand[channel] = rcCommand[channel];
-        }
-
-        factor = rcInterpolationFactor - 1;
-    } else {
-        factor--;
-    }
-
-    // Interpolate steps of rcCommand
-    if (factor > 0) {
-        for (int channel=0; channel < 4; channel++) {
-            rcCommand[channel] = lastCommand[channel] - deltaRC[channel] * factor/rcInterpolationFactor;
-         }
-    } else {
-        factor = 0;
-    }
-}
+static bool gyroTriggeredCycle = false;
 
 void taskMainPidLoop(void)
 {
     cycleTime = getTaskDeltaTime(TASK_SELF);
-    dT = (float)cycleTime * 0.000001f;
+    dT = loopTimingUpdate(cycleTime, gyroTriggeredCycle);
 
     imuUpdateAccelerometer();
     imuUpdateGyroAndAttitude();
 
     annexCode();
+    rxRecordLatency(RX_LATENCY_RC_COMMAND, micros());
 
-    if (masterConfig.rxConfig.rcSmoothing) {
-        filterRc(isRXDataNew);
-    }
+    rcSmoothingApply(masterConfig.rxConfig.rcSmoothing, rcCommand, isRXDataNew, rxGetFrameTime(), micros(), dT);
 
 #if defined(NAV)
     if (isRXDataNew) {
@@ -589,6 +548,7 @@ void taskMainPidLoop(void)
     }
 
     pidController(&currentProfile->pidProfile, currentControlRateProfile, &masterConfig.rxConfig);
+    motorLatencyRecord(MOTOR_LATENCY_PID, micros());
 
 #ifdef HIL
     if (hilActive) {
@@ -598,6 +558,7 @@ void taskMainPidLoop(void)
 #endif
 
     mixTable();
+    rxRecordLatency(RX_LATENCY_MIXER, micros());
 
 #ifdef USE_SERVOS
 
@@ -618,6 +579,7 @@ void taskMainPidLoop(void)
 
     if (motorControlEnable) {
         writeMotors();
+        rxRecordLatency(RX_LATENCY_MOTOR_OUTPUT, micros());
     }
 
 #ifdef USE_SDCARD
@@ -637,14 +599,24 @@ void taskMainPidLoopChecker(void) {
     // To make busy-waiting timeout work we need to account for time spent within busy-waiting loop
     uint32_t currentDeltaTime = getTaskDeltaTime(TASK_SELF);
 
+    gyroTriggeredCycle = false;
+
     if (masterConfig.gyroSync) {
         while (1) {
-            if (gyroSyncCheckUpdate() || ((currentDeltaTime + (micros() - currentTime)) >= (targetLooptime + GYRO_WATCHDOG_DELAY))) {
+            if (gyroSyncCheckUpdate()) {
+                gyroTriggeredCycle = true;
+                break;
+            }
+            // the watchdog fired, the gyro sample period does not tell how long this cycle was
+            if ((currentDeltaTime + (micros() - currentTime)) >= (targetLooptime + GYRO_WATCHDOG_DELAY)) {
                 break;
             }
         }
     }
 
+    // with gyro sync this is when data ready was seen, otherwise the sample age is not known here
+    motorLatencyGyroSample(micros());
+
     taskMainPidLoop();
 }
 
@@ -691,7 +663,7 @@ bool taskUpdateRxCheck(uint32_t currentDeltaTime)
 void taskUpdateRxMain(void)
 {
     processRx();
-    updatePIDCoefficients(&currentProfile->pidProfile, currentControlRateProfile, &masterConfig.rxConfig);
+    updatePIDCoefficients(&currentProfile->pidProfile, currentTime);
     isRXDataNew = true;
 }
 
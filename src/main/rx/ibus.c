@@ -44,10 +44,15 @@
 
 #define IBUS_BAUDRATE 115200
 
-static bool ibusFrameDone = false;
+// Set by the receive callback once a frame has been decoded, cleared when the RX task picks it up
+static volatile uint8_t ibusFrameStatusFlags = SERIAL_RX_FRAME_PENDING;
 static uint32_t ibusChannelData[IBUS_MAX_CHANNEL];
+// written by the receive callback
+static volatile uint32_t ibusDecodedChannelData[IBUS_MAX_CHANNEL];
+static volatile uint8_t ibusDecodedFrameCount;
 
 static void ibusDataReceive(uint16_t c);
+static uint8_t ibusDecodeFrame(void);
 static uint16_t ibusReadRawRC(rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan);
 
 bool ibusInit(rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig, rcReadRawDataPtr *callback)
@@ -91,24 +96,33 @@ static void ibusDataReceive(uint16_t c)
     ibus[ibusFramePosition] = (uint8_t)c;
 
     if (ibusFramePosition == IBUS_BUFFSIZE - 1) {
-        ibusFrameDone = true;
+        const uint8_t frameStatus = ibusDecodeFrame();
+        if (frameStatus != SERIAL_RX_FRAME_PENDING) {
+            ibusFrameStatusFlags = frameStatus;
+            ibusDecodedFrameCount++;
+            rxSerialFrameReceived(ibusTime);
+        }
     } else {
         ibusFramePosition++;
     }
 }
 
 uint8_t ibusFrameStatus(void)
+{
+    const uint8_t frameStatus = ibusFrameStatusFlags;
+    ibusFrameStatusFlags = SERIAL_RX_FRAME_PENDING;
+    if (frameStatus != SERIAL_RX_FRAME_PENDING) {
+        rxSerialCopyChannels(ibusChannelData, ibusDecodedChannelData, sizeof(ibusChannelData), &ibusDecodedFrameCount);
+    }
+    return frameStatus;
+}
+
+static uint8_t ibusDecodeFrame(void)
 {
     uint8_t i;
     uint8_t frameStatus = SERIAL_RX_FRAME_PENDING;
     uint16_t chksum, rxsum;
 
-    if (!ibusFrameDone) {
-        return frameStatus;
-    }
-
-    ibusFrameDone = false;
-
     chksum = 0xFFFF;
     for (i = 0; i < 30; i++)
         chksum -= ibus[i];
@@ -116,18 +130,20 @@ uint8_t ibusFrameStatus(void)
     rxsum = ibus[30] + (ibus[31] << 8);
 
     if (chksum == rxsum) {
-        ibusChannelData[0] = (ibus[ 3] << 8) + ibus[ 2];
-        ibusChannelData[1] = (ibus[ 5] << 8) + ibus[ 4];
-        ibusChannelData[2] = (ibus[ 7] << 8) + ibus[ 6];
-        ibusChannelData[3] = (ibus[ 9] << 8) + ibus[ 8];
-        ibusChannelData[4] = (ibus[11] << 8) + ibus[10];
-        ibusChannelData[5] = (ibus[13] << 8) + ibus[12];
-        ibusChannelData[6] = (ibus[15] << 8) + ibus[14];
-        ibusChannelData[7] = (ibus[17] << 8) + ibus[16];
-        ibusChannelData[8] = (ibus[19] << 8) + ibus[18];
-        ibusChannelData[9] = (ibus[21] << 8) + ibus[20];
+        ibusDecodedChannelData[0] = (ibus[ 3] << 8) + ibus[ 2];
+        ibusDecodedChannelData[1] = (ibus[ 5] << 8) + ibus[ 4];
+        ibusDecodedChannelData[2] = (ibus[ 7] << 8) + ibus[ 6];
+        ibusDecodedChannelData[3] = (ibus[ 9] << 8) + ibus[ 8];
+        ibusDecodedChannelData[4] = (ibus[11] << 8) + ibus[10];
+        ibusDecodedChannelData[5] = (ibus[13] << 8) + ibus[12];
+        ibusDecodedChannelData[6] = (ibus[15] << 8) + ibus[14];
+        ibusDecodedChannelData[7] = (ibus[17] << 8) + ibus[16];
+        ibusDecodedChannelData[8] = (ibus[19] << 8) + ibus[18];
+        ibusDecodedChannelData[9] = (ibus[21] << 8) + ibus[20];
 
         frameStatus = SERIAL_RX_FRAME_COMPLETE;
+    } else {
+        rxSerialFrameError();
     }
 
     return frameStatus;
@@ -191,6 +191,7 @@ enum exSensors_e {
 static serialPort_t *jetiExBusPort;
 
 static uint32_t jetiTimeStampRequest = 0;
+static uint32_t jetiExBusFrameTime = 0;
 
 static uint8_t jetiExBusFramePosition;
 static uint8_t jetiExBusFrameLength;
@@ -362,16 +363,18 @@ static void jetiExBusDataReceive(uint16_t c)
     jetiExBusFrame[jetiExBusFramePosition] = (uint8_t)c;
     jetiExBusFramePosition++;
 
-    // Check the header for the message length
+    // Check the header for the message length, a frame shorter than the header and CRC would never complete
     if (jetiExBusFramePosition == EXBUS_HEADER_LEN) {
 
-        if((jetiExBusFrameState == EXBUS_STATE_IN_PROGRESS) && (jetiExBusFrame[EXBUS_HEADER_MSG_LEN] <= EXBUS_MAX_CHANNEL_FRAME_SIZE)) {
-            jetiExBusFrameLength = jetiExBusFrame[EXBUS_HEADER_MSG_LEN];
+        const uint8_t messageLength = jetiExBusFrame[EXBUS_HEADER_MSG_LEN];
+
+        if((jetiExBusFrameState == EXBUS_STATE_IN_PROGRESS) && (messageLength >= EXBUS_OVERHEAD) && (messageLength <= EXBUS_MAX_CHANNEL_FRAME_SIZE)) {
+            jetiExBusFrameLength = messageLength;
             return;
         }
 
-        if((jetiExBusRequestState == EXBUS_STATE_IN_PROGRESS) && (jetiExBusFrame[EXBUS_HEADER_MSG_LEN] <= EXBUS_MAX_REQUEST_FRAME_SIZE)) {
-            jetiExBusFrameLength = jetiExBusFrame[EXBUS_HEADER_MSG_LEN];
+        if((jetiExBusRequestState == EXBUS_STATE_IN_PROGRESS) && (messageLength >= EXBUS_OVERHEAD) && (messageLength <= EXBUS_MAX_REQUEST_FRAME_SIZE)) {
+            jetiExBusFrameLength = messageLength;
             return;
         }
 
@@ -383,8 +386,11 @@ static void jetiExBusDataReceive(uint16_t c)
 
     // Done?
     if (jetiExBusFrameLength == jetiExBusFramePosition) {
-        if (jetiExBusFrameState == EXBUS_STATE_IN_PROGRESS)
+        if (jetiExBusFrameState == EXBUS_STATE_IN_PROGRESS) {
+            // the CRC is checked over the whole frame in jetiExBusFrameStatus(), too slow for the receive callback
             jetiExBusFrameState = EXBUS_STATE_RECEIVED;
+            jetiExBusFrameTime = micros();
+        }
         if (jetiExBusRequestState == EXBUS_STATE_IN_PROGRESS) {
             jetiExBusRequestState = EXBUS_STATE_RECEIVED;
             jetiTimeStampRequest = micros();
@@ -404,9 +410,11 @@ uint8_t jetiExBusFrameStatus()
     if(calcCRC16(jetiExBusChannelFrame, jetiExBusChannelFrame[EXBUS_HEADER_MSG_LEN]) == 0) {
         jetiExBusDecodeChannelFrame(jetiExBusChannelFrame);
         jetiExBusFrameState = EXBUS_STATE_ZERO;
+        rxSerialFrameReceived(jetiExBusFrameTime);
         return SERIAL_RX_FRAME_COMPLETE;
     } else {
         jetiExBusFrameState = EXBUS_STATE_ZERO;
+        rxSerialFrameError();
         return SERIAL_RX_FRAME_PENDING;
     }
 }
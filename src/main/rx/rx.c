@@ -72,6 +72,17 @@ static bool rxIsInFailsafeMode = true;
 static bool rxIsInFailsafeModeNotDataDriven = true;
 
 static uint32_t rxUpdateAt = 0;
+static volatile uint32_t rxSerialFrameAt = 0;  // set by serial RX receive callbacks when a frame completes
+static uint32_t rxFrameAt = 0;                 // end of the frame being processed
+static uint32_t rxChannelsFrameAt = 0;         // end of the frame the channels were last read from
+static uint8_t rxLatencyNextStage = RX_LATENCY_STAGE_COUNT;
+static uint32_t rxLatency[RX_LATENCY_STAGE_COUNT];
+static volatile bool rxSerialFramePending = false;   // a decoded serial frame has not been read by the RX task yet
+static volatile uint32_t rxSerialFrameErrorCount = 0;
+static volatile uint32_t rxSerialFrameDroppedCount = 0;
+static bool rxStatsFramePending = false;
+static uint32_t rxStatsLastFrameAt = 0;
+static rxStats_t rxStats;
 static uint32_t needRxSignalBefore = 0;
 static uint32_t suspendRxSignalUntil = 0;
 static uint8_t  skipRxSamples = 0;
@@ -298,6 +309,84 @@ uint8_t calculateChannelRemapping(uint8_t *channelMap, uint8_t channelMapEntryCo
     return channelToRemap;
 }
 
+const uint8_t rxIntervalHistogramLimitsMs[RX_INTERVAL_HISTOGRAM_BUCKET_COUNT - 1] = { 5, 10, 15, 20, 25, 30, 50 };
+
+void rxSerialFrameReceived(uint32_t frameEndAt)
+{
+    if (rxSerialFramePending) {
+        rxSerialFrameDroppedCount++;
+    }
+    rxSerialFramePending = true;
+    rxSerialFrameAt = frameEndAt;
+}
+
+void rxSerialFrameError(void)
+{
+    rxSerialFrameErrorCount++;
+}
+
+static void rxStartLatencyMeasurement(uint32_t frameEndAt)
+{
+    rxFrameAt = frameEndAt;
+    rxLatencyNextStage = RX_LATENCY_RX_TASK;
+    rxStatsFramePending = true;
+}
+
+static void rxUpdateStats(void)
+{
+    if (rxStats.frameCount > 0) {
+        const uint32_t intervalMs = (rxFrameAt - rxStatsLastFrameAt) / 1000;
+        uint8_t bucket = 0;
+        while (bucket < RX_INTERVAL_HISTOGRAM_BUCKET_COUNT - 1 && intervalMs >= rxIntervalHistogramLimitsMs[bucket]) {
+            bucket++;
+        }
+        rxStats.intervalHistogram[bucket]++;
+    }
+
+    rxStatsLastFrameAt = rxFrameAt;
+    rxStats.frameCount++;
+    rxStats.errorCount = rxSerialFrameErrorCount;
+    rxStats.droppedCount = rxSerialFrameDroppedCount;
+}
+
+const rxStats_t *rxGetStats(void)
+{
+    return &rxStats;
+}
+
+void rxResetStats(void)
+{
+    rxSerialFrameErrorCount = 0;
+    rxSerialFrameDroppedCount = 0;
+    memset(&rxStats, 0, sizeof(rxStats));
+}
+
+// Each stage is timed once per frame, in order, the first time it is reached after the frame arrived
+void rxRecordLatency(rxLatencyStage_e stage, uint32_t currentTime)
+{
+    if (stage != rxLatencyNextStage) {
+        return;
+    }
+
+    rxLatency[stage] = currentTime - rxFrameAt;
+    rxLatencyNextStage++;
+
+    if (stage == RX_LATENCY_MIXER) {
+        rxStats.frameToMixerUs = rxLatency[stage];
+        rxStats.frameToMixerMaxUs = MAX(rxStats.frameToMixerMaxUs, rxLatency[stage]);
+    }
+}
+
+uint32_t rxGetLatency(rxLatencyStage_e stage)
+{
+    return rxLatency[stage];
+}
+
+uint32_t rxGetFrameTime(void)
+{
+    return rxChannelsFrameAt;
+}
+
 bool rxIsReceivingSignal(void)
 {
     return rxSignalReceived;
@@ -352,9 +441,11 @@ void updateRx(uint32_t currentTime)
 
         if (frameStatus & SERIAL_RX_FRAME_COMPLETE) {
             rxDataReceived = true;
+            rxSerialFramePending = false;
             rxIsInFailsafeMode = (frameStatus & SERIAL_RX_FRAME_FAILSAFE) != 0;
             rxSignalReceived = !rxIsInFailsafeMode;
             needRxSignalBefore = currentTime + DELAY_10_HZ;
+            rxStartLatencyMeasurement(rxSerialFrameAt);
         }
     }
 #endif
@@ -366,6 +457,7 @@ void updateRx(uint32_t currentTime)
             rxSignalReceived = true;
             rxIsInFailsafeMode = false;
             needRxSignalBefore = currentTime + DELAY_10_HZ;
+            rxStartLatencyMeasurement(currentTime);
         }
     }
 #endif
@@ -377,6 +469,7 @@ void updateRx(uint32_t currentTime)
             rxSignalReceived = true;
             rxIsInFailsafeMode = false;
             needRxSignalBefore = currentTime + DELAY_5_HZ;
+            rxStartLatencyMeasurement(currentTime);
         }
     }
 #endif
@@ -585,7 +678,16 @@ void calculateRxChannelsAndUpdateFailsafe(uint32_t currentTime)
     readRxChannelsApplyRanges();
     detectAndApplySignalLossBehaviour();
 
+    // PPM and PWM are sampled on the 50Hz schedule, the sample is the frame
+    rxChannelsFrameAt = isRxDataDriven() ? rxFrameAt : currentTime;
+
     rcSampleIndex++;
+
+    if (rxStatsFramePending) {
+        rxStatsFramePending = false;
+        rxUpdateStats();
+    }
+    rxRecordLatency(RX_LATENCY_RX_TASK, currentTime);
 }
 
 void parseRcChannels(const char *input, rxConfig_t *rxConfig)
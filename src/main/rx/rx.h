@@ -118,7 +118,7 @@ typedef struct rxConfig_s {
     uint8_t rssi_channel;
     uint8_t rssi_scale;
     uint8_t rssi_ppm_invert;
-    uint8_t rcSmoothing;                    // Enable/Disable RC filtering
+    uint8_t rcSmoothing;                    // RC smoothing between frames, see rcSmoothingType_e
     uint16_t midrc;                         // Some radios have not a neutral point centered on 1500. can be changed here
     uint16_t mincheck;                      // minimum rc end
     uint16_t maxcheck;                      // maximum rc end
@@ -159,3 +159,51 @@ void suspendRxSignal(void);
 void resumeRxSignal(void);
 
 void initRxRefreshRate(uint16_t *rxRefreshRatePtr);
+
+// MSP_RX_LATENCY sends the stages in this order, new stages go at the end
+typedef enum {
+    RX_LATENCY_RX_TASK = 0,                 // frame end to the RX task reading the channels
+    RX_LATENCY_RC_COMMAND,                  // frame end to rcCommand being updated
+    RX_LATENCY_MIXER,                       // frame end to mixTable having run
+    RX_LATENCY_MOTOR_OUTPUT,                // frame end to the motors being written
+    RX_LATENCY_STAGE_COUNT
+} rxLatencyStage_e;
+
+void rxSerialFrameReceived(uint32_t frameEndAt);
+
+/*
+ * Serial RX drivers decode frames in their receive callback. The RX task copies the decoded channels
+ * before reading them, again if the callback decoded another frame (and bumped frameCount) meanwhile.
+ */
+static inline void rxSerialCopyChannels(void *dst, const volatile void *src, uint32_t size, const volatile uint8_t *frameCount)
+{
+    uint8_t count;
+
+    do {
+        count = *frameCount;
+        for (uint32_t i = 0; i < size; i++) {
+            ((uint8_t *)dst)[i] = ((const volatile uint8_t *)src)[i];
+        }
+    } while (count != *frameCount);
+}
+void rxSerialFrameError(void);
+void rxRecordLatency(rxLatencyStage_e stage, uint32_t currentTime);
+uint32_t rxGetLatency(rxLatencyStage_e stage);
+uint32_t rxGetFrameTime(void);
+
+#define RX_INTERVAL_HISTOGRAM_BUCKET_COUNT 8
+
+// Upper limits of the frame interval histogram buckets, the last bucket holds everything above the last limit
+extern const uint8_t rxIntervalHistogramLimitsMs[RX_INTERVAL_HISTOGRAM_BUCKET_COUNT - 1];
+
+typedef struct rxStats_s {
+    uint32_t frameCount;                    // frames processed by the RX task
+    uint32_t errorCount;                    // serial RX frames rejected by their checksum or CRC
+    uint32_t droppedCount;                  // serial RX frames replaced by a newer frame before the RX task read them
+    uint32_t frameToMixerUs;                // frame end to mixTable, last frame
+    uint32_t frameToMixerMaxUs;
+    uint32_t intervalHistogram[RX_INTERVAL_HISTOGRAM_BUCKET_COUNT]; // time between consecutive frames
+} rxStats_t;
+
+const rxStats_t *rxGetStats(void);
+void rxResetStats(void);
@@ -72,17 +72,24 @@ static uint16_t sbusStateFlags = 0;
 #define SBUS_DIGITAL_CHANNEL_MIN 173
 #define SBUS_DIGITAL_CHANNEL_MAX 1812
 
-static bool sbusFrameDone = false;
+// Set by the receive callback once a frame has been decoded, cleared when the RX task picks it up
+static volatile uint8_t sbusFrameStatusFlags = SERIAL_RX_FRAME_PENDING;
 static void sbusDataReceive(uint16_t c);
+static uint8_t sbusDecodeFrame(void);
 static uint16_t sbusReadRawRC(rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan);
 
 static uint32_t sbusChannelData[SBUS_MAX_CHANNEL];
+// written by the receive callback
+static volatile uint32_t sbusDecodedChannelData[SBUS_MAX_CHANNEL];
+static volatile uint8_t sbusDecodedFrameCount;
 
 bool sbusInit(rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig, rcReadRawDataPtr *callback)
 {
     int b;
-    for (b = 0; b < SBUS_MAX_CHANNEL; b++)
+    for (b = 0; b < SBUS_MAX_CHANNEL; b++) {
         sbusChannelData[b] = (16 * rxConfig->midrc) / 10 - 1408;
+        sbusDecodedChannelData[b] = sbusChannelData[b];
+    }
     if (callback)
         *callback = sbusReadRawRC;
     rxRuntimeConfig->channelCount = SBUS_MAX_CHANNEL;
@@ -163,55 +170,60 @@ static void sbusDataReceive(uint16_t c)
         sbusFrame.bytes[sbusFramePosition++] = (uint8_t)c;
         if (sbusFramePosition == SBUS_FRAME_SIZE) {
             // endByte currently ignored
-            sbusFrameDone = true;
+            sbusFrameStatusFlags = sbusDecodeFrame();
+            sbusDecodedFrameCount++;
+            rxSerialFrameReceived(now);
 #ifdef DEBUG_SBUS_PACKETS
             debug[2] = sbusFrameTime;
 #endif
-        } else {
-            sbusFrameDone = false;
         }
     }
 }
 
 uint8_t sbusFrameStatus(void)
 {
-    if (!sbusFrameDone) {
-        return SERIAL_RX_FRAME_PENDING;
+    const uint8_t frameStatus = sbusFrameStatusFlags;
+    sbusFrameStatusFlags = SERIAL_RX_FRAME_PENDING;
+    if (frameStatus != SERIAL_RX_FRAME_PENDING) {
+        rxSerialCopyChannels(sbusChannelData, sbusDecodedChannelData, sizeof(sbusChannelData), &sbusDecodedFrameCount);
     }
-    sbusFrameDone = false;
+    return frameStatus;
+}
 
+static uint8_t sbusDecodeFrame(void)
+{
 #ifdef DEBUG_SBUS_PACKETS
     sbusStateFlags = 0;
     debug[1] = sbusFrame.frame.flags;
 #endif
 
-    sbusChannelData[0] = sbusFrame.frame.chan0;
-    sbusChannelData[1] = sbusFrame.frame.chan1;
-    sbusChannelData[2] = sbusFrame.frame.chan2;
-    sbusChannelData[3] = sbusFrame.frame.chan3;
-    sbusChannelData[4] = sbusFrame.frame.chan4;
-    sbusChannelData[5] = sbusFrame.frame.chan5;
-    sbusChannelData[6] = sbusFrame.frame.chan6;
-    sbusChannelData[7] = sbusFrame.frame.chan7;
-    sbusChannelData[8] = sbusFrame.frame.chan8;
-    sbusChannelData[9] = sbusFrame.frame.chan9;
-    sbusChannelData[10] = sbusFrame.frame.chan10;
-    sbusChannelData[11] = sbusFrame.frame.chan11;
-    sbusChannelData[12] = sbusFrame.frame.chan12;
-    sbusChannelData[13] = sbusFrame.frame.chan13;
-    sbusChannelData[14] = sbusFrame.frame.chan14;
-    sbusChannelData[15] = sbusFrame.frame.chan15;
+    sbusDecodedChannelData[0] = sbusFrame.frame.chan0;
+    sbusDecodedChannelData[1] = sbusFrame.frame.chan1;
+    sbusDecodedChannelData[2] = sbusFrame.frame.chan2;
+    sbusDecodedChannelData[3] = sbusFrame.frame.chan3;
+    sbusDecodedChannelData[4] = sbusFrame.frame.chan4;
+    sbusDecodedChannelData[5] = sbusFrame.frame.chan5;
+    sbusDecodedChannelData[6] = sbusFrame.frame.chan6;
+    sbusDecodedChannelData[7] = sbusFrame.frame.chan7;
+    sbusDecodedChannelData[8] = sbusFrame.frame.chan8;
+    sbusDecodedChannelData[9] = sbusFrame.frame.chan9;
+    sbusDecodedChannelData[10] = sbusFrame.frame.chan10;
+    sbusDecodedChannelData[11] = sbusFrame.frame.chan11;
+    sbusDecodedChannelData[12] = sbusFrame.frame.chan12;
+    sbusDecodedChannelData[13] = sbusFrame.frame.chan13;
+    sbusDecodedChannelData[14] = sbusFrame.frame.chan14;
+    sbusDecodedChannelData[15] = sbusFrame.frame.chan15;
 
     if (sbusFrame.frame.flags & SBUS_FLAG_CHANNEL_17) {
-        sbusChannelData[16] = SBUS_DIGITAL_CHANNEL_MAX;
+        sbusDecodedChannelData[16] = SBUS_DIGITAL_CHANNEL_MAX;
     } else {
-        sbusChannelData[16] = SBUS_DIGITAL_CHANNEL_MIN;
+        sbusDecodedChannelData[16] = SBUS_DIGITAL_CHANNEL_MIN;
     }
 
     if (sbusFrame.frame.flags & SBUS_FLAG_CHANNEL_18) {
-        sbusChannelData[17] = SBUS_DIGITAL_CHANNEL_MAX;
+        sbusDecodedChannelData[17] = SBUS_DIGITAL_CHANNEL_MAX;
     } else {
-        sbusChannelData[17] = SBUS_DIGITAL_CHANNEL_MIN;
+        sbusDecodedChannelData[17] = SBUS_DIGITAL_CHANNEL_MIN;
     }
 
     if (sbusFrame.frame.flags & SBUS_FLAG_SIGNAL_LOSS) {
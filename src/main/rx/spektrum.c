@@ -49,12 +49,17 @@
 
 static uint8_t spek_chan_shift;
 static uint8_t spek_chan_mask;
-static bool rcFrameComplete = false;
+// Set by the receive callback once a frame has been decoded, cleared when the RX task picks it up
+static volatile uint8_t spekFrameStatusFlags = SERIAL_RX_FRAME_PENDING;
 static bool spekHiRes = false;
 
 static volatile uint8_t spekFrame[SPEK_FRAME_SIZE];
+// written by the receive callback, a frame may only carry some of the channels
+static volatile uint32_t spekDecodedChannelData[SPEKTRUM_MAX_SUPPORTED_CHANNEL_COUNT];
+static volatile uint8_t spekDecodedFrameCount;
 
 static void spektrumDataReceive(uint16_t c);
+static uint8_t spektrumDecodeFrame(void);
 static uint16_t spektrumReadRawRC(rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan);
 
 static rxRuntimeConfig_t *rxRuntimeConfigPtr;
@@ -111,9 +116,9 @@ static void spektrumDataReceive(uint16_t c)
     if (spekFramePosition < SPEK_FRAME_SIZE) {
         spekFrame[spekFramePosition++] = (uint8_t)c;
         if (spekFramePosition == SPEK_FRAME_SIZE) {
-            rcFrameComplete = true;
-        } else {
-            rcFrameComplete = false;
+            spekFrameStatusFlags = spektrumDecodeFrame();
+            spekDecodedFrameCount++;
+            rxSerialFrameReceived(spekTime);
         }
     }
 }
@@ -122,18 +127,22 @@ static uint32_t spekChannelData[SPEKTRUM_MAX_SUPPORTED_CHANNEL_COUNT];
 
 uint8_t spektrumFrameStatus(void)
 {
-    uint8_t b;
-
-    if (!rcFrameComplete) {
-        return SERIAL_RX_FRAME_PENDING;
+    const uint8_t frameStatus = spekFrameStatusFlags;
+    spekFrameStatusFlags = SERIAL_RX_FRAME_PENDING;
+    if (frameStatus != SERIAL_RX_FRAME_PENDING) {
+        rxSerialCopyChannels(spekChannelData, spekDecodedChannelData, sizeof(spekChannelData), &spekDecodedFrameCount);
     }
+    return frameStatus;
+}
 
-    rcFrameComplete = false;
+static uint8_t spektrumDecodeFrame(void)
+{
+    uint8_t b;
 
     for (b = 3; b < SPEK_FRAME_SIZE; b += 2) {
         uint8_t spekChannel = 0x0F & (spekFrame[b - 1] >> spek_chan_shift);
         if (spekChannel < rxRuntimeConfigPtr->channelCount && spekChannel < SPEKTRUM_MAX_SUPPORTED_CHANNEL_COUNT) {
-            spekChannelData[spekChannel] = ((uint32_t)(spekFrame[b - 1] & spek_chan_mask) << 8) + spekFrame[b];
+            spekDecodedChannelData[spekChannel] = ((uint32_t)(spekFrame[b - 1] & spek_chan_mask) << 8) + spekFrame[b];
         }
     }
 
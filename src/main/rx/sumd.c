@@ -42,11 +42,16 @@
 
 #define SUMD_BAUDRATE 115200
 
-static bool sumdFrameDone = false;
+// Set by the receive callback once a frame has been decoded, cleared when the RX task picks it up
+static volatile uint8_t sumdFrameStatusFlags = SERIAL_RX_FRAME_PENDING;
 static uint16_t sumdChannels[SUMD_MAX_CHANNEL];
+// written by the receive callback
+static volatile uint16_t sumdDecodedChannels[SUMD_MAX_CHANNEL];
+static volatile uint8_t sumdDecodedFrameCount;
 static uint16_t crc;
 
 static void sumdDataReceive(uint16_t c);
+static uint8_t sumdDecodeFrame(void);
 static uint16_t sumdReadRawRC(rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan);
 
 bool sumdInit(rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig, rcReadRawDataPtr *callback)
@@ -104,12 +109,17 @@ static void sumdDataReceive(uint16_t c)
             return;
         else
         {
-            sumdFrameDone = false; // lazy main loop didnt fetch the stuff
             crc = 0;
         }
     }
-    if (sumdIndex == 2)
+    if (sumdIndex == 2) {
+        // a frame with more channels than the buffer holds is noise, the CRC would be read from past its end
+        if (c > SUMD_MAX_CHANNEL) {
+            sumdIndex = 0;
+            return;
+        }
         sumdChannelCount = (uint8_t)c;
+    }
     if (sumdIndex < SUMD_BUFFSIZE)
         sumd[sumdIndex] = (uint8_t)c;
     sumdIndex++;
@@ -118,7 +128,12 @@ static void sumdDataReceive(uint16_t c)
     else
         if (sumdIndex == sumdChannelCount * 2 + 5) {
             sumdIndex = 0;
-            sumdFrameDone = true;
+            const uint8_t frameStatus = sumdDecodeFrame();
+            if (frameStatus != SERIAL_RX_FRAME_PENDING) {
+                sumdFrameStatusFlags = frameStatus;
+                sumdDecodedFrameCount++;
+                rxSerialFrameReceived(sumdTime);
+            }
         }
 }
 
@@ -131,21 +146,27 @@ static void sumdDataReceive(uint16_t c)
 #define SUMD_FRAME_STATE_FAILSAFE 0x81
 
 uint8_t sumdFrameStatus(void)
+{
+    const uint8_t frameStatus = sumdFrameStatusFlags;
+    sumdFrameStatusFlags = SERIAL_RX_FRAME_PENDING;
+    if (frameStatus != SERIAL_RX_FRAME_PENDING) {
+        rxSerialCopyChannels(sumdChannels, sumdDecodedChannels, sizeof(sumdChannels), &sumdDecodedFrameCount);
+    }
+    return frameStatus;
+}
+
+static uint8_t sumdDecodeFrame(void)
 {
     uint8_t channelIndex;
 
     uint8_t frameStatus = SERIAL_RX_FRAME_PENDING;
 
-    if (!sumdFrameDone) {
-        return frameStatus;
-    }
-
-    sumdFrameDone = false;
-
     // verify CRC
     if (crc != ((sumd[SUMD_BYTES_PER_CHANNEL * sumdChannelCount + SUMD_OFFSET_CHANNEL_1_HIGH] << 8) |
-            (sumd[SUMD_BYTES_PER_CHANNEL * sumdChannelCount + SUMD_OFFSET_CHANNEL_1_LOW])))
+            (sumd[SUMD_BYTES_PER_CHANNEL * sumdChannelCount + SUMD_OFFSET_CHANNEL_1_LOW]))) {
+        rxSerialFrameError();
         return frameStatus;
+    }
 
     switch (sumd[1]) {
         case SUMD_FRAME_STATE_FAILSAFE:
@@ -162,7 +183,7 @@ uint8_t sumdFrameStatus(void)
         sumdChannelCount = SUMD_MAX_CHANNEL;
 
     for (channelIndex = 0; channelIndex < sumdChannelCount; channelIndex++) {
-        sumdChannels[channelIndex] = (
+        sumdDecodedChannels[channelIndex] = (
             (sumd[SUMD_BYTES_PER_CHANNEL * channelIndex + SUMD_OFFSET_CHANNEL_1_HIGH] << 8) |
             sumd[SUMD_BYTES_PER_CHANNEL * channelIndex + SUMD_OFFSET_CHANNEL_1_LOW]
         );
@@ -45,13 +45,18 @@
 #define SUMH_MAX_CHANNEL_COUNT 8
 #define SUMH_FRAME_SIZE 21
 
-static bool sumhFrameDone = false;
+// Set by the receive callback once a frame has been decoded, cleared when the RX task picks it up
+static volatile uint8_t sumhFrameStatusFlags = SERIAL_RX_FRAME_PENDING;
 
 static uint8_t sumhFrame[SUMH_FRAME_SIZE];
 static uint32_t sumhChannels[SUMH_MAX_CHANNEL_COUNT];
+// written by the receive callback
+static volatile uint32_t sumhDecodedChannels[SUMH_MAX_CHANNEL_COUNT];
+static volatile uint8_t sumhDecodedFrameCount;
 
 static void sumhDataReceive(uint16_t c);
 static uint16_t sumhReadRawRC(rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan);
+static uint8_t sumhDecodeFrame(void);
 
 static serialPort_t *sumhPort;
 
@@ -97,7 +102,12 @@ static void sumhDataReceive(uint16_t c)
     sumhFrame[sumhFramePosition] = (uint8_t) c;
     if (sumhFramePosition == SUMH_FRAME_SIZE - 1) {
         // FIXME at this point the value of 'c' is unused and un tested, what should it be, is it important?
-        sumhFrameDone = true;
+        const uint8_t frameStatus = sumhDecodeFrame();
+        if (frameStatus != SERIAL_RX_FRAME_PENDING) {
+            sumhFrameStatusFlags = frameStatus;
+            sumhDecodedFrameCount++;
+            rxSerialFrameReceived(sumhTime);
+        }
     } else {
         sumhFramePosition++;
     }
@@ -105,20 +115,25 @@ static void sumhDataReceive(uint16_t c)
 
 uint8_t sumhFrameStatus(void)
 {
-    uint8_t channelIndex;
-
-    if (!sumhFrameDone) {
-        return SERIAL_RX_FRAME_PENDING;
+    const uint8_t frameStatus = sumhFrameStatusFlags;
+    sumhFrameStatusFlags = SERIAL_RX_FRAME_PENDING;
+    if (frameStatus != SERIAL_RX_FRAME_PENDING) {
+        rxSerialCopyChannels(sumhChannels, sumhDecodedChannels, sizeof(sumhChannels), &sumhDecodedFrameCount);
     }
+    return frameStatus;
+}
 
-    sumhFrameDone = false;
+static uint8_t sumhDecodeFrame(void)
+{
+    uint8_t channelIndex;
 
     if (!((sumhFrame[0] == 0xA8) && (sumhFrame[SUMH_FRAME_SIZE - 2] == 0))) {
+        rxSerialFrameError();
         return SERIAL_RX_FRAME_PENDING;
     }
 
     for (channelIndex = 0; channelIndex < SUMH_MAX_CHANNEL_COUNT; channelIndex++) {
-        sumhChannels[channelIndex] = (((uint32_t)(sumhFrame[(channelIndex << 1) + 3]) << 8)
+        sumhDecodedChannels[channelIndex] = (((uint32_t)(sumhFrame[(channelIndex << 1) + 3]) << 8)
                 + sumhFrame[(channelIndex << 1) + 4]) / 6.4f - 375;
     }
     return SERIAL_RX_FRAME_COMPLETE;
@@ -200,6 +200,9 @@ static void xBusUnpackModeBFrame(uint8_t offsetBytes)
         }
 
         xBusFrameReceived = true;
+        rxSerialFrameReceived(micros());
+    } else {
+        rxSerialFrameError();
     }
 
 }
@@ -244,6 +247,7 @@ static void xBusUnpackRJ01Frame(void)
     if (outerCrc != xBusFrame[xBusFrameLength - 1])
     {
         // CRC does not match, skip this frame
+        rxSerialFrameError();
         return;
     }
 
@@ -283,8 +287,10 @@ static void xBusDataReceive(uint16_t c)
         switch (xBusProvider) {
             case SERIALRX_XBUS_MODE_B:
                 xBusUnpackModeBFrame(0);
+                break;
             case SERIALRX_XBUS_MODE_B_RJ01:
                 xBusUnpackRJ01Frame();
+                break;
         }
         xBusDataIncoming = false;
         xBusFramePosition = 0;
@@ -27,14 +27,47 @@
 
 #include "boardalignment.h"
 
+#define ALIGNMENT_CACHE_SIZE 3         // gyro, acc and mag
+
+// Sensor rotation followed by the board alignment, dest[i] = sum(matrix[i][j] * src[j])
+typedef struct sensorAlignment_s {
+    float matrix[3][3];                 // used with a custom board alignment
+    int8_t rotationMatrix[3][3];        // sensor rotation only, exact for the standard board alignment
+    uint8_t rotation;
+    bool valid;
+} sensorAlignment_t;
+
 static bool standardBoardAlignment = true;     // board orientation correction
 static float boardRotation[3][3];              // matrix
 
+static sensorAlignment_t alignmentCache[ALIGNMENT_CACHE_SIZE];
+static uint8_t alignmentCacheNext;
+
+// Rows are the destination axes, ALIGN_DEFAULT and unknown rotations are treated as CW0_DEG
+static const int8_t sensorRotations[CW270_DEG_FLIP + 1][3][3] = {
+    [ALIGN_DEFAULT]  = { {  1,  0,  0 }, {  0,  1,  0 }, {  0,  0,  1 } },
+    [CW0_DEG]        = { {  1,  0,  0 }, {  0,  1,  0 }, {  0,  0,  1 } },
+    [CW90_DEG]       = { {  0,  1,  0 }, { -1,  0,  0 }, {  0,  0,  1 } },
+    [CW180_DEG]      = { { -1,  0,  0 }, {  0, -1,  0 }, {  0,  0,  1 } },
+    [CW270_DEG]      = { {  0, -1,  0 }, {  1,  0,  0 }, {  0,  0,  1 } },
+    [CW0_DEG_FLIP]   = { { -1,  0,  0 }, {  0,  1,  0 }, {  0,  0, -1 } },
+    [CW90_DEG_FLIP]  = { {  0,  1,  0 }, {  1,  0,  0 }, {  0,  0, -1 } },
+    [CW180_DEG_FLIP] = { {  1,  0,  0 }, {  0, -1,  0 }, {  0,  0, -1 } },
+    [CW270_DEG_FLIP] = { {  0, -1,  0 }, { -1,  0,  0 }, {  0,  0, -1 } },
+};
+
 static bool isBoardAlignmentStandard(boardAlignment_t *boardAlignment)
 {
     return !boardAlignment->rollDeciDegrees && !boardAlignment->pitchDeciDegrees && !boardAlignment->yawDeciDegrees;
 }
 
+static void invalidateSensorAlignments(void)
+{
+    for (int i = 0; i < ALIGNMENT_CACHE_SIZE; i++) {
+        alignmentCache[i].valid = false;
+    }
+}
+
 void initBoardAlignment(boardAlignment_t *boardAlignment)
 {
     if (isBoardAlignmentStandard(boardAlignment)) {
@@ -51,6 +84,8 @@ void initBoardAlignment(boardAlignment_t *boardAlignment)
 
         buildRotationMatrix(&rotationAngles, boardRotation);
     }
+
+    invalidateSensorAlignments();
 }
 
 void updateBoardAlignment(boardAlignment_t *boardAlignment, int16_t roll, int16_t pitch)
@@ -64,66 +99,63 @@ void updateBoardAlignment(boardAlignment_t *boardAlignment, int16_t roll, int16_
     initBoardAlignment(boardAlignment);
 }
 
-static void alignBoard(int32_t *vec)
+static void buildSensorAlignment(sensorAlignment_t *alignment, uint8_t rotation)
 {
-    int32_t x = vec[X];
-    int32_t y = vec[Y];
-    int32_t z = vec[Z];
+    const int8_t (*sensorRotation)[3] = sensorRotations[rotation <= CW270_DEG_FLIP ? rotation : CW0_DEG];
+
+    memcpy(alignment->rotationMatrix, sensorRotation, sizeof(alignment->rotationMatrix));
+
+    // the board rotation is applied as boardRotation[axis][i] * v[axis], i.e. transposed
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            alignment->matrix[i][j] = boardRotation[X][i] * sensorRotation[X][j]
+                                    + boardRotation[Y][i] * sensorRotation[Y][j]
+                                    + boardRotation[Z][i] * sensorRotation[Z][j];
+        }
+    }
 
-    vec[X] = lrintf(boardRotation[0][X] * x + boardRotation[1][X] * y + boardRotation[2][X] * z);
-    vec[Y] = lrintf(boardRotation[0][Y] * x + boardRotation[1][Y] * y + boardRotation[2][Y] * z);
-    vec[Z] = lrintf(boardRotation[0][Z] * x + boardRotation[1][Z] * y + boardRotation[2][Z] * z);
+    alignment->rotation = rotation;
+    alignment->valid = true;
 }
 
-void alignSensors(int32_t *src, int32_t *dest, uint8_t rotation)
+/*
+ * Every sensor uses one rotation, so a handful of matrices cover all of them.
+ * They are built the first time a rotation is used after the board alignment changed.
+ */
+static const sensorAlignment_t *getSensorAlignment(uint8_t rotation)
 {
-    static uint32_t swap[3];
-    memcpy(swap, src, sizeof(swap));
-
-    switch (rotation) {
-        default:
-        case CW0_DEG:
-            dest[X] = swap[X];
-            dest[Y] = swap[Y];
-            dest[Z] = swap[Z];
-            break;
-        case CW90_DEG:
-            dest[X] = swap[Y];
-            dest[Y] = -swap[X];
-            dest[Z] = swap[Z];
-            break;
-        case CW180_DEG:
-            dest[X] = -swap[X];
-            dest[Y] = -swap[Y];
-            dest[Z] = swap[Z];
-            break;
-        case CW270_DEG:
-            dest[X] = -swap[Y];
-            dest[Y] = swap[X];
-            dest[Z] = swap[Z];
-            break;
-        case CW0_DEG_FLIP:
-            dest[X] = -swap[X];
-            dest[Y] = swap[Y];
-            dest[Z] = -swap[Z];
-            break;
-        case CW90_DEG_FLIP:
-            dest[X] = swap[Y];
-            dest[Y] = swap[X];
-            dest[Z] = -swap[Z];
-            break;
-        case CW180_DEG_FLIP:
-            dest[X] = swap[X];
-            dest[Y] = -swap[Y];
-            dest[Z] = -swap[Z];
-            break;
-        case CW270_DEG_FLIP:
-            dest[X] = -swap[Y];
-            dest[Y] = -swap[X];
-            dest[Z] = -swap[Z];
-            break;
+    for (int i = 0; i < ALIGNMENT_CACHE_SIZE; i++) {
+        if (alignmentCache[i].valid && alignmentCache[i].rotation == rotation) {
+            return &alignmentCache[i];
+        }
     }
 
-    if (!standardBoardAlignment)
-        alignBoard(dest);
+    sensorAlignment_t *alignment = &alignmentCache[alignmentCacheNext];
+    alignmentCacheNext = (alignmentCacheNext + 1) % ALIGNMENT_CACHE_SIZE;
+
+    buildSensorAlignment(alignment, rotation);
+
+    return alignment;
+}
+
+void alignSensors(int32_t *src, int32_t *dest, uint8_t rotation)
+{
+    const sensorAlignment_t *alignment = getSensorAlignment(rotation);
+    const int32_t x = src[X];
+    const int32_t y = src[Y];
+    const int32_t z = src[Z];
+
+    if (standardBoardAlignment) {
+        const int8_t (*m)[3] = alignment->rotationMatrix;
+
+        dest[X] = m[X][X] * x + m[X][Y] * y + m[X][Z] * z;
+        dest[Y] = m[Y][X] * x + m[Y][Y] * y + m[Y][Z] * z;
+        dest[Z] = m[Z][X] * x + m[Z][Y] * y + m[Z][Z] * z;
+    } else {
+        const float (*m)[3] = alignment->matrix;
+
+        dest[X] = lrintf(m[X][X] * x + m[X][Y] * y + m[X][Z] * z);
+        dest[Y] = lrintf(m[Y][X] * x + m[Y][Y] * y + m[Y][Z] * z);
+        dest[Z] = lrintf(m[Z][X] * x + m[Z][Y] * y + m[Z][Z] * z);
+    }
 }
@@ -19,8 +19,6 @@
 
 #define TARGET_BOARD_IDENTIFIER "REVO"
 
-#define CONFIG_START_FLASH_ADDRESS (0x08080000) //0x08080000 to 0x080A0000 (FLASH_Sector_8)
-
 #define USBD_PRODUCT_STRING "Revolution"
 #ifdef OPBL
 #define USBD_SERIALNUMBER_STRING "0x8020000"
@@ -24,6 +24,11 @@
 #define SERIAL_RX
 #define USE_CLI
 
+#if defined(STM32F3)
+#define USE_DSHOT
+#define USE_MPU_FIFO
+#endif
+
 #if (FLASH_SIZE <= 64)
 #define SKIP_TASK_STATISTICS
 #define SKIP_CLI_COMMAND_HELP
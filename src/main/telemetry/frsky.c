@@ -58,13 +58,16 @@
 #include "config/config.h"
 
 #include "telemetry/telemetry.h"
+#include "telemetry/telemetry_scheduler.h"
 #include "telemetry/frsky.h"
 
 static serialPort_t *frskyPort = NULL;
 static serialPortConfig_t *portConfig;
 
 #define FRSKY_BAUDRATE 9600
+#define FRSKY_BITS_PER_BYTE 10
 #define FRSKY_INITIAL_PORT_MODE MODE_TX
+#define FRSKY_BURST_BYTES 96                // must hold the largest item
 
 static telemetryConfig_t *telemetryConfig;
 static bool frskyTelemetryEnabled =  false;
@@ -75,8 +78,6 @@ extern batteryConfig_t *batteryConfig;
 
 extern int16_t telemTemperature1; // FIXME dependency on mw.c
 
-#define CYCLETIME             125
-
 #define PROTOCOL_HEADER       0x5E
 #define PROTOCOL_TAIL         0x5E
 
@@ -124,30 +125,64 @@ extern int16_t telemTemperature1; // FIXME dependency on mw.c
 #define DELAY_FOR_BARO_INITIALISATION (5 * 1000) //5s
 #define BLADE_NUMBER_DIVIDER  5 // should set 12 blades in Taranis
 
-static uint32_t lastCycleTime = 0;
-static uint8_t cycleNum = 0;
+// Worst case bytes for a value: header, id and two stuffed data bytes
+#define FRSKY_VALUE_MAX_SIZE 6
+#define FRSKY_ITEM_MAX_SIZE(values) ((values) * FRSKY_VALUE_MAX_SIZE + 1)
+
+typedef enum {
+    FRSKY_ITEM_ACCEL = 0,
+    FRSKY_ITEM_VARIO,
+    FRSKY_ITEM_HEADING,
+    FRSKY_ITEM_BARO,
+    FRSKY_ITEM_BATTERY,
+    FRSKY_ITEM_GPS,
+    FRSKY_ITEM_TEMPERATURE_RPM,
+    FRSKY_ITEM_TIME,
+    FRSKY_ITEM_COUNT
+} frskyItem_e;
+
+static telemetryItem_t frskyItems[FRSKY_ITEM_COUNT] = {
+    [FRSKY_ITEM_ACCEL]           = { .intervalMs = 125,  .priority = TELEMETRY_PRIORITY_HIGH,   .maxSize = FRSKY_ITEM_MAX_SIZE(3) },
+    [FRSKY_ITEM_VARIO]           = { .intervalMs = 125,  .priority = TELEMETRY_PRIORITY_HIGH,   .maxSize = FRSKY_ITEM_MAX_SIZE(1) },
+    [FRSKY_ITEM_HEADING]         = { .intervalMs = 500,  .priority = TELEMETRY_PRIORITY_HIGH,   .maxSize = FRSKY_ITEM_MAX_SIZE(2) },
+    [FRSKY_ITEM_BARO]            = { .intervalMs = 500,  .priority = TELEMETRY_PRIORITY_NORMAL, .maxSize = FRSKY_ITEM_MAX_SIZE(2) },
+    [FRSKY_ITEM_BATTERY]         = { .intervalMs = 1000, .priority = TELEMETRY_PRIORITY_HIGH,   .maxSize = FRSKY_ITEM_MAX_SIZE(5) },
+    [FRSKY_ITEM_GPS]             = { .intervalMs = 1000, .priority = TELEMETRY_PRIORITY_HIGH,   .maxSize = FRSKY_ITEM_MAX_SIZE(11) },
+    [FRSKY_ITEM_TEMPERATURE_RPM] = { .intervalMs = 1000, .priority = TELEMETRY_PRIORITY_LOW,    .maxSize = FRSKY_ITEM_MAX_SIZE(2) },
+    [FRSKY_ITEM_TIME]            = { .intervalMs = 5000, .priority = TELEMETRY_PRIORITY_LOW,    .maxSize = FRSKY_ITEM_MAX_SIZE(2) },
+};
+
+static telemetryLink_t frskyLink;
+static uint16_t frskyBytesWritten;
+
+static void frskyWrite(uint8_t data)
+{
+    serialWrite(frskyPort, data);
+    frskyBytesWritten++;
+}
+
 static void sendDataHead(uint8_t id)
 {
-    serialWrite(frskyPort, PROTOCOL_HEADER);
-    serialWrite(frskyPort, id);
+    frskyWrite(PROTOCOL_HEADER);
+    frskyWrite(id);
 }
 
 static void sendTelemetryTail(void)
 {
-    serialWrite(frskyPort, PROTOCOL_TAIL);
+    frskyWrite(PROTOCOL_TAIL);
 }
 
 static void serializeFrsky(uint8_t data)
 {
     // take care of byte stuffing
     if (data == 0x5e) {
-        serialWrite(frskyPort, 0x5d);
-        serialWrite(frskyPort, 0x3e);
+        frskyWrite(0x5d);
+        frskyWrite(0x3e);
     } else if (data == 0x5d) {
-        serialWrite(frskyPort, 0x5d);
-        serialWrite(frskyPort, 0x3d);
+        frskyWrite(0x5d);
+        frskyWrite(0x3d);
     } else
-        serialWrite(frskyPort, data);
+        frskyWrite(data);
 }
 
 static void serialize16(int16_t a)
@@ -221,7 +256,7 @@ static void sendTemperature1(void)
 static void sendSatalliteSignalQualityAsTemperature2(void)
 {
     uint16_t satellite = gpsSol.numSat;
-    if (gpsSol.hdop > GPS_BAD_QUALITY && ( (cycleNum % 16 ) < 8)) {//Every 1s
+    if (gpsSol.hdop > GPS_BAD_QUALITY && ((millis() / 1000) & 1) == 0) {//Every 1s
         satellite = constrain(gpsSol.hdop, 0, GPS_MAX_HDOP_VAL);
     }
     sendDataHead(ID_TEMPRATURE2);
@@ -466,12 +501,10 @@ void configureFrSkyTelemetryPort(void)
         return;
     }
 
-    frskyTelemetryEnabled = true;
-}
+    telemetryLinkInit(&frskyLink, FRSKY_BAUDRATE, FRSKY_BITS_PER_BYTE, FRSKY_BURST_BYTES);
+    frskyLink.lastRefillAt = micros();
 
-bool hasEnoughTimeLapsedSinceLastTelemetryTransmission(uint32_t currentMillis)
-{
-    return currentMillis - lastCycleTime >= CYCLETIME;
+    frskyTelemetryEnabled = true;
 }
 
 void checkFrSkyTelemetryState(void)
@@ -488,46 +521,37 @@ void checkFrSkyTelemetryState(void)
         freeFrSkyTelemetryPort();
 }
 
-void handleFrSkyTelemetry(rxConfig_t *rxConfig, uint16_t deadband3d_throttle)
+static void sendFrSkyItem(frskyItem_e item, rxConfig_t *rxConfig, uint16_t deadband3d_throttle)
 {
-    if (!frskyTelemetryEnabled) {
-        return;
-    }
+    switch (item) {
+    case FRSKY_ITEM_ACCEL:
+        sendAccel();
+        break;
 
-    uint32_t now = millis();
+    case FRSKY_ITEM_VARIO:
+        sendVario();
+        break;
 
-    if (!hasEnoughTimeLapsedSinceLastTelemetryTransmission(now)) {
-        return;
-    }
-
-    lastCycleTime = now;
-
-    cycleNum++;
-
-    // Sent every 125ms
-    sendAccel();
-    sendVario();
-    sendTelemetryTail();
+    case FRSKY_ITEM_HEADING:
+        sendHeading();
+        break;
 
-    if ((cycleNum % 4) == 0) {      // Sent every 500ms
-        if (lastCycleTime > DELAY_FOR_BARO_INITIALISATION) { //Allow 5s to boot correctly
+    case FRSKY_ITEM_BARO:
+        if (millis() > DELAY_FOR_BARO_INITIALISATION) { //Allow 5s to boot correctly
             sendBaro();
         }
-        sendHeading();
-        sendTelemetryTail();
-    }
-
-    if ((cycleNum % 8) == 0) {      // Sent every 1s
-        sendTemperature1();
-        sendThrottleOrBatterySizeAsRpm(rxConfig, deadband3d_throttle);
+        break;
 
+    case FRSKY_ITEM_BATTERY:
         if (feature(FEATURE_VBAT)) {
             sendVoltage();
             sendVoltageAmp();
             sendAmperage();
             sendFuelLevel();
         }
+        break;
 
+    case FRSKY_ITEM_GPS:
 #ifdef GPS
         if (sensors(SENSOR_GPS)) {
             sendSpeed();
@@ -541,15 +565,47 @@ void handleFrSkyTelemetry(rxConfig_t *rxConfig, uint16_t deadband3d_throttle)
 #else
         sendFakeLatLongThatAllowsHeadingDisplay();
 #endif
+        break;
 
-        sendTelemetryTail();
-    }
+    case FRSKY_ITEM_TEMPERATURE_RPM:
+        sendTemperature1();
+        sendThrottleOrBatterySizeAsRpm(rxConfig, deadband3d_throttle);
+        break;
 
-    if (cycleNum == 40) {     //Frame 3: Sent every 5s
-        cycleNum = 0;
+    case FRSKY_ITEM_TIME:
         sendTime();
+        break;
+
+    default:
+        return;
+    }
+
+    if (frskyBytesWritten > 0) {
         sendTelemetryTail();
     }
 }
 
+void handleFrSkyTelemetry(rxConfig_t *rxConfig, uint16_t deadband3d_throttle)
+{
+    if (!frskyTelemetryEnabled) {
+        return;
+    }
+
+    telemetryLinkRefill(&frskyLink, micros());
+
+    const uint32_t now = millis();
+    int item;
+
+    while ((item = telemetryScheduleNextItem(&frskyLink, frskyItems, FRSKY_ITEM_COUNT, now)) != TELEMETRY_NO_ITEM) {
+        // the link budget follows the line rate, the TX buffer may still hold bytes from a port shared with MSP
+        if (serialTxBytesFree(frskyPort) < frskyItems[item].maxSize) {
+            break;
+        }
+
+        frskyBytesWritten = 0;
+        sendFrSkyItem(item, rxConfig, deadband3d_throttle);
+        telemetryScheduleItemSent(&frskyLink, &frskyItems[item], frskyBytesWritten, now);
+    }
+}
+
 #endif
@@ -71,12 +71,18 @@
 #include "flight/navigation_rewrite.h"
 
 #include "telemetry/telemetry.h"
+#include "telemetry/telemetry_scheduler.h"
 #include "telemetry/ltm.h"
 
 #include "config/config.h"
 
 #define TELEMETRY_LTM_INITIAL_PORT_MODE MODE_TX
-#define LTM_CYCLETIME   100
+#define LTM_BITS_PER_BYTE 10
+#define LTM_BURST_BYTES 32              // must hold the largest frame
+#define LTM_FAST_MIN_BAUDRATE 57600
+
+// '$', 'T', frame id, payload, crc
+#define LTM_FRAME_SIZE(payload) (3 + (payload) + 1)
 
 extern uint16_t rssi;           // FIXME dependency on mw.c
 static serialPort_t *ltmPort;
@@ -280,68 +286,126 @@ static bool ltm_shouldSendXFrame(void)
     return false;
 }
 
-#define LTM_BIT_AFRAME  (1 << 0)
-#define LTM_BIT_GFRAME  (1 << 1)
-#define LTM_BIT_SFRAME  (1 << 2)
-#define LTM_BIT_OFRAME  (1 << 3)
-#define LTM_BIT_NFRAME  (1 << 4)
-#define LTM_BIT_XFRAME  (1 << 5)
-
-static uint8_t ltm_schedule[10] = {
-    LTM_BIT_AFRAME | LTM_BIT_GFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_SFRAME | LTM_BIT_OFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_GFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_SFRAME | LTM_BIT_NFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_GFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_SFRAME | LTM_BIT_XFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_GFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_SFRAME | LTM_BIT_NFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_GFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_SFRAME | LTM_BIT_NFRAME
+typedef enum {
+    LTM_AFRAME = 0,
+    LTM_SFRAME,
+    LTM_GFRAME,
+    LTM_NFRAME,
+    LTM_OFRAME,
+    LTM_XFRAME,
+    LTM_FRAME_COUNT
+} ltmFrame_e;
+
+// Attitude and status (arming, battery, failsafe) keep their rate on a slow link, home and GPS extra go first
+static const uint8_t ltmFramePriorities[LTM_FRAME_COUNT] = {
+    [LTM_AFRAME] = TELEMETRY_PRIORITY_HIGH,
+    [LTM_SFRAME] = TELEMETRY_PRIORITY_HIGH,
+    [LTM_GFRAME] = TELEMETRY_PRIORITY_NORMAL,
+    [LTM_NFRAME] = TELEMETRY_PRIORITY_NORMAL,
+    [LTM_OFRAME] = TELEMETRY_PRIORITY_LOW,
+    [LTM_XFRAME] = TELEMETRY_PRIORITY_LOW
+};
+
+static const uint8_t ltmFrameSizes[LTM_FRAME_COUNT] = {
+    [LTM_AFRAME] = LTM_FRAME_SIZE(6),
+    [LTM_SFRAME] = LTM_FRAME_SIZE(7),
+    [LTM_GFRAME] = LTM_FRAME_SIZE(14),
+    [LTM_NFRAME] = LTM_FRAME_SIZE(6),
+    [LTM_OFRAME] = LTM_FRAME_SIZE(14),
+    [LTM_XFRAME] = LTM_FRAME_SIZE(6)
 };
 
-static void process_ltm(void)
+// Frame intervals in ms for each ltmUpdateRate_e, NORMAL keeps the rates of the 10Hz schedule LTM always had
+static const uint16_t ltmFrameIntervals[][LTM_FRAME_COUNT] = {
+    [LTM_RATE_FAST]   = {   20,  100,  100,  200,  500,  500 },
+    [LTM_RATE_NORMAL] = {  100,  200,  200,  333, 1000, 1000 },
+    [LTM_RATE_MEDIUM] = {  200,  500,  500, 1000, 2000, 2000 },
+    [LTM_RATE_SLOW]   = {  500, 1000, 1000, 2000, 5000, 5000 },
+};
+
+static telemetryItem_t ltmFrames[LTM_FRAME_COUNT];
+static telemetryLink_t ltmLink;
+
+static void ltm_configureSchedule(uint32_t baudRate)
 {
-    static uint8_t ltm_scheduler;
-    uint8_t current_schedule = ltm_schedule[ltm_scheduler];
+    ltmUpdateRate_e updateRate = telemetryConfig->ltmUpdateRate;
+    if (updateRate == LTM_RATE_AUTO) {
+        updateRate = baudRate >= LTM_FAST_MIN_BAUDRATE ? LTM_RATE_FAST : LTM_RATE_NORMAL;
+    }
 
-    if (current_schedule & LTM_BIT_AFRAME)
-        ltm_aframe();
+    for (int frame = 0; frame < LTM_FRAME_COUNT; frame++) {
+        ltmFrames[frame].intervalMs = ltmFrameIntervals[updateRate][frame];
+        ltmFrames[frame].priority = ltmFramePriorities[frame];
+        ltmFrames[frame].maxSize = ltmFrameSizes[frame];
+        ltmFrames[frame].lastSentAt = 0;
+    }
+
+    // frames that cannot be produced without GPS or navigation are never scheduled
+#if !defined(GPS)
+    ltmFrames[LTM_GFRAME].priority = TELEMETRY_PRIORITY_OFF;
+    ltmFrames[LTM_OFRAME].priority = TELEMETRY_PRIORITY_OFF;
+    ltmFrames[LTM_XFRAME].priority = TELEMETRY_PRIORITY_OFF;
+#endif
+#if !defined(NAV)
+    ltmFrames[LTM_NFRAME].priority = TELEMETRY_PRIORITY_OFF;
+#endif
+}
 
+// Returns the number of bytes written
+static uint8_t ltm_sendFrame(ltmFrame_e frame)
+{
+    switch (frame) {
+    case LTM_AFRAME:
+        ltm_aframe();
+        break;
+    case LTM_SFRAME:
+        ltm_sframe();
+        break;
 #if defined(GPS)
-    if (current_schedule & LTM_BIT_GFRAME)
+    case LTM_GFRAME:
         ltm_gframe();
-
-    if (current_schedule & LTM_BIT_OFRAME)
+        break;
+    case LTM_OFRAME:
         ltm_oframe();
-
-    if (current_schedule & LTM_BIT_XFRAME && ltm_shouldSendXFrame())
+        break;
+    case LTM_XFRAME:
+        if (!ltm_shouldSendXFrame()) {
+            return 0;
+        }
         ltm_xframe();
+        break;
 #endif
-
-    if (current_schedule & LTM_BIT_SFRAME)
-        ltm_sframe();
-
 #if defined(NAV)
-    if (current_schedule & LTM_BIT_NFRAME)
+    case LTM_NFRAME:
         ltm_nframe();
+        break;
 #endif
+    default:
+        return 0;
+    }
 
-    ltm_scheduler = (ltm_scheduler + 1) % 10;
+    return ltmFrameSizes[frame];
 }
 
 void handleLtmTelemetry(void)
 {
-    static uint32_t ltm_lastCycleTime;
-    uint32_t now;
     if (!ltmEnabled)
         return;
     if (!ltmPort)
         return;
-    now = millis();
-    if ((now - ltm_lastCycleTime) >= LTM_CYCLETIME) {
-        process_ltm();
-        ltm_lastCycleTime = now;
+
+    telemetryLinkRefill(&ltmLink, micros());
+
+    const uint32_t now = millis();
+    int frame;
+
+    while ((frame = telemetryScheduleNextItem(&ltmLink, ltmFrames, LTM_FRAME_COUNT, now)) != TELEMETRY_NO_ITEM) {
+        // a radio modem slower than the serial port holds bytes back, wait rather than block in serialWrite
+        if (serialTxBytesFree(ltmPort) < ltmFrames[frame].maxSize) {
+            break;
+        }
+
+        telemetryScheduleItemSent(&ltmLink, &ltmFrames[frame], ltm_sendFrame(frame), now);
     }
 }
 
@@ -371,6 +435,9 @@ void configureLtmTelemetryPort(void)
     ltmPort = openSerialPort(portConfig->identifier, FUNCTION_TELEMETRY_LTM, NULL, baudRates[baudRateIndex], TELEMETRY_LTM_INITIAL_PORT_MODE, SERIAL_NOT_INVERTED);
     if (!ltmPort)
         return;
+    telemetryLinkInit(&ltmLink, baudRates[baudRateIndex], LTM_BITS_PER_BYTE, LTM_BURST_BYTES);
+    ltmLink.lastRefillAt = micros();
+    ltm_configureSchedule(baudRates[baudRateIndex]);
     ltmEnabled = true;
 }
 
@@ -23,6 +23,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
+#include <math.h>
 
 #include "platform.h"
 
@@ -47,6 +48,7 @@
 #include "io/gimbal.h"
 #include "io/gps.h"
 #include "io/ledstrip.h"
+#include "io/serial_cli.h"
 
 #include "sensors/sensors.h"
 #include "sensors/acceleration.h"
@@ -64,10 +66,9 @@
 #include "flight/navigation_rewrite.h"
 
 #include "telemetry/telemetry.h"
+#include "telemetry/telemetry_scheduler.h"
 #include "telemetry/mavlink.h"
 
-#include "mavlink/common/mavlink.h"
-
 #include "config/config.h"
 #include "config/runtime_config.h"
 #include "config/config_profile.h"
@@ -82,61 +83,176 @@
 #include "mavlink/common/mavlink.h"
 #pragma GCC diagnostic pop
 
-#define TELEMETRY_MAVLINK_INITIAL_PORT_MODE MODE_TX
-#define TELEMETRY_MAVLINK_MAXRATE 50
-#define TELEMETRY_MAVLINK_DELAY ((1000 * 1000) / TELEMETRY_MAVLINK_MAXRATE)
+#define TELEMETRY_MAVLINK_INITIAL_PORT_MODE MODE_RXTX
+#define TELEMETRY_MAVLINK_BITS_PER_BYTE 10
+#define TELEMETRY_MAVLINK_BATCH_SIZE 128    // must hold the largest stream
+
+#define MAVLINK_SYSTEM_ID 0
+#define MAVLINK_COMPONENT_ID 200
+#define MAVLINK_PARAM_ID_LENGTH 16          // not terminated when all 16 characters are used
+#define MAVLINK_REPLY_INTERVAL_MS 10
+#define MAVLINK_REPLY_QUEUE_SIZE 8
+#define MAVLINK_PARAM_ACTIVATE_DELAY_MS 250 // settings sent in a burst are activated once the burst is over
+#define MAVLINK_HEARTBEAT_INTERVAL_MS 1000  // ground stations drop the link after a few missed heartbeats
+#define MAVLINK_MISSION_RETRY_MS 1000
+#define MAVLINK_MISSION_RETRIES 5
+
+#define MAVLINK_MSG_SIZE(name) (MAVLINK_NUM_NON_PAYLOAD_BYTES + MAVLINK_MSG_ID_ ## name ## _LEN)
 
 extern uint16_t rssi; // FIXME dependency on mw.c
 
 static serialPort_t *mavlinkPort = NULL;
 static serialPortConfig_t *portConfig;
+static telemetryConfig_t *telemetryConfig;
 
 static bool mavlinkTelemetryEnabled =  false;
 static portSharing_e mavlinkPortSharing;
 
-/* MAVLink datastream rates in Hz */
-static const uint8_t mavRates[] = {
-    [MAV_DATA_STREAM_EXTENDED_STATUS] = 2, //2Hz
-    [MAV_DATA_STREAM_RC_CHANNELS] = 5, //5Hz
-    [MAV_DATA_STREAM_POSITION] = 2, //2Hz
-    [MAV_DATA_STREAM_EXTRA1] = 10, //10Hz
-    [MAV_DATA_STREAM_EXTRA2] = 10 //2Hz
+typedef enum {
+    MAVLINK_STREAM_EXTENDED_STATUS = 0,
+    MAVLINK_STREAM_RC_CHANNELS,
+    MAVLINK_STREAM_POSITION,
+    MAVLINK_STREAM_EXTRA1,
+    MAVLINK_STREAM_EXTRA2,
+    MAVLINK_STREAM_GCS_REPLY,           // answers to the ground station, scheduled only while there is one to send
+    MAVLINK_STREAM_HEARTBEAT,           // fixed 1Hz, not a MAVLink data stream
+    MAVLINK_STREAM_COUNT
+} mavlinkStream_e;
+
+#define MAVLINK_DATA_STREAM_COUNT MAVLINK_STREAM_GCS_REPLY
+
+static const uint8_t mavlinkDataStreamIds[MAVLINK_DATA_STREAM_COUNT] = {
+    [MAVLINK_STREAM_EXTENDED_STATUS] = MAV_DATA_STREAM_EXTENDED_STATUS,
+    [MAVLINK_STREAM_RC_CHANNELS] = MAV_DATA_STREAM_RC_CHANNELS,
+    [MAVLINK_STREAM_POSITION] = MAV_DATA_STREAM_POSITION,
+    [MAVLINK_STREAM_EXTRA1] = MAV_DATA_STREAM_EXTRA1,
+    [MAVLINK_STREAM_EXTRA2] = MAV_DATA_STREAM_EXTRA2
+};
+
+// Attitude, the HUD and the heartbeat keep their rate when the link is short, RC channels give way first
+static const uint8_t mavlinkStreamPriorities[MAVLINK_STREAM_COUNT] = {
+    [MAVLINK_STREAM_EXTENDED_STATUS] = TELEMETRY_PRIORITY_NORMAL,
+    [MAVLINK_STREAM_RC_CHANNELS] = TELEMETRY_PRIORITY_LOW,
+    [MAVLINK_STREAM_POSITION] = TELEMETRY_PRIORITY_NORMAL,
+    [MAVLINK_STREAM_EXTRA1] = TELEMETRY_PRIORITY_HIGH,
+    [MAVLINK_STREAM_EXTRA2] = TELEMETRY_PRIORITY_HIGH,
+    [MAVLINK_STREAM_GCS_REPLY] = TELEMETRY_PRIORITY_NORMAL,
+    [MAVLINK_STREAM_HEARTBEAT] = TELEMETRY_PRIORITY_HIGH
+};
+
+static const uint8_t mavlinkStreamSizes[MAVLINK_STREAM_COUNT] = {
+    [MAVLINK_STREAM_EXTENDED_STATUS] = MAVLINK_MSG_SIZE(SYS_STATUS),
+    [MAVLINK_STREAM_RC_CHANNELS] = MAVLINK_MSG_SIZE(RC_CHANNELS_RAW),
+    [MAVLINK_STREAM_POSITION] = MAVLINK_MSG_SIZE(GPS_RAW_INT) + MAVLINK_MSG_SIZE(GLOBAL_POSITION_INT) + MAVLINK_MSG_SIZE(GPS_GLOBAL_ORIGIN),
+    [MAVLINK_STREAM_EXTRA1] = MAVLINK_MSG_SIZE(ATTITUDE),
+    [MAVLINK_STREAM_EXTRA2] = MAVLINK_MSG_SIZE(VFR_HUD),
+    [MAVLINK_STREAM_GCS_REPLY] = MAVLINK_MSG_SIZE(MISSION_ITEM),
+    [MAVLINK_STREAM_HEARTBEAT] = MAVLINK_MSG_SIZE(HEARTBEAT)
 };
 
-#define MAXSTREAMS (sizeof(mavRates) / sizeof(mavRates[0]))
+typedef enum {
+    MAVLINK_REPLY_NONE = 0,
+    MAVLINK_REPLY_PARAM_VALUE,
+    MAVLINK_REPLY_MISSION_COUNT,
+    MAVLINK_REPLY_MISSION_ITEM,
+    MAVLINK_REPLY_MISSION_REQUEST,
+    MAVLINK_REPLY_MISSION_ACK,
+    MAVLINK_REPLY_COMMAND_ACK
+} mavlinkReply_e;
+
+typedef struct mavlinkReply_s {
+    uint8_t reply;                          // mavlinkReply_e
+    uint8_t result;                         // MAV_MISSION_RESULT or MAV_RESULT
+    uint16_t index;                         // setting index, mission sequence or command
+} mavlinkReply_t;
+
+/*
+ * Ground station requests are answered from the settings table and the waypoint list as the link has room,
+ * one message per turn of the reply stream. Replies wait in a small queue, when it is full the request is
+ * dropped and the ground station repeats it. Parameter lists are streamed by index and mission uploads request
+ * one item at a time.
+ */
+typedef struct mavlinkGcsState_s {
+    mavlinkReply_t replies[MAVLINK_REPLY_QUEUE_SIZE];
+    uint8_t replyHead;
+    uint8_t replyCount;
+    uint16_t repliesDropped;
+    uint8_t gcsSystemId;
+    uint8_t gcsComponentId;
+
+    uint16_t paramStreamIndex;              // next setting sent after PARAM_REQUEST_LIST
+    uint16_t paramStreamCount;              // 0 when no list is being sent
+    bool paramsChanged;                     // set by PARAM_SET until the config is activated
+    uint32_t paramSetAt;                    // ms
+
+    uint8_t missionUploadCount;             // items announced by MISSION_COUNT, 0 when no upload is running
+    uint8_t missionUploadSeq;               // next item wanted
+    uint8_t missionUploadRetries;
+    uint32_t missionRequestedAt;            // ms
+} mavlinkGcsState_t;
+
+static mavlinkGcsState_t gcsState;
+
+#if defined(NAV)
+// uploaded items are kept here and replace the mission only once the last one has arrived
+static navWaypoint_t missionUpload[NAV_MAX_WAYPOINTS];
+#endif
+
+static telemetryItem_t mavlinkStreams[MAVLINK_STREAM_COUNT];
+static telemetryLink_t mavlinkLink;
 
-static uint8_t mavTicks[MAXSTREAMS];
 static mavlink_message_t mavMsg;
-static uint8_t mavBuffer[MAVLINK_MAX_PACKET_LEN];
-static uint32_t lastMavlinkMessage = 0;
 
-static int mavlinkStreamTrigger(enum MAV_DATA_STREAM streamNum)
+// Messages are packed back to back and handed to the port in one write
+static uint8_t mavBatch[TELEMETRY_MAVLINK_BATCH_SIZE];
+static uint16_t mavBatchLength;
+static uint16_t mavBytesWritten;
+
+static void mavlinkFlushBatch(void)
 {
-    uint8_t rate = (uint8_t) mavRates[streamNum];
-    if (rate == 0) {
-        return 0;
+    if (mavBatchLength) {
+        serialWriteBuf(mavlinkPort, mavBatch, mavBatchLength);
+        mavBatchLength = 0;
     }
+}
 
-    if (mavTicks[streamNum] == 0) {
-        // we're triggering now, setup the next trigger point
-        if (rate > TELEMETRY_MAVLINK_MAXRATE) {
-            rate = TELEMETRY_MAVLINK_MAXRATE;
-        }
-
-        mavTicks[streamNum] = (TELEMETRY_MAVLINK_MAXRATE / rate);
-        return 1;
+static void mavlinkSendMessage(void)
+{
+    const uint16_t msgLength = MAVLINK_NUM_NON_PAYLOAD_BYTES + mavMsg.len;
+    if (mavBatchLength + msgLength > sizeof(mavBatch)) {
+        mavlinkFlushBatch();
     }
 
-    // count down at TASK_RATE_HZ
-    mavTicks[streamNum]--;
-    return 0;
+    mavBatchLength += mavlink_msg_to_send_buffer(mavBatch + mavBatchLength, &mavMsg);
+    mavBytesWritten += msgLength;
 }
 
+static void mavlinkSetStreamRate(mavlinkStream_e stream, uint8_t rate)
+{
+    rate = MIN(rate, TELEMETRY_MAVLINK_MAXRATE);
+
+    mavlinkStreams[stream].intervalMs = rate ? 1000 / rate : 0;
+    mavlinkStreams[stream].priority = rate ? mavlinkStreamPriorities[stream] : TELEMETRY_PRIORITY_OFF;
+    mavlinkStreams[stream].maxSize = mavlinkStreamSizes[stream];
+}
 
-static void mavlinkSerialWrite(uint8_t * buf, uint16_t length)
+static void mavlinkConfigureStreams(void)
 {
-    for (int i = 0; i < length; i++)
-        serialWrite(mavlinkPort, buf[i]);
+    memset(mavlinkStreams, 0, sizeof(mavlinkStreams));
+
+    mavlinkStreams[MAVLINK_STREAM_GCS_REPLY].intervalMs = MAVLINK_REPLY_INTERVAL_MS;
+    mavlinkStreams[MAVLINK_STREAM_GCS_REPLY].priority = TELEMETRY_PRIORITY_OFF;
+    mavlinkStreams[MAVLINK_STREAM_GCS_REPLY].maxSize = mavlinkStreamSizes[MAVLINK_STREAM_GCS_REPLY];
+
+    mavlinkStreams[MAVLINK_STREAM_HEARTBEAT].intervalMs = MAVLINK_HEARTBEAT_INTERVAL_MS;
+    mavlinkStreams[MAVLINK_STREAM_HEARTBEAT].priority = mavlinkStreamPriorities[MAVLINK_STREAM_HEARTBEAT];
+    mavlinkStreams[MAVLINK_STREAM_HEARTBEAT].maxSize = mavlinkStreamSizes[MAVLINK_STREAM_HEARTBEAT];
+
+    mavlinkSetStreamRate(MAVLINK_STREAM_EXTENDED_STATUS, telemetryConfig->mavlink_ext_status_rate);
+    mavlinkSetStreamRate(MAVLINK_STREAM_RC_CHANNELS, telemetryConfig->mavlink_rc_chan_rate);
+    mavlinkSetStreamRate(MAVLINK_STREAM_POSITION, telemetryConfig->mavlink_pos_rate);
+    mavlinkSetStreamRate(MAVLINK_STREAM_EXTRA1, telemetryConfig->mavlink_extra1_rate);
+    mavlinkSetStreamRate(MAVLINK_STREAM_EXTRA2, telemetryConfig->mavlink_extra2_rate);
 }
 
 void freeMAVLinkTelemetryPort(void)
@@ -146,8 +262,9 @@ void freeMAVLinkTelemetryPort(void)
     mavlinkTelemetryEnabled = false;
 }
 
-void initMAVLinkTelemetry(void)
+void initMAVLinkTelemetry(telemetryConfig_t *initialTelemetryConfig)
 {
+    telemetryConfig = initialTelemetryConfig;
     portConfig = findSerialPortConfig(FUNCTION_TELEMETRY_MAVLINK);
     mavlinkPortSharing = determinePortSharing(portConfig, FUNCTION_TELEMETRY_MAVLINK);
 }
@@ -170,6 +287,12 @@ void configureMAVLinkTelemetryPort(void)
         return;
     }
 
+    telemetryLinkInit(&mavlinkLink, baudRates[baudRateIndex], TELEMETRY_MAVLINK_BITS_PER_BYTE, TELEMETRY_MAVLINK_BATCH_SIZE);
+    mavlinkLink.lastRefillAt = micros();
+    mavlinkConfigureStreams();
+    mavBatchLength = 0;
+    memset(&gcsState, 0, sizeof(gcsState));
+
     mavlinkTelemetryEnabled = true;
 }
 
@@ -187,9 +310,8 @@ void checkMAVLinkTelemetryState(void)
         freeMAVLinkTelemetryPort();
 }
 
-void mavlinkSendSystemStatus(void)
+static void mavlinkSendSystemStatus(void)
 {
-    uint16_t msgLength;
 
     uint32_t onboardControlAndSensors = 35843;
 
@@ -207,7 +329,7 @@ void mavlinkSendSystemStatus(void)
     if (sensors(SENSOR_BARO)) onboardControlAndSensors |=  8200;
     if (sensors(SENSOR_GPS))  onboardControlAndSensors |= 16416;
 
-    mavlink_msg_sys_status_pack(0, 200, &mavMsg,
+    mavlink_msg_sys_status_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // onboard_control_sensors_present Bitmask showing which onboard controllers and sensors are present. 
         //Value of 0: not present. Value of 1: present. Indices: 0: 3D gyro, 1: 3D acc, 2: 3D mag, 3: absolute pressure, 
         // 4: differential pressure, 5: GPS, 6: optical flow, 7: computer vision position, 8: laser based position, 
@@ -238,14 +360,12 @@ void mavlinkSendSystemStatus(void)
         0,
         // errors_count4 Autopilot-specific errors
         0);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkSendMessage();
 }
 
-void mavlinkSendRCChannelsAndRSSI(void)
+static void mavlinkSendRCChannelsAndRSSI(void)
 {
-    uint16_t msgLength;
-    mavlink_msg_rc_channels_raw_pack(0, 200, &mavMsg,
+    mavlink_msg_rc_channels_raw_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // time_boot_ms Timestamp (milliseconds since system boot)
         millis(),
         // port Servo output port (set of 8 outputs = 1 port). Most MAVs will just use one, but this allows to encode more than 8 servos.
@@ -268,14 +388,12 @@ void mavlinkSendRCChannelsAndRSSI(void)
         (rxRuntimeConfig.channelCount >= 8) ? rcData[7] : 0,
         // rssi Receive signal strength indicator, 0: 0%, 255: 100%
         scaleRange(rssi, 0, 1023, 0, 255));
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkSendMessage();
 }
 
 #if defined(GPS)
-void mavlinkSendPosition(void)
+static void mavlinkSendPosition(void)
 {
-    uint16_t msgLength;
     uint8_t gpsFixType = 0;
 
     if (!sensors(SENSOR_GPS))
@@ -288,7 +406,7 @@ void mavlinkSendPosition(void)
     else if (gpsSol.fixType == GPS_FIX_3D)
             gpsFixType = 3;
 
-    mavlink_msg_gps_raw_int_pack(0, 200, &mavMsg,
+    mavlink_msg_gps_raw_int_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // time_usec Timestamp (microseconds since UNIX epoch or microseconds since system boot)
         micros(),
         // fix_type 0-1: no fix, 2: 2D fix, 3: 3D fix. Some applications will not use the value of this field unless it is at least two, so always correctly fill in the fix.
@@ -309,11 +427,10 @@ void mavlinkSendPosition(void)
         gpsSol.groundCourse * 10,
         // satellites_visible Number of satellites visible. If unknown, set to 255
         gpsSol.numSat);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkSendMessage();
 
     // Global position
-    mavlink_msg_global_position_int_pack(0, 200, &mavMsg,
+    mavlink_msg_global_position_int_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // time_usec Timestamp (microseconds since UNIX epoch or microseconds since system boot)
         micros(),
         // lat Latitude in 1E7 degrees
@@ -337,25 +454,22 @@ void mavlinkSendPosition(void)
         // heading Current heading in degrees, in compass units (0..360, 0=north)
         DECIDEGREES_TO_DEGREES(attitude.values.yaw)
     );
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkSendMessage();
 
-    mavlink_msg_gps_global_origin_pack(0, 200, &mavMsg,
+    mavlink_msg_gps_global_origin_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // latitude Latitude (WGS84), expressed as * 1E7
         GPS_home.lat,
         // longitude Longitude (WGS84), expressed as * 1E7
         GPS_home.lon,
         // altitude Altitude(WGS84), expressed as * 1000
         GPS_home.alt * 10); // FIXME
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkSendMessage();
 }
 #endif
 
-void mavlinkSendAttitude(void)
+static void mavlinkSendAttitude(void)
 {
-    uint16_t msgLength;
-    mavlink_msg_attitude_pack(0, 200, &mavMsg,
+    mavlink_msg_attitude_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // time_boot_ms Timestamp (milliseconds since system boot)
         millis(),
         // roll Roll angle (rad)
@@ -370,13 +484,11 @@ void mavlinkSendAttitude(void)
         0,
         // yawspeed Yaw angular speed (rad/s)
         0);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkSendMessage();
 }
 
-void mavlinkSendHUDAndHeartbeat(void)
+static void mavlinkSendHUD(void)
 {
-    uint16_t msgLength;
     float mavAltitude = 0;
     float mavGroundSpeed = 0;
     float mavAirSpeed = 0;
@@ -400,7 +512,7 @@ void mavlinkSendHUDAndHeartbeat(void)
     }
 #endif
 
-    mavlink_msg_vfr_hud_pack(0, 200, &mavMsg,
+    mavlink_msg_vfr_hud_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // airspeed Current airspeed in m/s
         mavAirSpeed,
         // groundspeed Current ground speed in m/s
@@ -413,10 +525,11 @@ void mavlinkSendHUDAndHeartbeat(void)
         mavAltitude,
         // climb Current climb rate in meters/second
         mavClimbRate);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
-
+    mavlinkSendMessage();
+}
 
+static void mavlinkSendHeartbeat(void)
+{
     uint8_t mavModes = MAV_MODE_FLAG_MANUAL_INPUT_ENABLED;
     if (ARMING_FLAG(ARMED))
         mavModes |= MAV_MODE_FLAG_SAFETY_ARMED;
@@ -486,7 +599,7 @@ void mavlinkSendHUDAndHeartbeat(void)
         mavSystemState = MAV_STATE_STANDBY;
     }
 
-    mavlink_msg_heartbeat_pack(0, 200, &mavMsg,
+    mavlink_msg_heartbeat_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
         // type Type of the MAV (quadrotor, helicopter, etc., up to 15 types, defined in MAV_TYPE ENUM)
         mavSystemType,
         // autopilot Autopilot type / class. defined in MAV_AUTOPILOT ENUM
@@ -497,33 +610,534 @@ void mavlinkSendHUDAndHeartbeat(void)
         mavCustomMode,
         // system_status System status flag, see MAV_STATE ENUM
         mavSystemState);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkSendMessage();
 }
 
-void processMAVLinkTelemetry(void)
+static void mavlinkQueueReply(mavlinkReply_e reply, uint16_t index, uint8_t result)
 {
-    // is executed @ TELEMETRY_MAVLINK_MAXRATE rate
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_EXTENDED_STATUS)) {
-        mavlinkSendSystemStatus();
+    if (gcsState.replyCount == MAVLINK_REPLY_QUEUE_SIZE) {
+        gcsState.repliesDropped++;
+        return;
     }
 
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_RC_CHANNELS)) {
-        mavlinkSendRCChannelsAndRSSI();
+    mavlinkReply_t *queued = &gcsState.replies[(gcsState.replyHead + gcsState.replyCount) % MAVLINK_REPLY_QUEUE_SIZE];
+    queued->reply = reply;
+    queued->index = index;
+    queued->result = result;
+    gcsState.replyCount++;
+}
+
+static void mavlinkUpdateReplyStream(void)
+{
+    const bool replyPending = gcsState.replyCount > 0 || gcsState.paramStreamIndex < gcsState.paramStreamCount;
+
+    mavlinkStreams[MAVLINK_STREAM_GCS_REPLY].priority = replyPending ? mavlinkStreamPriorities[MAVLINK_STREAM_GCS_REPLY] : TELEMETRY_PRIORITY_OFF;
+}
+
+#ifdef USE_CLI
+/*
+ * Setting names that fit are used as param ids. Longer names share prefixes (failsafe_throttle and
+ * failsafe_throttle_low_delay), so they are cut to 11 characters and tagged with a CRC of the whole name,
+ * e.g. "failsafe_th~1a2b". The id only depends on the name, saved parameter files stay valid across builds.
+ */
+static void mavlinkGetParamId(uint16_t index, char *paramId)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    const char *name = cliGetSettingName(index);
+
+    // the packer copies all 16 characters
+    strncpy(paramId, name, MAVLINK_PARAM_ID_LENGTH);
+
+    if (strlen(name) > MAVLINK_PARAM_ID_LENGTH) {
+        uint16_t crc = 0;
+        for (const char *c = name; *c; c++) {
+            crc = crc16_ccitt(crc, *c);
+        }
+
+        paramId[MAVLINK_PARAM_ID_LENGTH - 5] = '~';
+        for (int i = 0; i < 4; i++) {
+            paramId[MAVLINK_PARAM_ID_LENGTH - 1 - i] = hexDigits[(crc >> (i * 4)) & 0x0F];
+        }
     }
+}
 
-#ifdef GPS
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_POSITION)) {
-        mavlinkSendPosition();
+static int mavlinkFindParam(const char *paramId)
+{
+    const uint16_t count = cliGetSettingCount();
+
+    for (uint16_t i = 0; i < count; i++) {
+        char settingParamId[MAVLINK_PARAM_ID_LENGTH];
+        mavlinkGetParamId(i, settingParamId);
+
+        if (strncmp(settingParamId, paramId, MAVLINK_PARAM_ID_LENGTH) == 0) {
+            return i;
+        }
     }
+    return -1;
+}
+
+static void mavlinkSendParamValue(uint16_t index)
+{
+    char paramId[MAVLINK_PARAM_ID_LENGTH];
+
+    mavlinkGetParamId(index, paramId);
+
+    mavlink_msg_param_value_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
+        paramId, cliGetSettingValue(index), MAV_PARAM_TYPE_REAL32, cliGetSettingCount(), index);
+    mavlinkSendMessage();
+}
+
+static void mavlinkHandleParamRequestList(void)
+{
+    gcsState.paramStreamIndex = 0;
+    gcsState.paramStreamCount = cliGetSettingCount();
+}
+
+static void mavlinkHandleParamRequestRead(void)
+{
+    mavlink_param_request_read_t request;
+    mavlink_msg_param_request_read_decode(&mavMsg, &request);
+
+    const int index = request.param_index >= 0 ? request.param_index : mavlinkFindParam(request.param_id);
+    if (index >= 0 && index < cliGetSettingCount()) {
+        mavlinkQueueReply(MAVLINK_REPLY_PARAM_VALUE, index, 0);
+    }
+}
+
+static void mavlinkHandleParamSet(uint32_t currentTimeMs)
+{
+    mavlink_param_set_t request;
+    mavlink_msg_param_set_decode(&mavMsg, &request);
+
+    const int index = mavlinkFindParam(request.param_id);
+    if (index < 0) {
+        return;
+    }
+
+    // settings only change on the ground, as with the CLI, the reply carries the value in use either way
+    if (!ARMING_FLAG(ARMED) && cliSetSettingValue(index, request.param_value)) {
+        gcsState.paramsChanged = true;
+        gcsState.paramSetAt = currentTimeMs;
+    }
+    mavlinkQueueReply(MAVLINK_REPLY_PARAM_VALUE, index, 0);
+}
+
+/*
+ * Rate curves, TPA tables and mode ranges are derived from the settings, rebuild them like MSP does. A ground
+ * station writes a parameter file one PARAM_SET at a time, they are rebuilt once when the writes stop.
+ */
+static void mavlinkActivateChangedParams(uint32_t currentTimeMs)
+{
+    if (gcsState.paramsChanged && !ARMING_FLAG(ARMED) && currentTimeMs - gcsState.paramSetAt >= MAVLINK_PARAM_ACTIVATE_DELAY_MS) {
+        gcsState.paramsChanged = false;
+        activateConfig();
+    }
+}
 #endif
 
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_EXTRA1)) {
-        mavlinkSendAttitude();
+static void mavlinkHandleCommandLong(void)
+{
+    mavlink_command_long_t command;
+    mavlink_msg_command_long_decode(&mavMsg, &command);
+
+    uint8_t result = MAV_RESULT_UNSUPPORTED;
+
+    if (command.command == MAV_CMD_PREFLIGHT_STORAGE && command.param1 == 1) {
+        if (ARMING_FLAG(ARMED)) {
+            result = MAV_RESULT_TEMPORARILY_REJECTED;
+        } else {
+            writeEEPROM();
+            readEEPROM();
+            result = MAV_RESULT_ACCEPTED;
+        }
     }
 
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_EXTRA2)) {
-        mavlinkSendHUDAndHeartbeat();
+    mavlinkQueueReply(MAVLINK_REPLY_COMMAND_ACK, command.command, result);
+}
+
+static void mavlinkHandleRequestDataStream(void)
+{
+    mavlink_request_data_stream_t request;
+    mavlink_msg_request_data_stream_decode(&mavMsg, &request);
+
+    const uint8_t rate = request.start_stop ? MAX(request.req_message_rate, 1) : 0;
+
+    for (int stream = 0; stream < MAVLINK_DATA_STREAM_COUNT; stream++) {
+        if (request.req_stream_id == MAV_DATA_STREAM_ALL || request.req_stream_id == mavlinkDataStreamIds[stream]) {
+            mavlinkSetStreamRate(stream, rate);
+        }
+    }
+}
+
+#if defined(NAV)
+static void mavlinkSendMissionItem(uint16_t seq)
+{
+    navWaypoint_t wp;
+    getWaypoint(seq + 1, &wp);
+
+    mavlink_msg_mission_item_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
+        gcsState.gcsSystemId, gcsState.gcsComponentId, seq,
+        MAV_FRAME_GLOBAL_RELATIVE_ALT,
+        wp.action == NAV_WP_ACTION_RTH ? MAV_CMD_NAV_RETURN_TO_LAUNCH : MAV_CMD_NAV_WAYPOINT,
+        // current, autocontinue
+        0, 1,
+        // param1..4 are not used by our waypoints
+        0, 0, 0, 0,
+        wp.lat / 1e7f, wp.lon / 1e7f, wp.alt / 100.0f);
+    mavlinkSendMessage();
+}
+
+static void mavlinkRequestMissionItem(uint32_t currentTimeMs)
+{
+    gcsState.missionRequestedAt = currentTimeMs;
+    mavlinkQueueReply(MAVLINK_REPLY_MISSION_REQUEST, gcsState.missionUploadSeq, 0);
+}
+
+static void mavlinkEndMissionUpload(uint8_t result)
+{
+    gcsState.missionUploadCount = 0;
+    mavlinkQueueReply(MAVLINK_REPLY_MISSION_ACK, 0, result);
+}
+
+// Replaces the mission with the uploaded one, an upload that is aborted leaves the old mission in place
+static void mavlinkCommitMissionUpload(void)
+{
+    const uint8_t count = gcsState.missionUploadCount;
+
+    if (ARMING_FLAG(ARMED)) {
+        mavlinkEndMissionUpload(MAV_MISSION_DENIED);
+        return;
+    }
+
+    resetWaypointList();
+    for (int i = 0; i < count; i++) {
+        setWaypoint(i + 1, &missionUpload[i]);
+    }
+
+    mavlinkEndMissionUpload(getWaypointCount() == count ? MAV_MISSION_ACCEPTED : MAV_MISSION_ERROR);
+}
+
+static void mavlinkHandleMissionCount(uint32_t currentTimeMs)
+{
+    const uint16_t count = mavlink_msg_mission_count_get_count(&mavMsg);
+
+    if (ARMING_FLAG(ARMED)) {
+        mavlinkEndMissionUpload(MAV_MISSION_DENIED);
+        return;
+    }
+
+    if (count > NAV_MAX_WAYPOINTS) {
+        mavlinkEndMissionUpload(MAV_MISSION_NO_SPACE);
+        return;
+    }
+
+    if (count == 0) {
+        resetWaypointList();
+        mavlinkEndMissionUpload(MAV_MISSION_ACCEPTED);
+        return;
+    }
+
+    gcsState.missionUploadCount = count;
+    gcsState.missionUploadSeq = 0;
+    gcsState.missionUploadRetries = 0;
+    mavlinkRequestMissionItem(currentTimeMs);
+}
+
+static void mavlinkHandleMissionItem(uint32_t currentTimeMs)
+{
+    mavlink_mission_item_t item;
+    mavlink_msg_mission_item_decode(&mavMsg, &item);
+
+    if (gcsState.missionUploadCount == 0) {
+        return;
+    }
+
+    if (item.seq != gcsState.missionUploadSeq) {
+        // our request crossed a repeated item, ask again for the one we want
+        mavlinkRequestMissionItem(currentTimeMs);
+        return;
+    }
+
+    navWaypoint_t wp;
+    memset(&wp, 0, sizeof(wp));
+
+    if (item.frame != MAV_FRAME_GLOBAL_RELATIVE_ALT) {
+        mavlinkEndMissionUpload(MAV_MISSION_UNSUPPORTED_FRAME);
+        return;
+    }
+
+    if (item.command == MAV_CMD_NAV_WAYPOINT) {
+        wp.action = NAV_WP_ACTION_WAYPOINT;
+    } else if (item.command == MAV_CMD_NAV_RETURN_TO_LAUNCH) {
+        wp.action = NAV_WP_ACTION_RTH;
+    } else {
+        mavlinkEndMissionUpload(MAV_MISSION_UNSUPPORTED);
+        return;
+    }
+
+    wp.lat = lrintf(item.x * 1e7f);
+    wp.lon = lrintf(item.y * 1e7f);
+    wp.alt = lrintf(item.z * 100.0f);
+    wp.flag = (item.seq == gcsState.missionUploadCount - 1) ? NAV_WP_FLAG_LAST : 0;
+    missionUpload[item.seq] = wp;
+
+    gcsState.missionUploadSeq++;
+    gcsState.missionUploadRetries = 0;
+
+    if (gcsState.missionUploadSeq == gcsState.missionUploadCount) {
+        mavlinkCommitMissionUpload();
+    } else {
+        mavlinkRequestMissionItem(currentTimeMs);
+    }
+}
+
+static void mavlinkHandleMissionRequest(void)
+{
+    const uint16_t seq = mavlink_msg_mission_request_get_seq(&mavMsg);
+
+    if (seq < getWaypointCount()) {
+        mavlinkQueueReply(MAVLINK_REPLY_MISSION_ITEM, seq, 0);
+    } else {
+        mavlinkQueueReply(MAVLINK_REPLY_MISSION_ACK, 0, MAV_MISSION_INVALID_SEQUENCE);
+    }
+}
+
+static void mavlinkHandleMissionClearAll(void)
+{
+    if (ARMING_FLAG(ARMED)) {
+        mavlinkQueueReply(MAVLINK_REPLY_MISSION_ACK, 0, MAV_MISSION_DENIED);
+        return;
+    }
+
+    resetWaypointList();
+    gcsState.missionUploadCount = 0;
+    mavlinkQueueReply(MAVLINK_REPLY_MISSION_ACK, 0, MAV_MISSION_ACCEPTED);
+}
+
+// A lost MISSION_REQUEST or item would stall the upload, ask again and give up after a few tries
+static void mavlinkCheckMissionUpload(uint32_t currentTimeMs)
+{
+    if (gcsState.missionUploadCount == 0 || currentTimeMs - gcsState.missionRequestedAt < MAVLINK_MISSION_RETRY_MS) {
+        return;
+    }
+
+    if (++gcsState.missionUploadRetries > MAVLINK_MISSION_RETRIES) {
+        mavlinkEndMissionUpload(MAV_MISSION_ERROR);
+    } else {
+        mavlinkRequestMissionItem(currentTimeMs);
+    }
+}
+#endif
+
+// Only requests addressed to us are answered, others on a shared link are for another system or component
+static bool mavlinkIsForUs(void)
+{
+    uint8_t targetSystem;
+    uint8_t targetComponent;
+
+    switch (mavMsg.msgid) {
+    case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
+        targetSystem = mavlink_msg_param_request_list_get_target_system(&mavMsg);
+        targetComponent = mavlink_msg_param_request_list_get_target_component(&mavMsg);
+        break;
+    case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
+        targetSystem = mavlink_msg_param_request_read_get_target_system(&mavMsg);
+        targetComponent = mavlink_msg_param_request_read_get_target_component(&mavMsg);
+        break;
+    case MAVLINK_MSG_ID_PARAM_SET:
+        targetSystem = mavlink_msg_param_set_get_target_system(&mavMsg);
+        targetComponent = mavlink_msg_param_set_get_target_component(&mavMsg);
+        break;
+    case MAVLINK_MSG_ID_COMMAND_LONG:
+        targetSystem = mavlink_msg_command_long_get_target_system(&mavMsg);
+        targetComponent = mavlink_msg_command_long_get_target_component(&mavMsg);
+        break;
+    case MAVLINK_MSG_ID_REQUEST_DATA_STREAM:
+        targetSystem = mavlink_msg_request_data_stream_get_target_system(&mavMsg);
+        targetComponent = mavlink_msg_request_data_stream_get_target_component(&mavMsg);
+        break;
+    case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+        targetSystem = mavlink_msg_mission_request_list_get_target_system(&mavMsg);
+        targetComponent = mavlink_msg_mission_request_list_get_target_component(&mavMsg);
+        break;
+    case MAVLINK_MSG_ID_MISSION_REQUEST:
+        targetSystem = mavlink_msg_mission_request_get_target_system(&mavMsg);
+        targetComponent = mavlink_msg_mission_request_get_target_component(&mavMsg);
+        break;
+    case MAVLINK_MSG_ID_MISSION_COUNT:
+        targetSystem = mavlink_msg_mission_count_get_target_system(&mavMsg);
+        targetComponent = mavlink_msg_mission_count_get_target_component(&mavMsg);
+        break;
+    case MAVLINK_MSG_ID_MISSION_ITEM:
+        targetSystem = mavlink_msg_mission_item_get_target_system(&mavMsg);
+        targetComponent = mavlink_msg_mission_item_get_target_component(&mavMsg);
+        break;
+    case MAVLINK_MSG_ID_MISSION_CLEAR_ALL:
+        targetSystem = mavlink_msg_mission_clear_all_get_target_system(&mavMsg);
+        targetComponent = mavlink_msg_mission_clear_all_get_target_component(&mavMsg);
+        break;
+    default:
+        return false;
+    }
+
+    // 0 addresses every system or component
+    return (targetSystem == 0 || targetSystem == MAVLINK_SYSTEM_ID)
+        && (targetComponent == MAV_COMP_ID_ALL || targetComponent == MAVLINK_COMPONENT_ID);
+}
+
+static void mavlinkHandleMessage(uint32_t currentTimeMs)
+{
+    if (!mavlinkIsForUs()) {
+        return;
+    }
+
+    gcsState.gcsSystemId = mavMsg.sysid;
+    gcsState.gcsComponentId = mavMsg.compid;
+
+    switch (mavMsg.msgid) {
+#ifdef USE_CLI
+    case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
+        mavlinkHandleParamRequestList();
+        break;
+    case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
+        mavlinkHandleParamRequestRead();
+        break;
+    case MAVLINK_MSG_ID_PARAM_SET:
+        mavlinkHandleParamSet(currentTimeMs);
+        break;
+#endif
+    case MAVLINK_MSG_ID_COMMAND_LONG:
+        mavlinkHandleCommandLong();
+        break;
+    case MAVLINK_MSG_ID_REQUEST_DATA_STREAM:
+        mavlinkHandleRequestDataStream();
+        break;
+#if defined(NAV)
+    case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+        mavlinkQueueReply(MAVLINK_REPLY_MISSION_COUNT, getWaypointCount(), 0);
+        break;
+    case MAVLINK_MSG_ID_MISSION_REQUEST:
+        mavlinkHandleMissionRequest();
+        break;
+    case MAVLINK_MSG_ID_MISSION_COUNT:
+        mavlinkHandleMissionCount(currentTimeMs);
+        break;
+    case MAVLINK_MSG_ID_MISSION_ITEM:
+        mavlinkHandleMissionItem(currentTimeMs);
+        break;
+    case MAVLINK_MSG_ID_MISSION_CLEAR_ALL:
+        mavlinkHandleMissionClearAll();
+        break;
+#endif
+    default:
+        break;
+    }
+}
+
+static void mavlinkProcessReceivedBytes(uint32_t currentTimeMs)
+{
+    mavlink_status_t status;
+
+    while (serialRxBytesWaiting(mavlinkPort)) {
+        // the message being received is kept by the parser, mavMsg is free until the next reply is packed
+        if (mavlink_parse_char(MAVLINK_COMM_0, serialRead(mavlinkPort), &mavMsg, &status)) {
+            mavlinkHandleMessage(currentTimeMs);
+        }
+    }
+
+#ifdef USE_CLI
+    mavlinkActivateChangedParams(currentTimeMs);
+#endif
+#if defined(NAV)
+    mavlinkCheckMissionUpload(currentTimeMs);
+#endif
+
+    mavlinkUpdateReplyStream();
+}
+
+static void mavlinkSendGcsReply(void)
+{
+    mavlinkReply_t reply = { .reply = MAVLINK_REPLY_NONE };
+
+    if (gcsState.replyCount > 0) {
+        reply = gcsState.replies[gcsState.replyHead];
+        gcsState.replyHead = (gcsState.replyHead + 1) % MAVLINK_REPLY_QUEUE_SIZE;
+        gcsState.replyCount--;
+    }
+
+    switch (reply.reply) {
+#ifdef USE_CLI
+    case MAVLINK_REPLY_PARAM_VALUE:
+        mavlinkSendParamValue(reply.index);
+        break;
+#endif
+#if defined(NAV)
+    case MAVLINK_REPLY_MISSION_COUNT:
+        mavlink_msg_mission_count_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
+            gcsState.gcsSystemId, gcsState.gcsComponentId, reply.index);
+        mavlinkSendMessage();
+        break;
+    case MAVLINK_REPLY_MISSION_ITEM:
+        mavlinkSendMissionItem(reply.index);
+        break;
+    case MAVLINK_REPLY_MISSION_REQUEST:
+        mavlink_msg_mission_request_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
+            gcsState.gcsSystemId, gcsState.gcsComponentId, reply.index);
+        mavlinkSendMessage();
+        break;
+    case MAVLINK_REPLY_MISSION_ACK:
+        mavlink_msg_mission_ack_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
+            gcsState.gcsSystemId, gcsState.gcsComponentId, reply.result);
+        mavlinkSendMessage();
+        break;
+#endif
+    case MAVLINK_REPLY_COMMAND_ACK:
+        mavlink_msg_command_ack_pack(MAVLINK_SYSTEM_ID, MAVLINK_COMPONENT_ID, &mavMsg,
+            reply.index, reply.result);
+        mavlinkSendMessage();
+        break;
+    case MAVLINK_REPLY_NONE:
+    default:
+#ifdef USE_CLI
+        // a parameter list goes out between other replies
+        if (gcsState.paramStreamIndex < gcsState.paramStreamCount) {
+            mavlinkSendParamValue(gcsState.paramStreamIndex++);
+        }
+#endif
+        break;
+    }
+
+    mavlinkUpdateReplyStream();
+}
+
+static void mavlinkSendStream(mavlinkStream_e stream)
+{
+    switch (stream) {
+    case MAVLINK_STREAM_EXTENDED_STATUS:
+        mavlinkSendSystemStatus();
+        break;
+    case MAVLINK_STREAM_RC_CHANNELS:
+        mavlinkSendRCChannelsAndRSSI();
+        break;
+#ifdef GPS
+    case MAVLINK_STREAM_POSITION:
+        mavlinkSendPosition();
+        break;
+#endif
+    case MAVLINK_STREAM_EXTRA1:
+        mavlinkSendAttitude();
+        break;
+    case MAVLINK_STREAM_EXTRA2:
+        mavlinkSendHUD();
+        break;
+    case MAVLINK_STREAM_GCS_REPLY:
+        mavlinkSendGcsReply();
+        break;
+    case MAVLINK_STREAM_HEARTBEAT:
+        mavlinkSendHeartbeat();
+        break;
+    default:
+        break;
     }
 }
 
@@ -537,11 +1151,25 @@ void handleMAVLinkTelemetry(void)
         return;
     }
 
-    uint32_t now = micros();
-    if ((now - lastMavlinkMessage) >= TELEMETRY_MAVLINK_DELAY) {
-        processMAVLinkTelemetry();
-        lastMavlinkMessage = now;
+    const uint32_t now = millis();
+    int stream;
+
+    mavlinkProcessReceivedBytes(now);
+
+    telemetryLinkRefill(&mavlinkLink, micros());
+
+    while ((stream = telemetryScheduleNextItem(&mavlinkLink, mavlinkStreams, MAVLINK_STREAM_COUNT, now)) != TELEMETRY_NO_ITEM) {
+        // a stream that does not fit in the TX buffer waits for the next call instead of blocking in serialWrite
+        if (serialTxBytesFree(mavlinkPort) < mavBatchLength + mavlinkStreams[stream].maxSize) {
+            break;
+        }
+
+        mavBytesWritten = 0;
+        mavlinkSendStream(stream);
+        telemetryScheduleItemSent(&mavlinkLink, &mavlinkStreams[stream], mavBytesWritten, now);
     }
+
+    mavlinkFlushBatch();
 }
 
 #endif
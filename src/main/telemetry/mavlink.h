@@ -18,7 +18,9 @@
 #ifndef TELEMETRY_MAVLINK_H_
 #define TELEMETRY_MAVLINK_H_
 
-void initMAVLinkTelemetry(void);
+#define TELEMETRY_MAVLINK_MAXRATE 50
+
+void initMAVLinkTelemetry(telemetryConfig_t *initialTelemetryConfig);
 void handleMAVLinkTelemetry(void);
 void checkMAVLinkTelemetryState(void);
 
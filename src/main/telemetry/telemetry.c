@@ -70,7 +70,7 @@ void telemetryInit(void)
 #endif
 
 #if defined(TELEMETRY_MAVLINK)
-    initMAVLinkTelemetry();
+    initMAVLinkTelemetry(telemetryConfig);
 #endif
 
     telemetryCheckState();
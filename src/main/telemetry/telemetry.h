@@ -36,6 +36,14 @@ typedef enum {
     FRSKY_UNIT_IMPERIALS
 } frskyUnit_e;
 
+typedef enum {
+    LTM_RATE_AUTO = 0,                      // FAST from 57600 baud, NORMAL below
+    LTM_RATE_FAST,
+    LTM_RATE_NORMAL,
+    LTM_RATE_MEDIUM,
+    LTM_RATE_SLOW
+} ltmUpdateRate_e;
+
 typedef struct telemetryConfig_s {
     uint8_t telemetry_switch;               // Use aux channel to change serial output & baudrate( MSP / Telemetry ). It disables automatic switching to Telemetry when armed.
     uint8_t telemetry_inversion;            // also shared with smartport inversion
@@ -45,6 +53,12 @@ typedef struct telemetryConfig_s {
     frskyUnit_e frsky_unit;
     uint8_t frsky_vfas_precision;
     uint8_t hottAlarmSoundInterval;
+    uint8_t mavlink_ext_status_rate;        // Hz, 0 disables the stream
+    uint8_t mavlink_rc_chan_rate;
+    uint8_t mavlink_pos_rate;
+    uint8_t mavlink_extra1_rate;            // attitude
+    uint8_t mavlink_extra2_rate;            // VFR HUD
+    uint8_t ltmUpdateRate;                  // ltmUpdateRate_e
 } telemetryConfig_t;
 
 void telemetryCheckState(void);
@@ -0,0 +1,98 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef TELEMETRY
+
+#include "common/maths.h"
+
+#include "telemetry/telemetry_scheduler.h"
+
+#define TELEMETRY_MAX_ITEM_AGE_MS 60000U
+
+/*
+ * Shared scheduling for the telemetry protocols. A link earns a byte budget at the rate it can carry and every item
+ * has a refresh interval and a priority. Of the items that are due the one with the highest priority weighted
+ * staleness is sent next, so on a busy link the important items keep their rate and the rest slow down evenly.
+ * The most overdue item waits for budget rather than letting smaller ones past, so large items are not starved.
+ */
+
+void telemetryLinkInit(telemetryLink_t *link, uint32_t baudRate, uint8_t bitsPerByte, uint16_t burstBytes)
+{
+    memset(link, 0, sizeof(*link));
+    link->bytesPerSecond = baudRate / bitsPerByte;
+    link->burstBytes = burstBytes;
+}
+
+void telemetryLinkRefill(telemetryLink_t *link, uint32_t currentTimeUs)
+{
+    const uint32_t elapsedUs = MIN(currentTimeUs - link->lastRefillAt, 1000000U);
+    link->lastRefillAt = currentTimeUs;
+
+    const uint64_t earned = (uint64_t)elapsedUs * link->bytesPerSecond + link->budgetRemainder;
+    const uint32_t earnedBytes = earned / 1000000;
+    link->budgetRemainder = earned % 1000000;
+
+    link->budget = MIN(link->budget + earnedBytes, link->burstBytes);
+    if (link->budget == link->burstBytes) {
+        link->budgetRemainder = 0;
+    }
+}
+
+int telemetryScheduleNextItem(telemetryLink_t *link, const telemetryItem_t *items, uint8_t itemCount, uint32_t currentTimeMs)
+{
+    int nextItem = TELEMETRY_NO_ITEM;
+    uint32_t nextItemScore = 0;
+
+    for (int i = 0; i < itemCount; i++) {
+        // items that were never sent are capped so the score cannot overflow
+        const uint32_t age = MIN(currentTimeMs - items[i].lastSentAt, TELEMETRY_MAX_ITEM_AGE_MS);
+        if (age < items[i].intervalMs) {
+            continue;
+        }
+
+        // overdue ratio in 1/256 of the interval, an item twice as stale as wanted doubles its claim
+        const uint32_t score = (age * 256 / MAX(items[i].intervalMs, 1)) * items[i].priority;
+        if (score > nextItemScore) {
+            nextItemScore = score;
+            nextItem = i;
+        }
+    }
+
+    if (nextItem != TELEMETRY_NO_ITEM && items[nextItem].maxSize > link->budget) {
+        link->itemsDeferred++;
+        return TELEMETRY_NO_ITEM;
+    }
+
+    return nextItem;
+}
+
+void telemetryScheduleItemSent(telemetryLink_t *link, telemetryItem_t *item, uint16_t bytesWritten, uint32_t currentTimeMs)
+{
+    item->lastSentAt = currentTimeMs;
+
+    link->budget -= MIN(bytesWritten, link->budget);
+    link->bytesSent += bytesWritten;
+    link->itemsSent++;
+}
+
+#endif
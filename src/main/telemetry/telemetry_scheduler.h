@@ -0,0 +1,53 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Weight given to how overdue an item is, attitude, battery and GPS go before the rest when the link is busy
+typedef enum {
+    TELEMETRY_PRIORITY_OFF = 0,             // never scheduled
+    TELEMETRY_PRIORITY_LOW = 1,
+    TELEMETRY_PRIORITY_NORMAL = 2,
+    TELEMETRY_PRIORITY_HIGH = 4
+} telemetryPriority_e;
+
+typedef struct telemetryItem_s {
+    uint16_t intervalMs;                    // wanted refresh interval, the item is not sent more often
+    uint8_t priority;                       // telemetryPriority_e
+    uint8_t maxSize;                        // bytes on the wire in the worst case
+    uint32_t lastSentAt;                    // ms
+} telemetryItem_t;
+
+typedef struct telemetryLink_s {
+    uint32_t bytesPerSecond;                // line rate the budget is earned at
+    uint16_t burstBytes;                    // most the budget can save up
+    uint16_t budget;                        // bytes that may be written now
+    uint32_t budgetRemainder;               // part of a byte earned, in byte microseconds
+    uint32_t lastRefillAt;                  // us
+
+    uint32_t bytesSent;
+    uint32_t itemsSent;
+    uint32_t itemsDeferred;                 // times the most overdue item had to wait for budget
+} telemetryLink_t;
+
+#define TELEMETRY_NO_ITEM -1
+
+void telemetryLinkInit(telemetryLink_t *link, uint32_t baudRate, uint8_t bitsPerByte, uint16_t burstBytes);
+void telemetryLinkRefill(telemetryLink_t *link, uint32_t currentTimeUs);
+
+int telemetryScheduleNextItem(telemetryLink_t *link, const telemetryItem_t *items, uint8_t itemCount, uint32_t currentTimeMs);
+void telemetryScheduleItemSent(telemetryLink_t *link, telemetryItem_t *item, uint16_t bytesWritten, uint32_t currentTimeMs);
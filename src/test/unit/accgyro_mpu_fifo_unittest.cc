@@ -0,0 +1,158 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+    #include "common/axis.h"
+    #include "drivers/accgyro_mpu_fifo.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static void putWord(uint8_t *data, int16_t value)
+{
+    data[0] = (uint16_t)value >> 8;
+    data[1] = value & 0xFF;
+}
+
+static void putSample(uint8_t *data, const int16_t acc[3], const int16_t gyro[3])
+{
+    for (int axis = 0; axis < 3; axis++) {
+        putWord(&data[axis * 2], acc[axis]);
+        putWord(&data[6 + axis * 2], gyro[axis]);
+    }
+}
+
+TEST(MpuFifoTest, EmptySumHasNoAverage)
+{
+    mpuFifoSum_t sum;
+    int16_t acc[3];
+    int16_t gyro[3];
+
+    mpuFifoSumReset(&sum);
+
+    EXPECT_FALSE(mpuFifoSumAverage(&sum, acc, gyro));
+}
+
+TEST(MpuFifoTest, SingleSampleIsUnpackedBigEndian)
+{
+    const int16_t accIn[3] = { 4096, -4096, 32767 };
+    const int16_t gyroIn[3] = { -32768, 1, -1 };
+    uint8_t data[MPU_FIFO_SAMPLE_SIZE];
+    mpuFifoSum_t sum;
+    int16_t acc[3];
+    int16_t gyro[3];
+
+    putSample(data, accIn, gyroIn);
+
+    // when
+    mpuFifoSumReset(&sum);
+    mpuFifoSumSamples(&sum, data, 1);
+
+    // then
+    EXPECT_EQ(0x10, data[0]);
+    EXPECT_EQ(0x00, data[1]);
+    EXPECT_TRUE(mpuFifoSumAverage(&sum, acc, gyro));
+    for (int axis = 0; axis < 3; axis++) {
+        EXPECT_EQ(accIn[axis], acc[axis]);
+        EXPECT_EQ(gyroIn[axis], gyro[axis]);
+    }
+}
+
+TEST(MpuFifoTest, SamplesAreAveragedWithRounding)
+{
+    uint8_t data[4 * MPU_FIFO_SAMPLE_SIZE];
+    mpuFifoSum_t sum;
+    int16_t acc[3];
+    int16_t gyro[3];
+
+    for (int sample = 0; sample < 4; sample++) {
+        // acc X 0,1,2,3 -> 1.5, acc Y -> -1.5, acc Z constant, gyro X 0,0,0,1 -> 0.25
+        const int16_t accIn[3] = { (int16_t)sample, (int16_t)-sample, 4096 };
+        const int16_t gyroIn[3] = { (int16_t)(sample == 3), -100, 32767 };
+        putSample(&data[sample * MPU_FIFO_SAMPLE_SIZE], accIn, gyroIn);
+    }
+
+    // when
+    mpuFifoSumReset(&sum);
+    mpuFifoSumSamples(&sum, data, 4);
+
+    // then
+    EXPECT_EQ(4, sum.sampleCount);
+    EXPECT_TRUE(mpuFifoSumAverage(&sum, acc, gyro));
+    EXPECT_EQ(2, acc[X]);
+    EXPECT_EQ(-2, acc[Y]);
+    EXPECT_EQ(4096, acc[Z]);
+    EXPECT_EQ(0, gyro[X]);
+    EXPECT_EQ(-100, gyro[Y]);
+    EXPECT_EQ(32767, gyro[Z]);
+}
+
+TEST(MpuFifoTest, BurstsAccumulateIntoOneAverage)
+{
+    uint8_t data[MPU_FIFO_BURST_SAMPLES * MPU_FIFO_SAMPLE_SIZE];
+    mpuFifoSum_t sum;
+    int16_t acc[3];
+    int16_t gyro[3];
+
+    mpuFifoSumReset(&sum);
+
+    // a FIFO holding more than one burst is read in several transactions
+    for (int burst = 0; burst < 3; burst++) {
+        for (int sample = 0; sample < MPU_FIFO_BURST_SAMPLES; sample++) {
+            const int16_t value = burst * 1000;
+            const int16_t accIn[3] = { value, value, value };
+            const int16_t gyroIn[3] = { (int16_t)-value, (int16_t)-value, (int16_t)-value };
+            putSample(&data[sample * MPU_FIFO_SAMPLE_SIZE], accIn, gyroIn);
+        }
+        mpuFifoSumSamples(&sum, data, MPU_FIFO_BURST_SAMPLES);
+    }
+
+    // then
+    EXPECT_EQ(3 * MPU_FIFO_BURST_SAMPLES, sum.sampleCount);
+    EXPECT_TRUE(mpuFifoSumAverage(&sum, acc, gyro));
+    EXPECT_EQ(1000, acc[X]);
+    EXPECT_EQ(-1000, gyro[Z]);
+}
+
+TEST(MpuFifoTest, AveragingRemovesNoiseAtTheLoopRate)
+{
+    uint8_t data[8 * MPU_FIFO_SAMPLE_SIZE];
+    mpuFifoSum_t sum;
+    int16_t acc[3];
+    int16_t gyro[3];
+
+    // 8kHz samples of a 1kHz tone on top of a constant rate, read once per 1kHz loop
+    static const int16_t tone[8] = { 0, 707, 1000, 707, 0, -707, -1000, -707 };
+    for (int sample = 0; sample < 8; sample++) {
+        const int16_t accIn[3] = { 0, 0, 0 };
+        const int16_t gyroIn[3] = { (int16_t)(500 + tone[sample]), 0, 0 };
+        putSample(&data[sample * MPU_FIFO_SAMPLE_SIZE], accIn, gyroIn);
+    }
+
+    // when
+    mpuFifoSumReset(&sum);
+    mpuFifoSumSamples(&sum, data, 8);
+
+    // then the tone would alias to DC if only one sample was kept
+    EXPECT_TRUE(mpuFifoSumAverage(&sum, acc, gyro));
+    EXPECT_EQ(500, gyro[X]);
+}
@@ -267,3 +267,65 @@ TEST(AlignSensorTest, ClockwiseTwoSeventyDegreesFlip)
     testCWFlip(CW270_DEG_FLIP, 270);
 }
 
+
+static void expectSameAlignment(uint8_t rotation, uint8_t expectedRotation, boardAlignment_t *boardAlignment)
+{
+    boardAlignment_t standardAlignment = { 0, 0, 0 };
+    int32_t src[3] = { 1000, -2000, 3000 };
+    int32_t dest[3];
+    int32_t expected[3];
+
+    initBoardAlignment(&standardAlignment);
+    alignSensors(src, expected, expectedRotation);
+
+    initBoardAlignment(boardAlignment);
+    alignSensors(src, dest, rotation);
+
+    initBoardAlignment(&standardAlignment);
+
+    EXPECT_EQ(expected[X], dest[X]);
+    EXPECT_EQ(expected[Y], dest[Y]);
+    EXPECT_EQ(expected[Z], dest[Z]);
+}
+
+TEST(AlignSensorTest, BoardYawCombinesWithSensorRotation)
+{
+    boardAlignment_t boardAlignment = { 0, 0, 900 };
+
+    // a board yawed by 90 degrees adds to the sensor's own yaw rotation
+    expectSameAlignment(CW0_DEG, CW90_DEG, &boardAlignment);
+    expectSameAlignment(CW90_DEG, CW180_DEG, &boardAlignment);
+    expectSameAlignment(CW180_DEG, CW270_DEG, &boardAlignment);
+    expectSameAlignment(CW270_DEG, CW0_DEG, &boardAlignment);
+}
+
+TEST(AlignSensorTest, BoardAlignmentChangeRebuildsMatrices)
+{
+    boardAlignment_t boardAlignment = { 0, 0, 0 };
+    int32_t src[3] = { 1000, -2000, 3000 };
+    int32_t dest[3];
+
+    initBoardAlignment(&boardAlignment);
+    alignSensors(src, dest, CW0_DEG);
+    EXPECT_EQ(1000, dest[X]);
+
+    // roll by 180 degrees in two steps, the cached matrix must follow each step
+    updateBoardAlignment(&boardAlignment, 900, 0);
+    alignSensors(src, dest, CW0_DEG);
+    EXPECT_EQ(1000, dest[X]);
+    EXPECT_NEAR(3000, dest[Y], 1);
+    EXPECT_NEAR(2000, dest[Z], 1);
+
+    updateBoardAlignment(&boardAlignment, 900, 0);
+    alignSensors(src, dest, CW0_DEG);
+    EXPECT_EQ(1000, dest[X]);
+    EXPECT_NEAR(2000, dest[Y], 1);
+    EXPECT_NEAR(-3000, dest[Z], 1);
+
+    boardAlignment.rollDeciDegrees = 0;
+    initBoardAlignment(&boardAlignment);
+    alignSensors(src, dest, CW0_DEG);
+    EXPECT_EQ(1000, dest[X]);
+    EXPECT_EQ(-2000, dest[Y]);
+    EXPECT_EQ(3000, dest[Z]);
+}
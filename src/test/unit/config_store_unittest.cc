@@ -0,0 +1,357 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+    #include "config/config_store.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define FAKE_FLASH_PAGE_SIZE 1024
+#define FAKE_FLASH_AREA_SIZE 2048
+#define FAKE_FLASH_SIZE (2 * FAKE_FLASH_AREA_SIZE)
+#define TEST_CONFIG_SIZE 1500
+
+// RAM backed flash: erase sets a page to 0xFF, programming a word that is not erased fails like on the STM32
+static uint32_t fakeFlash[FAKE_FLASH_SIZE / sizeof(uint32_t)];
+static int fakeFlashEraseCount;
+static int fakeFlashProgramCount;
+static int fakeFlashProgramBudget; // programs allowed before simulating a power loss, -1 for unlimited
+
+static bool fakeFlashErase(uintptr_t address)
+{
+    memset((void *)address, 0xFF, FAKE_FLASH_PAGE_SIZE);
+    fakeFlashEraseCount++;
+    return true;
+}
+
+static bool fakeFlashProgram(uintptr_t address, uint32_t value)
+{
+    if (fakeFlashProgramBudget == 0) {
+        return false;
+    }
+    if (fakeFlashProgramBudget > 0) {
+        fakeFlashProgramBudget--;
+    }
+
+    uint32_t *word = (uint32_t *)address;
+    if (*word != 0xFFFFFFFF) {
+        return false;
+    }
+    *word = value;
+    fakeFlashProgramCount++;
+    return true;
+}
+
+static const configStoreFlash_t fakeFlashOps = {
+    .erase = fakeFlashErase,
+    .program = fakeFlashProgram
+};
+
+static configStore_t store;
+static uint8_t config[TEST_CONFIG_SIZE];
+static uint8_t loaded[TEST_CONFIG_SIZE];
+
+static void resetFakeFlash(void)
+{
+    memset(fakeFlash, 0xFF, sizeof(fakeFlash));
+    fakeFlashEraseCount = 0;
+    fakeFlashProgramCount = 0;
+    fakeFlashProgramBudget = -1;
+
+    store.start = (uintptr_t)fakeFlash;
+    store.altStart = (uintptr_t)fakeFlash + FAKE_FLASH_AREA_SIZE;
+    store.size = FAKE_FLASH_AREA_SIZE;
+    store.pageSize = FAKE_FLASH_PAGE_SIZE;
+    store.version = 1;
+    store.flash = &fakeFlashOps;
+
+    for (int i = 0; i < TEST_CONFIG_SIZE; i++) {
+        config[i] = i * 7;
+    }
+}
+
+TEST(ConfigStoreTest, ErasedStoreIsInvalid)
+{
+    // given
+    resetFakeFlash();
+
+    // expect
+    EXPECT_FALSE(configStoreIsValid(&store, TEST_CONFIG_SIZE));
+}
+
+TEST(ConfigStoreTest, CompactedStoreLoadsConfig)
+{
+    // given
+    resetFakeFlash();
+
+    // when
+    EXPECT_TRUE(configStoreCompact(&store, config, TEST_CONFIG_SIZE));
+
+    // then
+    EXPECT_TRUE(configStoreIsValid(&store, TEST_CONFIG_SIZE));
+    EXPECT_TRUE(configStoreLoad(&store, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(0, memcmp(config, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(2, fakeFlashEraseCount);
+}
+
+TEST(ConfigStoreTest, StoreIsInvalidForAnotherVersionOrSize)
+{
+    // given
+    resetFakeFlash();
+    configStoreCompact(&store, config, TEST_CONFIG_SIZE);
+
+    // expect
+    EXPECT_FALSE(configStoreIsValid(&store, TEST_CONFIG_SIZE - 4));
+
+    // and
+    store.version = 2;
+    EXPECT_FALSE(configStoreIsValid(&store, TEST_CONFIG_SIZE));
+}
+
+TEST(ConfigStoreTest, SaveAppendsOnlyChangedBytes)
+{
+    // given
+    resetFakeFlash();
+    configStoreSave(&store, config, TEST_CONFIG_SIZE);
+    fakeFlashEraseCount = 0;
+    fakeFlashProgramCount = 0;
+
+    // when
+    config[100] = 0x55;
+    config[1200] = 0xAA;
+    config[1201] = 0xAB;
+    EXPECT_TRUE(configStoreSave(&store, config, TEST_CONFIG_SIZE));
+
+    // then
+    EXPECT_EQ(0, fakeFlashEraseCount);
+    EXPECT_EQ(6, fakeFlashProgramCount); // two records of header, crc and one data word
+
+    // and
+    EXPECT_TRUE(configStoreLoad(&store, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(0, memcmp(config, loaded, TEST_CONFIG_SIZE));
+}
+
+TEST(ConfigStoreTest, SaveWithoutChangesDoesNotWrite)
+{
+    // given
+    resetFakeFlash();
+    configStoreSave(&store, config, TEST_CONFIG_SIZE);
+    fakeFlashEraseCount = 0;
+    fakeFlashProgramCount = 0;
+
+    // when
+    EXPECT_TRUE(configStoreSave(&store, config, TEST_CONFIG_SIZE));
+
+    // then
+    EXPECT_EQ(0, fakeFlashEraseCount);
+    EXPECT_EQ(0, fakeFlashProgramCount);
+}
+
+TEST(ConfigStoreTest, FullStoreIsCompacted)
+{
+    // given
+    resetFakeFlash();
+    configStoreSave(&store, config, TEST_CONFIG_SIZE);
+    fakeFlashEraseCount = 0;
+
+    // when
+    // each save appends a 12 byte record, the ~530 bytes left fill up after about 44 saves
+    for (int i = 0; i < 100; i++) {
+        config[i * 10] ^= 0xFF;
+        EXPECT_TRUE(configStoreSave(&store, config, TEST_CONFIG_SIZE));
+    }
+
+    // then
+    EXPECT_EQ(4, fakeFlashEraseCount);
+    EXPECT_TRUE(configStoreLoad(&store, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(0, memcmp(config, loaded, TEST_CONFIG_SIZE));
+}
+
+TEST(ConfigStoreTest, InterruptedSaveKeepsPreviousConfig)
+{
+    // given
+    resetFakeFlash();
+    configStoreSave(&store, config, TEST_CONFIG_SIZE);
+    uint8_t previous[TEST_CONFIG_SIZE];
+    memcpy(previous, config, TEST_CONFIG_SIZE);
+
+    // when
+    // power is lost after the crc and first data word of the record are written
+    memset(config + 200, 0x11, 40);
+    fakeFlashProgramBudget = 2;
+    EXPECT_FALSE(configStoreSave(&store, config, TEST_CONFIG_SIZE));
+
+    // then
+    EXPECT_TRUE(configStoreLoad(&store, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(0, memcmp(previous, loaded, TEST_CONFIG_SIZE));
+
+    // and
+    // the partly written slot is not erased, so the next save compacts instead of appending to it
+    fakeFlashProgramBudget = -1;
+    fakeFlashEraseCount = 0;
+    EXPECT_TRUE(configStoreSave(&store, config, TEST_CONFIG_SIZE));
+    EXPECT_EQ(FAKE_FLASH_AREA_SIZE / FAKE_FLASH_PAGE_SIZE, fakeFlashEraseCount);
+    EXPECT_TRUE(configStoreLoad(&store, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(0, memcmp(config, loaded, TEST_CONFIG_SIZE));
+}
+
+TEST(ConfigStoreTest, UncommittedRecordsAreNotLoaded)
+{
+    // given
+    resetFakeFlash();
+    configStoreSave(&store, config, TEST_CONFIG_SIZE);
+    uint8_t previous[TEST_CONFIG_SIZE];
+    memcpy(previous, config, TEST_CONFIG_SIZE);
+
+    // when
+    // a save of two records loses power after the first record is complete
+    config[10] = 0x99;
+    config[1000] = 0x99;
+    fakeFlashProgramBudget = 3;
+    EXPECT_FALSE(configStoreSave(&store, config, TEST_CONFIG_SIZE));
+
+    // then
+    EXPECT_TRUE(configStoreLoad(&store, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(0, memcmp(previous, loaded, TEST_CONFIG_SIZE));
+}
+
+TEST(ConfigStoreTest, LoadStopsAtCorruptedRecord)
+{
+    // given
+    resetFakeFlash();
+    configStoreSave(&store, config, TEST_CONFIG_SIZE);
+    uint8_t previous[TEST_CONFIG_SIZE];
+    memcpy(previous, config, TEST_CONFIG_SIZE);
+    config[10] = 0x99;
+    configStoreSave(&store, config, TEST_CONFIG_SIZE);
+    config[20] = 0x99;
+    configStoreSave(&store, config, TEST_CONFIG_SIZE);
+
+    // when
+    // flip a bit in the data word of the first delta record appended after the base record
+    const int deltaRecordWord = (CONFIG_STORE_HEADER_SIZE + CONFIG_STORE_RECORD_HEADER_SIZE + TEST_CONFIG_SIZE + CONFIG_STORE_RECORD_HEADER_SIZE) / 4;
+    fakeFlash[deltaRecordWord] ^= 0x01;
+
+    // then
+    // the later, intact record is not applied on top of the corrupted one either
+    EXPECT_TRUE(configStoreLoad(&store, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(0, memcmp(previous, loaded, TEST_CONFIG_SIZE));
+}
+
+TEST(ConfigStoreTest, CompactionAlternatesAreas)
+{
+    // given
+    resetFakeFlash();
+    configStoreCompact(&store, config, TEST_CONFIG_SIZE);
+
+    // when
+    config[0] ^= 0xFF;
+    EXPECT_TRUE(configStoreCompact(&store, config, TEST_CONFIG_SIZE));
+
+    // then
+    // the new image is in the second area, the first one still holds the previous image
+    EXPECT_EQ(0x53474643u, fakeFlash[0]);
+    EXPECT_EQ(0x53474643u, fakeFlash[FAKE_FLASH_AREA_SIZE / 4]);
+    EXPECT_TRUE(configStoreLoad(&store, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(0, memcmp(config, loaded, TEST_CONFIG_SIZE));
+
+    // and
+    config[0] ^= 0xFF;
+    EXPECT_TRUE(configStoreCompact(&store, config, TEST_CONFIG_SIZE));
+    EXPECT_TRUE(configStoreLoad(&store, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(0, memcmp(config, loaded, TEST_CONFIG_SIZE));
+}
+
+TEST(ConfigStoreTest, InterruptedCompactionKeepsPreviousConfig)
+{
+    // given
+    resetFakeFlash();
+    configStoreSave(&store, config, TEST_CONFIG_SIZE);
+    config[10] = 0x99;
+    configStoreSave(&store, config, TEST_CONFIG_SIZE);
+    uint8_t previous[TEST_CONFIG_SIZE];
+    memcpy(previous, config, TEST_CONFIG_SIZE);
+
+    // when
+    // power is lost after the new base record is written but before the header is complete
+    for (int i = 0; i < TEST_CONFIG_SIZE; i++) {
+        config[i] ^= 0x5A;
+    }
+    fakeFlashProgramBudget = 2 + TEST_CONFIG_SIZE / 4 + 1;
+    EXPECT_FALSE(configStoreSave(&store, config, TEST_CONFIG_SIZE));
+
+    // then
+    EXPECT_TRUE(configStoreLoad(&store, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(0, memcmp(previous, loaded, TEST_CONFIG_SIZE));
+
+    // and
+    fakeFlashProgramBudget = -1;
+    EXPECT_TRUE(configStoreSave(&store, config, TEST_CONFIG_SIZE));
+    EXPECT_TRUE(configStoreLoad(&store, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(0, memcmp(config, loaded, TEST_CONFIG_SIZE));
+}
+
+TEST(ConfigStoreTest, StagedConfigIsLoadedOnlyAfterCommit)
+{
+    // given
+    resetFakeFlash();
+    configStoreSave(&store, config, TEST_CONFIG_SIZE);
+    uint8_t previous[TEST_CONFIG_SIZE];
+    memcpy(previous, config, TEST_CONFIG_SIZE);
+    for (int i = 0; i < TEST_CONFIG_SIZE; i++) {
+        config[i] ^= 0xA5;
+    }
+
+    // when
+    // the config arrives in pieces that do not line up with flash words
+    configStoreStage_t stage;
+    EXPECT_TRUE(configStoreStageBegin(&store, &stage, TEST_CONFIG_SIZE));
+    for (int offset = 0; offset < TEST_CONFIG_SIZE; offset += 93) {
+        EXPECT_TRUE(configStoreStageWrite(&store, &stage, config + offset, (TEST_CONFIG_SIZE - offset < 93) ? TEST_CONFIG_SIZE - offset : 93));
+    }
+
+    // then
+    EXPECT_TRUE(configStoreLoad(&store, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(0, memcmp(previous, loaded, TEST_CONFIG_SIZE));
+
+    // and
+    EXPECT_TRUE(configStoreStageCommit(&store, &stage));
+    EXPECT_TRUE(configStoreLoad(&store, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(0, memcmp(config, loaded, TEST_CONFIG_SIZE));
+}
+
+TEST(ConfigStoreTest, IncompleteStagedConfigIsNotCommitted)
+{
+    // given
+    resetFakeFlash();
+    configStoreSave(&store, config, TEST_CONFIG_SIZE);
+    configStoreStage_t stage;
+    configStoreStageBegin(&store, &stage, TEST_CONFIG_SIZE);
+
+    // when
+    configStoreStageWrite(&store, &stage, config, TEST_CONFIG_SIZE - 1);
+
+    // then
+    EXPECT_FALSE(configStoreStageCommit(&store, &stage));
+    EXPECT_FALSE(configStoreStageWrite(&store, &stage, config, 2));
+    EXPECT_TRUE(configStoreLoad(&store, loaded, TEST_CONFIG_SIZE));
+    EXPECT_EQ(0, memcmp(config, loaded, TEST_CONFIG_SIZE));
+}
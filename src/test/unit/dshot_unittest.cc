@@ -0,0 +1,139 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+    #include "drivers/dshot.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+TEST(DshotTest, TimingForEachRate)
+{
+    dshotTiming_t timing;
+
+    // when
+    dshotTimingInit(&timing, 600, DSHOT_TIMER_MHZ);
+
+    // then
+    EXPECT_EQ(40, timing.bitPeriod);
+    EXPECT_EQ(30, timing.bit1);
+    EXPECT_EQ(15, timing.bit0);
+
+    // when
+    dshotTimingInit(&timing, 300, DSHOT_TIMER_MHZ);
+
+    // then
+    EXPECT_EQ(80, timing.bitPeriod);
+    EXPECT_EQ(60, timing.bit1);
+    EXPECT_EQ(30, timing.bit0);
+
+    // when
+    dshotTimingInit(&timing, 150, DSHOT_TIMER_MHZ);
+
+    // then
+    EXPECT_EQ(160, timing.bitPeriod);
+    EXPECT_EQ(120, timing.bit1);
+    EXPECT_EQ(60, timing.bit0);
+}
+
+TEST(DshotTest, PulseWidthMapsOntoThrottleRange)
+{
+    EXPECT_EQ(DSHOT_DISARM_COMMAND, dshotThrottleFromPulse(0));
+    EXPECT_EQ(DSHOT_DISARM_COMMAND, dshotThrottleFromPulse(1000));
+    EXPECT_EQ(DSHOT_MIN_THROTTLE + 1, dshotThrottleFromPulse(1001));
+    EXPECT_EQ(1047, dshotThrottleFromPulse(1500));
+    EXPECT_EQ(DSHOT_MAX_THROTTLE, dshotThrottleFromPulse(2000));
+    EXPECT_EQ(DSHOT_MAX_THROTTLE, dshotThrottleFromPulse(2100));
+
+    // and
+    uint16_t last = 0;
+    for (uint16_t pulse = 1000; pulse <= 2000; pulse++) {
+        uint16_t throttle = dshotThrottleFromPulse(pulse);
+        EXPECT_GE(throttle, last);
+        last = throttle;
+    }
+}
+
+TEST(DshotTest, FrameChecksum)
+{
+    // 1046 without telemetry is the example from the protocol description
+    EXPECT_EQ(0x82C6, dshotPrepareFrame(1046, false));
+
+    // and
+    EXPECT_EQ(0x0000, dshotPrepareFrame(DSHOT_DISARM_COMMAND, false));
+    EXPECT_EQ(0x0011, dshotPrepareFrame(DSHOT_DISARM_COMMAND, true));
+    EXPECT_EQ(0xFFEE, dshotPrepareFrame(DSHOT_MAX_THROTTLE, false));
+
+    // and every frame checks out: the xor of all four nibbles is zero
+    for (uint16_t value = 0; value <= DSHOT_MAX_THROTTLE; value++) {
+        for (int telemetry = 0; telemetry < 2; telemetry++) {
+            uint16_t frame = dshotPrepareFrame(value, telemetry);
+            EXPECT_EQ(0, (frame ^ (frame >> 4) ^ (frame >> 8) ^ (frame >> 12)) & 0x0f);
+            EXPECT_EQ(value, frame >> 5);
+            EXPECT_EQ(telemetry, (frame >> 4) & 1);
+        }
+    }
+}
+
+TEST(DshotTest, EncodeInterleavesChannels)
+{
+    dshotTiming_t timing;
+    dshotTimingInit(&timing, 600, DSHOT_TIMER_MHZ);
+
+    uint32_t buffer[DSHOT_DMA_BUFFER_SIZE * 4];
+    memset(buffer, 0xAA, sizeof(buffer));
+
+    // when
+    dshotEncodeFrame(&buffer[2], 4, 0x82C6, &timing);
+
+    // then MSB goes first, only the third channel of each burst is touched
+    const char *bits = "1000001011000110";
+    for (int i = 0; i < DSHOT_FRAME_BITS; i++) {
+        EXPECT_EQ(bits[i] == '1' ? timing.bit1 : timing.bit0, buffer[i * 4 + 2]);
+        EXPECT_EQ(0xAAAAAAAA, buffer[i * 4 + 1]);
+        EXPECT_EQ(0xAAAAAAAA, buffer[i * 4 + 3]);
+    }
+
+    // and the line is held low after the frame
+    EXPECT_EQ(0, buffer[DSHOT_FRAME_BITS * 4 + 2]);
+    EXPECT_EQ(0, buffer[(DSHOT_FRAME_BITS + 1) * 4 + 2]);
+}
+
+TEST(DshotTest, EncodeSingleChannelTimer)
+{
+    dshotTiming_t timing;
+    dshotTimingInit(&timing, 150, DSHOT_TIMER_MHZ);
+
+    uint32_t buffer[DSHOT_DMA_BUFFER_SIZE + 1];
+    buffer[DSHOT_DMA_BUFFER_SIZE] = 0x55;
+
+    // when
+    dshotEncodeFrame(buffer, 1, 0xFFEE, &timing);
+
+    // then
+    for (int i = 0; i < DSHOT_FRAME_BITS; i++) {
+        EXPECT_EQ((0xFFEE & (0x8000 >> i)) ? timing.bit1 : timing.bit0, buffer[i]);
+    }
+    EXPECT_EQ(0, buffer[DSHOT_FRAME_BITS]);
+    EXPECT_EQ(0, buffer[DSHOT_FRAME_BITS + 1]);
+    EXPECT_EQ(0x55, buffer[DSHOT_DMA_BUFFER_SIZE]);
+}
@@ -0,0 +1,164 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+
+extern "C" {
+    #include "common/filter.h"
+}
+
+#include "unittest_macros.h"
+#include "unittest_timing.h"
+#include "gtest/gtest.h"
+
+class PT1FilterTest : public ::testing::Test {
+protected:
+    pt1Filter_t reference;
+    pt1Filter_t cached;
+
+    virtual void SetUp() {
+        memset(&reference, 0, sizeof(reference));
+        memset(&cached, 0, sizeof(cached));
+    }
+};
+
+// Samples of a stick move with a bit of noise
+static float testInput(int i)
+{
+    return (i < 50 ? 0.0f : 400.0f) + ((i * 37) % 11) - 5.0f;
+}
+
+TEST_F(PT1FilterTest, CachedMatchesPerCallCalculation)
+{
+    for (int i = 0; i < 200; i++) {
+        EXPECT_NEAR(pt1FilterApply4(&reference, testInput(i), 20, 0.001f), pt1FilterApplyCached(&cached, testInput(i), 20, 0.001f), 1e-3f) << i;
+    }
+}
+
+TEST_F(PT1FilterTest, InitialisedFilterMatchesPerCallCalculation)
+{
+    // given
+    pt1FilterInit(&cached, 30, 0.002f);
+
+    // expect
+    for (int i = 0; i < 200; i++) {
+        EXPECT_NEAR(pt1FilterApply4(&reference, testInput(i), 30, 0.002f), pt1FilterApply(&cached, testInput(i)), 1e-3f) << i;
+    }
+}
+
+TEST_F(PT1FilterTest, CoefficientKeptForSmallDtChanges)
+{
+    // given
+    pt1FilterApplyCached(&cached, 0, 20, 0.001f);
+    const float k = cached.k;
+
+    // when the loop time jitters by less than the tolerance
+    pt1FilterApplyCached(&cached, 0, 20, 0.00103f);
+    pt1FilterApplyCached(&cached, 0, 20, 0.00097f);
+
+    // then
+    EXPECT_EQ(k, cached.k);
+
+    // when it changes by more
+    pt1FilterApplyCached(&cached, 0, 20, 0.002f);
+
+    // then
+    EXPECT_FLOAT_EQ(0.002f, cached.dT);
+    EXPECT_GT(cached.k, k);
+}
+
+TEST_F(PT1FilterTest, CutoffChangeKeepsState)
+{
+    // given
+    for (int i = 0; i < 100; i++) {
+        pt1FilterApplyCached(&cached, 100.0f, 10, 0.001f);
+    }
+    const float state = cached.state;
+    const float k = cached.k;
+
+    // when
+    const float output = pt1FilterApplyCached(&cached, state, 40, 0.001f);
+
+    // then the coefficient follows the cutoff and the output carries on from where it was
+    EXPECT_GT(cached.k, k);
+    EXPECT_FLOAT_EQ(state, output);
+}
+
+TEST_F(PT1FilterTest, RateLimitUsesCachedCoefficient)
+{
+    // when
+    const float output = pt1FilterApplyWithRateLimit(&cached, 1000.0f, 50, 100.0f, 0.001f);
+
+    // then
+    EXPECT_FLOAT_EQ(0.1f, output);
+    EXPECT_FLOAT_EQ(50, cached.f_cut);
+    EXPECT_GT(cached.k, 0);
+}
+
+#define PT1_BENCHMARK_ITERATIONS 2000000
+
+TEST_F(PT1FilterTest, BenchmarkPT1)
+{
+    // the control loop dT with a few us of scheduler jitter
+    static const float dTs[] = { 0.001f, 0.001012f, 0.000991f, 0.001004f };
+    float inputs[256];
+    for (int i = 0; i < 256; i++) {
+        inputs[i] = testInput(i);
+    }
+    volatile float sink = 0;
+
+    // when
+    uint64_t startedAt = monotonicNanos();
+    for (int n = 0; n < PT1_BENCHMARK_ITERATIONS; n++) {
+        sink = pt1FilterApply4(&reference, inputs[n & 255], 20, dTs[n & 3]);
+    }
+    const double nsPerCall = (double)(monotonicNanos() - startedAt) / PT1_BENCHMARK_ITERATIONS;
+
+    startedAt = monotonicNanos();
+    for (int n = 0; n < PT1_BENCHMARK_ITERATIONS; n++) {
+        sink = pt1FilterApplyCached(&cached, inputs[n & 255], 20, dTs[n & 3]);
+    }
+    const double nsPerCachedCall = (double)(monotonicNanos() - startedAt) / PT1_BENCHMARK_ITERATIONS;
+
+    // and count how often the cached coefficient was calculated, pt1FilterApply4() divides on every call
+    pt1Filter_t counted;
+    memset(&counted, 0, sizeof(counted));
+    int coefficientCalculations = 0;
+    for (int n = 0; n < PT1_BENCHMARK_ITERATIONS; n++) {
+        const float k = counted.k;
+        pt1FilterApplyCached(&counted, inputs[n & 255], 20, dTs[n & 3]);
+        if (counted.k != k) {
+            coefficientCalculations++;
+        }
+    }
+
+    // then
+    printf("[ BENCH    ] pt1FilterApply4: %.2f ns, %d divisions\n", nsPerCall, PT1_BENCHMARK_ITERATIONS);
+    printf("[ BENCH    ] pt1FilterApplyCached: %.2f ns, %d coefficient calculations\n", nsPerCachedCall, coefficientCalculations);
+    EXPECT_EQ(1, coefficientCalculations);
+    EXPECT_NEAR(reference.state, cached.state, 1.0f);
+    UNUSED(sink);
+}
+
+// STUBS
+
+extern "C" {
+uint32_t targetLooptime;
+}
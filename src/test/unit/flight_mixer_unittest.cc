@@ -39,19 +39,24 @@ extern "C" {
     #include "flight/pid.h"
     #include "flight/imu.h"
     #include "flight/mixer.h"
-    #include "flight/lowpass.h"
 
     #include "io/escservo.h"
     #include "io/gimbal.h"
     #include "io/rc_controls.h"
 
+    #include "config/runtime_config.h"
+    #include "config/config.h"
+
     void forwardAuxChannelsToServos(uint8_t firstServoIndex);
 
     void mixerInit(mixerMode_e mixerMode, motorMixer_t *initialCustomMixers, servoMixer_t *initialCustomServoMixers);
-    void mixerUsePWMOutputConfiguration(pwmOutputConfiguration_t *pwmOutputConfiguration);
+    void mixerUsePWMIOConfiguration(void);
+
+    extern uint32_t targetLooptime;
 }
 
 #include "unittest_macros.h"
+#include "unittest_timing.h"
 #include "gtest/gtest.h"
 
 // input
@@ -157,7 +162,7 @@ protected:
     };
 
     motorMixer_t customMotorMixer[MAX_SUPPORTED_MOTORS];
-    servoMixer_t customServoMixer[MAX_SUPPORTED_SERVOS];
+    servoMixer_t customServoMixer[MAX_SERVO_RULES];
 
     virtual void SetUp() {
         updatedServoCount = 0;
@@ -170,7 +175,7 @@ protected:
 
         memset(rcData, 0, sizeof(rcData));
         memset(rcCommand, 0, sizeof(rcCommand));
-        memset(axisPID, 0, sizeof(axisPID));
+        memset(axisPID, 0, sizeof(int16_t) * XYZ_AXIS_COUNT);
 
         memset(&customMotorMixer, 0, sizeof(customMotorMixer));
     }
@@ -190,7 +195,6 @@ protected:
             NULL,
             &escAndServoConfig,
             &mixerConfig,
-            NULL,
             &rxConfig
         );
     }
@@ -217,12 +221,7 @@ TEST_F(BasicMixerIntegrationTest, TestTricopterServo)
     mixerInit(MIXER_TRI, customMotorMixer, customServoMixer);
 
     // and
-    pwmOutputConfiguration_t pwmOutputConfiguration = {
-            .servoCount = 1,
-            .motorCount = 3
-    };
-
-    mixerUsePWMOutputConfiguration(&pwmOutputConfiguration);
+    mixerUsePWMIOConfiguration();
 
     // and
     axisPID[YAW] = 0;
@@ -246,18 +245,13 @@ TEST_F(BasicMixerIntegrationTest, TestQuadMotors)
     mixerInit(MIXER_QUADX, customMotorMixer, customServoMixer);
 
     // and
-    pwmOutputConfiguration_t pwmOutputConfiguration = {
-            .servoCount = 0,
-            .motorCount = 4
-    };
-
-    mixerUsePWMOutputConfiguration(&pwmOutputConfiguration);
+    mixerUsePWMIOConfiguration();
 
     // and
     memset(rcCommand, 0, sizeof(rcCommand));
 
     // and
-    memset(axisPID, 0, sizeof(axisPID));
+    memset(axisPID, 0, sizeof(int16_t) * XYZ_AXIS_COUNT);
     axisPID[YAW] = 0;
 
 
@@ -328,12 +322,7 @@ TEST_F(CustomMixerIntegrationTest, TestCustomMixer)
 
     mixerInit(MIXER_CUSTOM_AIRPLANE, customMotorMixer, customServoMixer);
 
-    pwmOutputConfiguration_t pwmOutputConfiguration = {
-            .servoCount = 6,
-            .motorCount = 2
-    };
-
-    mixerUsePWMOutputConfiguration(&pwmOutputConfiguration);
+    mixerUsePWMIOConfiguration();
 
     // and
     rcCommand[THROTTLE] = 1000;
@@ -342,12 +331,13 @@ TEST_F(CustomMixerIntegrationTest, TestCustomMixer)
     rcData[AUX1] = 2000;
 
     // and
-    memset(axisPID, 0, sizeof(axisPID));
+    memset(axisPID, 0, sizeof(int16_t) * XYZ_AXIS_COUNT);
     axisPID[YAW] = 0;
 
 
     // when
     mixTable();
+    servoMixer(0, 0);
     writeMotors();
     writeServos();
 
@@ -368,6 +358,464 @@ TEST_F(CustomMixerIntegrationTest, TestCustomMixer)
 
 }
 
+class MotorMixerTest : public BasicMixerIntegrationTest {
+protected:
+
+    virtual void SetUp() {
+
+        BasicMixerIntegrationTest::SetUp();
+
+        escAndServoConfig.mincommand = TEST_MIN_COMMAND;
+        escAndServoConfig.minthrottle = 1150;
+        escAndServoConfig.maxthrottle = 1850;
+
+        mixerConfig.yaw_motor_direction = 1;
+        mixerConfig.yaw_jump_prevention_limit = YAW_JUMP_PREVENTION_LIMIT_HIGH;
+
+        withDefaultRxConfig();
+        rxConfig.mincheck = 1100;
+
+        testFeatureMask = 0;
+        armingFlags = 0;
+        ENABLE_ARMING_FLAG(ARMED);
+
+        configureMixer();
+    }
+
+    virtual void TearDown() {
+        armingFlags = 0;
+    }
+};
+
+static const motorMixer_t referenceQuadX[] = {
+    { 1.0f, -1.0f,  1.0f, -1.0f },          // REAR_R
+    { 1.0f, -1.0f, -1.0f,  1.0f },          // FRONT_R
+    { 1.0f,  1.0f,  1.0f,  1.0f },          // REAR_L
+    { 1.0f,  1.0f, -1.0f, -1.0f },          // FRONT_L
+};
+
+// The integer mixer the float one replaced, armed and without 3D, failsafe or motor stop
+static void referenceMixTable(const escAndServoConfig_t *escAndServoConfig, int16_t *out)
+{
+    int16_t rpyMix[4];
+    int16_t rpyMixMax = 0;
+    int16_t rpyMixMin = 0;
+
+    for (int i = 0; i < 4; i++) {
+        rpyMix[i] = axisPID[PITCH] * referenceQuadX[i].pitch + axisPID[ROLL] * referenceQuadX[i].roll + -1 * axisPID[YAW] * referenceQuadX[i].yaw;
+        if (rpyMix[i] > rpyMixMax) rpyMixMax = rpyMix[i];
+        if (rpyMix[i] < rpyMixMin) rpyMixMin = rpyMix[i];
+    }
+
+    int16_t rpyMixRange = rpyMixMax - rpyMixMin;
+    int16_t throttleMin = escAndServoConfig->minthrottle;
+    int16_t throttleMax = escAndServoConfig->maxthrottle;
+    int16_t throttleRange = throttleMax - throttleMin;
+
+    if (rpyMixRange > throttleRange) {
+        float mixReduction = (float)throttleRange / rpyMixRange;
+        for (int i = 0; i < 4; i++) {
+            rpyMix[i] = mixReduction * rpyMix[i];
+        }
+        throttleMin = throttleMin + (throttleRange / 2) - (throttleRange * 0.33f / 2);
+        throttleMax = throttleMin + (throttleRange / 2) + (throttleRange * 0.33f / 2);
+    } else {
+        throttleMin = MIN(throttleMin + (rpyMixRange / 2), throttleMin + (throttleRange / 2) - (throttleRange * 0.33f / 2));
+        throttleMax = MAX(throttleMax - (rpyMixRange / 2), throttleMin + (throttleRange / 2) + (throttleRange * 0.33f / 2));
+    }
+
+    for (int i = 0; i < 4; i++) {
+        out[i] = rpyMix[i] + constrain(rcCommand[THROTTLE] * referenceQuadX[i].throttle, throttleMin, throttleMax);
+        out[i] = constrain(out[i], escAndServoConfig->minthrottle, escAndServoConfig->maxthrottle);
+    }
+}
+
+TEST_F(MotorMixerTest, TestQuadXMatchesIntegerMixer)
+{
+    // given
+    mixerInit(MIXER_QUADX, customMotorMixer, customServoMixer);
+    mixerUsePWMIOConfiguration();
+
+    srand(42);
+    for (int n = 0; n < 10000; n++) {
+        // and
+        rcCommand[THROTTLE] = 1000 + rand() % 1001;
+        axisPID[ROLL] = rand() % 1001 - 500;
+        axisPID[PITCH] = rand() % 1001 - 500;
+        axisPID[YAW] = rand() % 1001 - 500;
+
+        int16_t expected[4];
+        referenceMixTable(&escAndServoConfig, expected);
+
+        // when
+        mixTable();
+
+        // then the float mixer only differs by rounding
+        for (int i = 0; i < 4; i++) {
+            EXPECT_NEAR(expected[i], motor[i], 2);
+        }
+    }
+}
+
+TEST_F(MotorMixerTest, TestRollSaturationIsReportedOnRollOnly)
+{
+    // given
+    mixerInit(MIXER_QUADX, customMotorMixer, customServoMixer);
+    mixerUsePWMIOConfiguration();
+
+    // and
+    rcCommand[THROTTLE] = 1500;
+    axisPID[ROLL] = 400;
+    axisPID[PITCH] = 0;
+    axisPID[YAW] = 0;
+
+    // when
+    mixTable();
+
+    // then the left and right motors get the full throttle range between them
+    EXPECT_TRUE(motorLimitReached);
+    EXPECT_EQ(1 << ROLL, motorLimitReachedAxes);
+    EXPECT_EQ(motor[0], motor[1]);
+    EXPECT_EQ(motor[2], motor[3]);
+    EXPECT_NEAR(escAndServoConfig.maxthrottle - escAndServoConfig.minthrottle, motor[2] - motor[0], 1);
+}
+
+TEST_F(MotorMixerTest, TestSaturationFollowsTheAxesDrivingTheExtremeMotors)
+{
+    // given
+    mixerInit(MIXER_QUADX, customMotorMixer, customServoMixer);
+    mixerUsePWMIOConfiguration();
+
+    // and roll and pitch both push REAR_L up and FRONT_R down, yaw moves both of those motors the same way
+    rcCommand[THROTTLE] = 1500;
+    axisPID[ROLL] = 300;
+    axisPID[PITCH] = 300;
+    axisPID[YAW] = -20;
+
+    // when
+    mixTable();
+
+    // then
+    EXPECT_TRUE(motorLimitReached);
+    EXPECT_EQ((1 << ROLL) | (1 << PITCH), motorLimitReachedAxes);
+
+    // when
+    axisPID[ROLL] = 50;
+    axisPID[PITCH] = 50;
+    axisPID[YAW] = 20;
+    mixTable();
+
+    // then
+    EXPECT_FALSE(motorLimitReached);
+    EXPECT_EQ(0, motorLimitReachedAxes);
+}
+
+TEST_F(MotorMixerTest, TestMotorStopAndFailsafeLimits)
+{
+    // given
+    mixerInit(MIXER_QUADX, customMotorMixer, customServoMixer);
+    mixerUsePWMIOConfiguration();
+
+    // and
+    testFeatureMask = FEATURE_MOTOR_STOP;
+    rcData[THROTTLE] = 1000;
+    rcCommand[THROTTLE] = 1000;
+    axisPID[ROLL] = 100;
+
+    // when
+    mixTable();
+
+    // then
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(TEST_MIN_COMMAND, motor[i]);
+    }
+
+    // when
+    armingFlags = 0;
+    mixTable();
+
+    // then
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(TEST_MIN_COMMAND, motor[i]);
+    }
+}
+
+#define MIXER_BENCHMARK_ITERATIONS 200000
+
+TEST_F(MotorMixerTest, BenchmarkMixTable)
+{
+    static const struct {
+        mixerMode_e mode;
+        const char *name;
+    } layouts[] = {
+        { MIXER_QUADX, "quad" },
+        { MIXER_HEX6X, "hex" },
+        { MIXER_OCTOX8, "octo" },
+    };
+
+    for (unsigned l = 0; l < sizeof(layouts) / sizeof(layouts[0]); l++) {
+        // given
+        mixerInit(layouts[l].mode, customMotorMixer, customServoMixer);
+        mixerUsePWMIOConfiguration();
+
+        // when
+        const uint64_t startedAt = monotonicNanos();
+        for (int n = 0; n < MIXER_BENCHMARK_ITERATIONS; n++) {
+            rcCommand[THROTTLE] = 1200 + (n & 511);
+            axisPID[ROLL] = (n & 255) - 128;
+            axisPID[PITCH] = 128 - (n & 127);
+            axisPID[YAW] = (n & 63) - 32;
+            mixTable();
+        }
+        const double usPerMix = (monotonicNanos() - startedAt) / 1000.0 / MIXER_BENCHMARK_ITERATIONS;
+
+        // then
+        printf("[ BENCH    ] mixTable %s: %.3f us\n", layouts[l].name, usPerMix);
+    }
+}
+
+class ServoMixerTest : public CustomMixerIntegrationTest {
+protected:
+
+    virtual void SetUp() {
+
+        CustomMixerIntegrationTest::SetUp();
+
+        testFeatureMask = 0;
+        flightModeFlags = 0;
+        rcModeActivationMask = 0;
+
+        for (int i = 0; i < MAX_SUPPORTED_RC_CHANNEL_COUNT; i++) {
+            rcData[i] = TEST_RC_MID;
+        }
+    }
+
+    virtual void TearDown() {
+        flightModeFlags = 0;
+        rcModeActivationMask = 0;
+    }
+};
+
+// Rules of a flying wing with a few extras, every rule feature is used at least once
+static const servoMixer_t testPlaneServoMixer[] = {
+    { SERVO_FLAPPERON_1, INPUT_STABILIZED_ROLL,  100, 0, 0, 100, 0 },
+    { SERVO_FLAPPERON_1, INPUT_STABILIZED_PITCH, 100, 0, 0, 100, 0 },
+    { SERVO_FLAPPERON_2, INPUT_STABILIZED_ROLL,  100, 0, 0, 100, 0 },
+    { SERVO_FLAPPERON_2, INPUT_STABILIZED_PITCH, -100, 0, 0, 100, 0 },
+    { SERVO_RUDDER, INPUT_STABILIZED_YAW, 80, 0, 10, 90, 0 },
+    { SERVO_RUDDER, INPUT_RC_YAW, 20, 5, 0, 100, 0 },
+    { SERVO_ELEVATOR, INPUT_STABILIZED_PITCH, 125, 0, 30, 70, 0 },
+    { SERVO_ELEVATOR, INPUT_GIMBAL_PITCH, 50, 0, 0, 100, 1 },
+    { SERVO_THROTTLE, INPUT_STABILIZED_THROTTLE, 100, 0, 0, 100, 0 },
+    { SERVO_FLAPS, INPUT_RC_AUX1, 100, 10, 0, 100, 0 },
+    { SERVO_FLAPS, INPUT_RC_AUX2, -50, 0, 0, 100, 2 },
+};
+
+#define TEST_PLANE_SERVO_RULE_COUNT (sizeof(testPlaneServoMixer) / sizeof(testPlaneServoMixer[0]))
+
+// The rule walk the compiled servo mixer replaced
+static void referenceServoMixer(const servoMixer_t *rules, int ruleCount, const servoParam_t *servoConf, const rxConfig_t *rxConfig,
+    int16_t *currentOutput, uint16_t flaperon_throw_offset, uint8_t flaperon_throw_inverted, int16_t *out)
+{
+    int16_t input[INPUT_SOURCE_COUNT];
+
+    if (FLIGHT_MODE(PASSTHRU_MODE)) {
+        input[INPUT_STABILIZED_ROLL] = rcCommand[ROLL];
+        input[INPUT_STABILIZED_PITCH] = rcCommand[PITCH];
+        input[INPUT_STABILIZED_YAW] = rcCommand[YAW];
+    } else {
+        input[INPUT_STABILIZED_ROLL] = axisPID[ROLL];
+        input[INPUT_STABILIZED_PITCH] = axisPID[PITCH];
+        input[INPUT_STABILIZED_YAW] = axisPID[YAW];
+    }
+    input[INPUT_GIMBAL_PITCH] = scaleRange(attitude.values.pitch, -1800, 1800, -500, +500);
+    input[INPUT_GIMBAL_ROLL] = scaleRange(attitude.values.roll, -1800, 1800, -500, +500);
+    input[INPUT_STABILIZED_THROTTLE] = motor[0] - 1000 - 500;
+    for (int i = INPUT_RC_ROLL; i <= INPUT_RC_AUX4; i++) {
+        input[i] = rcData[i - INPUT_RC_ROLL] - rxConfig->midrc;
+    }
+
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        out[i] = 0;
+    }
+
+    for (int i = 0; i < ruleCount; i++) {
+        if (rules[i].box == 0 || IS_RC_MODE_ACTIVE(BOXSERVO1 + rules[i].box - 1)) {
+            uint8_t target = rules[i].targetChannel;
+            uint8_t from = rules[i].inputSource;
+            uint16_t servo_width = servoConf[target].max - servoConf[target].min;
+            int16_t min = rules[i].min * servo_width / 100 - servo_width / 2;
+            int16_t max = rules[i].max * servo_width / 100 - servo_width / 2;
+
+            if (rules[i].speed == 0) {
+                currentOutput[i] = input[from];
+            } else if (currentOutput[i] < input[from]) {
+                currentOutput[i] = constrain(currentOutput[i] + rules[i].speed, currentOutput[i], input[from]);
+            } else if (currentOutput[i] > input[from]) {
+                currentOutput[i] = constrain(currentOutput[i] - rules[i].speed, input[from], currentOutput[i]);
+            }
+
+            if (FLIGHT_MODE(FLAPERON) && (target == SERVO_FLAPPERON_1 || target == SERVO_FLAPPERON_2)) {
+                currentOutput[i] += flaperon_throw_offset * (target == SERVO_FLAPPERON_2 ? -1 : 1) * (flaperon_throw_inverted == 1 ? -1 : 1);
+            }
+
+            int direction = (servoConf[target].reversedSources & (1 << from)) ? -1 : 1;
+            out[target] += direction * constrain(((int32_t)currentOutput[i] * rules[i].rate) / 100, min, max);
+        } else {
+            currentOutput[i] = 0;
+        }
+    }
+
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        out[i] = ((int32_t)servoConf[i].rate * out[i]) / 100L + servoConf[i].middle;
+    }
+}
+
+static void driveServoInputs(int n)
+{
+    axisPID[ROLL] = (n * 37 % 1000) - 500;
+    axisPID[PITCH] = 400 - (n * 53 % 800);
+    axisPID[YAW] = (n * 11 % 600) - 300;
+    motor[0] = 1000 + (n * 7 % 1000);
+    attitude.values.pitch = (n * 101 % 3600) - 1800;
+    rcData[YAW] = 1000 + (n * 29 % 1000);
+    rcData[AUX1] = (n / 50) % 2 ? 2000 : 1000;
+    rcData[AUX2] = 1000 + (n * 13 % 1000);
+}
+
+TEST_F(ServoMixerTest, TestCompiledRulesMatchRuleWalk)
+{
+    // given
+    memcpy(customServoMixer, testPlaneServoMixer, sizeof(testPlaneServoMixer));
+
+    // and some servos reversed for some of their sources, one with unusual limits
+    servoConf[SERVO_FLAPPERON_2].reversedSources = 1 << INPUT_STABILIZED_ROLL;
+    servoConf[SERVO_RUDDER].reversedSources = (1 << INPUT_STABILIZED_YAW) | (1 << INPUT_RC_YAW);
+    servoConf[SERVO_ELEVATOR].min = 1100;
+    servoConf[SERVO_ELEVATOR].max = 1700;
+    servoConf[SERVO_ELEVATOR].rate = -80;
+
+    mixerInit(MIXER_CUSTOM_AIRPLANE, customMotorMixer, customServoMixer);
+    mixerUsePWMIOConfiguration();
+
+    int16_t referenceOutput[TEST_PLANE_SERVO_RULE_COUNT];
+    memset(referenceOutput, 0, sizeof(referenceOutput));
+
+    for (int n = 0; n < 2000; n++) {
+        // given
+        driveServoInputs(n);
+
+        // and boxes, passthru and flaperon come and go
+        rcModeActivationMask = (n / 100) % 4 << BOXSERVO1;
+        flightModeFlags = 0;
+        if ((n / 300) % 2) {
+            flightModeFlags |= FLAPERON;
+        }
+        if ((n / 700) % 2) {
+            flightModeFlags |= PASSTHRU_MODE;
+            rcCommand[ROLL] = axisPID[PITCH];
+            rcCommand[PITCH] = axisPID[YAW];
+            rcCommand[YAW] = axisPID[ROLL];
+        }
+
+        int16_t expected[MAX_SUPPORTED_SERVOS];
+        referenceServoMixer(testPlaneServoMixer, TEST_PLANE_SERVO_RULE_COUNT, servoConf, &rxConfig, referenceOutput, 250, (n / 1000) % 2, expected);
+
+        // when
+        servoMixer(250, (n / 1000) % 2);
+
+        // then
+        for (int i = SERVO_PLANE_INDEX_MIN; i <= SERVO_PLANE_INDEX_MAX; i++) {
+            ASSERT_EQ(expected[i], servo[i]) << "servo " << i << " cycle " << n;
+        }
+    }
+}
+
+TEST_F(ServoMixerTest, TestServoConfigurationChangesNeedRecompile)
+{
+    // given
+    memcpy(customServoMixer, testPlaneServoMixer, sizeof(testPlaneServoMixer));
+    mixerInit(MIXER_CUSTOM_AIRPLANE, customMotorMixer, customServoMixer);
+    mixerUsePWMIOConfiguration();
+
+    // and
+    axisPID[YAW] = 100;
+
+    // when
+    servoMixer(0, 0);
+
+    // then
+    EXPECT_EQ(TEST_SERVO_MID + 80, servo[SERVO_RUDDER]);
+
+    // when the yaw input is reversed on the rudder
+    servoConf[SERVO_RUDDER].reversedSources = 1 << INPUT_STABILIZED_YAW;
+    servoMixerCompileRules();
+    servoMixer(0, 0);
+
+    // then
+    EXPECT_EQ(TEST_SERVO_MID - 80, servo[SERVO_RUDDER]);
+
+    // when the rule limits shrink with the servo throw
+    servoConf[SERVO_RUDDER].min = 1450;
+    servoConf[SERVO_RUDDER].max = 1550;
+    servoMixerCompileRules();
+    servoMixer(0, 0);
+
+    // then the rule is clipped to 90% of the new throw
+    EXPECT_EQ(TEST_SERVO_MID - 40, servo[SERVO_RUDDER]);
+}
+
+TEST_F(ServoMixerTest, TestOnlyWrittenServosAreFiltered)
+{
+    // given
+    mixerConfig.servo_lowpass_enable = 1;
+    mixerConfig.servo_lowpass_freq = 50;
+    targetLooptime = 2000;
+
+    memcpy(customServoMixer, testPlaneServoMixer, sizeof(testPlaneServoMixer));
+    mixerInit(MIXER_CUSTOM_AIRPLANE, customMotorMixer, customServoMixer);
+    mixerUsePWMIOConfiguration();
+
+    // and the gimbal servos are not written out
+    servo[SERVO_GIMBAL_PITCH] = 1900;
+    servo[SERVO_GIMBAL_ROLL] = 1100;
+    for (int i = SERVO_PLANE_INDEX_MIN; i <= SERVO_PLANE_INDEX_MAX; i++) {
+        servo[i] = 1900;
+    }
+
+    // when
+    filterServos();
+
+    // then
+    EXPECT_EQ(1900, servo[SERVO_GIMBAL_PITCH]);
+    EXPECT_EQ(1100, servo[SERVO_GIMBAL_ROLL]);
+    for (int i = SERVO_PLANE_INDEX_MIN; i <= SERVO_PLANE_INDEX_MAX; i++) {
+        EXPECT_LT(servo[i], 1900);
+    }
+}
+
+TEST_F(ServoMixerTest, BenchmarkServoMixer)
+{
+    // given all rules in use, the worst case
+    for (int i = 0; i < MAX_SERVO_RULES; i++) {
+        customServoMixer[i] = testPlaneServoMixer[i % TEST_PLANE_SERVO_RULE_COUNT];
+    }
+    mixerInit(MIXER_CUSTOM_AIRPLANE, customMotorMixer, customServoMixer);
+    mixerUsePWMIOConfiguration();
+    rcModeActivationMask = (1 << BOXSERVO1) | (1 << BOXSERVO2);
+
+    // when
+    const uint64_t startedAt = monotonicNanos();
+    for (int n = 0; n < MIXER_BENCHMARK_ITERATIONS; n++) {
+        driveServoInputs(n);
+        servoMixer(0, 0);
+    }
+    const double usPerMix = (monotonicNanos() - startedAt) / 1000.0 / MIXER_BENCHMARK_ITERATIONS;
+
+    // then
+    printf("[ BENCH    ] servoMixer %d rules: %.3f us\n", MAX_SERVO_RULES, usPerMix);
+}
+
 // STUBS
 
 extern "C" {
@@ -385,14 +833,16 @@ uint8_t stateFlags;
 uint16_t flightModeFlags;
 uint8_t armingFlags;
 
+uint32_t targetLooptime;
+
 void delay(uint32_t) {}
 
-bool feature(uint32_t mask) {
-    return (mask & testFeatureMask);
+uint32_t micros(void) {
+    return 0;
 }
 
-int32_t lowpassFixed(lowpass_t *, int32_t, int16_t) {
-    return 0;
+bool feature(uint32_t mask) {
+    return (mask & testFeatureMask);
 }
 
 void pwmWriteMotor(uint8_t index, uint16_t value) {
@@ -0,0 +1,425 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+extern "C" {
+    #include "debug.h"
+
+    #include "platform.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+    #include "common/filter.h"
+
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+
+    #include "sensors/sensors.h"
+    #include "sensors/gyro.h"
+
+    #include "rx/rx.h"
+    #include "io/rc_controls.h"
+    #include "flight/pid.h"
+    #include "flight/imu.h"
+
+    #include "config/runtime_config.h"
+
+    float throttlePGain(int16_t throttle);
+    float throttleDGain(int16_t throttle);
+    float antiGravityIGain(const pidProfile_t *pidProfile, int16_t throttle, uint32_t currentTime);
+
+    extern uint32_t targetLooptime;
+    extern float dT;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+class ThrottlePIDGainTest : public ::testing::Test {
+protected:
+    controlRateConfig_t controlRateConfig;
+    rxConfig_t rxConfig;
+    pidProfile_t pidProfile;
+
+    virtual void SetUp() {
+        memset(&controlRateConfig, 0, sizeof(controlRateConfig));
+        memset(&rxConfig, 0, sizeof(rxConfig));
+        memset(&pidProfile, 0, sizeof(pidProfile));
+
+        rxConfig.mincheck = 1100;
+        rxConfig.maxcheck = 1900;
+
+        pidProfile.anti_gravity_gain = ANTI_GRAVITY_GAIN_OFF;
+        pidProfile.anti_gravity_threshold = 35;
+    }
+};
+
+// What updatePIDCoefficients() worked out on every RX update before the tables
+static float referenceTpaFactor(const controlRateConfig_t *controlRateConfig, int16_t throttle)
+{
+    if (controlRateConfig->dynThrPID == 0 || throttle < controlRateConfig->tpa_breakpoint) {
+        return 1.0f;
+    } else if (throttle < 2000) {
+        return (100 - (uint16_t)controlRateConfig->dynThrPID * (throttle - controlRateConfig->tpa_breakpoint) / (2000 - controlRateConfig->tpa_breakpoint)) / 100.0f;
+    } else {
+        return (100 - controlRateConfig->dynThrPID) / 100.0f;
+    }
+}
+
+static float referenceKdAttenuation(const rxConfig_t *rxConfig, int16_t throttle)
+{
+    float relThrottle = constrainf(((float)throttle - (float)rxConfig->mincheck) / ((float)rxConfig->maxcheck - (float)rxConfig->mincheck), 0.0f, 1.0f);
+
+    if (relThrottle < 0.25f) {
+        return constrainf((relThrottle / 0.25f) + 0.50f, 0.0f, 1.0f);
+    }
+    return 1.0f;
+}
+
+TEST_F(ThrottlePIDGainTest, TablesFollowTpaAndKdAttenuation)
+{
+    static const struct {
+        uint8_t rate;
+        uint16_t breakpoint;
+    } settings[] = {
+        { 0, 1500 },
+        { 50, 1500 },
+        { 100, 1000 },
+        { 30, 1725 },
+    };
+
+    for (unsigned s = 0; s < sizeof(settings) / sizeof(settings[0]); s++) {
+        // given
+        controlRateConfig.dynThrPID = settings[s].rate;
+        controlRateConfig.tpa_breakpoint = settings[s].breakpoint;
+
+        // when
+        generateThrottlePIDGains(&controlRateConfig, &rxConfig);
+
+        // then the interpolated tables are within 2% of the formulas, even between the table points where TPA and KD attenuation multiply
+        for (int16_t throttle = 900; throttle <= 2100; throttle++) {
+            const int16_t constrainedThrottle = constrain(throttle, PWM_RANGE_MIN, PWM_RANGE_MAX);
+            const float tpaFactor = referenceTpaFactor(&controlRateConfig, constrainedThrottle);
+            const float kdAttenuation = referenceKdAttenuation(&rxConfig, constrainedThrottle);
+
+            ASSERT_NEAR(tpaFactor, throttlePGain(throttle), 0.02f) << "tpa_rate " << (int)settings[s].rate << " throttle " << throttle;
+            ASSERT_NEAR(tpaFactor * kdAttenuation, throttleDGain(throttle), 0.02f) << "tpa_rate " << (int)settings[s].rate << " throttle " << throttle;
+        }
+    }
+}
+
+TEST_F(ThrottlePIDGainTest, TablesAreExactAtTheirPoints)
+{
+    // given
+    controlRateConfig.dynThrPID = 40;
+    controlRateConfig.tpa_breakpoint = 1500;
+
+    // when
+    generateThrottlePIDGains(&controlRateConfig, &rxConfig);
+
+    // then
+    EXPECT_FLOAT_EQ(1.0f, throttlePGain(1000));
+    EXPECT_FLOAT_EQ(1.0f, throttlePGain(1500));
+    EXPECT_FLOAT_EQ(0.8f, throttlePGain(1750));
+    EXPECT_FLOAT_EQ(0.6f, throttlePGain(2000));
+
+    // and D is cut by half at mincheck, recovering over the next eighth of the stick
+    EXPECT_FLOAT_EQ(0.5f, throttleDGain(1100));
+    EXPECT_FLOAT_EQ(0.75f, throttleDGain(1150));
+    EXPECT_FLOAT_EQ(1.0f, throttleDGain(1200));
+    EXPECT_FLOAT_EQ(0.6f, throttleDGain(2000));
+}
+
+TEST_F(ThrottlePIDGainTest, AntiGravityOffByDefault)
+{
+    // given
+    antiGravityIGain(&pidProfile, 1000, 0);
+
+    // when the throttle is slammed
+    float iGain = antiGravityIGain(&pidProfile, 2000, 20000);
+
+    // then
+    EXPECT_FLOAT_EQ(1.0f, iGain);
+}
+
+TEST_F(ThrottlePIDGainTest, AntiGravityBoostsOnFastThrottleMoves)
+{
+    // given
+    pidProfile.anti_gravity_gain = 25;
+    uint32_t now = 1000000;
+    antiGravityIGain(&pidProfile, 1300, now);
+
+    // when the throttle moves slower than 35us per 10ms, updates every 20ms
+    float iGain = 0;
+    int16_t throttle = 1300;
+    for (int i = 0; i < 10; i++) {
+        now += 20000;
+        throttle += 60;
+        iGain = antiGravityIGain(&pidProfile, throttle, now);
+    }
+
+    // then
+    EXPECT_FLOAT_EQ(1.0f, iGain);
+
+    // when it is chopped
+    now += 20000;
+    iGain = antiGravityIGain(&pidProfile, 1300, now);
+
+    // then
+    EXPECT_FLOAT_EQ(2.5f, iGain);
+
+    // and the boost is held
+    now += 200000;
+    EXPECT_FLOAT_EQ(2.5f, antiGravityIGain(&pidProfile, 1300, now));
+
+    // and released 250ms after the throttle stopped
+    now += 60000;
+    EXPECT_FLOAT_EQ(1.0f, antiGravityIGain(&pidProfile, 1300, now));
+}
+
+TEST_F(ThrottlePIDGainTest, AntiGravityThresholdScalesWithUpdateInterval)
+{
+    // given
+    pidProfile.anti_gravity_gain = 20;
+    antiGravityIGain(&pidProfile, 1500, 5000000);
+
+    // when 100us in 20ms, 50us per 10ms
+    float iGain = antiGravityIGain(&pidProfile, 1600, 5020000);
+
+    // then
+    EXPECT_FLOAT_EQ(2.0f, iGain);
+
+    // given
+    antiGravityIGain(&pidProfile, 1600, 6000000);
+
+    // when 100us in 50ms, 20us per 10ms
+    iGain = antiGravityIGain(&pidProfile, 1500, 6050000);
+
+    // then
+    EXPECT_FLOAT_EQ(1.0f, iGain);
+}
+
+TEST_F(ThrottlePIDGainTest, AntiGravityIgnoresSmallMovesAfterALongStall)
+{
+    // given
+    pidProfile.anti_gravity_gain = 20;
+    pidProfile.anti_gravity_threshold = ANTI_GRAVITY_THRESHOLD_MAX;
+    antiGravityIGain(&pidProfile, 1500, 1000000);
+
+    // when the next update comes after a stall long enough for threshold * time to pass 2^32
+    float iGain = antiGravityIGain(&pidProfile, 1510, 1000000 + 42949673);
+
+    // then
+    EXPECT_FLOAT_EQ(1.0f, iGain);
+}
+
+// Peak output of the bank for a sine at the given frequency, after it settled
+static float filterBankGain(filterBank_t *bank, float frequency, float dT)
+{
+    float peak = 0;
+
+    for (int i = 0; i < 4000; i++) {
+        const float output = filterBankApply(bank, sinf(2 * M_PIf * frequency * i * dT));
+        if (i >= 3000) {
+            peak = MAX(peak, fabsf(output));
+        }
+    }
+    return peak;
+}
+
+TEST(FilterBankTest, PT1StageMatchesPT1Filter)
+{
+    // given
+    const float dT = 0.002f;
+    filterBank_t bank;
+    filterBankInit(&bank);
+    pt1Filter_t pt1;
+    memset(&pt1, 0, sizeof(pt1));
+
+    // when
+    EXPECT_TRUE(filterBankAddPT1(&bank, 40, dT));
+
+    // then
+    for (int i = 0; i < 100; i++) {
+        const float input = (i % 7) * 10.0f - 30.0f;
+        EXPECT_NEAR(pt1FilterApply4(&pt1, input, 40, dT), filterBankApply(&bank, input), 1e-4f);
+    }
+}
+
+TEST(FilterBankTest, NotchRemovesItsCenterOnly)
+{
+    // given
+    const float dT = 0.000125f;
+    filterBank_t bank;
+    filterBankInit(&bank);
+
+    // when
+    EXPECT_TRUE(filterBankAddNotch(&bank, 200, 150, dT));
+
+    // then
+    EXPECT_LT(filterBankGain(&bank, 200, dT), 0.02f);
+    EXPECT_NEAR(1.0f / sqrtf(2), filterBankGain(&bank, 150, dT), 0.03f);
+    EXPECT_GT(filterBankGain(&bank, 20, dT), 0.98f);
+    EXPECT_GT(filterBankGain(&bank, 1000, dT), 0.98f);
+}
+
+TEST(FilterBankTest, StagesAreChained)
+{
+    // given
+    const float dT = 0.000250f;
+    filterBank_t lowpass, notch, bank;
+    filterBankInit(&lowpass);
+    filterBankInit(&notch);
+    filterBankInit(&bank);
+    filterBankAddLowpass(&lowpass, 100, dT);
+    filterBankAddNotch(&notch, 300, 200, dT);
+
+    // when
+    EXPECT_TRUE(filterBankAddLowpass(&bank, 100, dT));
+    EXPECT_TRUE(filterBankAddNotch(&bank, 300, 200, dT));
+
+    // then the gains multiply
+    EXPECT_NEAR(1.0f / sqrtf(2), filterBankGain(&lowpass, 100, dT), 0.03f);
+    for (float frequency = 50; frequency <= 500; frequency += 50) {
+        EXPECT_NEAR(filterBankGain(&lowpass, frequency, dT) * filterBankGain(&notch, frequency, dT), filterBankGain(&bank, frequency, dT), 0.01f) << frequency << "Hz";
+    }
+
+    // and DC goes through both
+    float output = 0;
+    for (int i = 0; i < 2000; i++) {
+        output = filterBankApply(&bank, 1.0f);
+    }
+    EXPECT_NEAR(1.0f, output, 0.01f);
+}
+
+TEST(FilterBankTest, UnusableStagesAreLeftOut)
+{
+    // given
+    filterBank_t bank;
+    filterBankInit(&bank);
+
+    // when
+    EXPECT_FALSE(filterBankAddPT1(&bank, 0, 0.001f));           // off
+    EXPECT_FALSE(filterBankAddLowpass(&bank, 600, 0.001f));     // above Nyquist
+    EXPECT_FALSE(filterBankAddNotch(&bank, 200, 250, 0.001f));  // cutoff above the center
+
+    // then the bank passes the input through
+    EXPECT_EQ(0, bank.stageCount);
+    EXPECT_FLOAT_EQ(12.5f, filterBankApply(&bank, 12.5f));
+}
+
+class RateControllerDTermTest : public ::testing::Test {
+protected:
+    pidProfile_t pidProfile;
+    controlRateConfig_t controlRateConfig;
+    rxConfig_t rxConfig;
+    dtermConfig_t dtermConfig;
+
+    virtual void SetUp() {
+        memset(&pidProfile, 0, sizeof(pidProfile));
+        memset(&controlRateConfig, 0, sizeof(controlRateConfig));
+        memset(&rxConfig, 0, sizeof(rxConfig));
+        memset(&dtermConfig, 0, sizeof(dtermConfig));
+        memset(rcCommand, 0, sizeof(rcCommand));
+        memset(gyroADC, 0, sizeof(gyroADC));
+
+        // D only on ROLL, TPA off
+        pidProfile.D8[FD_ROLL] = 30;
+        pidProfile.rollPitchItermIgnoreRate = 200;
+        pidProfile.yawItermIgnoreRate = 50;
+        pidProfile.anti_gravity_gain = ANTI_GRAVITY_GAIN_OFF;
+        controlRateConfig.rates[FD_ROLL] = 50;
+        generateThrottlePIDGains(&controlRateConfig, &rxConfig);
+
+        targetLooptime = 1000;
+        dT = 0.001f;
+        gyro.scale = 1.0f;
+    }
+
+    // ROLL output to a stick step with the gyro not moving
+    float rollOutputToStickStep(void) {
+        pidUseDtermConfig(&dtermConfig);
+        pidInit();
+        updatePIDCoefficients(&pidProfile, 0);
+
+        rcCommand[FD_ROLL] = 0;
+        pidController(&pidProfile, &controlRateConfig, &rxConfig);
+        rcCommand[FD_ROLL] = 10;
+        pidController(&pidProfile, &controlRateConfig, &rxConfig);
+        return axisPID[FD_ROLL];
+    }
+};
+
+TEST_F(RateControllerDTermTest, DTermIgnoresTheSticksWithoutSetpointWeight)
+{
+    // given
+    dtermConfig.dterm_setpoint_weight = 0;
+
+    // expect
+    EXPECT_EQ(0, rollOutputToStickStep());
+}
+
+TEST_F(RateControllerDTermTest, SetpointWeightFeedsStickMovesIntoDTerm)
+{
+    // given
+    dtermConfig.dterm_setpoint_weight = 50;
+    const float halfWeighted = rollOutputToStickStep();
+
+    dtermConfig.dterm_setpoint_weight = 100;
+    const float fullWeighted = rollOutputToStickStep();
+
+    // then the D term pushes in the direction of the stick, in proportion to the weight
+    EXPECT_GT(halfWeighted, 0);
+    EXPECT_NEAR(2 * halfWeighted, fullWeighted, 1);
+}
+
+// STUBS
+
+extern "C" {
+attitudeEulerAngles_t attitude;
+gyro_t gyro;
+int32_t gyroADC[XYZ_AXIS_COUNT];
+
+int16_t rcCommand[4];
+int16_t rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+
+uint8_t stateFlags;
+uint16_t flightModeFlags;
+uint8_t armingFlags;
+
+uint8_t motorCount;
+uint8_t motorLimitReachedAxes;
+float dT;
+
+uint32_t targetLooptime;
+
+int16_t debug[DEBUG16_VALUE_COUNT];
+
+bool sensors(uint32_t) {
+    return false;
+}
+
+int32_t getRcStickDeflection(int32_t, uint16_t) {
+    return 0;
+}
+
+void imuTransformVectorEarthToBody(t_fp_vector *) {}
+}
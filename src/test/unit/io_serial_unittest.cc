@@ -27,10 +27,12 @@ extern "C" {
     #include "io/serial.h"
 
     void serialInit(serialConfig_t *initialSerialConfig);
+    void serialCalculateBufferSizes(const serialPortConfig_t *portConfig, serialPortBuffers_t *buffers);
 
 }
 
 #include "unittest_macros.h"
+#include "unittest_timing.h"
 #include "gtest/gtest.h"
 
 //uint32_t testFeatureMask = 0;
@@ -52,6 +54,251 @@ TEST(IoSerialTest, TestFindPortConfig)
     EXPECT_EQ(NULL, portConfig);
 }
 
+TEST(IoSerialTest, TestBufferSizesFollowFunctionAndBaudRate)
+{
+    // given
+    serialPortConfig_t portConfig;
+    serialPortBuffers_t buffers;
+    memset(&portConfig, 0, sizeof(portConfig));
+
+    // when
+    portConfig.functionMask = FUNCTION_GPS;
+    portConfig.gps_baudrateIndex = BAUD_9600;
+    serialCalculateBufferSizes(&portConfig, &buffers);
+
+    // then
+    EXPECT_EQ(128u, buffers.rxBufferSize);
+    EXPECT_EQ(128u, buffers.txBufferSize);
+
+    // when
+    portConfig.gps_baudrateIndex = BAUD_115200;
+    serialCalculateBufferSizes(&portConfig, &buffers);
+
+    // then
+    EXPECT_EQ(512u, buffers.rxBufferSize);
+
+    // when
+    portConfig.functionMask = FUNCTION_MSP | FUNCTION_BLACKBOX;
+    portConfig.msp_baudrateIndex = BAUD_115200;
+    portConfig.blackbox_baudrateIndex = BAUD_250000;
+    serialCalculateBufferSizes(&portConfig, &buffers);
+
+    // then
+    EXPECT_EQ(256u, buffers.rxBufferSize);
+    EXPECT_EQ(1024u, buffers.txBufferSize);
+
+    // when
+    portConfig.functionMask = FUNCTION_RX_SERIAL;
+    serialCalculateBufferSizes(&portConfig, &buffers);
+
+    // then
+    EXPECT_EQ(32u, buffers.rxBufferSize);
+    EXPECT_EQ(32u, buffers.txBufferSize);
+
+    // when
+    portConfig.functionMask = (1 << 15);
+    serialCalculateBufferSizes(&portConfig, &buffers);
+
+    // then
+    EXPECT_EQ(64u, buffers.rxBufferSize);
+    EXPECT_EQ(64u, buffers.txBufferSize);
+}
+
+// Ring buffer port laid out like the UART and softserial drivers, used to compare read paths
+
+#define FAKE_RX_BUFFER_SIZE 256
+
+static volatile uint8_t fakeRxBuffer[FAKE_RX_BUFFER_SIZE];
+
+static uint32_t fakeRxBytesWaiting(serialPort_t *instance)
+{
+    return (instance->rxBufferHead - instance->rxBufferTail) & (instance->rxBufferSize - 1);
+}
+
+static uint8_t fakeRead(serialPort_t *instance)
+{
+    uint8_t ch = instance->rxBuffer[instance->rxBufferTail];
+    instance->rxBufferTail = (instance->rxBufferTail + 1) % instance->rxBufferSize;
+    return ch;
+}
+
+static uint32_t fakePeekRx(serialPort_t *instance, const uint8_t **data)
+{
+    uint32_t count = fakeRxBytesWaiting(instance);
+    if (count > instance->rxBufferSize - instance->rxBufferTail) {
+        count = instance->rxBufferSize - instance->rxBufferTail;
+    }
+    *data = (const uint8_t *)&instance->rxBuffer[instance->rxBufferTail];
+    return count;
+}
+
+static void fakeSkipRx(serialPort_t *instance, uint32_t count)
+{
+    instance->rxBufferTail = (instance->rxBufferTail + count) % instance->rxBufferSize;
+}
+
+static uint32_t fakeTxFree;
+
+static uint32_t fakeTotalTxFree(serialPort_t *instance)
+{
+    UNUSED(instance);
+    return fakeTxFree;
+}
+
+static const struct serialPortVTable fakeVTable = {
+    .serialWrite = NULL,
+    .serialTotalRxWaiting = fakeRxBytesWaiting,
+    .serialTotalTxFree = fakeTotalTxFree,
+    .serialRead = fakeRead,
+    .serialSetBaudRate = NULL,
+    .isSerialTransmitBufferEmpty = NULL,
+    .setMode = NULL,
+    .writeBuf = NULL,
+    .beginWrite = NULL,
+    .endWrite = NULL,
+    .peekRx = fakePeekRx,
+    .skipRx = fakeSkipRx,
+};
+
+static void fakePortInit(serialPort_t *port, uint32_t startOffset)
+{
+    memset(port, 0, sizeof(*port));
+    port->vTable = &fakeVTable;
+    port->mode = MODE_RXTX;
+    port->rxBuffer = fakeRxBuffer;
+    port->rxBufferSize = FAKE_RX_BUFFER_SIZE;
+    port->rxBufferHead = port->rxBufferTail = startOffset;
+}
+
+// Simulates the receive interrupt
+static void fakePortReceive(serialPort_t *port, uint8_t seed, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        port->rxBuffer[port->rxBufferHead] = (uint8_t)(seed + i);
+        port->rxBufferHead = (port->rxBufferHead + 1) % port->rxBufferSize;
+    }
+}
+
+TEST(IoSerialTest, TestReadBufWrapsAroundRingBuffer)
+{
+    // given
+    serialPort_t port;
+    fakePortInit(&port, FAKE_RX_BUFFER_SIZE - 10);
+    fakePortReceive(&port, 0, 100);
+
+    // when
+    uint8_t data[128];
+    uint32_t count = serialReadBuf(&port, data, sizeof(data));
+
+    // then
+    EXPECT_EQ(100u, count);
+    for (uint32_t i = 0; i < count; i++) {
+        EXPECT_EQ(i, data[i]);
+    }
+    EXPECT_EQ(0u, serialRxBytesWaiting(&port));
+}
+
+TEST(IoSerialTest, TestReadBufHonoursMaxCount)
+{
+    // given
+    serialPort_t port;
+    fakePortInit(&port, 0);
+    fakePortReceive(&port, 0, 50);
+
+    // when
+    uint8_t data[20];
+    uint32_t count = serialReadBuf(&port, data, sizeof(data));
+
+    // then
+    EXPECT_EQ(20u, count);
+    EXPECT_EQ(30u, serialRxBytesWaiting(&port));
+    EXPECT_EQ(20, serialRead(&port));
+}
+
+TEST(IoSerialTest, TestPeekRxReturnsContiguousRun)
+{
+    // given
+    serialPort_t port;
+    fakePortInit(&port, FAKE_RX_BUFFER_SIZE - 4);
+    fakePortReceive(&port, 0, 10);
+
+    // when
+    const uint8_t *data;
+    uint32_t count = serialPeekRx(&port, &data);
+
+    // then
+    EXPECT_EQ(4u, count);
+    EXPECT_EQ(0, data[0]);
+    EXPECT_EQ(10u, serialRxBytesWaiting(&port));
+
+    // and
+    serialSkipRx(&port, count);
+    count = serialPeekRx(&port, &data);
+    EXPECT_EQ(6u, count);
+    EXPECT_EQ(4, data[0]);
+}
+
+TEST(IoSerialTest, TestTxHighWaterSkipsRxOnlyPort)
+{
+    // given
+    serialPort_t port;
+    fakePortInit(&port, 0);
+    port.txBufferSize = 64;
+    port.mode = MODE_RX;
+    fakeTxFree = 0;
+
+    // when
+    serialTxBytesFree(&port);
+
+    // then
+    EXPECT_EQ(0u, port.txBufferHighWater);
+
+    // and
+    port.mode = MODE_RXTX;
+    serialTxBytesFree(&port);
+    EXPECT_EQ(63u, port.txBufferHighWater);
+}
+
+TEST(IoSerialTest, BenchmarkPerByteVsBulkRead)
+{
+    const int iterations = 20000;
+    const uint32_t chunk = FAKE_RX_BUFFER_SIZE - 1;
+    serialPort_t port;
+    uint32_t sumPerByte = 0;
+    uint32_t sumBulk = 0;
+
+    fakePortInit(&port, 0);
+    uint64_t startedAt = monotonicNanos();
+    for (int n = 0; n < iterations; n++) {
+        fakePortReceive(&port, n, chunk);
+        while (serialRxBytesWaiting(&port)) {
+            sumPerByte += serialRead(&port);
+        }
+    }
+    const uint64_t perByteNs = monotonicNanos() - startedAt;
+
+    fakePortInit(&port, 0);
+    startedAt = monotonicNanos();
+    for (int n = 0; n < iterations; n++) {
+        fakePortReceive(&port, n, chunk);
+        const uint8_t *data;
+        uint32_t count;
+        while ((count = serialPeekRx(&port, &data)) > 0) {
+            for (uint32_t i = 0; i < count; i++) {
+                sumBulk += data[i];
+            }
+            serialSkipRx(&port, count);
+        }
+    }
+    const uint64_t bulkNs = monotonicNanos() - startedAt;
+
+    const double bytes = (double)iterations * chunk;
+    printf("serialRead: %.2f ns/byte, serialPeekRx: %.2f ns/byte (includes simulated receive)\n",
+        perByteNs / bytes, bulkNs / bytes);
+
+    EXPECT_EQ(sumPerByte, sumBulk);
+}
+
 
 // STUBS
 
@@ -64,9 +311,6 @@ extern "C" {
 void delay(uint32_t) {}
 void cliEnter(serialPort_t *) {}
 void cliProcess(void) {}
-bool isSerialTransmitBufferEmpty(serialPort_t *) {
-    return true;
-}
 void mspProcess(void) {}
 void systemResetToBootloader(void) {}
 
@@ -0,0 +1,106 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "common/utils.h"
+
+    #include "flight/loop_timing.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// Scheduler cycle times around a 1000us gyro sync loop
+static const uint32_t jitteryCycleTimes[] = { 1000, 1012, 988, 1003, 997, 1020, 980, 1000 };
+
+TEST(LoopTimingTest, FixedRateUsesTheNominalPeriod)
+{
+    // given
+    loopTimingInit(1000, true);
+
+    // expect
+    for (unsigned i = 0; i < ARRAYLEN(jitteryCycleTimes); i++) {
+        EXPECT_FLOAT_EQ(0.001f, loopTimingUpdate(jitteryCycleTimes[i], true));
+    }
+}
+
+TEST(LoopTimingTest, MeasuredRateUsesTheCycleTime)
+{
+    // given
+    loopTimingInit(1000, false);
+
+    // expect
+    for (unsigned i = 0; i < ARRAYLEN(jitteryCycleTimes); i++) {
+        EXPECT_FLOAT_EQ(jitteryCycleTimes[i] * 1e-6f, loopTimingUpdate(jitteryCycleTimes[i], true));
+    }
+}
+
+TEST(LoopTimingTest, JitterIsTracked)
+{
+    // given
+    loopTimingInit(1000, true);
+
+    // when
+    for (unsigned i = 0; i < ARRAYLEN(jitteryCycleTimes); i++) {
+        loopTimingUpdate(jitteryCycleTimes[i], true);
+    }
+
+    // then
+    const loopTimingStats_t *stats = loopTimingGetStats();
+    EXPECT_EQ(ARRAYLEN(jitteryCycleTimes), stats->cycleCount);
+    EXPECT_EQ(0, stats->overrunCount);
+    EXPECT_EQ(-20, stats->jitterMinUs);
+    EXPECT_EQ(20, stats->jitterMaxUs);
+
+    // when
+    loopTimingResetStats();
+
+    // then
+    EXPECT_EQ(0, stats->cycleCount);
+}
+
+TEST(LoopTimingTest, OverrunsUseTheCycleTime)
+{
+    // given
+    loopTimingInit(250, true);
+
+    // when a gyro sample was missed
+    const float dT = loopTimingUpdate(510, true);
+
+    // then the integrators still get the time that passed
+    EXPECT_FLOAT_EQ(0.000510f, dT);
+    EXPECT_EQ(1, loopTimingGetStats()->overrunCount);
+
+    // and the next cycle is back to the nominal period
+    EXPECT_FLOAT_EQ(0.000250f, loopTimingUpdate(240, true));
+}
+
+TEST(LoopTimingTest, WatchdogCyclesUseTheCycleTime)
+{
+    // given
+    loopTimingInit(1000, true);
+
+    // when the data ready interrupt did not come and the watchdog started the cycle
+    const float dT = loopTimingUpdate(1100, false);
+
+    // then the gyro sample period says nothing about the cycle
+    EXPECT_FLOAT_EQ(0.001100f, dT);
+    EXPECT_EQ(0, loopTimingGetStats()->overrunCount);
+}
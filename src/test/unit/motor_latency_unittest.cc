@@ -0,0 +1,421 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C" {
+    #include "debug.h"
+
+    #include "platform.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+    #include "drivers/gyro_sync.h"
+
+    #include "rx/rx.h"
+    #include "flight/pid.h"
+    #include "flight/imu.h"
+    #include "flight/mixer.h"
+    #include "flight/motor_latency.h"
+
+    #include "io/escservo.h"
+    #include "io/gimbal.h"
+    #include "io/rc_controls.h"
+
+    #include "config/runtime_config.h"
+    #include "config/config.h"
+
+    void mixerInit(mixerMode_e mixerMode, motorMixer_t *initialCustomMixers, servoMixer_t *initialCustomServoMixers);
+    void mixerUsePWMIOConfiguration(void);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+uint32_t testFeatureMask = 0;
+
+TEST(MotorLatencyTest, StagesAreTimedOncePerSampleInOrder)
+{
+    // given
+    motorLatencyResetStats();
+    motorLatencyGyroSample(1000);
+
+    // when
+    motorLatencyRecord(MOTOR_LATENCY_MOTOR_WRITE, 1100);   // out of order, ignored
+    motorLatencyRecord(MOTOR_LATENCY_PID, 1200);
+    motorLatencyRecord(MOTOR_LATENCY_PID, 1250);           // already timed
+    motorLatencyRecord(MOTOR_LATENCY_MOTOR_WRITE, 1300);
+    motorLatencyRecord(MOTOR_LATENCY_MOTOR_UPDATE, 1310);
+    motorLatencyRecord(MOTOR_LATENCY_MOTOR_UPDATE, 1400);  // e.g. writeAllMotors() outside the loop
+
+    // then
+    EXPECT_EQ(200, motorLatencyGet(MOTOR_LATENCY_PID));
+    EXPECT_EQ(300, motorLatencyGet(MOTOR_LATENCY_MOTOR_WRITE));
+    EXPECT_EQ(310, motorLatencyGet(MOTOR_LATENCY_MOTOR_UPDATE));
+    EXPECT_EQ(1, motorLatencyGetStats()->cycleCount);
+
+    // when the next sample is quicker
+    motorLatencyGyroSample(2000);
+    motorLatencyRecord(MOTOR_LATENCY_PID, 2100);
+    motorLatencyRecord(MOTOR_LATENCY_MOTOR_WRITE, 2150);
+    motorLatencyRecord(MOTOR_LATENCY_MOTOR_UPDATE, 2160);
+
+    // then the max is kept
+    EXPECT_EQ(160, motorLatencyGet(MOTOR_LATENCY_MOTOR_UPDATE));
+    EXPECT_EQ(310, motorLatencyGetStats()->latencyMaxUs[MOTOR_LATENCY_MOTOR_UPDATE]);
+    EXPECT_EQ(2, motorLatencyGetStats()->cycleCount);
+
+    // and time wraps
+    motorLatencyGyroSample(UINT32_MAX - 50);
+    motorLatencyRecord(MOTOR_LATENCY_PID, 50);
+    EXPECT_EQ(101, motorLatencyGet(MOTOR_LATENCY_PID));
+}
+
+/*
+ * Host simulation of the control loop from gyro data ready to the ESC having received the motor command.
+ *
+ * Time only moves when the harness says so: the gyro, the loop stages and each motor write cost a fixed
+ * amount of simulated microseconds. The real mixTable() and writeMotors() run on it, so the instrumentation
+ * in writeMotors() is exercised, and the stubs of the PWM driver below model the motor timer:
+ * standard PWM loads a new compare value at the next timer update (preload), oneshot starts the pulse when
+ * the update is forced. The command has reached the ESC at the end of the pulse.
+ */
+#define SIM_GYRO_READ_US            120     // gyro read, IMU and rc processing
+#define SIM_PID_US                  60
+#define SIM_MOTOR_WRITE_US          1
+#define SIM_ONESHOT_UPDATE_US       2
+#define SIM_SCHEDULER_JITTER_US     16      // task start after data ready or the looptime
+
+#define SIM_LOOP_COUNT              4000
+
+static uint32_t simTime;
+
+static struct {
+    bool oneshot;
+    uint32_t period;                        // standard PWM timer period
+
+    uint32_t nextUpdateAt;                  // standard PWM timer update, the first one is at the phase
+    bool pending;                           // a value is waiting in the preload register
+    uint32_t pendingSampleAt;
+    uint16_t pendingValue;
+
+    uint32_t currentSampleAt;               // sample the loop is working on
+
+    uint32_t outputCount;
+    uint32_t droppedCount;
+    uint64_t pulseEndLatencySum;
+    uint32_t pulseEndLatencyMax;
+} simTimer;
+
+static void simTimerInit(bool oneshot, uint16_t motorPwmRate, uint32_t phase)
+{
+    memset(&simTimer, 0, sizeof(simTimer));
+    simTimer.oneshot = oneshot;
+    simTimer.period = 1000000 / motorPwmRate;
+    simTimer.nextUpdateAt = phase;
+}
+
+static void simTimerPulse(uint32_t startAt, uint32_t sampleAt, uint32_t width)
+{
+    const uint32_t latency = startAt + width - sampleAt;
+
+    simTimer.outputCount++;
+    simTimer.pulseEndLatencySum += latency;
+    simTimer.pulseEndLatencyMax = MAX(simTimer.pulseEndLatencyMax, latency);
+}
+
+// Runs the standard PWM timer up to now, each update sends what is in the preload register
+static void simTimerAdvance(uint32_t now)
+{
+    if (simTimer.oneshot) {
+        return;
+    }
+
+    while ((int32_t)(now - simTimer.nextUpdateAt) >= 0) {
+        if (simTimer.pending) {
+            simTimerPulse(simTimer.nextUpdateAt, simTimer.pendingSampleAt, simTimer.pendingValue);
+            simTimer.pending = false;
+        }
+        simTimer.nextUpdateAt += simTimer.period;
+    }
+}
+
+typedef struct simConfig_s {
+    const char *name;
+    uint16_t looptime;
+    uint8_t gyroSync;
+    uint8_t gyroSyncDenominator;
+    uint8_t lpf;
+    bool oneshot;
+    uint16_t motorPwmRate;
+} simConfig_t;
+
+typedef struct simResult_s {
+    double updateMeanUs;                    // gyro sample to writeMotors() done, from the instrumentation
+    uint32_t updateMaxUs;
+    double pulseEndMeanUs;                  // gyro sample to the ESC having the command
+    uint32_t pulseEndMaxUs;
+    uint32_t droppedCount;                  // commands overwritten before the timer sent them
+} simResult_t;
+
+class MotorLatencySimulationTest : public ::testing::Test {
+protected:
+    mixerConfig_t mixerConfig;
+    rxConfig_t rxConfig;
+    escAndServoConfig_t escAndServoConfig;
+    flight3DConfig_t flight3DConfig;
+    servoParam_t servoConf[MAX_SUPPORTED_SERVOS];
+    gimbalConfig_t gimbalConfig;
+
+    motorMixer_t customMotorMixer[MAX_SUPPORTED_MOTORS];
+    servoMixer_t customServoMixer[MAX_SERVO_RULES];
+
+    virtual void SetUp() {
+        memset(&mixerConfig, 0, sizeof(mixerConfig));
+        memset(&rxConfig, 0, sizeof(rxConfig));
+        memset(&escAndServoConfig, 0, sizeof(escAndServoConfig));
+        memset(&flight3DConfig, 0, sizeof(flight3DConfig));
+        memset(&servoConf, 0, sizeof(servoConf));
+        memset(&gimbalConfig, 0, sizeof(gimbalConfig));
+        memset(&customMotorMixer, 0, sizeof(customMotorMixer));
+        memset(&customServoMixer, 0, sizeof(customServoMixer));
+
+        escAndServoConfig.mincommand = 1000;
+        escAndServoConfig.minthrottle = 1150;
+        escAndServoConfig.maxthrottle = 1850;
+        mixerConfig.yaw_motor_direction = 1;
+        mixerConfig.yaw_jump_prevention_limit = YAW_JUMP_PREVENTION_LIMIT_HIGH;
+        rxConfig.midrc = 1500;
+        rxConfig.mincheck = 1100;
+
+        armingFlags = 0;
+        ENABLE_ARMING_FLAG(ARMED);
+
+        mixerUseConfigs(servoConf, &gimbalConfig, &flight3DConfig, &escAndServoConfig, &mixerConfig, &rxConfig);
+        mixerInit(MIXER_QUADX, customMotorMixer, customServoMixer);
+        mixerUsePWMIOConfiguration();
+    }
+
+    virtual void TearDown() {
+        armingFlags = 0;
+        testFeatureMask = 0;
+    }
+
+    simResult_t simulate(const simConfig_t *config) {
+        uint32_t random = 12345;
+
+        gyroSetSampleRate(config->looptime, config->lpf, config->gyroSync, config->gyroSyncDenominator, 0);
+        // the gyro runs off its own clock, a little fast, so the age of the sample an unsynced loop reads keeps changing
+        const uint64_t gyroSamplePeriodNs = (config->lpf == 0 ? 125 : 1000) * 997;
+        const uint64_t gyroPhaseNs = 37000;
+
+        testFeatureMask = config->oneshot ? FEATURE_ONESHOT125 : 0;
+        simTimerInit(config->oneshot, config->motorPwmRate, 211);
+        motorLatencyResetStats();
+
+        uint64_t updateLatencySum = 0;
+        uint32_t loopAt = 1000;
+
+        for (int n = 0; n < SIM_LOOP_COUNT; n++) {
+            random = random * 1103515245 + 12345;
+            const uint32_t jitter = (random >> 16) % SIM_SCHEDULER_JITTER_US;
+
+            // the loop works on the latest gyro sample
+            uint32_t sampleAt;
+            if (config->gyroSync) {
+                sampleAt = loopAt;
+                simTime = sampleAt + jitter;
+            } else {
+                simTime = loopAt + jitter;
+                const uint64_t sampleIndex = ((uint64_t)simTime * 1000 - gyroPhaseNs) / gyroSamplePeriodNs;
+                sampleAt = (gyroPhaseNs + sampleIndex * gyroSamplePeriodNs) / 1000;
+            }
+            simTimerAdvance(simTime);
+
+            motorLatencyGyroSample(sampleAt);
+            simTimer.currentSampleAt = sampleAt;
+
+            simTime += SIM_GYRO_READ_US;
+            axisPID[ROLL] = (n % 64) - 32;
+            axisPID[PITCH] = 16 - (n % 32);
+            axisPID[YAW] = (n % 16) - 8;
+            rcCommand[THROTTLE] = 1400 + (n % 200);
+
+            simTime += SIM_PID_US;
+            motorLatencyRecord(MOTOR_LATENCY_PID, simTime);
+
+            mixTable();
+            writeMotors();
+
+            updateLatencySum += motorLatencyGet(MOTOR_LATENCY_MOTOR_UPDATE);
+
+            if (config->gyroSync) {
+                // next data ready the loop takes, the busy wait in taskMainPidLoopChecker() catches it
+                loopAt += targetLooptime;
+            } else {
+                loopAt += config->looptime;
+            }
+        }
+        simTimerAdvance(simTime + simTimer.period);
+
+        const motorLatencyStats_t *stats = motorLatencyGetStats();
+        EXPECT_EQ((uint32_t)SIM_LOOP_COUNT, stats->cycleCount);
+
+        simResult_t result;
+        result.updateMeanUs = (double)updateLatencySum / SIM_LOOP_COUNT;
+        result.updateMaxUs = stats->latencyMaxUs[MOTOR_LATENCY_MOTOR_UPDATE];
+        result.pulseEndMeanUs = (double)simTimer.pulseEndLatencySum / simTimer.outputCount;
+        result.pulseEndMaxUs = simTimer.pulseEndLatencyMax;
+        result.droppedCount = simTimer.droppedCount;
+
+        printf("[ BENCH    ] gyro to motor %s: update %.0f us (max %u), at the ESC %.0f us (max %u), %u of %u commands dropped\n",
+            config->name, result.updateMeanUs, result.updateMaxUs, result.pulseEndMeanUs, result.pulseEndMaxUs,
+            result.droppedCount, SIM_LOOP_COUNT);
+
+        return result;
+    }
+};
+
+TEST_F(MotorLatencySimulationTest, GyroSyncedOneshot)
+{
+    // given
+    const simConfig_t config = { "gyroSync 1kHz/2 oneshot", 2000, 1, 2, 1, true, 400 };
+
+    // when
+    simResult_t result = simulate(&config);
+
+    // then the loop starts at data ready, every stage has a fixed cost
+    const uint32_t loopCost = SIM_GYRO_READ_US + SIM_PID_US + 4 * SIM_MOTOR_WRITE_US + SIM_ONESHOT_UPDATE_US;
+    EXPECT_LE(result.updateMaxUs, loopCost + SIM_SCHEDULER_JITTER_US);
+    EXPECT_GE(result.updateMeanUs, loopCost);
+
+    // and every command goes out, the pulse is at most 250us
+    EXPECT_EQ(0, result.droppedCount);
+    EXPECT_LE(result.pulseEndMaxUs, result.updateMaxUs + 250);
+}
+
+TEST_F(MotorLatencySimulationTest, BenchmarkGyroToMotorLatency)
+{
+    static const simConfig_t configs[] = {
+        { "2000us PWM 400Hz", 2000, 0, 1, 1, false, 400 },
+        { "2000us oneshot", 2000, 0, 1, 1, true, 400 },
+        { "gyroSync 1kHz/2 PWM 400Hz", 2000, 1, 2, 1, false, 400 },
+        { "gyroSync 1kHz/2 oneshot", 2000, 1, 2, 1, true, 400 },
+        { "gyroSync 8kHz/4 PWM 400Hz", 500, 1, 4, 0, false, 400 },
+        { "gyroSync 8kHz/4 oneshot", 500, 1, 4, 0, true, 400 },
+    };
+    simResult_t results[sizeof(configs) / sizeof(configs[0])];
+
+    for (unsigned i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+        results[i] = simulate(&configs[i]);
+    }
+
+    // then oneshot beats PWM, whose command waits for the next timer period and is a 1-2ms pulse
+    EXPECT_LT(results[1].pulseEndMeanUs, results[0].pulseEndMeanUs);
+    EXPECT_LT(results[3].pulseEndMeanUs, results[2].pulseEndMeanUs);
+    EXPECT_LT(results[5].pulseEndMeanUs, results[4].pulseEndMeanUs);
+
+    // and gyro sync removes the age of the sample
+    EXPECT_LT(results[3].updateMeanUs, results[1].updateMeanUs);
+
+    // and a loop faster than the PWM rate throws most of its commands away
+    EXPECT_GT(results[4].droppedCount, (uint32_t)SIM_LOOP_COUNT / 2);
+    EXPECT_EQ(0, results[5].droppedCount);
+
+    // and nothing is worse than a full PWM period, the longest pulse and a gyro sample
+    for (unsigned i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+        EXPECT_LT(results[i].pulseEndMaxUs, 2500 + 2000 + 1000 + 500);
+    }
+}
+
+// STUBS
+
+extern "C" {
+attitudeEulerAngles_t attitude;
+rxRuntimeConfig_t rxRuntimeConfig;
+gyro_t gyro;
+
+int16_t axisPID[XYZ_AXIS_COUNT];
+int16_t rcCommand[4];
+int16_t rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+
+uint32_t rcModeActivationMask;
+int16_t debug[DEBUG16_VALUE_COUNT];
+
+uint8_t stateFlags;
+uint16_t flightModeFlags;
+uint8_t armingFlags;
+
+void delay(uint32_t) {}
+
+uint32_t micros(void) {
+    return simTime;
+}
+
+bool feature(uint32_t mask) {
+    return (mask & testFeatureMask);
+}
+
+void pwmWriteMotor(uint8_t index, uint16_t value) {
+    simTime += SIM_MOTOR_WRITE_US;
+
+    if (index != 0) {
+        return;
+    }
+
+    if (simTimer.oneshot) {
+        simTimer.pendingValue = value;
+        simTimer.pendingSampleAt = simTimer.currentSampleAt;
+        simTimer.pending = true;
+        return;
+    }
+
+    // the timer may have updated while the loop was running
+    simTimerAdvance(simTime);
+    if (simTimer.pending) {
+        simTimer.droppedCount++;
+    }
+    simTimer.pendingValue = value;
+    simTimer.pendingSampleAt = simTimer.currentSampleAt;
+    simTimer.pending = true;
+}
+
+void pwmShutdownPulsesForAllMotors(uint8_t) {}
+
+void pwmCompleteOneshotMotorUpdate(uint8_t) {
+    simTime += SIM_ONESHOT_UPDATE_US;
+
+    // 1000-2000 is scaled onto 125-250us
+    if (simTimer.pending) {
+        simTimerPulse(simTime, simTimer.pendingSampleAt, simTimer.pendingValue / 8);
+        simTimer.pending = false;
+    }
+}
+
+void pwmWriteServo(uint8_t, uint16_t) {}
+
+bool failsafeIsActive(void) {
+    return false;
+}
+
+}
@@ -54,6 +54,9 @@ protected:
 
     virtual void SetUp() {
         memset(&modeActivationConditions, 0, sizeof(modeActivationConditions));
+
+        // every test starts from a new config
+        resetAuxChannelIndexes();
     }
 };
 
@@ -73,7 +76,7 @@ TEST_F(RcControlsModesTest, updateActivatedModesWithAllInputsAtMidde)
     }
 
     // when
-    updateActivatedModes(modeActivationConditions);
+    updateActivatedModes(modeActivationConditions, MODE_OPERATOR_OR);
 
     // then
     for (index = 0; index < CHECKBOX_ITEM_COUNT; index++) {
@@ -163,7 +166,7 @@ TEST_F(RcControlsModesTest, updateActivatedModesUsingValidAuxConfigurationAndRXV
     expectedMask |= (0 << 6);
 
     // when
-    updateActivatedModes(modeActivationConditions);
+    updateActivatedModes(modeActivationConditions, MODE_OPERATOR_OR);
 
     // then
     for (index = 0; index < CHECKBOX_ITEM_COUNT; index++) {
@@ -174,6 +177,119 @@ TEST_F(RcControlsModesTest, updateActivatedModesUsingValidAuxConfigurationAndRXV
     }
 }
 
+TEST_F(RcControlsModesTest, updateActivatedModesFollowsChannelsThatMoveWithOrLogic)
+{
+    // given
+    modeActivationConditions[0].modeId = (boxId_e)1;
+    modeActivationConditions[0].auxChannelIndex = AUX1 - NON_AUX_CHANNEL_COUNT;
+    modeActivationConditions[0].range.startStep = CHANNEL_VALUE_TO_STEP(1700);
+    modeActivationConditions[0].range.endStep = CHANNEL_VALUE_TO_STEP(2100);
+
+    modeActivationConditions[1].modeId = (boxId_e)1;
+    modeActivationConditions[1].auxChannelIndex = AUX2 - NON_AUX_CHANNEL_COUNT;
+    modeActivationConditions[1].range.startStep = CHANNEL_VALUE_TO_STEP(1700);
+    modeActivationConditions[1].range.endStep = CHANNEL_VALUE_TO_STEP(2100);
+
+    modeActivationConditions[2].modeId = (boxId_e)2;
+    modeActivationConditions[2].auxChannelIndex = AUX3 - NON_AUX_CHANNEL_COUNT;
+    modeActivationConditions[2].range.startStep = CHANNEL_VALUE_TO_STEP(1700);
+    modeActivationConditions[2].range.endStep = CHANNEL_VALUE_TO_STEP(2100);
+
+    // and
+    for (uint8_t index = AUX1; index < MAX_SUPPORTED_RC_CHANNEL_COUNT; index++) {
+        rcData[index] = PWM_RANGE_MIN;
+    }
+    rcData[AUX3] = PWM_RANGE_MAX;
+
+    // when
+    updateActivatedModes(modeActivationConditions, MODE_OPERATOR_OR);
+
+    // then
+    EXPECT_FALSE(IS_RC_MODE_ACTIVE(1));
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE(2));
+
+    // when
+    rcData[AUX1] = PWM_RANGE_MAX;
+    updateActivatedModes(modeActivationConditions, MODE_OPERATOR_OR);
+
+    // then
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE(1));
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE(2));
+
+    // when
+    // the other condition of the mode becomes valid as well, then the first one drops out
+    rcData[AUX2] = PWM_RANGE_MAX;
+    updateActivatedModes(modeActivationConditions, MODE_OPERATOR_OR);
+    rcData[AUX1] = PWM_RANGE_MIN;
+    updateActivatedModes(modeActivationConditions, MODE_OPERATOR_OR);
+
+    // then
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE(1));
+
+    // when
+    rcData[AUX2] = PWM_RANGE_MIN;
+    updateActivatedModes(modeActivationConditions, MODE_OPERATOR_OR);
+
+    // then
+    EXPECT_FALSE(IS_RC_MODE_ACTIVE(1));
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE(2));
+}
+
+TEST_F(RcControlsModesTest, updateActivatedModesFollowsChannelsThatMoveWithAndLogic)
+{
+    // given
+    modeActivationConditions[0].modeId = (boxId_e)0;
+    modeActivationConditions[0].auxChannelIndex = AUX1 - NON_AUX_CHANNEL_COUNT;
+    modeActivationConditions[0].range.startStep = CHANNEL_VALUE_TO_STEP(1700);
+    modeActivationConditions[0].range.endStep = CHANNEL_VALUE_TO_STEP(2100);
+
+    modeActivationConditions[1].modeId = (boxId_e)0;
+    modeActivationConditions[1].auxChannelIndex = AUX2 - NON_AUX_CHANNEL_COUNT;
+    modeActivationConditions[1].range.startStep = CHANNEL_VALUE_TO_STEP(1300);
+    modeActivationConditions[1].range.endStep = CHANNEL_VALUE_TO_STEP(1700);
+
+    // and
+    for (uint8_t index = AUX1; index < MAX_SUPPORTED_RC_CHANNEL_COUNT; index++) {
+        rcData[index] = PWM_RANGE_MIN;
+    }
+
+    // when
+    rcData[AUX1] = PWM_RANGE_MAX;
+    updateActivatedModes(modeActivationConditions, MODE_OPERATOR_AND);
+
+    // then
+    EXPECT_FALSE(IS_RC_MODE_ACTIVE(0));
+
+    // when
+    rcData[AUX2] = PWM_RANGE_MIDDLE;
+    updateActivatedModes(modeActivationConditions, MODE_OPERATOR_AND);
+
+    // then
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE(0));
+
+    // when
+    // a move within the same step changes nothing
+    rcData[AUX2] = PWM_RANGE_MIDDLE + 5;
+    updateActivatedModes(modeActivationConditions, MODE_OPERATOR_AND);
+
+    // then
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE(0));
+
+    // when
+    rcData[AUX1] = PWM_RANGE_MIDDLE;
+    updateActivatedModes(modeActivationConditions, MODE_OPERATOR_AND);
+
+    // then
+    EXPECT_FALSE(IS_RC_MODE_ACTIVE(0));
+
+    // when
+    // switching to OR logic re-evaluates the conditions without any channel moving
+    updateActivatedModes(modeActivationConditions, MODE_OPERATOR_OR);
+
+    // then
+    EXPECT_TRUE(IS_RC_MODE_ACTIVE(0));
+}
+
 enum {
     COUNTER_GENERATE_PITCH_ROLL_CURVE = 0,
     COUNTER_QUEUE_CONFIRMATION_BEEP,
@@ -186,7 +302,7 @@ static int callCounts[CALL_COUNT_ITEM_COUNT];
 #define CALL_COUNTER(item) (callCounts[item])
 
 extern "C" {
-void generateRcCurves(controlRateConfig_t *) {
+void generatePitchRollYawCurves(controlRateConfig_t *) {
     callCounts[COUNTER_GENERATE_PITCH_ROLL_CURVE]++;
 }
 
@@ -228,8 +344,8 @@ rxConfig_t rxConfig;
 extern uint8_t adjustmentStateMask;
 extern adjustmentState_t adjustmentStates[MAX_SIMULTANEOUS_ADJUSTMENT_COUNT];
 
-static const adjustmentConfig_t rateAdjustmentConfig = {
-    .adjustmentFunction = ADJUSTMENT_RC_RATE,
+static const adjustmentConfig_t expoAdjustmentConfig = {
+    .adjustmentFunction = ADJUSTMENT_RC_EXPO,
     .mode = ADJUSTMENT_MODE_STEP,
     .data = { { 1 } }
 };
@@ -271,7 +387,7 @@ protected:
 TEST_F(RcControlsAdjustmentsTest, processRcAdjustmentsSticksInMiddle)
 {
     // given
-    configureAdjustment(0, AUX3 - NON_AUX_CHANNEL_COUNT, &rateAdjustmentConfig);
+    configureAdjustment(0, AUX3 - NON_AUX_CHANNEL_COUNT, &expoAdjustmentConfig);
 
     // and
     uint8_t index;
@@ -292,7 +408,7 @@ TEST_F(RcControlsAdjustmentsTest, processRcAdjustmentsSticksInMiddle)
     EXPECT_EQ(adjustmentStateMask, 0);
 }
 
-TEST_F(RcControlsAdjustmentsTest, processRcAdjustmentsWithRcRateFunctionSwitchUp)
+TEST_F(RcControlsAdjustmentsTest, processRcAdjustmentsWithRcExpoFunctionSwitchUp)
 {
     // given
     controlRateConfig_t controlRateConfig = {
@@ -314,7 +430,7 @@ TEST_F(RcControlsAdjustmentsTest, processRcAdjustmentsWithRcRateFunctionSwitchUp
     // and
     adjustmentStateMask = 0;
     memset(&adjustmentStates, 0, sizeof(adjustmentStates));
-    configureAdjustment(0, AUX3 - NON_AUX_CHANNEL_COUNT, &rateAdjustmentConfig);
+    configureAdjustment(0, AUX3 - NON_AUX_CHANNEL_COUNT, &expoAdjustmentConfig);
 
     // and
     uint8_t index;
@@ -530,7 +646,6 @@ TEST_F(RcControlsAdjustmentsTest, processPIDIncreasePidController0)
 
     pidProfile_t pidProfile;
     memset(&pidProfile, 0, sizeof (pidProfile));
-    pidProfile.pidController = 0;
     pidProfile.P8[PIDPITCH] = 0;
     pidProfile.P8[PIDROLL] = 5;
     pidProfile.P8[YAW] = 7;
@@ -596,82 +711,48 @@ TEST_F(RcControlsAdjustmentsTest, processPIDIncreasePidController0)
     EXPECT_EQ(28, pidProfile.D8[YAW]);
 }
 
-TEST_F(RcControlsAdjustmentsTest, processPIDIncreasePidController2)
+TEST_F(RcControlsAdjustmentsTest, updateAdjustmentStatesConfiguresSlotsAgainAfterReset)
 {
     // given
-    modeActivationCondition_t modeActivationConditions[MAX_MODE_ACTIVATION_CONDITION_COUNT];
-    memset(&modeActivationConditions, 0, sizeof (modeActivationConditions));
+    adjustmentRange_t adjustmentRanges[MAX_ADJUSTMENT_RANGE_COUNT];
+    memset(&adjustmentRanges, 0, sizeof(adjustmentRanges));
 
-    escAndServoConfig_t escAndServoConfig;
-    memset(&escAndServoConfig, 0, sizeof (escAndServoConfig));
-
-    pidProfile_t pidProfile;
-    memset(&pidProfile, 0, sizeof (pidProfile));
-    pidProfile.pidController = 2;
-    pidProfile.P_f[PIDPITCH] = 0.0f;
-    pidProfile.P_f[PIDROLL] = 5.0f;
-    pidProfile.P_f[PIDYAW] = 7.0f;
-    pidProfile.I_f[PIDPITCH] = 10.0f;
-    pidProfile.I_f[PIDROLL] = 15.0f;
-    pidProfile.I_f[PIDYAW] = 17.0f;
-    pidProfile.D_f[PIDPITCH] = 20.0f;
-    pidProfile.D_f[PIDROLL] = 25.0f;
-    pidProfile.D_f[PIDYAW] = 27.0f;
-
-    // and
-    controlRateConfig_t controlRateConfig;
-    memset(&controlRateConfig, 0, sizeof (controlRateConfig));
-
-    configureAdjustment(0, AUX1 - NON_AUX_CHANNEL_COUNT, &pidPitchAndRollPAdjustmentConfig);
-    configureAdjustment(1, AUX2 - NON_AUX_CHANNEL_COUNT, &pidPitchAndRollIAdjustmentConfig);
-    configureAdjustment(2, AUX3 - NON_AUX_CHANNEL_COUNT, &pidPitchAndRollDAdjustmentConfig);
-    configureAdjustment(3, AUX1 - NON_AUX_CHANNEL_COUNT, &pidYawPAdjustmentConfig);
-    configureAdjustment(4, AUX2 - NON_AUX_CHANNEL_COUNT, &pidYawIAdjustmentConfig);
-    configureAdjustment(5, AUX3 - NON_AUX_CHANNEL_COUNT, &pidYawDAdjustmentConfig);
+    adjustmentRanges[0].auxChannelIndex = AUX1 - NON_AUX_CHANNEL_COUNT;
+    adjustmentRanges[0].range.startStep = CHANNEL_VALUE_TO_STEP(1700);
+    adjustmentRanges[0].range.endStep = CHANNEL_VALUE_TO_STEP(2100);
+    adjustmentRanges[0].adjustmentFunction = ADJUSTMENT_RC_EXPO;
+    adjustmentRanges[0].auxSwitchChannelIndex = AUX2 - NON_AUX_CHANNEL_COUNT;
+    adjustmentRanges[0].adjustmentIndex = 1;
 
     // and
-    uint8_t index;
-    for (index = AUX1; index < MAX_SUPPORTED_RC_CHANNEL_COUNT; index++) {
-        rcData[index] = PWM_RANGE_MIDDLE;
+    for (uint8_t index = AUX1; index < MAX_SUPPORTED_RC_CHANNEL_COUNT; index++) {
+        rcData[index] = PWM_RANGE_MIN;
     }
+    resetAdjustmentStates();
 
-    // and
-    resetCallCounters();
-    resetMillis();
-
-    // and
-    rcData[AUX1] = PWM_RANGE_MAX;
-    rcData[AUX2] = PWM_RANGE_MAX;
-    rcData[AUX3] = PWM_RANGE_MAX;
+    // when
+    updateAdjustmentStates(adjustmentRanges);
 
-    // and
-    uint8_t expectedAdjustmentStateMask =
-            (1 << 0) |
-            (1 << 1) |
-            (1 << 2) |
-            (1 << 3) |
-            (1 << 4) |
-            (1 << 5);
+    // then
+    EXPECT_EQ(NULL, adjustmentStates[1].config);
 
     // when
-    useRcControlsConfig(modeActivationConditions, &escAndServoConfig, &pidProfile);
-    processRcAdjustments(&controlRateConfig, &rxConfig);
+    rcData[AUX1] = PWM_RANGE_MAX;
+    updateAdjustmentStates(adjustmentRanges);
 
     // then
-    EXPECT_EQ(CALL_COUNTER(COUNTER_QUEUE_CONFIRMATION_BEEP), 6);
-    EXPECT_EQ(adjustmentStateMask, expectedAdjustmentStateMask);
+    ASSERT_NE((const adjustmentConfig_t *)NULL, adjustmentStates[1].config);
+    EXPECT_EQ(ADJUSTMENT_RC_EXPO, adjustmentStates[1].config->adjustmentFunction);
+    EXPECT_EQ(AUX2 - NON_AUX_CHANNEL_COUNT, adjustmentStates[1].auxChannelIndex);
 
-    // and
-    EXPECT_EQ(0.1f, pidProfile.P_f[PIDPITCH]);
-    EXPECT_EQ(5.1f, pidProfile.P_f[PIDROLL]);
-    EXPECT_EQ(7.1f, pidProfile.P_f[PIDYAW]);
-    EXPECT_EQ(10.01f, pidProfile.I_f[PIDPITCH]);
-    EXPECT_EQ(15.01f, pidProfile.I_f[PIDROLL]);
-    EXPECT_EQ(17.01f, pidProfile.I_f[PIDYAW]);
-    EXPECT_EQ(20.001f, pidProfile.D_f[PIDPITCH]);
-    EXPECT_EQ(25.001f, pidProfile.D_f[PIDROLL]);
-    EXPECT_EQ(27.001f, pidProfile.D_f[PIDYAW]);
+    // when
+    // the slots are cleared, e.g. on a profile change, while the range channel stays where it is
+    resetAdjustmentStates();
+    updateAdjustmentStates(adjustmentRanges);
 
+    // then
+    ASSERT_NE((const adjustmentConfig_t *)NULL, adjustmentStates[1].config);
+    EXPECT_EQ(ADJUSTMENT_RC_EXPO, adjustmentStates[1].config->adjustmentFunction);
 }
 
 extern "C" {
@@ -680,7 +761,7 @@ void generateThrottleCurve(controlRateConfig_t *, escAndServoConfig_t *) {}
 void changeProfile(uint8_t) {}
 void accSetCalibrationCycles(uint16_t) {}
 void gyroSetCalibrationCycles(uint16_t) {}
-void applyAndSaveAccelerometerTrimsDelta(rollAndPitchTrims_t*) {}
+void applyAndSaveBoardAlignmentDelta(int16_t, int16_t) {}
 void handleInflightCalibrationStickPosition(void) {}
 bool feature(uint32_t) { return false;}
 bool sensors(uint32_t) { return false;}
@@ -0,0 +1,90 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "rx/rx.h"
+    #include "io/rc_controls.h"
+    #include "io/escservo.h"
+    #include "io/rc_curves.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// the expo polynomial the tables are generated from
+static float expoCurve(int32_t stickDeflection, uint8_t expo)
+{
+    float tmpf = stickDeflection / 100.0f;
+    return (2500.0f + (float)expo * (tmpf * tmpf - 25.0f)) * tmpf / 25.0f;
+}
+
+static controlRateConfig_t controlRateConfig;
+
+TEST(RcCurvesTest, LookupMatchesExpoCurve)
+{
+    // given
+    memset(&controlRateConfig, 0, sizeof(controlRateConfig));
+    controlRateConfig.rcExpo8 = 70;
+    controlRateConfig.rcYawExpo8 = 20;
+
+    // when
+    generatePitchRollYawCurves(&controlRateConfig);
+
+    // then
+    for (int32_t deflection = -500; deflection <= 500; deflection++) {
+        EXPECT_NEAR(expoCurve(deflection, 70), rcLookup(ROLL, deflection), 1.5f);
+        EXPECT_NEAR(expoCurve(deflection, 70), rcLookup(PITCH, deflection), 1.5f);
+        EXPECT_NEAR(expoCurve(deflection, 20), rcLookup(YAW, deflection), 1.5f);
+    }
+}
+
+TEST(RcCurvesTest, LookupIsSymmetricAndHitsTheEnds)
+{
+    // given
+    memset(&controlRateConfig, 0, sizeof(controlRateConfig));
+    controlRateConfig.rcExpo8 = 100;
+
+    // when
+    generatePitchRollYawCurves(&controlRateConfig);
+
+    // then
+    EXPECT_EQ(0, rcLookup(ROLL, 0));
+    EXPECT_EQ(500, rcLookup(ROLL, 500));
+    EXPECT_EQ(-500, rcLookup(ROLL, -500));
+    for (int32_t deflection = 1; deflection <= 500; deflection++) {
+        EXPECT_EQ(-rcLookup(ROLL, deflection), rcLookup(ROLL, -deflection));
+    }
+}
+
+TEST(RcCurvesTest, ZeroExpoIsLinear)
+{
+    // given
+    memset(&controlRateConfig, 0, sizeof(controlRateConfig));
+
+    // when
+    generatePitchRollYawCurves(&controlRateConfig);
+
+    // then
+    for (int32_t deflection = -500; deflection <= 500; deflection++) {
+        EXPECT_EQ(deflection, rcLookup(YAW, deflection));
+    }
+}
@@ -0,0 +1,173 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "io/rc_smoothing.h"
+
+    uint32_t targetLooptime;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define LOOP_TIME_US 1000
+
+static uint32_t currentTime = 1000000;
+static uint32_t nextFrameAt;
+static uint32_t frameAt;
+static int16_t command[4];
+
+/*
+ * Runs the PID loop for a while with frames arriving at the given interval, returns the last smoothed roll command.
+ * A frame is processed on the first loop after it ended.
+ */
+static int16_t runLoop(rcSmoothingType_e type, int16_t roll, uint32_t frameIntervalUs, uint32_t durationUs)
+{
+    const uint32_t endAt = currentTime + durationUs;
+
+    while (currentTime < endAt) {
+        currentTime += LOOP_TIME_US;
+
+        const bool isRXDataNew = (int32_t)(currentTime - nextFrameAt) >= 0;
+        if (isRXDataNew) {
+            // the last frame that ended by now, frames missed while the interval was longer are skipped
+            frameAt = currentTime - (currentTime - nextFrameAt) % frameIntervalUs;
+            nextFrameAt = frameAt + frameIntervalUs;
+        }
+
+        // rcCommand is recalculated from the latest frame on every loop
+        command[0] = roll;
+        rcSmoothingApply(type, command, isRXDataNew, frameAt, currentTime, LOOP_TIME_US * 0.000001f);
+    }
+    return command[0];
+}
+
+TEST(RcSmoothingTest, NominalIntervalSetsInitialCutoff)
+{
+    // when
+    rcSmoothingInit(22000);
+
+    // then
+    EXPECT_EQ(22000, rcSmoothingGetFrameInterval());
+    EXPECT_EQ(15, rcSmoothingGetCutoffHz());
+}
+
+TEST(RcSmoothingTest, FrameIntervalIsMeasured)
+{
+    // given
+    rcSmoothingInit(22000);
+
+    // when
+    runLoop(RC_SMOOTHING_FILTER, 0, 7000, 1000000);
+
+    // then
+    EXPECT_NEAR(7000, rcSmoothingGetFrameInterval(), 100);
+    EXPECT_NEAR(48, rcSmoothingGetCutoffHz(), 1);
+}
+
+TEST(RcSmoothingTest, FrameIntervalIsMeasuredFromFrameTimes)
+{
+    // given
+    rcSmoothingInit(22000);
+
+    // when
+    // frames are processed 7000us and 8000us apart on the 1000us PID loop
+    runLoop(RC_SMOOTHING_FILTER, 0, 7500, 1000000);
+
+    // then
+    EXPECT_NEAR(7500, rcSmoothingGetFrameInterval(), 1);
+}
+
+TEST(RcSmoothingTest, LostFramesAreIgnored)
+{
+    // given
+    rcSmoothingInit(7000);
+    runLoop(RC_SMOOTHING_FILTER, 0, 7000, 100000);
+
+    // when
+    for (int i = 0; i < 5; i++) {
+        runLoop(RC_SMOOTHING_FILTER, 0, 14000, 14000);
+        runLoop(RC_SMOOTHING_FILTER, 0, 7000, 28000);
+    }
+
+    // then
+    EXPECT_NEAR(7000, rcSmoothingGetFrameInterval(), 100);
+}
+
+TEST(RcSmoothingTest, SlowerLinkIsDetected)
+{
+    // given
+    rcSmoothingInit(7000);
+    runLoop(RC_SMOOTHING_FILTER, 0, 7000, 100000);
+
+    // when
+    runLoop(RC_SMOOTHING_FILTER, 0, 22000, 22000 * 6);
+
+    // then
+    EXPECT_NEAR(22000, rcSmoothingGetFrameInterval(), 100);
+    EXPECT_EQ(15, rcSmoothingGetCutoffHz());
+}
+
+TEST(RcSmoothingTest, FilterFollowsStepWithoutOvershoot)
+{
+    // given
+    rcSmoothingInit(7000);
+    runLoop(RC_SMOOTHING_FILTER, 0, 7000, 100000);
+
+    // when
+    int16_t previous = 0;
+    for (int i = 0; i < 100; i++) {
+        const int16_t output = runLoop(RC_SMOOTHING_FILTER, 500, 7000, LOOP_TIME_US);
+
+        // then
+        EXPECT_GE(output, previous);
+        EXPECT_LE(output, 500);
+        previous = output;
+
+        if (i == 30) {
+            EXPECT_GE(output, 495);
+        }
+    }
+}
+
+TEST(RcSmoothingTest, InterpolationRampsOverTheFrameInterval)
+{
+    // given
+    rcSmoothingInit(10000);
+    runLoop(RC_SMOOTHING_INTERPOLATE, 0, 10000, 100000);
+
+    // when
+    // the step arrives with the next frame, on time
+    runLoop(RC_SMOOTHING_INTERPOLATE, 0, 10000, nextFrameAt - currentTime - LOOP_TIME_US);
+    EXPECT_EQ(10, runLoop(RC_SMOOTHING_INTERPOLATE, 100, 10000, LOOP_TIME_US));
+
+    // then
+    EXPECT_EQ(50, runLoop(RC_SMOOTHING_INTERPOLATE, 100, 10000, 4 * LOOP_TIME_US));
+    EXPECT_EQ(100, runLoop(RC_SMOOTHING_INTERPOLATE, 100, 10000, 5 * LOOP_TIME_US));
+}
+
+TEST(RcSmoothingTest, OffPassesCommandsThrough)
+{
+    // given
+    rcSmoothingInit(10000);
+
+    // expect
+    EXPECT_EQ(300, runLoop(RC_SMOOTHING_OFF, 300, 10000, LOOP_TIME_US));
+    EXPECT_EQ(-200, runLoop(RC_SMOOTHING_OFF, -200, 10000, LOOP_TIME_US));
+}
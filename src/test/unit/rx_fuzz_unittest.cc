@@ -0,0 +1,420 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/maths.h"
+
+    #include "drivers/serial.h"
+    #include "io/serial.h"
+
+    #include "rx/rx.h"
+    #include "rx/sbus.h"
+    #include "rx/ibus.h"
+    #include "rx/sumd.h"
+    #include "rx/sumh.h"
+    #include "rx/spektrum.h"
+    #include "rx/xbus.h"
+    #include "rx/jetiexbus.h"
+}
+
+#include "unittest_macros.h"
+#include "unittest_timing.h"
+#include "gtest/gtest.h"
+
+/*
+ * Replays clean, corrupted and random byte streams through every serial RX decoder at its line rate. The decoders
+ * are built with the address sanitizer for this target, an out of bounds write on a bad frame fails the run.
+ */
+
+// Frames captured from receivers, sticks at roll low, pitch centred, yaw high, throttle centred
+
+static const uint8_t sbusFrame[] = {
+    0x0F, 0xAD, 0xA0, 0x78, 0xF8, 0xC2, 0x17, 0xBE, 0xF0, 0x85, 0x2F, 0x7C,
+    0xE1, 0x0B, 0x5F, 0xF8, 0xC2, 0x17, 0xBE, 0xF0, 0x85, 0x2F, 0x7C, 0x00,
+    0x00,
+};
+
+static const uint8_t ibusFrame[] = {
+    0x20, 0x40, 0xE8, 0x03, 0xDC, 0x05, 0xD0, 0x07, 0xDC, 0x05, 0xDC, 0x05,
+    0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05,
+    0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05, 0x51, 0xF3,
+};
+
+static const uint8_t sumdFrame[] = {
+    0xA8, 0x01, 0x08, 0x22, 0x60, 0x2E, 0xE0, 0x3B, 0x60, 0x2E, 0xE0, 0x2E,
+    0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x6B, 0x0E,
+};
+
+static const uint8_t sumhFrame[] = {
+    0xA8, 0x00, 0x00, 0x24, 0xE0, 0x2E, 0xE0, 0x38, 0xE0, 0x2E, 0xE0, 0x2E,
+    0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x00, 0x00,
+};
+
+static const uint8_t spektrum2048Frame[] = {
+    0x00, 0x12, 0x00, 0xE0, 0x0C, 0x00, 0x17, 0x20, 0x1C, 0x00, 0x24, 0x00,
+    0x2C, 0x00, 0x34, 0x00,
+};
+
+static const uint8_t xbusFrame[] = {
+    0xA1, 0x03, 0x6E, 0x08, 0x00, 0x0C, 0x93, 0x08, 0x00, 0x08, 0x00, 0x08,
+    0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08,
+    0x00, 0xA2, 0xDF,
+};
+
+static const uint8_t jetiExBusFrame[] = {
+    0x3E, 0x03, 0x28, 0x01, 0x31, 0x20, 0x60, 0x22, 0xE0, 0x2E, 0x60, 0x3B,
+    0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E,
+    0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E,
+    0xE0, 0x2E, 0x66, 0xD6,
+};
+
+typedef bool (*rxProviderInit)(rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig, rcReadRawDataPtr *callback);
+typedef uint8_t (*rxProviderFrameStatus)(void);
+
+typedef struct rxProtocol_s {
+    const char *name;
+    rxProviderInit init;
+    rxProviderFrameStatus frameStatus;
+    uint8_t provider;
+    uint32_t baudRate;
+    uint8_t bitsPerByte;                    // start, data, parity and stop bits
+    uint32_t frameIntervalUs;
+    const uint8_t *frame;
+    uint8_t frameLength;
+    bool hasChecksum;                       // every single bit error is detected
+    uint16_t channels[4];                   // roll, pitch, yaw and throttle in the frame
+} rxProtocol_t;
+
+static const rxProtocol_t rxProtocols[] = {
+    { "SBUS",     sbusInit,     sbusFrameStatus,     SERIALRX_SBUS,         100000, 12, 14000, sbusFrame,         sizeof(sbusFrame),         false, { 988, 2012, 1500, 1500 } },
+    { "IBUS",     ibusInit,     ibusFrameStatus,     SERIALRX_IBUS,         115200, 10, 7000,  ibusFrame,         sizeof(ibusFrame),         true,  { 1000, 1500, 2000, 1500 } },
+    { "SUMD",     sumdInit,     sumdFrameStatus,     SERIALRX_SUMD,         115200, 10, 10000, sumdFrame,         sizeof(sumdFrame),         true,  { 1100, 1500, 1900, 1500 } },
+    { "SUMH",     sumhInit,     sumhFrameStatus,     SERIALRX_SUMH,         115200, 10, 10000, sumhFrame,         sizeof(sumhFrame),         false, { 1100, 1500, 1900, 1500 } },
+    { "SPEKTRUM", spektrumInit, spektrumFrameStatus, SERIALRX_SPEKTRUM2048, 115200, 10, 11000, spektrum2048Frame, sizeof(spektrum2048Frame), false, { 1100, 1500, 1900, 1500 } },
+    { "XBUS",     xBusInit,     xBusFrameStatus,     SERIALRX_XBUS_MODE_B,  115200, 10, 14000, xbusFrame,         sizeof(xbusFrame),         true,  { 1100, 1500, 1900, 1500 } },
+    { "JETIEXBUS", jetiExBusInit, jetiExBusFrameStatus, SERIALRX_JETIEXBUS, 125000, 10, 10000, jetiExBusFrame,    sizeof(jetiExBusFrame),    true,  { 1100, 1500, 1900, 1500 } },
+};
+
+#define RX_PROTOCOL_COUNT (sizeof(rxProtocols) / sizeof(rxProtocols[0]))
+
+// frames a decoder may miss after the stream was corrupted, the damaged frame and the one it ran into
+#define MAX_FRAMES_TO_RESYNC 2
+
+#define NOISE_ITERATIONS 500
+#define THROUGHPUT_FRAME_COUNT 20000
+
+static uint64_t fakeNanos;
+static serialReceiveCallbackPtr receiveCallback;
+static int frameErrors;
+
+static rxConfig_t rxConfig;
+rxRuntimeConfig_t rxRuntimeConfig;
+static rcReadRawDataPtr readRawRC;
+
+static const rxProtocol_t *protocol;
+static uint32_t byteTimeNs;
+
+// xorshift, the same sequence on every run
+static uint32_t randomState;
+
+static uint32_t nextRandom(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+static void initProtocol(const rxProtocol_t *protocolToUse)
+{
+    protocol = protocolToUse;
+    byteTimeNs = 1000000000 / (protocol->baudRate / protocol->bitsPerByte);
+
+    memset(&rxConfig, 0, sizeof(rxConfig));
+    memset(&rxRuntimeConfig, 0, sizeof(rxRuntimeConfig));
+    rxConfig.midrc = 1500;
+    rxConfig.serialrx_provider = protocol->provider;
+
+    receiveCallback = NULL;
+    frameErrors = 0;
+    randomState = 0x1234567;
+
+    // a long silence so no decoder is part way through a frame
+    fakeNanos += 1000000000;
+
+    EXPECT_TRUE(protocol->init(&rxConfig, &rxRuntimeConfig, &readRawRC));
+    EXPECT_TRUE(receiveCallback != NULL);
+}
+
+static void feedBytes(const uint8_t *data, int length)
+{
+    for (int i = 0; i < length; i++) {
+        fakeNanos += byteTimeNs;
+        receiveCallback(data[i]);
+    }
+}
+
+// feeds the bytes at the line rate so the last one arrives a frame interval after the previous frame, then polls the decoder like the RX task
+static bool feedFrame(const uint8_t *frame, int length)
+{
+    fakeNanos += (uint64_t)protocol->frameIntervalUs * 1000 - (uint64_t)length * byteTimeNs;
+    feedBytes(frame, length);
+    return protocol->frameStatus() & SERIAL_RX_FRAME_COMPLETE;
+}
+
+static bool hasCapturedChannels(void)
+{
+    for (int i = 0; i < 4; i++) {
+        if (readRawRC(&rxRuntimeConfig, i) != protocol->channels[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// feeds clean frames until one is decoded, returns how many it took
+static int framesToResync(void)
+{
+    for (int frameCount = 1; frameCount <= 10; frameCount++) {
+        if (feedFrame(protocol->frame, protocol->frameLength) && hasCapturedChannels()) {
+            return frameCount;
+        }
+    }
+    return 11;
+}
+
+TEST(RxFuzzTest, CapturedStreamsAreDecoded)
+{
+    for (unsigned p = 0; p < RX_PROTOCOL_COUNT; p++) {
+        SCOPED_TRACE(rxProtocols[p].name);
+
+        // given
+        initProtocol(&rxProtocols[p]);
+
+        // when
+        int framesDecoded = 0;
+        for (int i = 0; i < 100; i++) {
+            if (feedFrame(protocol->frame, protocol->frameLength) && hasCapturedChannels()) {
+                framesDecoded++;
+            }
+        }
+
+        // then
+        EXPECT_EQ(100, framesDecoded);
+        EXPECT_EQ(0, frameErrors);
+    }
+}
+
+TEST(RxFuzzTest, SingleBitErrorsAreRejected)
+{
+    for (unsigned p = 0; p < RX_PROTOCOL_COUNT; p++) {
+        SCOPED_TRACE(rxProtocols[p].name);
+
+        // given
+        initProtocol(&rxProtocols[p]);
+        uint8_t corrupted[64];
+        int maxFramesToResync = 0;
+
+        for (int bit = 0; bit < protocol->frameLength * 8; bit++) {
+            memcpy(corrupted, protocol->frame, protocol->frameLength);
+            corrupted[bit / 8] ^= 1 << (bit % 8);
+            feedFrame(protocol->frame, protocol->frameLength);
+
+            // when
+            const bool decoded = feedFrame(corrupted, protocol->frameLength);
+
+            // then
+            if (protocol->hasChecksum) {
+                EXPECT_FALSE(decoded && !hasCapturedChannels()) << "bit " << bit;
+            }
+            maxFramesToResync = MAX(maxFramesToResync, framesToResync());
+        }
+
+        // and
+        EXPECT_LE(maxFramesToResync, 1);
+    }
+}
+
+TEST(RxFuzzTest, DecodersResyncAfterNoise)
+{
+    for (unsigned p = 0; p < RX_PROTOCOL_COUNT; p++) {
+        SCOPED_TRACE(rxProtocols[p].name);
+
+        // given
+        initProtocol(&rxProtocols[p]);
+        uint8_t noise[128];
+        int maxFramesToResync = 0;
+        int totalFramesToResync = 0;
+
+        for (int i = 0; i < NOISE_ITERATIONS; i++) {
+            feedFrame(protocol->frame, protocol->frameLength);
+
+            // when
+            const int noiseLength = 1 + nextRandom() % sizeof(noise);
+            for (int n = 0; n < noiseLength; n++) {
+                noise[n] = nextRandom();
+            }
+
+            switch (nextRandom() % 4) {
+            case 0:
+                // noise burst running straight into the next frame
+                fakeNanos += (uint64_t)protocol->frameIntervalUs * 1000 / 2;
+                feedBytes(noise, noiseLength);
+                fakeNanos -= (uint64_t)protocol->frameIntervalUs * 1000 - (uint64_t)protocol->frameLength * byteTimeNs;
+                break;
+            case 1:
+                // noise in place of a frame
+                feedFrame(noise, noiseLength);
+                break;
+            case 2: {
+                // a byte lost part way through a frame
+                const int lost = nextRandom() % protocol->frameLength;
+                memcpy(noise, protocol->frame, lost);
+                memcpy(noise + lost, protocol->frame + lost + 1, protocol->frameLength - lost - 1);
+                feedFrame(noise, protocol->frameLength - 1);
+                break;
+            }
+            default: {
+                // a glitch adding a byte part way through a frame
+                const int added = nextRandom() % protocol->frameLength;
+                const uint8_t glitch = noise[0];
+                memcpy(noise, protocol->frame, added);
+                noise[added] = glitch;
+                memcpy(noise + added + 1, protocol->frame + added, protocol->frameLength - added);
+                feedFrame(noise, protocol->frameLength + 1);
+                break;
+            }
+            }
+
+            // then
+            const int frames = framesToResync();
+            maxFramesToResync = MAX(maxFramesToResync, frames);
+            totalFramesToResync += frames;
+        }
+
+        EXPECT_LE(maxFramesToResync, MAX_FRAMES_TO_RESYNC);
+        printf("[ RX FUZZ  ] %-9s resync after noise: %d frames max, %d.%02d average\n", protocol->name,
+            maxFramesToResync, totalFramesToResync / NOISE_ITERATIONS, (totalFramesToResync % NOISE_ITERATIONS) * 100 / NOISE_ITERATIONS);
+    }
+}
+
+TEST(RxFuzzTest, DecodeThroughput)
+{
+    for (unsigned p = 0; p < RX_PROTOCOL_COUNT; p++) {
+        SCOPED_TRACE(rxProtocols[p].name);
+
+        // given
+        initProtocol(&rxProtocols[p]);
+
+        // when
+        int framesDecoded = 0;
+        const uint64_t startedAt = monotonicNanos();
+        for (int i = 0; i < THROUGHPUT_FRAME_COUNT; i++) {
+            if (feedFrame(protocol->frame, protocol->frameLength)) {
+                framesDecoded++;
+            }
+        }
+        const uint32_t nsPerFrame = (monotonicNanos() - startedAt) / THROUGHPUT_FRAME_COUNT;
+
+        // then
+        EXPECT_EQ(THROUGHPUT_FRAME_COUNT, framesDecoded);
+        printf("[ RX FUZZ  ] %-9s %u ns per frame, %u ns per byte\n", protocol->name, nsPerFrame, nsPerFrame / protocol->frameLength);
+    }
+}
+
+// STUBS
+
+extern "C" {
+
+uint32_t micros(void) { return fakeNanos / 1000; }
+uint32_t millis(void) { return fakeNanos / 1000000; }
+
+void rxSerialFrameReceived(uint32_t frameEndAt)
+{
+    UNUSED(frameEndAt);
+}
+
+void rxSerialFrameError(void)
+{
+    frameErrors++;
+}
+
+static serialPortConfig_t portConfig;
+static serialPort_t port;
+
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function)
+{
+    UNUSED(function);
+    return &portConfig;
+}
+
+serialPort_t *openSerialPort(
+    serialPortIdentifier_e identifier,
+    serialPortFunction_e function,
+    serialReceiveCallbackPtr callback,
+    uint32_t baudrate,
+    portMode_t mode,
+    portOptions_t options
+)
+{
+    UNUSED(identifier);
+    UNUSED(function);
+    UNUSED(baudrate);
+    UNUSED(mode);
+    UNUSED(options);
+
+    receiveCallback = callback;
+    return &port;
+}
+
+void serialSetMode(serialPort_t *instance, portMode_t mode)
+{
+    UNUSED(instance);
+    UNUSED(mode);
+}
+
+// used by the Jeti EX Bus telemetry
+uint16_t vbat;
+int32_t amperage;
+int32_t mAhDrawn;
+int32_t BaroAlt;
+
+uint32_t uartTotalRxBytesWaiting(serialPort_t *instance)
+{
+    UNUSED(instance);
+    return 0;
+}
+
+bool isSerialTransmitBufferEmpty(serialPort_t *instance)
+{
+    UNUSED(instance);
+    return true;
+}
+
+void serialWrite(serialPort_t *instance, uint8_t ch)
+{
+    UNUSED(instance);
+    UNUSED(ch);
+}
+
+}
@@ -25,6 +25,7 @@ extern "C" {
 
     #include "rx/rx.h"
     #include "io/rc_controls.h"
+    #include "config/config.h"
     #include "common/maths.h"
 
     uint32_t rcModeActivationMask;
@@ -44,6 +45,8 @@ extern "C" {
 typedef struct testData_s {
     bool isPPMDataBeingReceived;
     bool isPWMDataBeingReceived;
+    bool mspFrameComplete;
+    uint32_t enabledFeatures;
 } testData_t;
 
 static testData_t testData;
@@ -155,6 +158,64 @@ TEST(RxTest, TestInvalidFlightChannels)
     }
 }
 
+TEST(RxTest, TestRxStats)
+{
+    // given
+    memset(&testData, 0, sizeof(testData));
+    testData.enabledFeatures = FEATURE_RX_MSP;
+    testData.mspFrameComplete = true;
+
+    // and
+    rxConfig_t rxConfig;
+    modeActivationCondition_t modeActivationConditions[MAX_MODE_ACTIVATION_CONDITION_COUNT];
+
+    memset(&rxConfig, 0, sizeof(rxConfig));
+    rxConfig.rx_min_usec = 1000;
+    rxConfig.rx_max_usec = 2000;
+    memset(&modeActivationConditions, 0, sizeof(modeActivationConditions));
+
+    rxInit(&rxConfig, modeActivationConditions);
+    rxResetStats();
+
+    // when
+    // frames 7ms, 7ms, 12ms and 60ms apart
+    const uint32_t frameTimes[] = { 100000, 107000, 114000, 126000, 186000 };
+    for (unsigned i = 0; i < sizeof(frameTimes) / sizeof(frameTimes[0]); i++) {
+        updateRx(frameTimes[i]);
+        calculateRxChannelsAndUpdateFailsafe(frameTimes[i]);
+        rxRecordLatency(RX_LATENCY_RC_COMMAND, frameTimes[i] + 100);
+        rxRecordLatency(RX_LATENCY_MIXER, frameTimes[i] + 300 + i * 100);
+    }
+
+    // and
+    rxSerialFrameError();
+    rxSerialFrameReceived(200000);
+    rxSerialFrameReceived(207000);
+    updateRx(208000);
+    calculateRxChannelsAndUpdateFailsafe(208000);
+
+    // then
+    const rxStats_t *rxStats = rxGetStats();
+    EXPECT_EQ(6, rxStats->frameCount);
+    EXPECT_EQ(1, rxStats->errorCount);
+    EXPECT_EQ(1, rxStats->droppedCount);
+    EXPECT_EQ(700, rxStats->frameToMixerUs);
+    EXPECT_EQ(700, rxStats->frameToMixerMaxUs);
+
+    // and
+    EXPECT_EQ(0, rxStats->intervalHistogram[0]);    // < 5ms
+    EXPECT_EQ(2, rxStats->intervalHistogram[1]);    // < 10ms
+    EXPECT_EQ(1, rxStats->intervalHistogram[2]);    // < 15ms
+    EXPECT_EQ(1, rxStats->intervalHistogram[4]);    // < 25ms
+    EXPECT_EQ(1, rxStats->intervalHistogram[RX_INTERVAL_HISTOGRAM_BUCKET_COUNT - 1]); // >= 50ms
+
+    // when
+    rxResetStats();
+
+    // then
+    EXPECT_EQ(0, rxGetStats()->frameCount);
+    EXPECT_EQ(0, rxGetStats()->droppedCount);
+}
 
 // STUBS
 
@@ -169,8 +230,7 @@ extern "C" {
     uint32_t millis(void) { return 0; }
 
     bool feature(uint32_t mask) {
-        UNUSED(mask);
-        return false;
+        return (testData.enabledFeatures & mask) != 0;
     }
 
     bool isPPMDataBeingReceived(void) {
@@ -183,7 +243,7 @@ extern "C" {
 
     void resetPPMDataReceivedState(void) {}
 
-    bool rxMspFrameComplete(void) { return false; }
+    bool rxMspFrameComplete(void) { return testData.mspFrameComplete; }
 
     void rxMspInit(rxConfig_t *, rxRuntimeConfig_t *, rcReadRawDataPtr *) {}
 
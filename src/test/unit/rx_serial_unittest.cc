@@ -0,0 +1,475 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/serial.h"
+    #include "io/serial.h"
+
+    #include "rx/rx.h"
+    #include "rx/sbus.h"
+    #include "rx/ibus.h"
+    #include "rx/sumd.h"
+    #include "rx/sumh.h"
+    #include "rx/spektrum.h"
+    #include "rx/xbus.h"
+    #include "rx/jetiexbus.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// Frames captured from receivers, sticks at roll low, pitch centred, yaw high, throttle centred
+
+static const uint8_t sbusFrame[] = {
+    0x0F, 0xAD, 0xA0, 0x78, 0xF8, 0xC2, 0x17, 0xBE, 0xF0, 0x85, 0x2F, 0x7C,
+    0xE1, 0x0B, 0x5F, 0xF8, 0xC2, 0x17, 0xBE, 0xF0, 0x85, 0x2F, 0x7C, 0x00,
+    0x00,
+};
+
+static const uint8_t sbusFailsafeFrame[] = {
+    0x0F, 0xAD, 0xA0, 0x78, 0xF8, 0xC2, 0x17, 0xBE, 0xF0, 0x85, 0x2F, 0x7C,
+    0xE1, 0x0B, 0x5F, 0xF8, 0xC2, 0x17, 0xBE, 0xF0, 0x85, 0x2F, 0x7C, 0x08,
+    0x00,
+};
+
+static const uint8_t ibusFrame[] = {
+    0x20, 0x40, 0xE8, 0x03, 0xDC, 0x05, 0xD0, 0x07, 0xDC, 0x05, 0xDC, 0x05,
+    0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05,
+    0xDC, 0x05, 0xDC, 0x05, 0xDC, 0x05, 0x51, 0xF3,
+};
+
+static const uint8_t sumdFrame[] = {
+    0xA8, 0x01, 0x08, 0x22, 0x60, 0x2E, 0xE0, 0x3B, 0x60, 0x2E, 0xE0, 0x2E,
+    0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x6B, 0x0E,
+};
+
+static const uint8_t sumhFrame[] = {
+    0xA8, 0x00, 0x00, 0x24, 0xE0, 0x2E, 0xE0, 0x38, 0xE0, 0x2E, 0xE0, 0x2E,
+    0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x00, 0x00,
+};
+
+static const uint8_t spektrum2048Frame[] = {
+    0x00, 0x12, 0x00, 0xE0, 0x0C, 0x00, 0x17, 0x20, 0x1C, 0x00, 0x24, 0x00,
+    0x2C, 0x00, 0x34, 0x00,
+};
+
+static const uint8_t xbusModeBFrame[] = {
+    0xA1, 0x03, 0x6E, 0x08, 0x00, 0x0C, 0x93, 0x08, 0x00, 0x08, 0x00, 0x08,
+    0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08,
+    0x00, 0xA2, 0xDF,
+};
+
+static const uint8_t jetiExBusFrame[] = {
+    0x3E, 0x03, 0x28, 0x01, 0x31, 0x20, 0x60, 0x22, 0xE0, 0x2E, 0x60, 0x3B,
+    0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E,
+    0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E, 0xE0, 0x2E,
+    0xE0, 0x2E, 0x66, 0xD6,
+};
+
+#define FRAME_INTERVAL_US 14000
+#define BYTE_TIME_US 100
+
+static uint32_t fakeMicros;
+static serialReceiveCallbackPtr receiveCallback;
+static int framesReceived;
+static int frameErrors;
+static uint32_t lastFrameEndAt;
+
+static rxConfig_t rxConfig;
+rxRuntimeConfig_t rxRuntimeConfig;
+static rcReadRawDataPtr readRawRC;
+
+typedef bool (*rxProviderInit)(rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig, rcReadRawDataPtr *callback);
+
+static void initProvider(rxProviderInit init, uint8_t serialrxProvider)
+{
+    memset(&rxConfig, 0, sizeof(rxConfig));
+    memset(&rxRuntimeConfig, 0, sizeof(rxRuntimeConfig));
+    rxConfig.midrc = 1500;
+    rxConfig.serialrx_provider = serialrxProvider;
+
+    receiveCallback = NULL;
+    framesReceived = 0;
+    frameErrors = 0;
+
+    EXPECT_TRUE(init(&rxConfig, &rxRuntimeConfig, &readRawRC));
+    EXPECT_TRUE(receiveCallback != NULL);
+}
+
+// replays a frame byte by byte at the line rate, starting a frame interval after the previous one
+static void feedFrame(const uint8_t *frame, int length)
+{
+    fakeMicros += FRAME_INTERVAL_US - length * BYTE_TIME_US;
+    for (int i = 0; i < length; i++) {
+        fakeMicros += BYTE_TIME_US;
+        receiveCallback(frame[i]);
+    }
+}
+
+static void expectFlightChannels(uint16_t roll, uint16_t pitch, uint16_t yaw, uint16_t throttle)
+{
+    EXPECT_EQ(roll, readRawRC(&rxRuntimeConfig, 0));
+    EXPECT_EQ(pitch, readRawRC(&rxRuntimeConfig, 1));
+    EXPECT_EQ(yaw, readRawRC(&rxRuntimeConfig, 2));
+    EXPECT_EQ(throttle, readRawRC(&rxRuntimeConfig, 3));
+}
+
+TEST(RxSerialTest, SbusFramesAreDecodedInTheReceiveCallback)
+{
+    // given
+    initProvider(sbusInit, SERIALRX_SBUS);
+
+    // when
+    for (int i = 0; i < 10; i++) {
+        feedFrame(sbusFrame, sizeof(sbusFrame));
+    }
+
+    // then
+    EXPECT_EQ(10, framesReceived);
+    EXPECT_EQ(0, frameErrors);
+    EXPECT_EQ(fakeMicros, lastFrameEndAt);
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, sbusFrameStatus());
+    EXPECT_EQ(SERIAL_RX_FRAME_PENDING, sbusFrameStatus());
+    expectFlightChannels(988, 2012, 1500, 1500);
+}
+
+TEST(RxSerialTest, SbusFailsafeFlagIsReported)
+{
+    // given
+    initProvider(sbusInit, SERIALRX_SBUS);
+
+    // when
+    feedFrame(sbusFailsafeFrame, sizeof(sbusFailsafeFrame));
+
+    // then
+    EXPECT_EQ(1, framesReceived);
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE | SERIAL_RX_FRAME_FAILSAFE, sbusFrameStatus());
+}
+
+TEST(RxSerialTest, IbusFrames)
+{
+    // given
+    initProvider(ibusInit, SERIALRX_IBUS);
+
+    // when
+    for (int i = 0; i < 10; i++) {
+        feedFrame(ibusFrame, sizeof(ibusFrame));
+    }
+
+    // then
+    EXPECT_EQ(10, framesReceived);
+    EXPECT_EQ(0, frameErrors);
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, ibusFrameStatus());
+    expectFlightChannels(1000, 1500, 2000, 1500);
+}
+
+TEST(RxSerialTest, ChannelsOnlyChangeWhenTheRxTaskPicksUpAFrame)
+{
+    // given
+    initProvider(ibusInit, SERIALRX_IBUS);
+    uint8_t throttleUp[sizeof(ibusFrame)];
+    memcpy(throttleUp, ibusFrame, sizeof(ibusFrame));
+    throttleUp[8] = 0xD0;
+    throttleUp[9] = 0x07;
+    uint16_t checksum = 0xFFFF;
+    for (int i = 0; i < 30; i++) {
+        checksum -= throttleUp[i];
+    }
+    throttleUp[30] = checksum & 0xFF;
+    throttleUp[31] = checksum >> 8;
+
+    feedFrame(ibusFrame, sizeof(ibusFrame));
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, ibusFrameStatus());
+
+    // when
+    feedFrame(throttleUp, sizeof(throttleUp));
+
+    // then
+    expectFlightChannels(1000, 1500, 2000, 1500);
+
+    // and
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, ibusFrameStatus());
+    expectFlightChannels(1000, 1500, 2000, 2000);
+}
+
+TEST(RxSerialTest, IbusChecksumFailureIsCounted)
+{
+    // given
+    initProvider(ibusInit, SERIALRX_IBUS);
+    uint8_t corrupted[sizeof(ibusFrame)];
+    memcpy(corrupted, ibusFrame, sizeof(ibusFrame));
+    corrupted[5] ^= 0x10;
+
+    // when
+    feedFrame(ibusFrame, sizeof(ibusFrame));
+    feedFrame(corrupted, sizeof(corrupted));
+    feedFrame(ibusFrame, sizeof(ibusFrame));
+
+    // then
+    EXPECT_EQ(2, framesReceived);
+    EXPECT_EQ(1, frameErrors);
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, ibusFrameStatus());
+    expectFlightChannels(1000, 1500, 2000, 1500);
+}
+
+TEST(RxSerialTest, SumdFrames)
+{
+    // given
+    initProvider(sumdInit, SERIALRX_SUMD);
+
+    // when
+    for (int i = 0; i < 10; i++) {
+        feedFrame(sumdFrame, sizeof(sumdFrame));
+    }
+
+    // then
+    EXPECT_EQ(10, framesReceived);
+    EXPECT_EQ(0, frameErrors);
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, sumdFrameStatus());
+    expectFlightChannels(1100, 1500, 1900, 1500);
+}
+
+TEST(RxSerialTest, SumdCrcFailureIsCounted)
+{
+    // given
+    initProvider(sumdInit, SERIALRX_SUMD);
+    uint8_t corrupted[sizeof(sumdFrame)];
+    memcpy(corrupted, sumdFrame, sizeof(sumdFrame));
+    corrupted[8] ^= 0x01;
+
+    // when
+    feedFrame(corrupted, sizeof(corrupted));
+    feedFrame(corrupted, sizeof(corrupted));
+    feedFrame(sumdFrame, sizeof(sumdFrame));
+
+    // then
+    EXPECT_EQ(1, framesReceived);
+    EXPECT_EQ(2, frameErrors);
+}
+
+TEST(RxSerialTest, SumhFrames)
+{
+    // given
+    initProvider(sumhInit, SERIALRX_SUMH);
+
+    // when
+    for (int i = 0; i < 10; i++) {
+        feedFrame(sumhFrame, sizeof(sumhFrame));
+    }
+
+    // then
+    EXPECT_EQ(10, framesReceived);
+    EXPECT_EQ(0, frameErrors);
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, sumhFrameStatus());
+    expectFlightChannels(1100, 1500, 1900, 1500);
+}
+
+TEST(RxSerialTest, Spektrum2048Frames)
+{
+    // given
+    initProvider(spektrumInit, SERIALRX_SPEKTRUM2048);
+
+    // when
+    for (int i = 0; i < 10; i++) {
+        feedFrame(spektrum2048Frame, sizeof(spektrum2048Frame));
+    }
+
+    // then
+    EXPECT_EQ(10, framesReceived);
+    EXPECT_EQ(0, frameErrors);
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, spektrumFrameStatus());
+    expectFlightChannels(1100, 1500, 1900, 1500);
+}
+
+TEST(RxSerialTest, XbusModeBFrames)
+{
+    // given
+    initProvider(xBusInit, SERIALRX_XBUS_MODE_B);
+
+    // when
+    for (int i = 0; i < 10; i++) {
+        feedFrame(xbusModeBFrame, sizeof(xbusModeBFrame));
+    }
+
+    // then
+    EXPECT_EQ(10, framesReceived);
+    EXPECT_EQ(0, frameErrors);
+    EXPECT_EQ(fakeMicros, lastFrameEndAt);
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, xBusFrameStatus());
+    expectFlightChannels(1100, 1500, 1900, 1500);
+}
+
+TEST(RxSerialTest, XbusModeBCrcFailureIsCounted)
+{
+    // given
+    initProvider(xBusInit, SERIALRX_XBUS_MODE_B);
+    uint8_t corrupted[sizeof(xbusModeBFrame)];
+    memcpy(corrupted, xbusModeBFrame, sizeof(xbusModeBFrame));
+    corrupted[2] ^= 0x01;
+
+    // when
+    feedFrame(xbusModeBFrame, sizeof(xbusModeBFrame));
+    feedFrame(corrupted, sizeof(corrupted));
+
+    // then
+    EXPECT_EQ(1, framesReceived);
+    EXPECT_EQ(1, frameErrors);
+    expectFlightChannels(1100, 1500, 1900, 1500);
+}
+
+// the EX Bus CRC is checked in jetiExBusFrameStatus(), not in the receive callback
+TEST(RxSerialTest, JetiExBusFrames)
+{
+    // given
+    initProvider(jetiExBusInit, SERIALRX_JETIEXBUS);
+    uint32_t frameEndAt = 0;
+
+    // when
+    for (int i = 0; i < 10; i++) {
+        feedFrame(jetiExBusFrame, sizeof(jetiExBusFrame));
+        frameEndAt = fakeMicros;
+        fakeMicros += 500;
+        EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, jetiExBusFrameStatus());
+    }
+
+    // then
+    EXPECT_EQ(10, framesReceived);
+    EXPECT_EQ(0, frameErrors);
+    EXPECT_EQ(frameEndAt, lastFrameEndAt);
+    EXPECT_EQ(SERIAL_RX_FRAME_PENDING, jetiExBusFrameStatus());
+    expectFlightChannels(1100, 1500, 1900, 1500);
+}
+
+TEST(RxSerialTest, JetiExBusCrcFailureIsCounted)
+{
+    // given
+    initProvider(jetiExBusInit, SERIALRX_JETIEXBUS);
+    uint8_t corrupted[sizeof(jetiExBusFrame)];
+    memcpy(corrupted, jetiExBusFrame, sizeof(jetiExBusFrame));
+    corrupted[8] ^= 0x01;
+
+    // when
+    feedFrame(jetiExBusFrame, sizeof(jetiExBusFrame));
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, jetiExBusFrameStatus());
+    feedFrame(corrupted, sizeof(corrupted));
+    EXPECT_EQ(SERIAL_RX_FRAME_PENDING, jetiExBusFrameStatus());
+
+    // then
+    EXPECT_EQ(1, framesReceived);
+    EXPECT_EQ(1, frameErrors);
+    expectFlightChannels(1100, 1500, 1900, 1500);
+}
+
+TEST(RxSerialTest, NoiseBeforeTheFirstFrameIsSkipped)
+{
+    // given
+    initProvider(ibusInit, SERIALRX_IBUS);
+    const uint8_t noise[] = { 0x55, 0x20, 0x13, 0x00 };
+
+    // when
+    feedFrame(noise, sizeof(noise));
+    feedFrame(ibusFrame, sizeof(ibusFrame));
+
+    // then
+    EXPECT_EQ(1, framesReceived);
+    EXPECT_EQ(0, frameErrors);
+    EXPECT_EQ(SERIAL_RX_FRAME_COMPLETE, ibusFrameStatus());
+    expectFlightChannels(1000, 1500, 2000, 1500);
+}
+
+// STUBS
+
+extern "C" {
+
+uint32_t micros(void) { return fakeMicros; }
+uint32_t millis(void) { return fakeMicros / 1000; }
+
+void rxSerialFrameReceived(uint32_t frameEndAt)
+{
+    framesReceived++;
+    lastFrameEndAt = frameEndAt;
+}
+
+void rxSerialFrameError(void)
+{
+    frameErrors++;
+}
+
+static serialPortConfig_t portConfig;
+static serialPort_t port;
+
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function)
+{
+    UNUSED(function);
+    return &portConfig;
+}
+
+serialPort_t *openSerialPort(
+    serialPortIdentifier_e identifier,
+    serialPortFunction_e function,
+    serialReceiveCallbackPtr callback,
+    uint32_t baudrate,
+    portMode_t mode,
+    portOptions_t options
+)
+{
+    UNUSED(identifier);
+    UNUSED(function);
+    UNUSED(baudrate);
+    UNUSED(mode);
+    UNUSED(options);
+
+    receiveCallback = callback;
+    return &port;
+}
+
+void serialSetMode(serialPort_t *instance, portMode_t mode)
+{
+    UNUSED(instance);
+    UNUSED(mode);
+}
+
+// used by the Jeti EX Bus telemetry
+uint16_t vbat;
+int32_t amperage;
+int32_t mAhDrawn;
+int32_t BaroAlt;
+
+uint32_t uartTotalRxBytesWaiting(serialPort_t *instance)
+{
+    UNUSED(instance);
+    return 0;
+}
+
+bool isSerialTransmitBufferEmpty(serialPort_t *instance)
+{
+    UNUSED(instance);
+    return true;
+}
+
+void serialWrite(serialPort_t *instance, uint8_t ch)
+{
+    UNUSED(instance);
+    UNUSED(ch);
+}
+
+}
@@ -0,0 +1,294 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/maths.h"
+    #include "common/axis.h"
+    #include "common/color.h"
+
+    #include "drivers/system.h"
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+    #include "drivers/gpio.h"
+    #include "drivers/timer.h"
+    #include "drivers/serial.h"
+    #include "drivers/pwm_rx.h"
+
+    #include "io/serial.h"
+    #include "io/rc_controls.h"
+    #include "io/gimbal.h"
+    #include "io/gps.h"
+    #include "io/ledstrip.h"
+
+    #include "sensors/sensors.h"
+    #include "sensors/acceleration.h"
+    #include "sensors/gyro.h"
+    #include "sensors/barometer.h"
+    #include "sensors/boardalignment.h"
+    #include "sensors/battery.h"
+
+    #include "rx/rx.h"
+
+    #include "flight/mixer.h"
+    #include "flight/pid.h"
+    #include "flight/imu.h"
+    #include "flight/failsafe.h"
+    #include "flight/navigation_rewrite.h"
+
+    #include "telemetry/telemetry.h"
+    #include "telemetry/ltm.h"
+
+    #include "config/config.h"
+    #include "config/runtime_config.h"
+    #include "config/config_profile.h"
+    #include "config/config_master.h"
+
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+/*
+ * Runs the LTM telemetry against a simulated serial port that drains at the line rate of the radio behind it,
+ * and counts the frames of each type that come out.
+ */
+
+#define TELEMETRY_TASK_PERIOD_MS 4
+#define SIMULATED_TX_BUFFER_SIZE 64
+
+static uint32_t fakeTimeMs;
+
+static uint32_t txQueuedBytes;
+static uint32_t txDrainBytesPerSecond;
+static uint32_t txDrainRemainder;
+static uint32_t txTotalBytes;
+
+static uint8_t frameBytes[32];
+static uint8_t frameLength;
+static uint32_t frameCounts[256];
+static uint32_t badFrames;
+
+static telemetryConfig_t testTelemetryConfig;
+static serialPortConfig_t testPortConfig;
+static serialPort_t testPort;
+
+static uint8_t frameSize(uint8_t frameId)
+{
+    switch (frameId) {
+    case 'A': return 10;
+    case 'S': return 11;
+    case 'G': return 18;
+    case 'N': return 10;
+    case 'O': return 18;
+    case 'X': return 10;
+    default: return 0;
+    }
+}
+
+// Reassembles frames from the written bytes and checks their length and crc
+static void parseByte(uint8_t c)
+{
+    if (frameLength == 0 && c != '$') {
+        badFrames++;
+        return;
+    }
+    frameBytes[frameLength++] = c;
+
+    if (frameLength < 3) {
+        return;
+    }
+
+    const uint8_t size = frameSize(frameBytes[2]);
+    if (frameBytes[1] != 'T' || size == 0) {
+        badFrames++;
+        frameLength = 0;
+        return;
+    }
+
+    if (frameLength == size) {
+        uint8_t crc = 0;
+        for (int i = 3; i < size - 1; i++) {
+            crc ^= frameBytes[i];
+        }
+        if (crc == frameBytes[size - 1]) {
+            frameCounts[frameBytes[2]]++;
+        } else {
+            badFrames++;
+        }
+        frameLength = 0;
+    }
+}
+
+static void resetTest(baudRate_e baudRateIndex, uint32_t radioBaudRate, ltmUpdateRate_e updateRate)
+{
+    fakeTimeMs = 1000;
+    txQueuedBytes = 0;
+    txDrainBytesPerSecond = radioBaudRate / 10;
+    txDrainRemainder = 0;
+    txTotalBytes = 0;
+    frameLength = 0;
+    memset(frameCounts, 0, sizeof(frameCounts));
+    badFrames = 0;
+
+    memset(&testTelemetryConfig, 0, sizeof(testTelemetryConfig));
+    testTelemetryConfig.ltmUpdateRate = updateRate;
+    testPortConfig.telemetry_baudrateIndex = baudRateIndex;
+
+    initLtmTelemetry(&testTelemetryConfig);
+    configureLtmTelemetryPort();
+}
+
+// runs the telemetry task at its rate for a number of seconds, the port drains in between
+static void runTelemetry(uint32_t seconds)
+{
+    for (uint32_t elapsed = 0; elapsed < seconds * 1000; elapsed += TELEMETRY_TASK_PERIOD_MS) {
+        fakeTimeMs += TELEMETRY_TASK_PERIOD_MS;
+
+        const uint32_t drained = (TELEMETRY_TASK_PERIOD_MS * txDrainBytesPerSecond + txDrainRemainder) / 1000;
+        txDrainRemainder = (TELEMETRY_TASK_PERIOD_MS * txDrainBytesPerSecond + txDrainRemainder) % 1000;
+        txQueuedBytes -= MIN(drained, txQueuedBytes);
+
+        handleLtmTelemetry();
+    }
+}
+
+TEST(TelemetryLtmTest, FastLinkSendsAttitudeAtFullRate)
+{
+    // given
+    resetTest(BAUD_115200, 115200, LTM_RATE_AUTO);
+
+    // when
+    runTelemetry(10);
+
+    // then
+    EXPECT_EQ(0U, badFrames);
+    EXPECT_NEAR(500, frameCounts['A'], 10);
+    EXPECT_NEAR(100, frameCounts['S'], 5);
+    EXPECT_NEAR(100, frameCounts['G'], 5);
+    EXPECT_NEAR(50, frameCounts['N'], 3);
+    EXPECT_NEAR(20, frameCounts['O'], 2);
+}
+
+TEST(TelemetryLtmTest, AutoRateBelow57600KeepsTheNormalSchedule)
+{
+    // given
+    resetTest(BAUD_19200, 19200, LTM_RATE_AUTO);
+
+    // when
+    runTelemetry(10);
+
+    // then
+    EXPECT_EQ(0U, badFrames);
+    EXPECT_NEAR(100, frameCounts['A'], 3);
+    EXPECT_NEAR(50, frameCounts['S'], 2);
+    EXPECT_NEAR(50, frameCounts['G'], 2);
+    EXPECT_NEAR(30, frameCounts['N'], 2);
+    EXPECT_NEAR(10, frameCounts['O'], 1);
+}
+
+TEST(TelemetryLtmTest, SlowRadioKeepsTheImportantFrames)
+{
+    // given
+    // a 2400 baud radio behind a 9600 baud port can carry 240 bytes a second, the normal schedule needs about 300
+    resetTest(BAUD_9600, 2400, LTM_RATE_NORMAL);
+
+    // when
+    runTelemetry(10);
+
+    // then
+    EXPECT_EQ(0U, badFrames);
+    EXPECT_LE(txTotalBytes, 2400U + SIMULATED_TX_BUFFER_SIZE);
+
+    // attitude and status keep most of their rate, the rest gives way
+    EXPECT_GE(frameCounts['A'], 80U);
+    EXPECT_GE(frameCounts['S'], 40U);
+    EXPECT_GT(frameCounts['G'], 0U);
+    EXPECT_LT(frameCounts['O'] * 18 + frameCounts['N'] * 10, frameCounts['A'] * 10);
+}
+
+TEST(TelemetryLtmTest, SlowScheduleFitsA1200BaudRadio)
+{
+    // given
+    resetTest(BAUD_9600, 1200, LTM_RATE_SLOW);
+
+    // when
+    runTelemetry(20);
+
+    // then
+    EXPECT_EQ(0U, badFrames);
+    EXPECT_NEAR(40, frameCounts['A'], 2);
+    EXPECT_NEAR(20, frameCounts['S'], 1);
+    EXPECT_NEAR(20, frameCounts['G'], 1);
+    EXPECT_NEAR(4, frameCounts['O'], 1);
+}
+
+// STUBS
+
+extern "C" {
+
+uint8_t armingFlags;
+uint16_t flightModeFlags;
+uint8_t stateFlags;
+uint16_t rssi;
+uint16_t vbat;
+attitudeEulerAngles_t attitude;
+gpsSolutionData_t gpsSol;
+gpsLocation_t GPS_home;
+navSystemStatus_t NAV_Status;
+
+const uint32_t baudRates[] = {0, 9600, 19200, 38400, 57600, 115200, 230400, 250000};
+
+uint32_t millis(void) { return fakeTimeMs; }
+uint32_t micros(void) { return fakeTimeMs * 1000; }
+
+bool sensors(uint32_t mask) { UNUSED(mask); return true; }
+bool failsafeIsActive(void) { return false; }
+float getEstimatedActualPosition(int axis) { UNUSED(axis); return 0; }
+
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function) { UNUSED(function); return &testPortConfig; }
+portSharing_e determinePortSharing(serialPortConfig_t *portConfig, serialPortFunction_e function) { UNUSED(portConfig); UNUSED(function); return PORTSHARING_NOT_SHARED; }
+bool telemetryDetermineEnabledState(portSharing_e portSharing) { UNUSED(portSharing); return true; }
+serialPort_t *openSerialPort(serialPortIdentifier_e identifier, serialPortFunction_e function, serialReceiveCallbackPtr callback, uint32_t baudrate, portMode_t mode, portOptions_t options)
+{
+    UNUSED(identifier); UNUSED(function); UNUSED(callback); UNUSED(baudrate); UNUSED(mode); UNUSED(options);
+    return &testPort;
+}
+void closeSerialPort(serialPort_t *serialPort) { UNUSED(serialPort); }
+
+uint32_t serialTxBytesFree(serialPort_t *instance)
+{
+    UNUSED(instance);
+    return SIMULATED_TX_BUFFER_SIZE - txQueuedBytes;
+}
+
+void serialWrite(serialPort_t *instance, uint8_t ch)
+{
+    UNUSED(instance);
+    EXPECT_LT(txQueuedBytes, (uint32_t)SIMULATED_TX_BUFFER_SIZE);
+    txQueuedBytes++;
+    txTotalBytes++;
+    parseByte(ch);
+}
+
+}
@@ -0,0 +1,663 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/maths.h"
+    #include "common/axis.h"
+    #include "common/color.h"
+
+    #include "drivers/system.h"
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+    #include "drivers/gpio.h"
+    #include "drivers/timer.h"
+    #include "drivers/serial.h"
+    #include "drivers/pwm_rx.h"
+
+    #include "io/serial.h"
+    #include "io/rc_controls.h"
+    #include "io/gimbal.h"
+    #include "io/gps.h"
+    #include "io/ledstrip.h"
+
+    #include "sensors/sensors.h"
+    #include "sensors/acceleration.h"
+    #include "sensors/gyro.h"
+    #include "sensors/barometer.h"
+    #include "sensors/boardalignment.h"
+    #include "sensors/battery.h"
+
+    #include "rx/rx.h"
+
+    #include "flight/mixer.h"
+    #include "flight/pid.h"
+    #include "flight/imu.h"
+    #include "flight/failsafe.h"
+    #include "flight/navigation_rewrite.h"
+
+    #include "telemetry/telemetry.h"
+    #include "telemetry/mavlink.h"
+
+    #include "config/config.h"
+    #include "config/runtime_config.h"
+    #include "config/config_profile.h"
+    #include "config/config_master.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+    #include "mavlink/common/mavlink.h"
+#pragma GCC diagnostic pop
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+/*
+ * A loopback ground station talks to the MAVLink telemetry over a fake serial port. Bytes it sends are read by
+ * the telemetry task, bytes the task writes are parsed back into messages for the test to look at.
+ */
+
+#define GCS_SYSTEM_ID 255
+#define GCS_COMPONENT_ID 190
+#define TELEMETRY_TASK_PERIOD_MS 4
+
+static uint32_t fakeTimeMs;
+
+static uint8_t gcsToFc[1024];
+static uint32_t gcsToFcHead;
+static uint32_t gcsToFcTail;
+
+static std::vector<mavlink_message_t> fcToGcs;
+static mavlink_status_t gcsParserStatus;
+static mavlink_message_t gcsParserMessage;
+
+static telemetryConfig_t testTelemetryConfig;
+static serialPortConfig_t testPortConfig;
+static serialPort_t testPort;
+
+static void gcsSend(const mavlink_message_t *msg)
+{
+    gcsToFcHead += mavlink_msg_to_send_buffer(gcsToFc + gcsToFcHead, msg);
+}
+
+// runs the telemetry task at its rate, the serial port drains as fast as bytes are written
+static void runTelemetry(uint32_t durationMs)
+{
+    for (uint32_t elapsed = 0; elapsed < durationMs; elapsed += TELEMETRY_TASK_PERIOD_MS) {
+        fakeTimeMs += TELEMETRY_TASK_PERIOD_MS;
+        handleMAVLinkTelemetry();
+    }
+}
+
+static std::vector<mavlink_message_t> receivedWithId(uint8_t msgid)
+{
+    std::vector<mavlink_message_t> messages;
+    for (size_t i = 0; i < fcToGcs.size(); i++) {
+        if (fcToGcs[i].msgid == msgid) {
+            messages.push_back(fcToGcs[i]);
+        }
+    }
+    return messages;
+}
+
+// Settings served as parameters
+
+typedef struct testSetting_s {
+    const char *name;
+    const char *paramId;
+    float value;
+    float min;
+    float max;
+} testSetting_t;
+
+static testSetting_t testSettings[] = {
+    { "small_angle", "small_angle", 25, 0, 180 },
+    { "mavlink_ext_status_rate", "mavlink_ext~9e3d", 2, 0, 50 },
+    { "nav_rth_altitude", "nav_rth_altitude", 1000, 100, 65000 },
+    { "mag_declination", "mag_declination", -150, -18000, 18000 },
+    { "failsafe_throttle", "failsafe_th~151c", 1000, 1000, 2000 },
+    { "failsafe_throttle_low_delay", "failsafe_th~7d2a", 100, 0, 300 },
+};
+
+#define TEST_SETTING_COUNT (sizeof(testSettings) / sizeof(testSettings[0]))
+
+// Waypoint store
+
+static navWaypoint_t testWaypoints[NAV_MAX_WAYPOINTS];
+static int testWaypointCount;
+static bool testWaypointListValid;
+static int eepromWrites;
+static int configActivations;
+
+static void resetTest(void)
+{
+    fakeTimeMs = 1000;
+    gcsToFcHead = gcsToFcTail = 0;
+    fcToGcs.clear();
+    memset(&gcsParserStatus, 0, sizeof(gcsParserStatus));
+
+    testSettings[0].value = 25;
+    testSettings[1].value = 2;
+    testSettings[4].value = 1000;
+    testSettings[5].value = 100;
+    testWaypointCount = 0;
+    testWaypointListValid = false;
+    eepromWrites = 0;
+    configActivations = 0;
+    armingFlags = 0;
+
+    memset(&testTelemetryConfig, 0, sizeof(testTelemetryConfig));
+    testTelemetryConfig.mavlink_ext_status_rate = 2;
+    testTelemetryConfig.mavlink_rc_chan_rate = 5;
+    testTelemetryConfig.mavlink_pos_rate = 2;
+    testTelemetryConfig.mavlink_extra1_rate = 10;
+    testTelemetryConfig.mavlink_extra2_rate = 10;
+    testPortConfig.telemetry_baudrateIndex = BAUD_57600;
+
+    initMAVLinkTelemetry(&testTelemetryConfig);
+    configureMAVLinkTelemetryPort();
+}
+
+static void missionItem(mavlink_message_t *msg, uint16_t seq, uint16_t command, float lat, float lon, float alt)
+{
+    mavlink_msg_mission_item_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, msg, 0, 0, seq, MAV_FRAME_GLOBAL_RELATIVE_ALT,
+        command, 0, 1, 0, 0, 0, 0, lat, lon, alt);
+}
+
+TEST(TelemetryMavlinkTest, ParamListStreamsEverySettingOnce)
+{
+    // given
+    resetTest();
+    mavlink_message_t msg;
+    mavlink_msg_param_request_list_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0);
+
+    // when
+    gcsSend(&msg);
+    runTelemetry(1000);
+
+    // then
+    std::vector<mavlink_message_t> values = receivedWithId(MAVLINK_MSG_ID_PARAM_VALUE);
+    ASSERT_EQ(TEST_SETTING_COUNT, values.size());
+    for (uint16_t i = 0; i < TEST_SETTING_COUNT; i++) {
+        char paramId[17] = { 0 };
+        mavlink_msg_param_value_get_param_id(&values[i], paramId);
+
+        EXPECT_EQ(i, mavlink_msg_param_value_get_param_index(&values[i]));
+        EXPECT_EQ(TEST_SETTING_COUNT, mavlink_msg_param_value_get_param_count(&values[i]));
+        EXPECT_STREQ(testSettings[i].paramId, paramId);
+        EXPECT_EQ(testSettings[i].value, mavlink_msg_param_value_get_param_value(&values[i]));
+    }
+
+    // and
+    // the telemetry streams keep going meanwhile
+    EXPECT_GE(receivedWithId(MAVLINK_MSG_ID_ATTITUDE).size(), 9U);
+}
+
+TEST(TelemetryMavlinkTest, ParamSetChangesSettingAndAnswersWithNewValue)
+{
+    // given
+    resetTest();
+    mavlink_message_t msg;
+    mavlink_msg_param_set_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, "small_angle", 40, MAV_PARAM_TYPE_REAL32);
+
+    // when
+    gcsSend(&msg);
+    runTelemetry(500);
+
+    // then
+    EXPECT_EQ(40, testSettings[0].value);
+    EXPECT_EQ(1, configActivations);
+
+    std::vector<mavlink_message_t> values = receivedWithId(MAVLINK_MSG_ID_PARAM_VALUE);
+    ASSERT_EQ(1U, values.size());
+    EXPECT_EQ(40, mavlink_msg_param_value_get_param_value(&values[0]));
+}
+
+TEST(TelemetryMavlinkTest, ParamSetOutOfRangeKeepsSetting)
+{
+    // given
+    resetTest();
+    mavlink_message_t msg;
+    mavlink_msg_param_set_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, "small_angle", 200, MAV_PARAM_TYPE_REAL32);
+
+    // when
+    gcsSend(&msg);
+    runTelemetry(100);
+
+    // then
+    EXPECT_EQ(25, testSettings[0].value);
+    EXPECT_EQ(0, configActivations);
+
+    std::vector<mavlink_message_t> values = receivedWithId(MAVLINK_MSG_ID_PARAM_VALUE);
+    ASSERT_EQ(1U, values.size());
+    EXPECT_EQ(25, mavlink_msg_param_value_get_param_value(&values[0]));
+}
+
+TEST(TelemetryMavlinkTest, LongSettingNamesAreTaggedWithTheirNameCrc)
+{
+    // given
+    resetTest();
+    mavlink_message_t msg;
+    mavlink_msg_param_set_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, "mavlink_ext~9e3d", 5, MAV_PARAM_TYPE_REAL32);
+
+    // when
+    gcsSend(&msg);
+    runTelemetry(100);
+
+    // then
+    EXPECT_EQ(5, testSettings[1].value);
+}
+
+TEST(TelemetryMavlinkTest, LongSettingNamesWithTheSamePrefixAreToldApart)
+{
+    // given
+    resetTest();
+    mavlink_message_t msg;
+    mavlink_msg_param_set_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, "failsafe_th~7d2a", 200, MAV_PARAM_TYPE_REAL32);
+
+    // when
+    gcsSend(&msg);
+    runTelemetry(100);
+
+    // then
+    EXPECT_EQ(1000, testSettings[4].value);
+    EXPECT_EQ(200, testSettings[5].value);
+
+    // and
+    // the plain 16 character prefix shared by both names matches neither
+    mavlink_msg_param_set_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, "failsafe_throttl", 1500, MAV_PARAM_TYPE_REAL32);
+    gcsSend(&msg);
+    runTelemetry(100);
+    EXPECT_EQ(1000, testSettings[4].value);
+}
+
+TEST(TelemetryMavlinkTest, ParamSetIsRefusedWhenArmed)
+{
+    // given
+    resetTest();
+    ENABLE_ARMING_FLAG(ARMED);
+    mavlink_message_t msg;
+    mavlink_msg_param_set_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, "small_angle", 40, MAV_PARAM_TYPE_REAL32);
+
+    // when
+    gcsSend(&msg);
+    runTelemetry(100);
+
+    // then
+    EXPECT_EQ(25, testSettings[0].value);
+    EXPECT_EQ(1U, receivedWithId(MAVLINK_MSG_ID_PARAM_VALUE).size());
+}
+
+TEST(TelemetryMavlinkTest, ParamSetBurstIsActivatedOnceAndEveryWriteIsAnswered)
+{
+    // given
+    resetTest();
+    mavlink_message_t msg;
+
+    // when
+    // the writes arrive faster than the reply stream sends answers
+    for (int i = 0; i < 4; i++) {
+        mavlink_msg_param_set_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, "small_angle", 30 + i, MAV_PARAM_TYPE_REAL32);
+        gcsSend(&msg);
+    }
+    mavlink_msg_param_set_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, "nav_rth_altitude", 2000, MAV_PARAM_TYPE_REAL32);
+    gcsSend(&msg);
+    runTelemetry(100);
+
+    // then
+    EXPECT_EQ(0, configActivations);
+    EXPECT_EQ(5U, receivedWithId(MAVLINK_MSG_ID_PARAM_VALUE).size());
+
+    // and
+    runTelemetry(400);
+    EXPECT_EQ(1, configActivations);
+    EXPECT_EQ(33, testSettings[0].value);
+    EXPECT_EQ(2000, testSettings[2].value);
+}
+
+TEST(TelemetryMavlinkTest, RequestsForAnotherSystemOrComponentAreIgnored)
+{
+    // given
+    resetTest();
+    mavlink_message_t msg;
+
+    // when
+    mavlink_msg_param_set_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 1, 0, "small_angle", 40, MAV_PARAM_TYPE_REAL32);
+    gcsSend(&msg);
+    mavlink_msg_param_set_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, MAV_COMP_ID_CAMERA, "small_angle", 41, MAV_PARAM_TYPE_REAL32);
+    gcsSend(&msg);
+    runTelemetry(100);
+
+    // then
+    EXPECT_EQ(25, testSettings[0].value);
+    EXPECT_EQ(0U, receivedWithId(MAVLINK_MSG_ID_PARAM_VALUE).size());
+}
+
+TEST(TelemetryMavlinkTest, PreflightStorageSavesTheConfig)
+{
+    // given
+    resetTest();
+    mavlink_message_t msg;
+    mavlink_msg_command_long_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, MAV_CMD_PREFLIGHT_STORAGE, 0, 1, 0, 0, 0, 0, 0, 0);
+
+    // when
+    gcsSend(&msg);
+    runTelemetry(100);
+
+    // then
+    EXPECT_EQ(1, eepromWrites);
+
+    std::vector<mavlink_message_t> acks = receivedWithId(MAVLINK_MSG_ID_COMMAND_ACK);
+    ASSERT_EQ(1U, acks.size());
+    EXPECT_EQ(MAV_CMD_PREFLIGHT_STORAGE, mavlink_msg_command_ack_get_command(&acks[0]));
+    EXPECT_EQ(MAV_RESULT_ACCEPTED, mavlink_msg_command_ack_get_result(&acks[0]));
+}
+
+TEST(TelemetryMavlinkTest, MissionUploadStoresWaypoints)
+{
+    // given
+    resetTest();
+    mavlink_message_t msg;
+    mavlink_msg_mission_count_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, 3);
+    gcsSend(&msg);
+
+    // when
+    // the ground station answers every MISSION_REQUEST with the item asked for
+    for (int step = 0; step < 100; step++) {
+        const size_t seen = fcToGcs.size();
+        runTelemetry(TELEMETRY_TASK_PERIOD_MS);
+        for (size_t i = seen; i < fcToGcs.size(); i++) {
+            if (fcToGcs[i].msgid == MAVLINK_MSG_ID_MISSION_REQUEST) {
+                const uint16_t seq = mavlink_msg_mission_request_get_seq(&fcToGcs[i]);
+                missionItem(&msg, seq, seq == 2 ? MAV_CMD_NAV_RETURN_TO_LAUNCH : MAV_CMD_NAV_WAYPOINT, 50.1234567f + seq, 8.7654321f, 25.5f);
+                gcsSend(&msg);
+            }
+        }
+    }
+
+    // then
+    std::vector<mavlink_message_t> acks = receivedWithId(MAVLINK_MSG_ID_MISSION_ACK);
+    ASSERT_EQ(1U, acks.size());
+    EXPECT_EQ(MAV_MISSION_ACCEPTED, mavlink_msg_mission_ack_get_type(&acks[0]));
+
+    EXPECT_EQ(3, getWaypointCount());
+    EXPECT_EQ(NAV_WP_ACTION_WAYPOINT, testWaypoints[0].action);
+    EXPECT_NEAR(501234567, testWaypoints[0].lat, 50);
+    EXPECT_NEAR(87654321, testWaypoints[0].lon, 10);
+    EXPECT_EQ(2550, testWaypoints[0].alt);
+    EXPECT_EQ(NAV_WP_ACTION_RTH, testWaypoints[2].action);
+    EXPECT_EQ(NAV_WP_FLAG_LAST, testWaypoints[2].flag);
+}
+
+TEST(TelemetryMavlinkTest, MissionUploadAsksAgainForALostItem)
+{
+    // given
+    resetTest();
+    mavlink_message_t msg;
+    mavlink_msg_mission_count_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, 1);
+    gcsSend(&msg);
+
+    // when
+    // the first request goes unanswered
+    runTelemetry(1500);
+
+    // then
+    std::vector<mavlink_message_t> requests = receivedWithId(MAVLINK_MSG_ID_MISSION_REQUEST);
+    ASSERT_EQ(2U, requests.size());
+    EXPECT_EQ(0, mavlink_msg_mission_request_get_seq(&requests[1]));
+
+    // and
+    missionItem(&msg, 0, MAV_CMD_NAV_WAYPOINT, 50, 8, 10);
+    gcsSend(&msg);
+    runTelemetry(100);
+
+    std::vector<mavlink_message_t> acks = receivedWithId(MAVLINK_MSG_ID_MISSION_ACK);
+    ASSERT_EQ(1U, acks.size());
+    EXPECT_EQ(MAV_MISSION_ACCEPTED, mavlink_msg_mission_ack_get_type(&acks[0]));
+}
+
+TEST(TelemetryMavlinkTest, AbortedMissionUploadKeepsTheStoredMission)
+{
+    // given
+    resetTest();
+    testWaypoints[0] = (navWaypoint_t){ NAV_WP_ACTION_WAYPOINT, 501234567, 87654321, 2500, 0, 0, 0, NAV_WP_FLAG_LAST };
+    testWaypointCount = 1;
+    testWaypointListValid = true;
+
+    mavlink_message_t msg;
+    mavlink_msg_mission_count_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, 2);
+    gcsSend(&msg);
+    runTelemetry(100);
+
+    // when
+    // the first item arrives, then the ground station goes away
+    missionItem(&msg, 0, MAV_CMD_NAV_WAYPOINT, 50, 8, 10);
+    gcsSend(&msg);
+    runTelemetry(7000);
+
+    // then
+    std::vector<mavlink_message_t> acks = receivedWithId(MAVLINK_MSG_ID_MISSION_ACK);
+    ASSERT_EQ(1U, acks.size());
+    EXPECT_EQ(MAV_MISSION_ERROR, mavlink_msg_mission_ack_get_type(&acks[0]));
+
+    EXPECT_EQ(1, getWaypointCount());
+    EXPECT_EQ(501234567, testWaypoints[0].lat);
+}
+
+TEST(TelemetryMavlinkTest, MissionLongerThanTheStoreIsRefused)
+{
+    // given
+    resetTest();
+    mavlink_message_t msg;
+    mavlink_msg_mission_count_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, NAV_MAX_WAYPOINTS + 1);
+
+    // when
+    gcsSend(&msg);
+    runTelemetry(100);
+
+    // then
+    std::vector<mavlink_message_t> acks = receivedWithId(MAVLINK_MSG_ID_MISSION_ACK);
+    ASSERT_EQ(1U, acks.size());
+    EXPECT_EQ(MAV_MISSION_NO_SPACE, mavlink_msg_mission_ack_get_type(&acks[0]));
+    EXPECT_EQ(0U, receivedWithId(MAVLINK_MSG_ID_MISSION_REQUEST).size());
+}
+
+TEST(TelemetryMavlinkTest, MissionDownloadReturnsStoredWaypoints)
+{
+    // given
+    resetTest();
+    testWaypoints[0] = (navWaypoint_t){ NAV_WP_ACTION_WAYPOINT, 501234567, 87654321, 2500, 0, 0, 0, 0 };
+    testWaypoints[1] = (navWaypoint_t){ NAV_WP_ACTION_RTH, 0, 0, 0, 0, 0, 0, NAV_WP_FLAG_LAST };
+    testWaypointCount = 2;
+    testWaypointListValid = true;
+
+    mavlink_message_t msg;
+    mavlink_msg_mission_request_list_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0);
+
+    // when
+    gcsSend(&msg);
+    runTelemetry(40);
+    mavlink_msg_mission_request_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, 0);
+    gcsSend(&msg);
+    runTelemetry(40);
+    mavlink_msg_mission_request_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, 1);
+    gcsSend(&msg);
+    runTelemetry(40);
+
+    // then
+    std::vector<mavlink_message_t> counts = receivedWithId(MAVLINK_MSG_ID_MISSION_COUNT);
+    ASSERT_EQ(1U, counts.size());
+    EXPECT_EQ(2, mavlink_msg_mission_count_get_count(&counts[0]));
+    EXPECT_EQ(GCS_SYSTEM_ID, mavlink_msg_mission_count_get_target_system(&counts[0]));
+
+    std::vector<mavlink_message_t> items = receivedWithId(MAVLINK_MSG_ID_MISSION_ITEM);
+    ASSERT_EQ(2U, items.size());
+    EXPECT_EQ(MAV_CMD_NAV_WAYPOINT, mavlink_msg_mission_item_get_command(&items[0]));
+    EXPECT_NEAR(50.1234567f, mavlink_msg_mission_item_get_x(&items[0]), 1e-5f);
+    EXPECT_FLOAT_EQ(25.0f, mavlink_msg_mission_item_get_z(&items[0]));
+    EXPECT_EQ(MAV_CMD_NAV_RETURN_TO_LAUNCH, mavlink_msg_mission_item_get_command(&items[1]));
+}
+
+TEST(TelemetryMavlinkTest, RequestDataStreamChangesTheStreamRate)
+{
+    // given
+    resetTest();
+    mavlink_message_t msg;
+    mavlink_msg_request_data_stream_pack(GCS_SYSTEM_ID, GCS_COMPONENT_ID, &msg, 0, 0, MAV_DATA_STREAM_EXTRA1, 50, 1);
+
+    // when
+    gcsSend(&msg);
+    runTelemetry(4);
+    fcToGcs.clear();
+    runTelemetry(1000);
+
+    // then
+    // attitude at 50Hz fits on a 57600 link next to the other streams
+    EXPECT_GE(receivedWithId(MAVLINK_MSG_ID_ATTITUDE).size(), 45U);
+    EXPECT_GE(receivedWithId(MAVLINK_MSG_ID_VFR_HUD).size(), 9U);
+    EXPECT_EQ(1U, receivedWithId(MAVLINK_MSG_ID_HEARTBEAT).size());
+}
+
+TEST(TelemetryMavlinkTest, HeartbeatIsSentOnceASecondWhateverTheStreamRates)
+{
+    // given
+    resetTest();
+    testTelemetryConfig.mavlink_extra2_rate = 50;
+    configureMAVLinkTelemetryPort();
+
+    // when
+    runTelemetry(5000);
+
+    // then
+    EXPECT_EQ(5U, receivedWithId(MAVLINK_MSG_ID_HEARTBEAT).size());
+
+    // given
+    resetTest();
+    testTelemetryConfig.mavlink_extra2_rate = 0;
+    configureMAVLinkTelemetryPort();
+
+    // when
+    runTelemetry(5000);
+
+    // then
+    EXPECT_EQ(0U, receivedWithId(MAVLINK_MSG_ID_VFR_HUD).size());
+    EXPECT_EQ(5U, receivedWithId(MAVLINK_MSG_ID_HEARTBEAT).size());
+}
+
+// STUBS
+
+extern "C" {
+
+uint8_t armingFlags;
+uint16_t flightModeFlags;
+uint8_t stateFlags;
+uint16_t rssi;
+uint16_t vbat;
+int32_t amperage;
+int16_t rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+rxRuntimeConfig_t rxRuntimeConfig;
+attitudeEulerAngles_t attitude;
+gpsSolutionData_t gpsSol;
+gpsLocation_t GPS_home;
+master_t masterConfig;
+
+const uint32_t baudRates[] = {0, 9600, 19200, 38400, 57600, 115200, 230400, 250000};
+
+uint32_t millis(void) { return fakeTimeMs; }
+uint32_t micros(void) { return fakeTimeMs * 1000; }
+
+bool sensors(uint32_t mask) { UNUSED(mask); return false; }
+bool feature(uint32_t mask) { UNUSED(mask); return false; }
+uint8_t calculateBatteryPercentage(void) { return 0; }
+bool failsafeIsActive(void) { return false; }
+bool isCalibrating(void) { return false; }
+float getEstimatedActualPosition(int axis) { UNUSED(axis); return 0; }
+float getEstimatedActualVelocity(int axis) { UNUSED(axis); return 0; }
+
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function) { UNUSED(function); return &testPortConfig; }
+portSharing_e determinePortSharing(serialPortConfig_t *portConfig, serialPortFunction_e function) { UNUSED(portConfig); UNUSED(function); return PORTSHARING_NOT_SHARED; }
+bool telemetryDetermineEnabledState(portSharing_e portSharing) { UNUSED(portSharing); return true; }
+serialPort_t *openSerialPort(serialPortIdentifier_e identifier, serialPortFunction_e function, serialReceiveCallbackPtr callback, uint32_t baudrate, portMode_t mode, portOptions_t options)
+{
+    UNUSED(identifier); UNUSED(function); UNUSED(callback); UNUSED(baudrate); UNUSED(mode); UNUSED(options);
+    return &testPort;
+}
+void closeSerialPort(serialPort_t *serialPort) { UNUSED(serialPort); }
+
+uint32_t serialRxBytesWaiting(serialPort_t *instance) { UNUSED(instance); return gcsToFcHead - gcsToFcTail; }
+uint8_t serialRead(serialPort_t *instance) { UNUSED(instance); return gcsToFc[gcsToFcTail++]; }
+uint32_t serialTxBytesFree(serialPort_t *instance) { UNUSED(instance); return 256; }
+void serialWriteBuf(serialPort_t *instance, uint8_t *data, int count)
+{
+    UNUSED(instance);
+    for (int i = 0; i < count; i++) {
+        if (mavlink_parse_char(MAVLINK_COMM_1, data[i], &gcsParserMessage, &gcsParserStatus)) {
+            fcToGcs.push_back(gcsParserMessage);
+        }
+    }
+}
+
+void writeEEPROM(void) { eepromWrites++; }
+void readEEPROM(void) {}
+void activateConfig(void) { configActivations++; }
+
+uint16_t cliGetSettingCount(void) { return TEST_SETTING_COUNT; }
+const char *cliGetSettingName(uint16_t index) { return testSettings[index].name; }
+float cliGetSettingValue(uint16_t index) { return testSettings[index].value; }
+bool cliSetSettingValue(uint16_t index, float value)
+{
+    if (value < testSettings[index].min || value > testSettings[index].max) {
+        return false;
+    }
+    testSettings[index].value = value;
+    return true;
+}
+
+void getWaypoint(uint8_t wpNumber, navWaypoint_t *wpData)
+{
+    *wpData = testWaypoints[wpNumber - 1];
+}
+
+void setWaypoint(uint8_t wpNumber, navWaypoint_t *wpData)
+{
+    if (wpNumber == testWaypointCount + 1 || wpNumber == 1) {
+        testWaypoints[wpNumber - 1] = *wpData;
+        testWaypointCount = wpNumber;
+        testWaypointListValid = wpData->flag == NAV_WP_FLAG_LAST;
+    }
+}
+
+void resetWaypointList(void)
+{
+    testWaypointCount = 0;
+    testWaypointListValid = false;
+}
+
+int getWaypointCount(void)
+{
+    return testWaypointListValid ? testWaypointCount : 0;
+}
+
+}
@@ -0,0 +1,157 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "telemetry/telemetry_scheduler.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_ITEM_COUNT 3
+
+static telemetryLink_t testLink;
+static telemetryItem_t items[TEST_ITEM_COUNT];
+static uint32_t itemSendCount[TEST_ITEM_COUNT];
+static uint32_t bytesWrittenAt[1000];
+
+static void initItems(uint16_t size)
+{
+    memset(items, 0, sizeof(items));
+    memset(itemSendCount, 0, sizeof(itemSendCount));
+    memset(bytesWrittenAt, 0, sizeof(bytesWrittenAt));
+
+    items[0] = (telemetryItem_t){ .intervalMs = 100, .priority = TELEMETRY_PRIORITY_HIGH, .maxSize = (uint8_t)size, .lastSentAt = 0 };
+    items[1] = (telemetryItem_t){ .intervalMs = 100, .priority = TELEMETRY_PRIORITY_NORMAL, .maxSize = (uint8_t)size, .lastSentAt = 0 };
+    items[2] = (telemetryItem_t){ .intervalMs = 100, .priority = TELEMETRY_PRIORITY_LOW, .maxSize = (uint8_t)size, .lastSentAt = 0 };
+}
+
+// runs the telemetry task every millisecond for a second
+static void runOneSecond(uint32_t startAtMs)
+{
+    for (uint32_t ms = 0; ms < 1000; ms++) {
+        const uint32_t now = startAtMs + ms;
+        telemetryLinkRefill(&testLink, now * 1000);
+
+        int item;
+        while ((item = telemetryScheduleNextItem(&testLink, items, TEST_ITEM_COUNT, now)) != TELEMETRY_NO_ITEM) {
+            itemSendCount[item]++;
+            bytesWrittenAt[ms] += items[item].maxSize;
+            telemetryScheduleItemSent(&testLink, &items[item], items[item].maxSize, now);
+        }
+    }
+}
+
+TEST(TelemetrySchedulerTest, BudgetFollowsLineRate)
+{
+    // given
+    telemetryLinkInit(&testLink, 9600, 10, 64);
+
+    // when
+    testLink.lastRefillAt = 0;
+    telemetryLinkRefill(&testLink, 10000);
+
+    // then
+    EXPECT_EQ(960U, testLink.bytesPerSecond);
+    EXPECT_EQ(9, testLink.budget);
+
+    // and
+    telemetryLinkRefill(&testLink, 1000000);
+    EXPECT_EQ(64, testLink.budget);
+}
+
+TEST(TelemetrySchedulerTest, ItemsAreNotSentBeforeTheirInterval)
+{
+    // given
+    telemetryLinkInit(&testLink, 115200, 10, 255);
+    initItems(10);
+
+    // when
+    runOneSecond(1000);
+
+    // then
+    EXPECT_EQ(10U, itemSendCount[0]);
+    EXPECT_EQ(10U, itemSendCount[1]);
+    EXPECT_EQ(10U, itemSendCount[2]);
+}
+
+TEST(TelemetrySchedulerTest, WritesNeverExceedTheLink)
+{
+    // given
+    // 960 bytes per second for items wanting 3 * 10 * 60 = 1800
+    telemetryLinkInit(&testLink, 9600, 10, 60);
+    initItems(60);
+
+    // when
+    runOneSecond(1000);
+
+    // then
+    uint32_t bytesWritten = 0;
+    for (int ms = 0; ms < 1000; ms++) {
+        bytesWritten += bytesWrittenAt[ms];
+        // the burst allowance plus what the testLink carried so far
+        EXPECT_LE(bytesWritten, 60 + 960 * (ms + 1) / 1000);
+    }
+    EXPECT_EQ(testLink.bytesSent, bytesWritten);
+    EXPECT_GT(testLink.itemsDeferred, 0U);
+}
+
+TEST(TelemetrySchedulerTest, HigherPriorityKeepsItsRateOnABusyLink)
+{
+    // given
+    telemetryLinkInit(&testLink, 9600, 10, 60);
+    initItems(60);
+    runOneSecond(1000);
+    runOneSecond(2000);
+    memset(itemSendCount, 0, sizeof(itemSendCount));
+
+    // when
+    runOneSecond(3000);
+
+    // then
+    // 16 slots a second for 30 wanted, the high priority item gets most of its 10
+    EXPECT_GE(itemSendCount[0], 8U);
+    EXPECT_GE(itemSendCount[1], itemSendCount[2]);
+    EXPECT_EQ(16U, itemSendCount[0] + itemSendCount[1] + itemSendCount[2]);
+
+    // and
+    // stale low priority items still get through
+    EXPECT_GT(itemSendCount[2], 0U);
+}
+
+TEST(TelemetrySchedulerTest, ItemsSwitchedOffAreNeverSent)
+{
+    // given
+    telemetryLinkInit(&testLink, 115200, 10, 64);
+    testLink.lastRefillAt = 0;
+    initItems(8);
+    items[1].priority = TELEMETRY_PRIORITY_OFF;
+    items[1].intervalMs = 0;
+
+    // when
+    runOneSecond(1000);
+
+    // then
+    EXPECT_EQ(0U, itemSendCount[1]);
+    EXPECT_GE(itemSendCount[0], 9U);
+    EXPECT_GE(itemSendCount[2], 9U);
+}